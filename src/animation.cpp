@@ -0,0 +1,162 @@
+#include <math.h>
+
+#include "animation.h"
+
+// EASING
+// ------
+
+/// @brief Maps the linear progress `t` (0-1) of an animation to the eased progress
+float ease(Easing easing, float t)
+{
+    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+
+    switch (easing)
+    {
+    case EASE_OUT_CUBIC:
+    {
+        float inverse = 1 - t;
+        return 1 - inverse * inverse * inverse;
+    }
+    case EASE_IN_OUT_CUBIC:
+        if (t < 0.5f)
+        {
+            return 4 * t * t * t;
+        }
+        else
+        {
+            float inverse = -2 * t + 2;
+            return 1 - inverse * inverse * inverse / 2;
+        }
+    case EASE_GLIDE:
+        // Normalized, so that the glide ends exactly at its target
+        return (1 - expf(-GLIDE_DECAY * t)) / (1 - expf(-GLIDE_DECAY));
+    case EASE_LINEAR:
+    default:
+        return t;
+    }
+}
+
+static int interpolate(int from, int to, float progress)
+{
+    return from + (int)lroundf((to - from) * progress);
+}
+
+// SCHEDULING
+// ----------
+
+/// @brief Starts animating a window. An animation already running for the window is replaced.
+/// @param normal The rect of the window in its normal state once it is finished. If NULL, a
+/// maximized window is restored to where its animation started, and any other window stays at `to`.
+/// @return False if all slots are taken, in which case the caller should apply the change instantly
+bool AnimationScheduler::start(void *window, AnimationRect from, AnimationRect to, double now, double duration, Easing easing, AnimationFinish finish,
+                               const AnimationRect *normal)
+{
+    Animation *slot = nullptr;
+    for (Animation &animation : m_animations)
+    {
+        if (animation.window == window)
+        {
+            slot = &animation;
+            break;
+        }
+        if (!slot && !animation.window)
+        {
+            slot = &animation;
+        }
+    }
+
+    if (!window || !slot)
+    {
+        return false;
+    }
+
+    if (!slot->window)
+    {
+        m_activeCount++;
+    }
+    if (!normal)
+    {
+        normal = finish == ANIMATION_FINISH_MAXIMIZE ? &from : &to;
+    }
+    *slot = {window, from, to, now, duration, easing, finish, *normal};
+    return true;
+}
+
+/// @brief Stops animating a window where it is, e.g. because a new gesture grabbed it
+/// @param cancelled Receives what the animation was doing, so that the caller can act as if it had finished
+/// @return False if the window was not being animated
+bool AnimationScheduler::cancel(void *window, CancelledAnimation *cancelled)
+{
+    for (Animation &animation : m_animations)
+    {
+        if (window && animation.window == window)
+        {
+            if (cancelled)
+            {
+                cancelled->finish = animation.finish;
+                cancelled->normal = animation.normal;
+            }
+            animation.window = nullptr;
+            m_activeCount--;
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Advances all animations to the given time
+/// @param frames Receives the frame of each animation, room for `MAX_ANIMATIONS`
+/// @return The number of frames
+int AnimationScheduler::tick(double now, AnimationFrame *frames)
+{
+    int count = 0;
+    for (Animation &animation : m_animations)
+    {
+        if (!animation.window)
+        {
+            continue;
+        }
+
+        double elapsed = now - animation.start;
+        bool isLast = elapsed >= animation.duration;
+        float progress = isLast ? 1.0f : ease(animation.easing, (float)(elapsed / animation.duration));
+
+        AnimationFrame &frame = frames[count++];
+        frame.window = animation.window;
+        frame.rect.left = interpolate(animation.from.left, animation.to.left, progress);
+        frame.rect.top = interpolate(animation.from.top, animation.to.top, progress);
+        frame.rect.right = interpolate(animation.from.right, animation.to.right, progress);
+        frame.rect.bottom = interpolate(animation.from.bottom, animation.to.bottom, progress);
+        frame.isLast = isLast;
+        frame.finish = animation.finish;
+        frame.normal = animation.normal;
+
+        if (isLast)
+        {
+            animation.window = nullptr;
+            m_activeCount--;
+        }
+    }
+    return count;
+}
+
+bool AnimationScheduler::isAnimating(void *window) const
+{
+    for (const Animation &animation : m_animations)
+    {
+        if (window && animation.window == window)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AnimationScheduler::reset()
+{
+    for (Animation &animation : m_animations)
+    {
+        animation.window = nullptr;
+    }
+    m_activeCount = 0;
+}
@@ -0,0 +1,89 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+// ANIMATION
+
+struct AnimationRect
+{
+    int left;
+    int top;
+    int right;
+    int bottom;
+};
+
+enum Easing
+{
+    EASE_LINEAR,
+    EASE_OUT_CUBIC,    // Starts fast and settles gently, for windows reacting to a click
+    EASE_IN_OUT_CUBIC, // Speeds up, then slows down
+    EASE_GLIDE,        // Starts at full speed and slows down exponentially, like momentum under friction
+};
+
+/// How far a glide (EASE_GLIDE) decays: by its end, the speed has fallen to e^-GLIDE_DECAY (about 2%)
+const float GLIDE_DECAY = 4.0f;
+
+/// What to do with the window once the animation has reached its target
+enum AnimationFinish
+{
+    ANIMATION_FINISH_NONE,
+    ANIMATION_FINISH_MAXIMIZE,
+    ANIMATION_FINISH_RESTORE, // Nothing left to do, but the window is being restored (see `CancelledAnimation`)
+};
+
+/// The rect of one window in one frame
+struct AnimationFrame
+{
+    void *window;
+    AnimationRect rect;
+    bool isLast;            // The animation has reached its target, and is removed
+    AnimationFinish finish; // Only meaningful in the last frame
+    AnimationRect normal;   // The rect of the window in its normal state once finished
+};
+
+/// What an animation was doing when it was cancelled
+struct CancelledAnimation
+{
+    AnimationFinish finish;
+    AnimationRect normal; // The rect the window would have had in its normal state once finished
+};
+
+float ease(Easing easing, float t);
+
+// SCHEDULER
+
+/// @brief Interpolates window rects over time. Every `tick` produces the frame of all in-flight
+/// animations at once, so they can be applied in a single batch. Positions are computed from the
+/// time passed, not the number of ticks: if applying a frame takes long (e.g. a slow application
+/// repaints), the next tick simply lands further along, so frames are dropped rather than queued.
+/// Time comes from the caller (in milliseconds), which makes the scheduler deterministic.
+class AnimationScheduler
+{
+public:
+    static const int MAX_ANIMATIONS = 16;
+
+    bool start(void *window, AnimationRect from, AnimationRect to, double now, double duration, Easing easing, AnimationFinish finish,
+               const AnimationRect *normal = nullptr);
+    bool cancel(void *window, CancelledAnimation *cancelled = nullptr);
+    int tick(double now, AnimationFrame *frames);
+    bool isAnimating(void *window) const;
+    bool isActive() const { return m_activeCount > 0; }
+    void reset();
+
+private:
+    struct Animation
+    {
+        void *window; // NULL if the slot is free
+        AnimationRect from;
+        AnimationRect to;
+        double start;
+        double duration;
+        Easing easing;
+        AnimationFinish finish;
+        AnimationRect normal;
+    };
+
+    Animation m_animations[MAX_ANIMATIONS] = {};
+    int m_activeCount = 0;
+};
+
+#endif // ANIMATION_H
@@ -0,0 +1,390 @@
+#include <windows.h>
+#include <dwmapi.h>
+
+#include "animator.h"
+#include "animation.h"
+#include "helpers.h"
+#include "features.h"
+
+// Animates maximize and restore on a thread of its own, so neither the hooks nor the message loop
+// ever wait for a frame. The hook thread starts and cancels animations; the animation thread ticks
+// the scheduler once per compositor frame and moves all animated windows in one batch.
+
+// CONSTANTS
+// ---------
+
+/// The frame interval to fall back to if the compositor cannot be waited on
+const DWORD FRAME_INTERVAL_MS = 16;
+
+/// How long an animation takes unless `winctrl.ini` says otherwise
+const int DEFAULT_DURATION_MS = 150;
+
+/// How long to wait for the animation thread to exit
+const DWORD THREAD_EXIT_TIMEOUT_MS = 1000;
+
+/// How long cancelling an animation waits at most for a frame being applied to the window. A batch
+/// can be held up by an application that does not respond.
+const DWORD FRAME_WAIT_TIMEOUT_MS = 50;
+
+// STATE
+// -----
+
+/// Guards `s_scheduler` and `s_appliedCount`, which are shared between the hook thread and the animation thread
+static SRWLOCK s_lock = SRWLOCK_INIT;
+static AnimationScheduler s_scheduler;
+
+/// The frame the animation thread is applying (`s_appliedCount` is 0 while it is not applying one).
+/// `s_frameApplied` is woken once it has been applied.
+static AnimationFrame s_frames[AnimationScheduler::MAX_ANIMATIONS];
+static int s_appliedCount = 0;
+static CONDITION_VARIABLE s_frameApplied = CONDITION_VARIABLE_INIT;
+
+static HANDLE s_thread = NULL;
+static HANDLE s_wakeEvent = NULL; // Signaled when an animation is started, or the thread should exit
+static volatile bool s_shouldExit = false;
+
+static int s_durationMs = DEFAULT_DURATION_MS;
+
+// HELPER FUNCTIONS
+// ----------------
+
+static double now()
+{
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return counter.QuadPart * 1000.0 / frequency.QuadPart;
+}
+
+static AnimationRect toAnimationRect(const RECT &rect) { return {(int)rect.left, (int)rect.top, (int)rect.right, (int)rect.bottom}; }
+static RECT toRect(const AnimationRect &rect) { return {rect.left, rect.top, rect.right, rect.bottom}; }
+
+/// @brief Whether the user has left animations on in the Windows settings
+static bool isSystemAnimationEnabled()
+{
+    BOOL isEnabled = TRUE;
+    SystemParametersInfo(SPI_GETCLIENTAREAANIMATION, 0, &isEnabled, 0);
+    return isEnabled;
+}
+
+/// @brief Whether windows should be animated at all: animations are on in winctrl (`Feature::Animations`
+/// and `[Animation] Duration`) and in the Windows settings
+static bool shouldAnimate()
+{
+    return Feature::Animations && s_durationMs > 0 && isSystemAnimationEnabled();
+}
+
+// ANIMATION THREAD
+// ----------------
+
+/// @brief Maximizes a window that has been animated to fill its work area. The placement keeps the
+/// given normal rect (usually where the animation started), so that restoring it later goes back there.
+static void finishMaximize(HWND hWnd, const AnimationRect &normal)
+{
+    WINDOWPLACEMENT placement = {sizeof(WINDOWPLACEMENT)};
+    GetWindowPlacement(hWnd, &placement);
+
+    POINT offset = workspaceOffset(hWnd);
+    placement.rcNormalPosition = toRect(normal);
+    OffsetRect(&placement.rcNormalPosition, -offset.x, -offset.y);
+    placement.showCmd = SW_MAXIMIZE;
+    placement.flags = WPF_ASYNCWINDOWPLACEMENT; // Do not wait for slow applications
+    SetWindowPlacement(hWnd, &placement);
+}
+
+/// @brief Moves all windows of a frame in one batch
+static void applyFrame(const AnimationFrame *frames, int count)
+{
+    WindowPosition positions[AnimationScheduler::MAX_ANIMATIONS] = {};
+    int positionCount = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const AnimationFrame &frame = frames[i];
+        if (frame.isLast && frame.finish == ANIMATION_FINISH_MAXIMIZE)
+        {
+            continue; // Maximizing puts the window in its final place
+        }
+        positions[positionCount++] = {(HWND)frame.window, toRect(frame.rect)};
+    }
+    placeWindows(positions, positionCount, SWP_NOZORDER | SWP_NOACTIVATE | SWP_NOOWNERZORDER);
+
+    for (int i = 0; i < count; i++)
+    {
+        if (frames[i].isLast && frames[i].finish == ANIMATION_FINISH_MAXIMIZE)
+        {
+            finishMaximize((HWND)frames[i].window, frames[i].normal);
+        }
+    }
+}
+
+static DWORD WINAPI AnimationThreadProc(LPVOID lpParameter)
+{
+    while (!s_shouldExit)
+    {
+        // The frame is computed under the lock, but applied outside of it: moving windows can take
+        // a while, and the hook thread must not wait for that, unless it cancels the animation of a
+        // window in this very frame (see `cancelWindowAnimation`)
+        AcquireSRWLockExclusive(&s_lock);
+        int count = s_scheduler.tick(now(), s_frames);
+        bool isActive = s_scheduler.isActive();
+        s_appliedCount = count;
+        ReleaseSRWLockExclusive(&s_lock);
+
+        applyFrame(s_frames, count);
+
+        AcquireSRWLockExclusive(&s_lock);
+        s_appliedCount = 0;
+        ReleaseSRWLockExclusive(&s_lock);
+        WakeAllConditionVariable(&s_frameApplied);
+
+        if (!isActive)
+        {
+            WaitForSingleObject(s_wakeEvent, INFINITE);
+        }
+        else if (FAILED(DwmFlush())) // Waits for the next composition, which paces the frames
+        {
+            Sleep(FRAME_INTERVAL_MS);
+        }
+    }
+
+    return 0;
+}
+
+// ANIMATIONS
+// ----------
+
+static bool startAnimation(HWND hWnd, const RECT &from, const RECT &to, double duration, Easing easing, AnimationFinish finish,
+                           const RECT *normal = NULL)
+{
+    if (!s_thread)
+    {
+        s_shouldExit = false;
+        s_wakeEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+        s_thread = s_wakeEvent ? CreateThread(NULL, 0, AnimationThreadProc, NULL, 0, NULL) : NULL;
+        if (!s_thread)
+        {
+            return false;
+        }
+    }
+
+    AnimationRect normalRect = normal ? toAnimationRect(*normal) : AnimationRect();
+    AcquireSRWLockExclusive(&s_lock);
+    bool isStarted = s_scheduler.start(hWnd, toAnimationRect(from), toAnimationRect(to), now(), duration, easing, finish,
+                                       normal ? &normalRect : NULL);
+    ReleaseSRWLockExclusive(&s_lock);
+
+    if (isStarted)
+    {
+        SetEvent(s_wakeEvent);
+    }
+    return isStarted;
+}
+
+/// @brief Grows a window to fill the work area of its monitor, then maximizes it
+/// @return False if the window should be maximized instantly instead
+bool animateMaximize(HWND hWnd)
+{
+    if (!hWnd || !shouldAnimate() || IsZoomed(hWnd) || IsIconic(hWnd))
+    {
+        return false;
+    }
+
+    RECT from;
+    GetWindowRect(hWnd, &from);
+    MONITORINFO monitor = {sizeof(MONITORINFO)};
+    GetMonitorInfo(MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST), &monitor);
+
+    return startAnimation(hWnd, from, monitor.rcWork, s_durationMs, EASE_OUT_CUBIC, ANIMATION_FINISH_MAXIMIZE);
+}
+
+/// @brief Restores a maximized window in place, then shrinks it back to its normal rect
+/// @return False if the window should be restored instantly instead
+bool animateRestore(HWND hWnd)
+{
+    if (!hWnd || !shouldAnimate() || !IsZoomed(hWnd))
+    {
+        return false;
+    }
+
+    WINDOWPLACEMENT placement = {sizeof(WINDOWPLACEMENT)};
+    if (!GetWindowPlacement(hWnd, &placement))
+    {
+        return false;
+    }
+
+    POINT offset = workspaceOffset(hWnd);
+    RECT to = placement.rcNormalPosition;
+    OffsetRect(&to, offset.x, offset.y);
+
+    // Restoring with the work area as the normal rect leaves the window where it is, so the
+    // animation starts without a jump (and without the application painting its old size first)
+    MONITORINFO monitor = {sizeof(MONITORINFO)};
+    GetMonitorInfo(MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST), &monitor);
+    RECT from = monitor.rcWork;
+    placement.rcNormalPosition = from;
+    OffsetRect(&placement.rcNormalPosition, -offset.x, -offset.y);
+    placement.showCmd = SW_RESTORE;
+    SetWindowPlacement(hWnd, &placement);
+
+    if (!startAnimation(hWnd, from, to, s_durationMs, EASE_OUT_CUBIC, ANIMATION_FINISH_RESTORE))
+    {
+        SetWindowPos(hWnd, NULL, to.left, to.top, to.right - to.left, to.bottom - to.top, SWP_NOZORDER | SWP_NOACTIVATE);
+    }
+    return true;
+}
+
+/// @brief Takes a window that was still being maximized (see `cancelWindowAnimation`) back to the
+/// normal rect it came from, animated from where it is now
+void reverseMaximize(HWND hWnd, const RECT &normalRect)
+{
+    RECT from;
+    if (!GetWindowRect(hWnd, &from))
+    {
+        return;
+    }
+
+    if (!shouldAnimate() || !startAnimation(hWnd, from, normalRect, s_durationMs, EASE_OUT_CUBIC, ANIMATION_FINISH_RESTORE))
+    {
+        SetWindowPos(hWnd, NULL, normalRect.left, normalRect.top, normalRect.right - normalRect.left,
+                     normalRect.bottom - normalRect.top, SWP_NOZORDER | SWP_NOACTIVATE);
+    }
+}
+
+/// @brief Maximizes a window that was still being restored (see `cancelWindowAnimation`), animated
+/// from where it is now. Restoring it later goes to the normal rect it was being restored to.
+void reverseRestore(HWND hWnd, const RECT &normalRect)
+{
+    RECT from;
+    if (!GetWindowRect(hWnd, &from))
+    {
+        return;
+    }
+
+    MONITORINFO monitor = {sizeof(MONITORINFO)};
+    GetMonitorInfo(MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST), &monitor);
+    if (!shouldAnimate() ||
+        !startAnimation(hWnd, from, monitor.rcWork, s_durationMs, EASE_OUT_CUBIC, ANIMATION_FINISH_MAXIMIZE, &normalRect))
+    {
+        finishMaximize(hWnd, toAnimationRect(normalRect));
+    }
+}
+
+/// @brief Lets a window glide on with the given velocity (in pixels per millisecond) until friction
+/// stops it, or it comes to rest against the edges of its monitor (see `planThrow`)
+/// @return False if it was too slow to be thrown, in which case it stays where it is
+bool animateThrow(HWND hWnd, float velocityX, float velocityY, const ThrowSettings &settings)
+{
+    if (!hWnd || IsZoomed(hWnd) || IsIconic(hWnd))
+    {
+        return false;
+    }
+
+    RECT from;
+    GetWindowRect(hWnd, &from);
+    MONITORINFO monitor = {sizeof(MONITORINFO)};
+    GetMonitorInfo(MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST), &monitor);
+
+    ThrowPlan plan;
+    if (!planThrow(toAnimationRect(from), velocityX, velocityY, toAnimationRect(monitor.rcWork), settings, &plan))
+    {
+        return false;
+    }
+
+    // Without animations, the window goes straight to where it would have come to rest
+    RECT to = toRect(plan.to);
+    if (!shouldAnimate() || !startAnimation(hWnd, from, to, plan.duration, EASE_GLIDE, ANIMATION_FINISH_NONE))
+    {
+        SetWindowPos(hWnd, NULL, to.left, to.top, to.right - to.left, to.bottom - to.top, SWP_NOZORDER | SWP_NOACTIVATE);
+    }
+    return true;
+}
+
+static bool isBeingApplied(HWND hWnd)
+{
+    for (int i = 0; i < s_appliedCount; i++)
+    {
+        if (s_frames[i].window == hWnd)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Stops animating a window where it is, e.g. because a new gesture grabbed it. If the
+/// animation thread is applying a frame to the window right now, this waits until it is done (for
+/// at most `FRAME_WAIT_TIMEOUT_MS`), so the window does not move again once this returns.
+/// @param normalRect Receives the normal rect the window would have had once the animation finished
+/// @return Whether a maximize or restore was cancelled before it finished
+WindowTransition cancelWindowAnimation(HWND hWnd, RECT *normalRect)
+{
+    if (!s_thread)
+    {
+        return TRANSITION_NONE;
+    }
+
+    CancelledAnimation cancelled;
+    AcquireSRWLockExclusive(&s_lock);
+    bool isCancelled = s_scheduler.cancel(hWnd, &cancelled);
+    while (isBeingApplied(hWnd))
+    {
+        if (!SleepConditionVariableSRW(&s_frameApplied, &s_lock, FRAME_WAIT_TIMEOUT_MS, 0))
+        {
+            break; // Held up by an application that does not respond, go on without waiting for it
+        }
+    }
+    ReleaseSRWLockExclusive(&s_lock);
+
+    if (!isCancelled)
+    {
+        return TRANSITION_NONE;
+    }
+
+    if (normalRect)
+    {
+        *normalRect = toRect(cancelled.normal);
+    }
+    switch (cancelled.finish)
+    {
+    case ANIMATION_FINISH_MAXIMIZE:
+        return TRANSITION_MAXIMIZE;
+    case ANIMATION_FINISH_RESTORE:
+        return TRANSITION_RESTORE;
+    default:
+        return TRANSITION_NONE;
+    }
+}
+
+// SETUP AND TEARDOWN
+// ------------------
+
+/// @brief Reads the `[Animation]` section of `winctrl.ini`. `Duration` is in milliseconds; 0 turns animations off.
+void loadAnimationSettings()
+{
+    wchar_t path[MAX_PATH];
+    if (getAppFilePath(L".ini", path, MAX_PATH))
+    {
+        s_durationMs = GetPrivateProfileIntW(L"Animation", L"Duration", DEFAULT_DURATION_MS, path);
+    }
+}
+
+/// @brief Stops the animation thread. Windows being animated are left where they are.
+void teardownAnimations()
+{
+    if (!s_thread)
+    {
+        return;
+    }
+
+    s_shouldExit = true;
+    SetEvent(s_wakeEvent);
+    WaitForSingleObject(s_thread, THREAD_EXIT_TIMEOUT_MS);
+    CloseHandle(s_thread);
+    CloseHandle(s_wakeEvent);
+    s_thread = NULL;
+    s_wakeEvent = NULL;
+
+    AcquireSRWLockExclusive(&s_lock);
+    s_scheduler.reset();
+    ReleaseSRWLockExclusive(&s_lock);
+}
@@ -0,0 +1,28 @@
+#ifndef ANIMATOR_H
+#define ANIMATOR_H
+
+#include <windows.h>
+
+#include "kinetic.h"
+
+// WINDOW ANIMATIONS
+
+/// What a cancelled animation was doing to its window
+enum WindowTransition
+{
+    TRANSITION_NONE, // Nothing was animated, or the window was only moved (e.g. thrown)
+    TRANSITION_MAXIMIZE,
+    TRANSITION_RESTORE,
+};
+
+bool animateMaximize(HWND hWnd);
+bool animateRestore(HWND hWnd);
+bool animateThrow(HWND hWnd, float velocityX, float velocityY, const ThrowSettings &settings);
+void reverseMaximize(HWND hWnd, const RECT &normalRect);
+void reverseRestore(HWND hWnd, const RECT &normalRect);
+WindowTransition cancelWindowAnimation(HWND hWnd, RECT *normalRect = NULL);
+
+void loadAnimationSettings();
+void teardownAnimations();
+
+#endif // ANIMATOR_H
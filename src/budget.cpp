@@ -0,0 +1,192 @@
+#ifdef WINCTRL_HOOK_BUDGET
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <new>
+
+#include "budget.h"
+
+// BUDGETS
+// -------
+
+/// The maximum number of annotated platform calls (besides `CallNextHookEx`) per event type.
+/// Every event also makes the two QueryPerformanceCounter calls that time it for the live status.
+/// Window actions are rare, so they may talk to the system, but only so much: anything slower
+/// (waiting on another window, COM) is handed to the thread pool.
+static const int PLATFORM_CALL_BUDGET[HOOK_EVENT_TYPES] = {
+    2 + 1,  // HOOK_MOUSE_MOVE: SetWindowPos while dragging or resizing
+    2 + 3,  // HOOK_MOUSE_BUTTON: confirming the Win key, and (re)arming the long-press timer
+    2 + 0,  // HOOK_KEY: hotkeys are matched against tracked modifier state
+    2 + 20, // HOOK_ACTION: finding the window, reading its placement and limits, queuing the rest
+};
+
+static const char *const EVENT_NAMES[HOOK_EVENT_TYPES] = {
+    "mouse move",
+    "mouse button",
+    "key",
+    "action",
+};
+
+/// The number of call sites remembered per event for the report
+const int MAX_RECORDED_SITES = 16;
+
+// STATE
+// -----
+
+static int s_eventDepth = 0;
+static HookEventType s_eventType;
+static int s_allocations = 0;
+static int s_platformCalls = 0;
+static const char *s_sites[MAX_RECORDED_SITES];
+
+static HookEventCost s_lastEventCost;
+static int s_eventsOverBudget = 0;
+
+// EVENTS
+// ------
+
+void beginHookEvent(HookEventType type)
+{
+    // A nested event (e.g. a hook running while another one pumps messages) counts towards the outer one
+    if (s_eventDepth++ > 0)
+    {
+        return;
+    }
+
+    s_eventType = type;
+    s_allocations = 0;
+    s_platformCalls = 0;
+}
+
+void markHookAction()
+{
+    s_eventType = HOOK_ACTION;
+}
+
+void countPlatformCall(const char *site)
+{
+    if (s_eventDepth == 0)
+    {
+        return;
+    }
+
+    if (s_platformCalls < MAX_RECORDED_SITES)
+    {
+        s_sites[s_platformCalls] = site;
+    }
+    s_platformCalls++;
+}
+
+void endHookEvent()
+{
+    if (s_eventDepth == 0 || --s_eventDepth > 0)
+    {
+        return;
+    }
+
+    s_lastEventCost = {s_eventType, s_allocations, s_platformCalls};
+
+    int budget = PLATFORM_CALL_BUDGET[s_eventType];
+    bool isOverBudget = s_platformCalls > budget;
+    if (s_allocations == 0 && !isOverBudget)
+    {
+        return;
+    }
+    s_eventsOverBudget++;
+
+    char report[2048];
+    int length = snprintf(report, sizeof(report),
+                          "winctrl: %s event over budget: %d allocation(s), %d platform call(s) (budget %d)\n",
+                          EVENT_NAMES[s_eventType], s_allocations, s_platformCalls, budget);
+    for (int i = 0; i < s_platformCalls && i < MAX_RECORDED_SITES && length < (int)sizeof(report); i++)
+    {
+        length += snprintf(report + length, sizeof(report) - length, "  call %d: %s\n", i + 1, s_sites[i]);
+    }
+
+    OutputDebugStringA(report);
+    fputs(report, stderr);
+}
+
+// RESULTS
+// -------
+
+int getPlatformCallBudget(HookEventType type) { return PLATFORM_CALL_BUDGET[type]; }
+HookEventCost getLastHookEventCost() { return s_lastEventCost; }
+
+/// @brief Tells how many events went over their budget so far, so that a test can fail on them
+int getHookEventsOverBudget() { return s_eventsOverBudget; }
+
+// ALLOCATOR
+// ---------
+// Replaces the global allocator, so that any allocation made during a hook event is counted.
+// Every replaceable form of `new` is replaced, since any of them allocates.
+
+static void *allocate(size_t size, bool canFail = false)
+{
+    if (s_eventDepth > 0)
+    {
+        s_allocations++;
+    }
+
+    void *ptr = malloc(size ? size : 1);
+    if (!ptr && !canFail)
+    {
+        abort(); // Builds may disable exceptions, so treat running out of memory as fatal
+    }
+    return ptr;
+}
+
+/// @brief Over-allocates to align the block, and keeps the pointer to free just before it
+static void *allocateAligned(size_t size, std::align_val_t alignment, bool canFail = false)
+{
+    size_t align = (size_t)alignment < sizeof(void *) ? sizeof(void *) : (size_t)alignment;
+    char *block = (char *)allocate(size + align + sizeof(void *), canFail);
+    if (!block)
+    {
+        return NULL;
+    }
+
+    uintptr_t aligned = ((uintptr_t)block + sizeof(void *) + align - 1) & ~(uintptr_t)(align - 1);
+    ((void **)aligned)[-1] = block;
+    return (void *)aligned;
+}
+
+static void freeAligned(void *ptr)
+{
+    if (ptr)
+    {
+        free(((void **)ptr)[-1]);
+    }
+}
+
+void *operator new(size_t size) { return allocate(size); }
+void *operator new[](size_t size) { return allocate(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return allocate(size, true); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return allocate(size, true); }
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete[](void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { free(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { free(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { free(ptr); }
+
+void *operator new(size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void *operator new[](size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocateAligned(size, alignment, true);
+}
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocateAligned(size, alignment, true);
+}
+void operator delete(void *ptr, std::align_val_t) noexcept { freeAligned(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { freeAligned(ptr); }
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept { freeAligned(ptr); }
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept { freeAligned(ptr); }
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { freeAligned(ptr); }
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { freeAligned(ptr); }
+
+#endif // WINCTRL_HOOK_BUDGET
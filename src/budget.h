@@ -0,0 +1,65 @@
+#ifndef BUDGET_H
+#define BUDGET_H
+
+// HOOK BUDGET
+//
+// The hook callbacks run on every mouse and keyboard event in the system, and the system
+// silently removes hooks that are too slow. Each kind of event therefore has a budget:
+// it may never allocate, and may only make a declared number of platform calls.
+//
+// Building with `-DWINCTRL_HOOK_BUDGET` counts the heap allocations (through a replaced global
+// allocator, all forms of `new` included) and annotated platform calls of every hook event, and
+// reports each event that goes over its budget, along with the call sites, to the debugger output
+// and stderr. The tests also compare the annotated calls against every call the simulated platform
+// sees (see tests/test_budget.cpp). In a normal build all of this compiles away.
+
+enum HookEventType
+{
+    HOOK_MOUSE_MOVE,   // Cursor movement, including every step of a drag or resize
+    HOOK_MOUSE_BUTTON, // Button presses/releases and wheel turns that do not perform a window action
+    HOOK_KEY,          // Key presses that are not bound to a hotkey
+    HOOK_ACTION,       // Any event that starts, ends or performs a window action
+    HOOK_EVENT_TYPES
+};
+
+#ifdef WINCTRL_HOOK_BUDGET
+
+/// What a finished hook event cost
+struct HookEventCost
+{
+    HookEventType type;
+    int allocations;
+    int platformCalls;
+};
+
+void beginHookEvent(HookEventType type);
+void markHookAction();
+void countPlatformCall(const char *site);
+void endHookEvent();
+
+int getPlatformCallBudget(HookEventType type);
+HookEventCost getLastHookEventCost();
+int getHookEventsOverBudget();
+
+struct HookBudgetScope
+{
+    HookBudgetScope(HookEventType type) { beginHookEvent(type); }
+    ~HookBudgetScope() { endHookEvent(); }
+};
+
+// Accounts the rest of the current hook event as `type`
+#define HOOK_BUDGET_SCOPE(type) HookBudgetScope hookBudgetScope(type)
+// Moves the current hook event into the HOOK_ACTION budget, once it has performed a window action
+#define HOOK_BUDGET_ACTION() markHookAction()
+// Counts a platform call made at `site` against the budget of the current hook event
+#define HOOK_PLATFORM_CALL(site) countPlatformCall(site)
+
+#else
+
+#define HOOK_BUDGET_SCOPE(type)
+#define HOOK_BUDGET_ACTION()
+#define HOOK_PLATFORM_CALL(site)
+
+#endif // WINCTRL_HOOK_BUDGET
+
+#endif // BUDGET_H
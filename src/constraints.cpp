@@ -0,0 +1,85 @@
+#include "constraints.h"
+
+// CONSTANTS
+// ---------
+
+/// @brief How much larger (or smaller) than requested a window must end up before that is taken
+/// as a limit. Applications that size in steps (e.g. terminals, by character cells) correct every
+/// request by less than a step, and must not be mistaken for having reached a limit.
+const int LIMIT_EVIDENCE = 32;
+
+// HELPER FUNCTIONS
+// ----------------
+
+/// @brief Clamps one axis of a rect to the size limits
+/// @param movesLow, movesHigh Whether the resize moves the low (left/top) or high (right/bottom)
+/// edge. The clamped size is taken from the edges that move; if both or neither move, from both
+/// halves, so that the center stays where it is.
+static void clampAxis(int *low, int *high, bool movesLow, bool movesHigh, int minSize, int maxSize)
+{
+    int size = *high - *low;
+    int clamped = size < minSize ? minSize : (size > maxSize ? maxSize : size);
+    if (clamped == size)
+    {
+        return;
+    }
+
+    if (movesLow && !movesHigh)
+    {
+        *low = *high - clamped;
+    }
+    else if (movesHigh && !movesLow)
+    {
+        *high = *low + clamped;
+    }
+    else
+    {
+        *low += (size - clamped) / 2;
+        *high = *low + clamped;
+    }
+}
+
+/// @brief Learns the limits of one axis from how the application corrected a request
+static void learnAxis(int requested, int actual, int *minSize, int *maxSize)
+{
+    if (actual - requested >= LIMIT_EVIDENCE && actual > *minSize)
+    {
+        *minSize = actual;
+    }
+    else if (requested - actual >= LIMIT_EVIDENCE && actual < *maxSize)
+    {
+        *maxSize = actual;
+    }
+}
+
+// CONSTRAINTS
+// -----------
+
+/// @brief Starts a resize with the limits the window reports
+void ResizeConstraints::begin(const SizeLimits &limits)
+{
+    m_limits = limits;
+    if (m_limits.maxWidth < m_limits.minWidth)
+    {
+        m_limits.maxWidth = m_limits.minWidth;
+    }
+    if (m_limits.maxHeight < m_limits.minHeight)
+    {
+        m_limits.maxHeight = m_limits.minHeight;
+    }
+}
+
+/// @brief Clamps a requested rect to the limits, moving only the given `edges` (see `ResizeEdges`)
+void ResizeConstraints::clamp(int edges, int *left, int *top, int *right, int *bottom) const
+{
+    clampAxis(left, right, edges & EDGE_LEFT, edges & EDGE_RIGHT, m_limits.minWidth, m_limits.maxWidth);
+    clampAxis(top, bottom, edges & EDGE_TOP, edges & EDGE_BOTTOM, m_limits.minHeight, m_limits.maxHeight);
+}
+
+/// @brief Learns from the size the application actually gave the window after a request. A window
+/// that stays clearly larger (or smaller) than requested has reached a limit it did not report.
+void ResizeConstraints::observe(int requestedWidth, int requestedHeight, int actualWidth, int actualHeight)
+{
+    learnAxis(requestedWidth, actualWidth, &m_limits.minWidth, &m_limits.maxWidth);
+    learnAxis(requestedHeight, actualHeight, &m_limits.minHeight, &m_limits.maxHeight);
+}
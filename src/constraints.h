@@ -0,0 +1,45 @@
+#ifndef CONSTRAINTS_H
+#define CONSTRAINTS_H
+
+#include <limits.h>
+
+// SIZE LIMITS
+
+/// The smallest and largest size a window accepts
+struct SizeLimits
+{
+    int minWidth = 0;
+    int minHeight = 0;
+    int maxWidth = INT_MAX;
+    int maxHeight = INT_MAX;
+};
+
+/// The edges of a window that a resize moves; the others stay anchored where they are
+enum ResizeEdges
+{
+    EDGE_LEFT = 1,
+    EDGE_TOP = 2,
+    EDGE_RIGHT = 4,
+    EDGE_BOTTOM = 8,
+};
+
+// CONSTRAINTS
+
+/// @brief Keeps a resize within the size limits of the window, so that the application never has
+/// to correct it. An application that corrects a size on its own keeps the edge it prefers, which
+/// is not necessarily the anchored one, so the window jitters and its opposite edge drifts.
+/// Instead, a request is clamped here, before it is made, moving only the edges being dragged.
+/// Limits the application does not report are learned from how it corrects the requests.
+class ResizeConstraints
+{
+public:
+    void begin(const SizeLimits &limits);
+    void clamp(int edges, int *left, int *top, int *right, int *bottom) const;
+    void observe(int requestedWidth, int requestedHeight, int actualWidth, int actualHeight);
+    const SizeLimits &limits() const { return m_limits; }
+
+private:
+    SizeLimits m_limits;
+};
+
+#endif // CONSTRAINTS_H
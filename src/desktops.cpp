@@ -0,0 +1,88 @@
+#include "desktops.h"
+
+// STATE
+// -----
+
+void VirtualDesktops::setBackend(DesktopBackend *backend)
+{
+    m_backend = backend;
+    m_count = 0;
+    m_current = -1;
+}
+
+/// @brief Re-reads the desktops from the backend, since the user can add, remove or switch
+/// desktops without us knowing. False if the backend cannot tell.
+bool VirtualDesktops::refresh()
+{
+    int count, current;
+    if (!m_backend || !m_backend->query(&count, &current) || count <= 0 || current < 0 || current >= count)
+    {
+        m_count = 0;
+        m_current = -1;
+        return false;
+    }
+
+    m_count = count;
+    m_current = current;
+    return true;
+}
+
+// SWITCHING
+// ---------
+
+/// @brief Switches to the desktop with the given index
+/// @return False if there is no such desktop, it is already current, or the switch failed
+bool VirtualDesktops::switchTo(int index)
+{
+    if (!refresh() || index < 0 || index >= m_count || index == m_current)
+    {
+        return false;
+    }
+
+    double start = m_backend->now();
+
+    // Prefer a direct switch, and fall back to stepping there
+    m_usedDirectSwitch = m_backend->activate(index);
+    bool isSwitched = m_usedDirectSwitch || m_backend->step(index - m_current);
+    m_lastSwitchLatency = m_backend->now() - start;
+    if (isSwitched)
+    {
+        m_current = index;
+    }
+    return isSwitched;
+}
+
+/// @brief Switches to the desktop `delta` places to the right (or left, if negative).
+/// Stops at the first and last desktop, as the system does.
+bool VirtualDesktops::switchBy(int delta)
+{
+    if (!m_backend || delta == 0)
+    {
+        return false;
+    }
+
+    if (!refresh())
+    {
+        // Without knowing where we are, all we can do is step blindly
+        double start = m_backend->now();
+        m_usedDirectSwitch = false;
+        bool isSwitched = m_backend->step(delta);
+        m_lastSwitchLatency = m_backend->now() - start;
+        return isSwitched;
+    }
+
+    int index = m_current + delta;
+    index = index < 0 ? 0 : (index >= m_count ? m_count - 1 : index);
+    return switchTo(index);
+}
+
+/// @brief Moves a window to the desktop with the given index
+bool VirtualDesktops::moveWindowTo(void *window, int index)
+{
+    if (!window || !refresh() || index < 0 || index >= m_count)
+    {
+        return false;
+    }
+
+    return m_backend->moveWindow(window, index);
+}
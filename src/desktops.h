@@ -0,0 +1,53 @@
+#ifndef DESKTOPS_H
+#define DESKTOPS_H
+
+// VIRTUAL DESKTOP BACKEND
+
+/// @brief What the operating system offers for virtual desktops. Desktops are 0-based indexes.
+/// A backend implements what it can and returns false for the rest; `VirtualDesktops` then
+/// falls back to the next best way.
+class DesktopBackend
+{
+public:
+    /// Reads the number of desktops and the index of the current one. False if they are unknown
+    virtual bool query(int *count, int *current) = 0;
+    /// Switches straight to a desktop, without stepping through the ones in between
+    virtual bool activate(int index) = 0;
+    /// Steps through the desktops like Win+Ctrl+Left/Right, `steps` times (negative steps go left)
+    virtual bool step(int steps) = 0;
+    /// Moves a (platform-specific) window to another desktop
+    virtual bool moveWindow(void *window, int index) = 0;
+    /// A monotonic clock in milliseconds, used to measure how long each switch takes
+    virtual double now() = 0;
+};
+
+// VIRTUAL DESKTOPS
+
+/// @brief Switches between virtual desktops through a backend. Knows which desktop is current,
+/// turns "go to desktop N" into whatever the backend supports (a direct switch, or else the right
+/// number of steps in one go), and measures the latency of every switch.
+class VirtualDesktops
+{
+public:
+    void setBackend(DesktopBackend *backend);
+
+    bool switchTo(int index);
+    bool switchBy(int delta);
+    bool moveWindowTo(void *window, int index);
+
+    int count() const { return m_count; }
+    int current() const { return m_current; }
+    bool usedDirectSwitch() const { return m_usedDirectSwitch; }
+    double lastSwitchLatency() const { return m_lastSwitchLatency; }
+
+private:
+    bool refresh();
+
+    DesktopBackend *m_backend = nullptr;
+    bool m_usedDirectSwitch = false;
+    int m_count = 0;
+    int m_current = -1;
+    double m_lastSwitchLatency = 0;
+};
+
+#endif // DESKTOPS_H
@@ -5,9 +5,19 @@ bool Feature::Move = true;
 bool Feature::Resize = true;
 bool Feature::Transparency = true;
 bool Feature::VirtualDesktopScroll = true;
+bool Feature::AutoRestoreLayout = false;
+bool Feature::Hotkeys = true;
+bool Feature::PredictiveDrag = false;
+bool Feature::Animations = true;
+bool Feature::KineticThrow = false;
 
 void Feature::toggleWinCtrlEnabled() { isWinCtrlEnabled = !isWinCtrlEnabled; }
 void Feature::toggleMove() { Move = !Move; }
 void Feature::toggleResize() { Resize = !Resize; }
 void Feature::toggleTransparency() { Transparency = !Transparency; }
 void Feature::toggleVirtualDesktopScroll() { VirtualDesktopScroll = !VirtualDesktopScroll; }
+void Feature::toggleAutoRestoreLayout() { AutoRestoreLayout = !AutoRestoreLayout; }
+void Feature::toggleHotkeys() { Hotkeys = !Hotkeys; }
+void Feature::togglePredictiveDrag() { PredictiveDrag = !PredictiveDrag; }
+void Feature::toggleAnimations() { Animations = !Animations; }
+void Feature::toggleKineticThrow() { KineticThrow = !KineticThrow; }
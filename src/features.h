@@ -9,12 +9,22 @@ public:
     static bool Resize;
     static bool Transparency;
     static bool VirtualDesktopScroll;
+    static bool AutoRestoreLayout;
+    static bool Hotkeys;
+    static bool PredictiveDrag;
+    static bool Animations;
+    static bool KineticThrow;
 
     static void toggleWinCtrlEnabled();
     static void toggleMove();
     static void toggleResize();
     static void toggleTransparency();
     static void toggleVirtualDesktopScroll();
+    static void toggleAutoRestoreLayout();
+    static void toggleHotkeys();
+    static void togglePredictiveDrag();
+    static void toggleAnimations();
+    static void toggleKineticThrow();
 };
 
 #endif // FEATURES_H
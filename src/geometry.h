@@ -0,0 +1,144 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <stdint.h>
+
+#include "constraints.h"
+
+// The geometry of resizing and zooming, in integer and 16.16 fixed-point math only. Every rect is
+// computed from the rect at the start of the gesture rather than from the previous step, so
+// rounding never accumulates: returning to the start returns to the very same rect. All functions
+// are constexpr, which lets the checks at the end of this file run at compile time.
+
+// FIXED POINT
+
+/// A 16.16 fixed-point number
+typedef int32_t Fixed;
+
+const int FIXED_SHIFT = 16;
+const Fixed FIXED_ONE = 1 << FIXED_SHIFT;
+
+/// @brief Divides, rounding to the nearest integer (halves away from zero)
+constexpr int64_t divideRounded(int64_t numerator, int64_t denominator)
+{
+    if (denominator < 0)
+    {
+        numerator = -numerator;
+        denominator = -denominator;
+    }
+    return numerator >= 0 ? (numerator + denominator / 2) / denominator : -((-numerator + denominator / 2) / denominator);
+}
+
+/// @brief Divides, rounding towards negative infinity. `denominator` must be positive.
+constexpr int64_t divideFloor(int64_t numerator, int64_t denominator)
+{
+    return numerator >= 0 ? numerator / denominator : -((-numerator + denominator - 1) / denominator);
+}
+
+/// @brief `numerator / denominator` as a fixed-point number, saturating at the largest one
+constexpr Fixed fixedRatio(int numerator, int denominator)
+{
+    int64_t ratio = divideRounded((int64_t)numerator << FIXED_SHIFT, denominator);
+    return ratio > INT32_MAX ? INT32_MAX : (Fixed)ratio;
+}
+
+constexpr Fixed multiplyFixed(Fixed a, Fixed b)
+{
+    return (Fixed)divideRounded((int64_t)a * b, FIXED_ONE);
+}
+
+/// @brief `step` to the power of `count`, which may be negative
+constexpr Fixed powerFixed(Fixed step, int count)
+{
+    Fixed result = FIXED_ONE;
+    for (int i = 0; i < (count < 0 ? -count : count); i++)
+    {
+        result = multiplyFixed(result, step);
+    }
+    return count < 0 ? (Fixed)divideRounded((int64_t)FIXED_ONE << FIXED_SHIFT, result) : result;
+}
+
+/// @brief Scales a length, rounding to the nearest pixel
+constexpr int scaleLength(int length, Fixed scale)
+{
+    return (int)divideRounded((int64_t)length * scale, FIXED_ONE);
+}
+
+// RECTS
+
+struct GeometryRect
+{
+    int left;
+    int top;
+    int right;
+    int bottom;
+
+    constexpr int width() const { return right - left; }
+    constexpr int height() const { return bottom - top; }
+    constexpr bool operator==(const GeometryRect &other) const
+    {
+        return left == other.left && top == other.top && right == other.right && bottom == other.bottom;
+    }
+};
+
+/// @brief Moves the `edges` of a rect (see `ResizeEdges`) by the mouse movement, as dragging an
+/// edge or corner does. The other edges stay exactly where they are.
+constexpr GeometryRect moveEdges(GeometryRect rect, int edges, int dx, int dy)
+{
+    return {
+        rect.left + (edges & EDGE_LEFT ? dx : 0),
+        rect.top + (edges & EDGE_TOP ? dy : 0),
+        rect.right + (edges & EDGE_RIGHT ? dx : 0),
+        rect.bottom + (edges & EDGE_BOTTOM ? dy : 0),
+    };
+}
+
+/// @brief Limits a scale, so that a rect of the given size stays within the size limits once scaled
+constexpr Fixed clampScale(Fixed scale, int width, int height, const SizeLimits &limits)
+{
+    Fixed lowest = fixedRatio(limits.minWidth, width);
+    Fixed lowestForHeight = fixedRatio(limits.minHeight, height);
+    Fixed highest = fixedRatio(limits.maxWidth, width);
+    Fixed highestForHeight = fixedRatio(limits.maxHeight, height);
+    lowest = lowestForHeight > lowest ? lowestForHeight : lowest;
+    highest = highestForHeight < highest ? highestForHeight : highest;
+
+    // The minimum wins over the maximum, whichever side of both the scale is on
+    scale = scale > highest ? highest : scale;
+    return scale < lowest ? lowest : scale;
+}
+
+/// @brief Scales a rect to the given height about its center. The width follows from the exact
+/// aspect ratio, and the center stays put to within half a pixel (always rounding the same way).
+constexpr GeometryRect zoomAboutCenter(GeometryRect rect, int height)
+{
+    int width = (int)divideRounded((int64_t)height * rect.width(), rect.height());
+    int left = (int)divideFloor((int64_t)rect.left + rect.right - width, 2);
+    int top = (int)divideFloor((int64_t)rect.top + rect.bottom - height, 2);
+    return {left, top, left + width, top + height};
+}
+
+/// @brief Scales a rect about a point (e.g. the cursor), which stays over the same spot of the
+/// rect. The height follows from the width by the exact aspect ratio, and the point is placed
+/// by the scale of each side, so that an edge through the point stays exactly where it is.
+constexpr GeometryRect zoomAbout(GeometryRect rect, int x, int y, Fixed scale)
+{
+    int width = scaleLength(rect.width(), scale);
+    int height = (int)divideRounded((int64_t)width * rect.height(), rect.width());
+    int left = x - scaleLength(x - rect.left, scale);
+    int top = y - (int)divideRounded((int64_t)(y - rect.top) * height, rect.height());
+    return {left, top, left + width, top + height};
+}
+
+// CHECKS
+
+static_assert(powerFixed(72090, 0) == FIXED_ONE && powerFixed(FIXED_ONE, -5) == FIXED_ONE, "A zoom by no steps must be exact");
+static_assert(divideRounded(-3, 2) == -2 && divideFloor(-3, 2) == -2 && divideFloor(3, 2) == 1, "Rounding must be symmetric");
+static_assert(moveEdges({100, 100, 900, 600}, EDGE_TOP | EDGE_LEFT, 30, -20) == GeometryRect{130, 80, 900, 600}, "Anchored edges must not move");
+static_assert(zoomAboutCenter({101, 99, 902, 600}, 501) == GeometryRect{101, 99, 902, 600}, "Zooming back to the start must return the same rect");
+static_assert(zoomAboutCenter({0, 0, 1600, 900}, 450) == GeometryRect{400, 225, 1200, 675}, "Zooming must keep the center and the aspect ratio");
+static_assert(zoomAbout({-37, 250, 763, 851}, 13, 400, FIXED_ONE) == GeometryRect{-37, 250, 763, 851}, "Zooming back to the start must return the same rect");
+static_assert(zoomAbout({0, 0, 1600, 900}, 400, 300, FIXED_ONE / 2) == GeometryRect{200, 150, 1000, 600}, "The zoom point must stay in place");
+static_assert(clampScale(4 * FIXED_ONE, 1600, 100, {0, 400, 1000, INT_MAX}) == 4 * FIXED_ONE, "The minimum must win over the maximum");
+
+#endif // GEOMETRY_H
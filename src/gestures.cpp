@@ -0,0 +1,172 @@
+#include <stdlib.h>
+
+#include "gestures.h"
+
+static const Gesture NO_GESTURE = {GESTURE_NONE, GESTURE_LEFT};
+
+// BUTTONS
+// -------
+
+Gesture GestureRecognizer::buttonDown(GestureButton button, int x, int y, uint32_t time)
+{
+    ButtonState &state = m_buttons[button];
+    state.phase = PRESSED;
+    state.downX = x;
+    state.downY = y;
+    state.downTime = time;
+    return NO_GESTURE;
+}
+
+Gesture GestureRecognizer::buttonUp(GestureButton button, int x, int y, uint32_t time)
+{
+    ButtonState &state = m_buttons[button];
+    Phase phase = state.phase;
+    state.phase = IDLE;
+
+    switch (phase)
+    {
+    case DRAGGING:
+        state.hasLastClick = false;
+        return {GESTURE_DRAG_END, button};
+
+    case PRESSED:
+    {
+        // Only a short press that stayed in place counts as a click
+        bool isClick = time - state.downTime < thresholds.clickTime &&
+                       abs(x - state.downX) < thresholds.dragDistance &&
+                       abs(y - state.downY) < thresholds.dragDistance;
+        if (!isClick)
+        {
+            state.hasLastClick = false;
+            return NO_GESTURE;
+        }
+
+        // A click that closely follows another one completes a double-click
+        if (state.hasLastClick &&
+            time - state.lastClickTime < thresholds.doubleClickTime &&
+            abs(x - state.lastClickX) <= thresholds.doubleClickDistance &&
+            abs(y - state.lastClickY) <= thresholds.doubleClickDistance)
+        {
+            state.hasLastClick = false;
+            return {GESTURE_DOUBLE_CLICK, button};
+        }
+
+        state.hasLastClick = true;
+        state.lastClickX = x;
+        state.lastClickY = y;
+        state.lastClickTime = time;
+        return {GESTURE_CLICK, button};
+    }
+
+    case LONG_PRESSED:
+    case IDLE:
+    default:
+        state.hasLastClick = false;
+        return NO_GESTURE;
+    }
+}
+
+// MOVEMENT
+// --------
+
+/// @brief Feeds a cursor movement. If both buttons are held, the left one takes precedence when
+/// both have a gesture.
+Gesture GestureRecognizer::move(int x, int y, uint32_t time)
+{
+    for (int i = 0; i < GESTURE_BUTTON_COUNT; i++)
+    {
+        ButtonState &state = m_buttons[i];
+        GestureButton button = (GestureButton)i;
+
+        switch (state.phase)
+        {
+        case DRAGGING:
+            return {GESTURE_DRAG_MOVE, button};
+
+        case PRESSED:
+            if (abs(x - state.downX) > thresholds.dragDistance ||
+                abs(y - state.downY) > thresholds.dragDistance)
+            {
+                state.phase = DRAGGING;
+                state.hasLastClick = false;
+                return {GESTURE_DRAG_START, button};
+            }
+            // Pending long-presses are also recognized here, in case the timer was late
+            if (time - state.downTime >= thresholds.longPressTime)
+            {
+                state.phase = LONG_PRESSED;
+                state.hasLastClick = false;
+                return {GESTURE_LONG_PRESS, button};
+            }
+            // Still a press, so the other button gets its turn
+            break;
+
+        case LONG_PRESSED:
+            // The press has had its gesture, so moving on does not start a drag
+            break;
+
+        case IDLE:
+        default:
+            break;
+        }
+    }
+
+    return NO_GESTURE;
+}
+
+/// @brief Checks for gestures that complete without an event, i.e. long-presses.
+/// Call this from a timer while a button is held (see `timeUntilLongPress`).
+Gesture GestureRecognizer::poll(uint32_t time)
+{
+    for (int i = 0; i < GESTURE_BUTTON_COUNT; i++)
+    {
+        ButtonState &state = m_buttons[i];
+        if (state.phase == PRESSED && time - state.downTime >= thresholds.longPressTime)
+        {
+            state.phase = LONG_PRESSED;
+            state.hasLastClick = false;
+            return {GESTURE_LONG_PRESS, (GestureButton)i};
+        }
+    }
+
+    return NO_GESTURE;
+}
+
+/// @brief Tells how long a held button still has to be held to become a long-press. Timers and
+/// event timestamps do not tick in step, so a timer armed for the long-press time can fire early.
+/// @param remaining Receives the time left in milliseconds
+/// @return False if no button can become a long-press anymore
+bool GestureRecognizer::timeUntilLongPress(uint32_t time, uint32_t *remaining) const
+{
+    bool isPending = false;
+    for (const ButtonState &state : m_buttons)
+    {
+        if (state.phase != PRESSED)
+        {
+            continue;
+        }
+
+        uint32_t held = time - state.downTime;
+        uint32_t left = held < thresholds.longPressTime ? thresholds.longPressTime - held : 0;
+        if (!isPending || left < *remaining)
+        {
+            *remaining = left;
+        }
+        isPending = true;
+    }
+    return isPending;
+}
+
+// STATE
+// -----
+
+bool GestureRecognizer::isPressed(GestureButton button) const { return m_buttons[button].phase != IDLE; }
+bool GestureRecognizer::isDragging(GestureButton button) const { return m_buttons[button].phase == DRAGGING; }
+
+void GestureRecognizer::reset()
+{
+    for (auto &state : m_buttons)
+    {
+        state = ButtonState();
+    }
+}
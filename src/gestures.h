@@ -0,0 +1,90 @@
+#ifndef GESTURES_H
+#define GESTURES_H
+
+#include <stdint.h>
+
+// GESTURES
+
+enum GestureButton
+{
+    GESTURE_LEFT,
+    GESTURE_MIDDLE,
+    GESTURE_BUTTON_COUNT
+};
+
+enum GestureKind
+{
+    GESTURE_NONE,
+    GESTURE_CLICK,
+    GESTURE_DOUBLE_CLICK,
+    GESTURE_LONG_PRESS,
+    GESTURE_DRAG_START,
+    GESTURE_DRAG_MOVE,
+    GESTURE_DRAG_END
+};
+
+struct Gesture
+{
+    GestureKind kind;
+    GestureButton button;
+};
+
+/// Distances are in pixels, times in milliseconds
+struct GestureThresholds
+{
+    int dragDistance = 5;           // Movement beyond this turns a press into a drag
+    uint32_t clickTime = 200;       // A press released within this time is a click
+    uint32_t longPressTime = 600;   // A press held still for this long is a long-press
+    uint32_t doubleClickTime = 500; // A second click within this time is a double-click
+    int doubleClickDistance = 4;    // ... if it is also within this distance of the first
+};
+
+// RECOGNIZER
+
+/// @brief Turns a stream of button and move events into gestures.
+/// Each button is tracked by its own small state machine that resumes on every event,
+/// so recognition never allocates and costs a handful of comparisons per event.
+/// Times are the millisecond timestamps of the events (e.g. `MSLLHOOKSTRUCT::time`)
+/// and may wrap around.
+class GestureRecognizer
+{
+public:
+    GestureThresholds thresholds;
+
+    Gesture buttonDown(GestureButton button, int x, int y, uint32_t time);
+    Gesture buttonUp(GestureButton button, int x, int y, uint32_t time);
+    Gesture move(int x, int y, uint32_t time);
+    Gesture poll(uint32_t time);
+    bool timeUntilLongPress(uint32_t time, uint32_t *remaining) const;
+
+    bool isPressed(GestureButton button) const;
+    bool isDragging(GestureButton button) const;
+
+    void reset();
+
+private:
+    enum Phase
+    {
+        IDLE,
+        PRESSED,
+        LONG_PRESSED,
+        DRAGGING
+    };
+
+    struct ButtonState
+    {
+        Phase phase = IDLE;
+        int downX = 0;
+        int downY = 0;
+        uint32_t downTime = 0;
+
+        bool hasLastClick = false;
+        int lastClickX = 0;
+        int lastClickY = 0;
+        uint32_t lastClickTime = 0;
+    };
+
+    ButtonState m_buttons[GESTURE_BUTTON_COUNT];
+};
+
+#endif // GESTURES_H
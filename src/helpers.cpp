@@ -1,8 +1,10 @@
 #include <windows.h>
-#include <string>
-#include <vector>
+#include <wchar.h>
 #include <cmath>
 
+#include "helpers.h"
+#include "profiles.h"
+
 // HELPER FUNCTIONS
 // ----------------
 
@@ -24,10 +26,10 @@ bool isExcludedWindow(HWND hWnd)
 
     wchar_t className[256];
     GetClassNameW(hWnd, className, sizeof(className) / sizeof(wchar_t));
-    std::wstring clsName(className);
 
-    // List of window class names to exclude
-    static const std::vector<std::wstring> excludedClassNames = {
+    // List of window class names to exclude.
+    // Note: These are plain string literals so that the list needs no initialization or allocation
+    static const wchar_t *const excludedClassNames[] = {
         L"Shell_TrayWnd",              // Taskbar
         L"Progman",                    // Desktop
         L"Windows.UI.Core.CoreWindow", // UWP apps like Start Menu, Widget
@@ -36,21 +38,23 @@ bool isExcludedWindow(HWND hWnd)
         L"Button",                     // Common for system buttons
     };
 
-    for (const auto &excludedName : excludedClassNames)
+    for (const wchar_t *excludedName : excludedClassNames)
     {
-        if (clsName == excludedName)
+        if (wcscmp(className, excludedName) == 0)
         {
             return true;
         }
     }
 
-    // Final check for the desktop and taskbar windows
-    if (hWnd == GetDesktopWindow() || hWnd == FindWindowW(L"Shell_TrayWnd", NULL))
+    // Final check for the desktop window. The taskbar is already matched by its class name above,
+    // so there is no need to search for it by name (a cross-process call) on every action
+    if (hWnd == GetDesktopWindow())
     {
         return true;
     }
 
-    return false;
+    // Applications can be excluded through their profile
+    return getAppProfile(hWnd, className)->exclude;
 }
 
 /// @brief Determines if a given window is fullscreen.
@@ -83,3 +87,105 @@ bool isFullscreen(HWND hWnd)
     // For bordered windows, check if the window is maximized
     return IsZoomed(hWnd);
 }
+
+/// @brief Returns the pages of the process to the system while it is idle.
+/// `winctrl` spends nearly all of its time waiting for input, so there is no point holding on to
+/// memory that was only touched during startup or the last window action.
+void trimWorkingSet()
+{
+    SetProcessWorkingSetSize(GetCurrentProcess(), (SIZE_T)-1, (SIZE_T)-1);
+}
+
+/// @brief Builds the path of a file that lives next to the executable and shares its name,
+/// e.g. `winctrl.ini` for `winctrl.exe`.
+/// @param extension The extension of the file, including the dot
+/// @return False if the path does not fit into the buffer
+bool getAppFilePath(const wchar_t *extension, wchar_t *path, DWORD size)
+{
+    DWORD length = GetModuleFileNameW(NULL, path, size);
+    if (length == 0 || length + lstrlenW(extension) >= size)
+    {
+        return false;
+    }
+
+    // Replace the extension of the executable (if any)
+    wchar_t *end = path + length;
+    for (wchar_t *p = path + length; p > path && p[-1] != L'\\'; p--)
+    {
+        if (p[-1] == L'.')
+        {
+            end = p - 1;
+            break;
+        }
+    }
+    lstrcpynW(end, extension, (int)(size - (end - path)));
+    return true;
+}
+
+/// @brief FNV-1a hash of a wide string.
+/// @param foldCase Whether to ignore the case of ASCII letters (for file names)
+uint32_t hashString(const wchar_t *str, bool foldCase)
+{
+    uint32_t hash = 2166136261u;
+    for (; *str; str++)
+    {
+        wchar_t ch = *str;
+        if (foldCase && ch >= L'A' && ch <= L'Z')
+        {
+            ch += L'a' - L'A';
+        }
+        hash = (hash ^ (uint32_t)ch) * 16777619u;
+    }
+    return hash;
+}
+
+/// @brief The offset from workspace coordinates (used by `WINDOWPLACEMENT`) to screen coordinates.
+/// Workspace coordinates start at the top-left of the primary monitor's work area, so they only
+/// differ when the taskbar is docked to the top or left. Tool windows use screen coordinates.
+POINT workspaceOffset(HWND hWnd)
+{
+    POINT offset = {0, 0};
+    if (GetWindowLongPtr(hWnd, GWL_EXSTYLE) & WS_EX_TOOLWINDOW)
+    {
+        return offset;
+    }
+
+    MONITORINFO primary = {sizeof(MONITORINFO)};
+    GetMonitorInfo(MonitorFromPoint(offset, MONITOR_DEFAULTTOPRIMARY), &primary);
+    offset.x = primary.rcWork.left - primary.rcMonitor.left;
+    offset.y = primary.rcWork.top - primary.rcMonitor.top;
+    return offset;
+}
+
+/// @brief Moves windows in a single deferred batch, so that they are redrawn together.
+/// Windows that were closed meanwhile are left out. A batch that fails anyway (e.g. a window was
+/// closed after all, or out of memory) is discarded as a whole by the system, including the
+/// windows deferred before it, so then every window is placed on its own instead.
+void placeWindows(const WindowPosition *positions, int count, UINT flags)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    HDWP hDwp = BeginDeferWindowPos(count);
+    for (int i = 0; i < count && hDwp; i++)
+    {
+        const WindowPosition &position = positions[i];
+        if (IsWindow(position.hWnd))
+        {
+            const RECT &r = position.rect;
+            hDwp = DeferWindowPos(hDwp, position.hWnd, NULL, r.left, r.top, r.right - r.left, r.bottom - r.top, flags);
+        }
+    }
+    if (hDwp && EndDeferWindowPos(hDwp))
+    {
+        return;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        const RECT &r = positions[i].rect;
+        SetWindowPos(positions[i].hWnd, NULL, r.left, r.top, r.right - r.left, r.bottom - r.top, flags | SWP_ASYNCWINDOWPOS);
+    }
+}
@@ -2,8 +2,22 @@
 #define HELPERS_H
 
 #include <windows.h>
+#include <stdint.h>
 
 bool isExcludedWindow(HWND hWnd);
 bool isFullscreen(HWND hWnd);
+void trimWorkingSet();
+bool getAppFilePath(const wchar_t *extension, wchar_t *path, DWORD size);
+uint32_t hashString(const wchar_t *str, bool foldCase);
+POINT workspaceOffset(HWND hWnd);
+
+/// A window and the rect to move it to (see `placeWindows`)
+struct WindowPosition
+{
+    HWND hWnd;
+    RECT rect;
+};
+
+void placeWindows(const WindowPosition *positions, int count, UINT flags);
 
 #endif // HELPERS_H
@@ -0,0 +1,229 @@
+#include <windows.h>
+
+#include "history.h"
+
+// CONSTANTS
+// ---------
+
+/// The maximum number of windows that have a history at the same time
+const int HISTORY_WINDOWS = 32;
+/// The maximum number of geometry states remembered per window
+const int HISTORY_DEPTH = 16;
+
+// STATE
+// -----
+
+/// The restored rect and show state of a window at some point in time
+struct GeometryState
+{
+    RECT normalRect;
+    UINT showCmd;
+};
+
+/// A ring of geometry states for a single window.
+/// Entries `[0, cursor)` can be undone, entries `[cursor + 1, count)` can be redone.
+struct WindowHistory
+{
+    HWND hWnd;
+    DWORD lastUsed;
+    int start;
+    int count;
+    int cursor;
+    GeometryState states[HISTORY_DEPTH];
+};
+
+/// All histories live in this fixed arena, so memory stays bounded no matter how long the session runs
+static WindowHistory s_histories[HISTORY_WINDOWS];
+
+/// Incremented on every access, to find the least recently used history when the arena is full
+static DWORD s_useCounter = 0;
+
+/// The window and its state captured by `beginGeometryChange`
+static HWND s_pendingWindow = NULL;
+static GeometryState s_pendingState;
+
+// HELPER FUNCTIONS
+// ----------------
+
+static bool captureState(HWND hWnd, GeometryState *state)
+{
+    WINDOWPLACEMENT placement = {sizeof(WINDOWPLACEMENT)};
+    if (!GetWindowPlacement(hWnd, &placement))
+    {
+        return false;
+    }
+
+    state->normalRect = placement.rcNormalPosition;
+    state->showCmd = IsZoomed(hWnd) ? SW_SHOWMAXIMIZED : SW_SHOWNORMAL;
+    return true;
+}
+
+static void applyState(HWND hWnd, const GeometryState &state)
+{
+    WINDOWPLACEMENT placement = {sizeof(WINDOWPLACEMENT)};
+    GetWindowPlacement(hWnd, &placement);
+    placement.flags = WPF_ASYNCWINDOWPLACEMENT;
+    placement.showCmd = state.showCmd;
+    placement.rcNormalPosition = state.normalRect;
+    SetWindowPlacement(hWnd, &placement);
+}
+
+static GeometryState &stateAt(WindowHistory &history, int index)
+{
+    return history.states[(history.start + index) % HISTORY_DEPTH];
+}
+
+/// @brief Finds the history of a window.
+/// @param create Whether to claim a slot if the window has no history yet. Slots of destroyed
+///  windows are reclaimed first; otherwise the least recently used history is evicted.
+static WindowHistory *findHistory(HWND hWnd, bool create)
+{
+    WindowHistory *freeSlot = NULL;
+    WindowHistory *oldest = &s_histories[0];
+
+    for (auto &history : s_histories)
+    {
+        if (history.hWnd == hWnd)
+        {
+            history.lastUsed = ++s_useCounter;
+            return &history;
+        }
+
+        if (!freeSlot && (history.hWnd == NULL || !IsWindow(history.hWnd)))
+        {
+            freeSlot = &history;
+        }
+
+        if (history.lastUsed < oldest->lastUsed)
+        {
+            oldest = &history;
+        }
+    }
+
+    if (!create)
+    {
+        return NULL;
+    }
+
+    WindowHistory *history = freeSlot ? freeSlot : oldest;
+    history->hWnd = hWnd;
+    history->lastUsed = ++s_useCounter;
+    history->start = 0;
+    history->count = 0;
+    history->cursor = 0;
+    return history;
+}
+
+/// @brief Appends a state at the end of the history, dropping the oldest state if it is full
+static void appendState(WindowHistory &history, const GeometryState &state)
+{
+    if (history.count == HISTORY_DEPTH)
+    {
+        history.start = (history.start + 1) % HISTORY_DEPTH;
+        history.count--;
+        history.cursor--;
+    }
+
+    stateAt(history, history.count) = state;
+    history.count++;
+}
+
+// RECORDING
+// ---------
+
+/// @brief Captures the state of a window before a gesture changes it.
+/// The state only enters the history once `commitGeometryChange` is called.
+void beginGeometryChange(HWND hWnd)
+{
+    s_pendingWindow = captureState(hWnd, &s_pendingState) ? hWnd : NULL;
+}
+
+/// @brief Records the state captured by `beginGeometryChange` as an undoable step
+void commitGeometryChange()
+{
+    if (!s_pendingWindow)
+    {
+        return;
+    }
+
+    WindowHistory *history = findHistory(s_pendingWindow, true);
+    s_pendingWindow = NULL;
+
+    // A new change discards everything that could have been redone
+    history->count = history->cursor;
+    appendState(*history, s_pendingState);
+    history->cursor = history->count;
+}
+
+/// @brief Records the current state of a window right before an instant change (e.g. maximize)
+void recordGeometryChange(HWND hWnd)
+{
+    beginGeometryChange(hWnd);
+    commitGeometryChange();
+}
+
+// UNDO/REDO
+// ---------
+
+/// @brief Restores the state of the window before its most recent change
+/// @return True if there was something to undo
+bool undoGeometryChange(HWND hWnd)
+{
+    WindowHistory *history = findHistory(hWnd, false);
+    if (!history || history->cursor == 0)
+    {
+        return false;
+    }
+
+    // Remember the current state the first time we step back, so that it can be redone
+    if (history->cursor == history->count)
+    {
+        GeometryState current;
+        if (!captureState(hWnd, &current))
+        {
+            return false;
+        }
+        appendState(*history, current);
+        if (history->cursor == 0)
+        {
+            return false;
+        }
+    }
+
+    history->cursor--;
+    applyState(hWnd, stateAt(*history, history->cursor));
+    return true;
+}
+
+/// @brief Reapplies the most recently undone change of the window
+/// @return True if there was something to redo
+bool redoGeometryChange(HWND hWnd)
+{
+    WindowHistory *history = findHistory(hWnd, false);
+    if (!history || history->cursor + 1 >= history->count)
+    {
+        return false;
+    }
+
+    history->cursor++;
+    applyState(hWnd, stateAt(*history, history->cursor));
+    return true;
+}
+
+/// @brief Releases the history of a window, e.g. because it was destroyed.
+/// This also ensures a recycled window handle never inherits a stale history.
+void forgetGeometryHistory(HWND hWnd)
+{
+    for (auto &history : s_histories)
+    {
+        if (history.hWnd == hWnd)
+        {
+            history = WindowHistory();
+        }
+    }
+
+    if (s_pendingWindow == hWnd)
+    {
+        s_pendingWindow = NULL;
+    }
+}
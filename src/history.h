@@ -0,0 +1,17 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <windows.h>
+
+// GEOMETRY HISTORY
+
+void beginGeometryChange(HWND hWnd);
+void commitGeometryChange();
+void recordGeometryChange(HWND hWnd);
+
+bool undoGeometryChange(HWND hWnd);
+bool redoGeometryChange(HWND hWnd);
+
+void forgetGeometryHistory(HWND hWnd);
+
+#endif // HISTORY_H
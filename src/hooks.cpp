@@ -1,6 +1,15 @@
 #include <windows.h>
 
 #include "winctrl.h"
+#include "helpers.h"
+#include "gestures.h"
+#include "history.h"
+#include "hotkeys.h"
+#include "budget.h"
+#include "profiles.h"
+#include "animator.h"
+#include "status.h"
+#include "pluginhost.h"
 
 // CONSTANTS
 // ---------
@@ -17,17 +26,296 @@ static HHOOK s_mouseHook;
 // The keyboard-hook handle
 static HHOOK s_keyboardHook;
 
+// The event-hook handle, used to learn about destroyed windows
+static HWINEVENTHOOK s_destroyHook;
+
 // Indicates if we should consume the Win key after a successful `winctrl` action
 static bool s_shouldConsumeWin = false;
 
+// IDLE TRIM
+// ---------
+
+// How long after the last window action the working set is trimmed
+const UINT IDLE_TRIM_DELAY_MS = 30 * 1000;
+
+// The timer that trims the working set once we have been idle for a while
+static UINT_PTR s_idleTrimTimer = 0;
+
+static void CALLBACK IdleTrimTimerProc(HWND hWnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime)
+{
+    KillTimer(NULL, s_idleTrimTimer);
+    s_idleTrimTimer = 0;
+    trimWorkingSet();
+}
+
+// (Re)starts the idle countdown. Passing the current timer id replaces it instead of adding another one
+static void scheduleIdleTrim()
+{
+    s_idleTrimTimer = SetTimer(NULL, s_idleTrimTimer, IDLE_TRIM_DELAY_MS, IdleTrimTimerProc);
+}
+
+// GESTURES
+// --------
+
+// Recognizes clicks, drags, double-clicks and long-presses from the raw mouse events
+static GestureRecognizer s_gestures;
+
+// The timer that fires when a held button becomes a long-press
+static UINT_PTR s_longPressTimer = 0;
+
+// Where the cursor was when the last button went down, for gestures that complete without an event
+static POINT s_buttonDownPos;
+
+static void dispatchGesture(Gesture gesture, MSLLHOOKSTRUCT *pMouse);
+static UINT heldModifiers();
+
+// Called by the system once a button has been held for the long-press time
+static void CALLBACK LongPressTimerProc(HWND hWnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime)
+{
+    KillTimer(NULL, s_longPressTimer);
+    s_longPressTimer = 0;
+
+    // The gesture only counts if the Win key is still held
+    if (!Feature::isWinCtrlEnabled || !(GetAsyncKeyState(VK_LWIN) & KEY_PRESSED_FLAG))
+    {
+        return;
+    }
+
+    MSLLHOOKSTRUCT mouse = {};
+    mouse.pt = s_buttonDownPos;
+    mouse.time = dwTime;
+    dispatchGesture(s_gestures.poll(dwTime), &mouse);
+
+    // The timer ticks with a coarser clock than the event timestamps, so it can fire a little
+    // before the press is long enough. Wait for the rest of it rather than losing the long-press.
+    uint32_t remaining;
+    if (s_gestures.timeUntilLongPress(dwTime, &remaining))
+    {
+        s_longPressTimer = SetTimer(NULL, 0, remaining > 0 ? remaining : 1, LongPressTimerProc);
+    }
+}
+
+static void armLongPressTimer()
+{
+    if (s_longPressTimer)
+    {
+        HOOK_PLATFORM_CALL("armLongPressTimer: KillTimer");
+        KillTimer(NULL, s_longPressTimer);
+    }
+    HOOK_PLATFORM_CALL("armLongPressTimer: SetTimer");
+    s_longPressTimer = SetTimer(NULL, 0, s_gestures.thresholds.longPressTime, LongPressTimerProc);
+}
+
+static void disarmLongPressTimer()
+{
+    if (s_longPressTimer)
+    {
+        HOOK_PLATFORM_CALL("disarmLongPressTimer: KillTimer");
+        KillTimer(NULL, s_longPressTimer);
+        s_longPressTimer = 0;
+    }
+}
+
+/// @brief Accounts the current hook event as a window action, and counts it for the live status.
+/// Called once the action is actually performed, so that events that only might have acted stay
+/// within their own budget and out of the action rate.
+static void markActionPerformed()
+{
+    HOOK_BUDGET_ACTION();
+    countStatusAction();
+}
+
+/// @brief Performs the built-in action of a click, double-click or long press. Also called from
+/// the message loop for the gestures that a plugin declined (see `dispatchPluginGesture`)
+/// @return True if the gesture acted on a window, so the release of Win must be masked
+static bool performBuiltInGesture(Gesture gesture, POINT pt)
+{
+    switch (gesture.kind)
+    {
+    case GESTURE_CLICK:
+        if (gesture.button == GESTURE_LEFT)
+        {
+            toggleWindowMaximized(getTargetWindow(pt));
+            return true;
+        }
+        return false;
+
+    case GESTURE_DOUBLE_CLICK:
+        // Every left click toggles, so the second click of a double-click toggles back
+        if (gesture.button == GESTURE_LEFT)
+        {
+            toggleWindowMaximized(getTargetWindow(pt));
+            return true;
+        }
+        if (gesture.button == GESTURE_MIDDLE)
+        {
+            minimizeWindow(getTargetWindow(pt));
+            return true;
+        }
+        return false;
+
+    case GESTURE_LONG_PRESS:
+        if (gesture.button == GESTURE_LEFT)
+        {
+            toggleAlwaysOnTop(getTargetWindow(pt));
+            return true;
+        }
+        return false;
+
+    default:
+        return false;
+    }
+}
+
+/// @brief Performs the window action bound to a recognized gesture
+static void dispatchGesture(Gesture gesture, MSLLHOOKSTRUCT *pMouse)
+{
+    switch (gesture.kind)
+    {
+    case GESTURE_DRAG_START:
+        disarmLongPressTimer();
+        if (gesture.button == GESTURE_LEFT && Feature::Move)
+        {
+            startDragging(pMouse);
+            markActionPerformed();
+            s_shouldConsumeWin = true;
+        }
+        else if (gesture.button == GESTURE_MIDDLE && Feature::Resize)
+        {
+            startResizing(pMouse);
+            markActionPerformed();
+            s_shouldConsumeWin = true;
+        }
+        break;
+
+    case GESTURE_DRAG_MOVE:
+        if (gesture.button == GESTURE_LEFT && Feature::Move && isDragging())
+            performDrag(pMouse);
+        else if (gesture.button == GESTURE_MIDDLE && Feature::Resize && isResizing())
+            performResize(pMouse);
+        break;
+
+    case GESTURE_DRAG_END:
+        if (gesture.button == GESTURE_LEFT && Feature::Move && isDragging())
+        {
+            stopDragging(pMouse);
+            HOOK_BUDGET_ACTION(); // Ends the drag, which was counted when it started
+            scheduleIdleTrim();
+        }
+        else if (gesture.button == GESTURE_MIDDLE && Feature::Resize)
+        {
+            stopResizing();
+            HOOK_BUDGET_ACTION(); // Ends the resize, which was counted when it started
+            scheduleIdleTrim();
+        }
+        break;
+
+    case GESTURE_CLICK:
+    case GESTURE_DOUBLE_CLICK:
+    case GESTURE_LONG_PRESS:
+        // A gesture bound by a plugin replaces the built-in action, unless the plugin declines it.
+        // Plugins run later, from the message loop, so the gesture is consumed either way
+        if (dispatchPluginGesture(gesture, heldModifiers(), pMouse->pt, performBuiltInGesture) ||
+            performBuiltInGesture(gesture, pMouse->pt))
+        {
+            markActionPerformed();
+            scheduleIdleTrim();
+            s_shouldConsumeWin = true;
+        }
+        break;
+
+    case GESTURE_NONE:
+    default:
+        break;
+    }
+}
+
+// MODIFIER KEYS
+// -------------
+
+// An unassigned virtual-key code, tapped to stop the system from acting on the release of a modifier
+const WORD MASK_KEY = 0xE8;
+
+// The modifier keys that are currently held down, one bit per physical key (see `modifierKeyBit`)
+static UINT s_heldModifierKeys = 0;
+
+// The bit of the left Win key in `s_heldModifierKeys`, which the mouse hook checks on every event
+const UINT LWIN_KEY_BIT = 1 << 0;
+
+static const struct
+{
+    BYTE vkCode;
+    UINT bit;
+    UINT modifier;
+} MODIFIER_KEYS[] = {
+    {VK_LWIN, LWIN_KEY_BIT, MOD_WIN},
+    {VK_RWIN, 1 << 1, MOD_WIN},
+    {VK_LCONTROL, 1 << 2, MOD_CONTROL},
+    {VK_RCONTROL, 1 << 3, MOD_CONTROL},
+    {VK_LMENU, 1 << 4, MOD_ALT},
+    {VK_RMENU, 1 << 5, MOD_ALT},
+    {VK_LSHIFT, 1 << 6, MOD_SHIFT},
+    {VK_RSHIFT, 1 << 7, MOD_SHIFT},
+};
+
+// Returns the bit of a modifier key in `s_heldModifierKeys`, or 0 if the key is not a modifier
+static UINT modifierKeyBit(DWORD vkCode)
+{
+    for (const auto &key : MODIFIER_KEYS)
+    {
+        if (key.vkCode == vkCode)
+        {
+            return key.bit;
+        }
+    }
+    return 0;
+}
+
+// Returns the held modifiers as MOD_* flags
+static UINT heldModifiers()
+{
+    UINT modifiers = 0;
+    for (const auto &key : MODIFIER_KEYS)
+    {
+        if (s_heldModifierKeys & key.bit)
+        {
+            modifiers |= key.modifier;
+        }
+    }
+    return modifiers;
+}
+
+// Re-reads the state of the modifier keys from the system.
+// Returns true if it matched what we were tracking
+static bool syncHeldModifierKeys()
+{
+    UINT held = 0;
+    for (const auto &key : MODIFIER_KEYS)
+    {
+        if (GetAsyncKeyState(key.vkCode) & KEY_PRESSED_FLAG)
+        {
+            held |= key.bit;
+        }
+    }
+
+    bool inSync = held == s_heldModifierKeys;
+    s_heldModifierKeys = held;
+    return inSync;
+}
+
 // MouseProc Callback
 // ------------------
 
 /// @brief Windows will call this callback function for every single mouse event (move, click etc).
+/// Every event is accounted against the hook budget (see budget.h): moves may only make the one
+/// call that repositions the window, so the Win key is read from the tracked modifier state.
 LRESULT CALLBACK MouseProc(int nCode, WPARAM wParam, LPARAM lParam)
 {
     if (nCode == HC_ACTION)
     {
+        HOOK_BUDGET_SCOPE(wParam == WM_MOUSEMOVE ? HOOK_MOUSE_MOVE : HOOK_MOUSE_BUTTON);
+        StatusEventScope statusScope(((MSLLHOOKSTRUCT *)lParam)->time); // Counted and timed for the live status
+
         // If disabled, skip entirely
         if (!Feature::isWinCtrlEnabled)
         {
@@ -36,9 +324,39 @@ LRESULT CALLBACK MouseProc(int nCode, WPARAM wParam, LPARAM lParam)
 
         // The lParam contains a pointer to a structure with detailed information about the mouse event (like it's coordinates `pt`)
         MSLLHOOKSTRUCT *pMouse = (MSLLHOOKSTRUCT *)lParam;
+        int x = pMouse->pt.x;
+        int y = pMouse->pt.y;
+
+        // Button releases always reach the recognizer, so a drag ends even if the Win key was let go
+        // first. A click, like the press it started with, only counts while Win is held.
+        if (wParam == WM_LBUTTONUP || wParam == WM_MBUTTONUP)
+        {
+            disarmLongPressTimer();
+            Gesture gesture = s_gestures.buttonUp(wParam == WM_LBUTTONUP ? GESTURE_LEFT : GESTURE_MIDDLE, x, y, pMouse->time);
+            bool isClick = gesture.kind == GESTURE_CLICK || gesture.kind == GESTURE_DOUBLE_CLICK;
+            if (!isClick || (s_heldModifierKeys & LWIN_KEY_BIT))
+            {
+                dispatchGesture(gesture, pMouse);
+            }
+            return CallNextHookEx(s_mouseHook, nCode, wParam, lParam);
+        }
+
+        // Check if the left Windows key is pressed, as tracked by the keyboard hook
+        bool isWinKeyDown = s_heldModifierKeys & LWIN_KEY_BIT;
+
+        // Anything but a move is rare enough to confirm against the real key state. This also repairs
+        // the tracking when a release was missed (e.g. while the secure desktop was up) or an injected
+        // Win release (such as the one of our own virtual desktop switch) came in while the key was held
+        if (wParam != WM_MOUSEMOVE)
+        {
+            HOOK_PLATFORM_CALL("MouseProc: GetAsyncKeyState(VK_LWIN)");
+            isWinKeyDown = GetAsyncKeyState(VK_LWIN) & KEY_PRESSED_FLAG;
+            if (isWinKeyDown)
+                s_heldModifierKeys |= LWIN_KEY_BIT;
+            else
+                s_heldModifierKeys &= ~LWIN_KEY_BIT;
+        }
 
-        // Check if the left Windows key is pressed
-        bool isWinKeyDown = GetAsyncKeyState(VK_LWIN) & KEY_PRESSED_FLAG;
         if (isWinKeyDown)
         {
 
@@ -46,99 +364,55 @@ LRESULT CALLBACK MouseProc(int nCode, WPARAM wParam, LPARAM lParam)
             {
             // Left button down
             case WM_LBUTTONDOWN:
-                s_isLeftMouseButtonDown = true;
-                s_isLeftMouseButtonDownTime = std::chrono::steady_clock::now();
-                s_isLeftMouseButtonDownPos = pMouse->pt;
+                s_gestures.buttonDown(GESTURE_LEFT, x, y, pMouse->time);
+                s_buttonDownPos = pMouse->pt;
+                armLongPressTimer();
                 s_shouldConsumeWin = true;
                 break;
 
             // Middle button down
             case WM_MBUTTONDOWN:
-                s_isMiddleMouseButtonDown = true;
-                s_middleMouseButtonDownTime = std::chrono::steady_clock::now();
-                s_middleMouseButtonDownPos = pMouse->pt;
+                s_gestures.buttonDown(GESTURE_MIDDLE, x, y, pMouse->time);
+                s_buttonDownPos = pMouse->pt;
+                armLongPressTimer();
                 break;
 
             // Mouse move
             case WM_MOUSEMOVE:
-                if (Feature::Move && isDragging())
-                    performDrag(pMouse);
-                else if (Feature::Resize && isResizing())
-                    performResize(pMouse);
-                else if (Feature::Move && s_isLeftMouseButtonDown)
-                {
-                    // If left button is down and we are not yet dragging, check for movement to start dragging
-                    const int DRAG_THRESHOLD = 5; // Pixels
-                    if (abs(pMouse->pt.x - s_isLeftMouseButtonDownPos.x) > DRAG_THRESHOLD ||
-                        abs(pMouse->pt.y - s_isLeftMouseButtonDownPos.y) > DRAG_THRESHOLD)
-                    {
-                        startDragging(pMouse);
-                        s_shouldConsumeWin = true;
-                    }
-                }
-                else if (Feature::Resize && s_isMiddleMouseButtonDown)
-                {
-                    // If middle button is down and we are not yet resizing, check for movement to start resizing
-                    const int DRAG_THRESHOLD = 5; // Pixels
-                    if (abs(pMouse->pt.x - s_middleMouseButtonDownPos.x) > DRAG_THRESHOLD ||
-                        abs(pMouse->pt.y - s_middleMouseButtonDownPos.y) > DRAG_THRESHOLD)
-                    {
-                        startResizing(pMouse);
-                        s_shouldConsumeWin = true;
-                    }
-                }
-                break;
-
-            // Left button up
-            case WM_LBUTTONUP:
-                if (s_isLeftMouseButtonDown)
-                {
-                    s_isLeftMouseButtonDown = false;
-                    auto now = std::chrono::steady_clock::now();
-                    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - s_isLeftMouseButtonDownTime).count();
-                    // Define a click threshold (e.g., 200 milliseconds)
-                    const int CLICK_THRESHOLD_MS = 200;
-
-                    // Check if it was a click (short duration) and no dragging occurred
-                    if (duration < CLICK_THRESHOLD_MS && !isDragging() &&
-                        (abs(pMouse->pt.x - s_isLeftMouseButtonDownPos.x) < 5 &&
-                         abs(pMouse->pt.y - s_isLeftMouseButtonDownPos.y) < 5))
-                    {
-                        toggleMaximizeRestore(pMouse);
-                    }
-                    else if (Feature::Move && isDragging())
-                    {
-                        stopDragging(pMouse);
-                    }
-                }
-                break;
-
-            // Middle button up
-            case WM_MBUTTONUP:
-                if (Feature::Resize)
-                {
-                    stopResizing();
-                }
-                s_isMiddleMouseButtonDown = false;
+                dispatchGesture(s_gestures.move(x, y, pMouse->time), pMouse);
                 break;
 
             // Mouse Wheel Scroll
             case WM_MOUSEWHEEL:
                 // Check if Ctrl is also pressed for transparency adjustment
-                if (GetAsyncKeyState(VK_CONTROL) & KEY_PRESSED_FLAG)
+                if (heldModifiers() & MOD_CONTROL)
                 {
                     if (Feature::Transparency && handleTransparency(pMouse))
                     {
+                        markActionPerformed();
                         s_shouldConsumeWin = true;
                         return 1; // Consume the mouse-scroll to prevent propagation
                     }
                 }
+                // With Shift, zoom the window under the cursor
+                else if (heldModifiers() & MOD_SHIFT)
+                {
+                    if (Feature::Resize && handleZoomWheel(pMouse))
+                    {
+                        markActionPerformed();
+                        s_shouldConsumeWin = true;
+                        return 1;
+                    }
+                }
                 // Otherwise, scroll through the virtual desktops
                 else
                 {
                     // The event was handled (and not throttled), so consume it
                     if (Feature::VirtualDesktopScroll && handleMouseWheel(pMouse))
+                    {
+                        markActionPerformed();
                         s_shouldConsumeWin = true;
+                    }
                 }
                 break;
             }
@@ -156,14 +430,63 @@ LRESULT CALLBACK KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
 {
     if (nCode == HC_ACTION)
     {
+        HOOK_BUDGET_SCOPE(HOOK_KEY);
+        StatusEventScope statusScope(((KBDLLHOOKSTRUCT *)lParam)->time); // Counted and timed for the live status
+
         KBDLLHOOKSTRUCT *pKeyboard = (KBDLLHOOKSTRUCT *)lParam;
 
+        bool isKeyDown = wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN;
+
+        UINT modifierBit = modifierKeyBit(pKeyboard->vkCode);
+        if (modifierBit)
+        {
+            // Keep track of the held modifiers ourselves, so that matching a hotkey needs no system calls
+            if (isKeyDown)
+                s_heldModifierKeys |= modifierBit;
+            else
+                s_heldModifierKeys &= ~modifierBit;
+        }
+        else if (isKeyDown && Feature::isWinCtrlEnabled && Feature::Hotkeys && !(pKeyboard->flags & LLKHF_INJECTED))
+        {
+            const HotkeyAction *action = matchHotkey(heldModifiers(), pKeyboard->vkCode);
+
+            // A missed key release (e.g. while the secure desktop was up) can leave a modifier stuck,
+            // so a match is double-checked against the real key state before acting on it
+            if (action && !syncHeldModifierKeys())
+            {
+                action = matchHotkey(heldModifiers(), pKeyboard->vkCode);
+            }
+
+            if (action)
+            {
+                POINT pt;
+                GetCursorPos(&pt);
+                performHotkeyAction(action, getTargetWindow(pt));
+                markActionPerformed();
+
+                // Tap an unassigned key, so that releasing the modifiers does not open the
+                // Start Menu (Win) or activate the menu bar of the focused application (Alt)
+                INPUT inputs[2] = {};
+                inputs[0].type = INPUT_KEYBOARD;
+                inputs[0].ki.wVk = MASK_KEY;
+                inputs[1].type = INPUT_KEYBOARD;
+                inputs[1].ki.wVk = MASK_KEY;
+                inputs[1].ki.dwFlags = KEYEVENTF_KEYUP;
+                SendInput(2, inputs, sizeof(INPUT));
+
+                scheduleIdleTrim();
+                return 1; // Consume the key so the focused application does not see it
+            }
+        }
+
         // Whenever we release the Windows key...
         if (wParam == WM_KEYUP || wParam == WM_SYSKEYUP)
         {
             // Check to see if we triggered a winctrl shortcut, indicating that we need to consume the Win key release
             if (pKeyboard->vkCode == VK_LWIN && s_shouldConsumeWin)
             {
+                HOOK_BUDGET_ACTION(); // Ends a winctrl action, which was counted when it was performed
+
                 // Note: Send an Esc key to consume the held-down Win key
                 //  This is to prevent the Start Menu from appearing, which would otherwise happen
                 //  because the system registers the Win key release.
@@ -179,6 +502,19 @@ LRESULT CALLBACK KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
     return CallNextHookEx(s_keyboardHook, nCode, wParam, lParam);
 }
 
+// WinEventProc Callback
+// ---------------------
+
+// Called whenever a window is destroyed, so that any history kept for it can be reclaimed
+void CALLBACK WinEventProc(HWINEVENTHOOK hWinEventHook, DWORD event, HWND hWnd,
+                           LONG idObject, LONG idChild, DWORD idEventThread, DWORD dwmsEventTime)
+{
+    if (hWnd != NULL && idObject == OBJID_WINDOW && idChild == CHILDID_SELF)
+    {
+        forgetGeometryHistory(hWnd);
+    }
+}
+
 // SETUP AND TEARDOWN
 // ------------------
 
@@ -186,9 +522,24 @@ LRESULT CALLBACK KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
 // MouseProc/KeyProc callback functions for every mouse/keyboard event
 bool setupHooks()
 {
+    loadHotkeys();
+    loadAppProfiles();
+    loadDragSettings();
+    setupVirtualDesktops();
+    loadAnimationSettings();
+    loadPlugins();
+    s_heldModifierKeys = 0;
+
+    s_gestures.reset();
+    s_gestures.thresholds.doubleClickTime = GetDoubleClickTime(); // Respect the user's double-click speed
+
     s_mouseHook = SetWindowsHookEx(WH_MOUSE_LL, MouseProc, NULL, 0);
     s_keyboardHook = SetWindowsHookEx(WH_KEYBOARD_LL, KeyboardProc, NULL, 0);
-    return s_mouseHook != NULL && s_keyboardHook != NULL;
+    s_destroyHook = SetWinEventHook(EVENT_OBJECT_DESTROY, EVENT_OBJECT_DESTROY, NULL, WinEventProc, 0, 0, WINEVENT_OUTOFCONTEXT);
+
+    bool areHooksInstalled = s_mouseHook != NULL && s_keyboardHook != NULL;
+    setupStatus(areHooksInstalled);
+    return areHooksInstalled;
 }
 
 // Cleanup all registered hooks before exiting the application
@@ -204,4 +555,19 @@ void teardownHooks()
         UnhookWindowsHookEx(s_keyboardHook);
         s_keyboardHook = NULL;
     }
+    if (s_destroyHook)
+    {
+        UnhookWinEvent(s_destroyHook);
+        s_destroyHook = NULL;
+    }
+    if (s_idleTrimTimer)
+    {
+        KillTimer(NULL, s_idleTrimTimer);
+        s_idleTrimTimer = 0;
+    }
+    clearAppProfileCache();
+    teardownVirtualDesktops();
+    teardownAnimations();
+    teardownStatus();
+    unloadPlugins();
 }
@@ -0,0 +1,357 @@
+#include <windows.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <stdlib.h>
+
+#include "hotkeys.h"
+#include "helpers.h"
+#include "history.h"
+#include "winctrl.h"
+#include "animator.h"
+
+// CONSTANTS
+// ---------
+
+/// The maximum number of bindings. Action 0 means "not bound", so 255 fit in a byte
+const int MAX_HOTKEYS = 255;
+
+/// The number of distinct modifier combinations (MOD_ALT | MOD_CONTROL | MOD_SHIFT | MOD_WIN)
+const int MODIFIER_COMBINATIONS = 16;
+
+/// The bindings used when the config file has no [Hotkeys] section.
+/// Win+Alt and Win+Ctrl with a digit are left alone: the taskbar uses them to open jump lists and
+/// to cycle through the windows of pinned applications.
+static const wchar_t *const DEFAULT_HOTKEYS[] = {
+    L"Win+Alt+Left=move -20 0",
+    L"Win+Alt+Right=move 20 0",
+    L"Win+Alt+Up=move 0 -20",
+    L"Win+Alt+Down=move 0 20",
+    L"Win+Alt+Shift+Left=resize -20 0",
+    L"Win+Alt+Shift+Right=resize 20 0",
+    L"Win+Alt+Shift+Up=resize 0 -20",
+    L"Win+Alt+Shift+Down=resize 0 20",
+    L"Win+Alt+PageUp=opacity 15",
+    L"Win+Alt+PageDown=opacity -15",
+    L"Win+Ctrl+Z=undo",
+    L"Win+Ctrl+Y=redo",
+};
+
+// STATE
+// -----
+
+/// The actions of all bindings. Index 0 is reserved for "not bound"
+static HotkeyAction s_actions[MAX_HOTKEYS + 1];
+static int s_actionCount = 0;
+
+/// The compiled prefix trie of all bindings. A chord is a set of modifiers followed by a key,
+/// so the trie has exactly two levels, each flattened into a direct lookup table:
+/// the first is indexed by the modifier set, the second by the virtual-key code.
+/// Matching a key event therefore costs two array lookups, however many bindings there are.
+static BYTE s_bindings[MODIFIER_COMBINATIONS][256];
+
+// PARSING
+// -------
+
+struct KeyName
+{
+    const wchar_t *name;
+    BYTE vkCode;
+};
+
+static const KeyName KEY_NAMES[] = {
+    {L"Left", VK_LEFT},
+    {L"Right", VK_RIGHT},
+    {L"Up", VK_UP},
+    {L"Down", VK_DOWN},
+    {L"PageUp", VK_PRIOR},
+    {L"PageDown", VK_NEXT},
+    {L"Home", VK_HOME},
+    {L"End", VK_END},
+    {L"Enter", VK_RETURN},
+    {L"Space", VK_SPACE},
+    {L"Tab", VK_TAB},
+    {L"Plus", VK_OEM_PLUS},
+    {L"Minus", VK_OEM_MINUS},
+};
+
+/// @brief Compares a token (not null-terminated) to a name, ignoring case
+static bool tokenEquals(const wchar_t *token, int length, const wchar_t *name)
+{
+    return lstrlenW(name) == length && _wcsnicmp(token, name, length) == 0;
+}
+
+/// @brief Parses a key name such as `Left`, `A`, `7` or `F5`
+/// @return The virtual-key code, or 0 if the name is not known
+static BYTE parseKeyName(const wchar_t *token, int length)
+{
+    if (length == 1)
+    {
+        wchar_t ch = towupper(token[0]);
+        if ((ch >= L'A' && ch <= L'Z') || (ch >= L'0' && ch <= L'9'))
+        {
+            return (BYTE)ch; // Letters and digits are their own virtual-key codes
+        }
+        return 0;
+    }
+
+    if ((token[0] == L'F' || token[0] == L'f') && length <= 3)
+    {
+        // Every character after the F must be a digit, so that e.g. `F1a` is not taken for `F1`
+        int number = 0;
+        for (int i = 1; i < length && number >= 0; i++)
+        {
+            number = token[i] >= L'0' && token[i] <= L'9' ? number * 10 + (token[i] - L'0') : -1;
+        }
+        if (number >= 1 && number <= 24)
+        {
+            return (BYTE)(VK_F1 + number - 1);
+        }
+    }
+
+    for (const KeyName &key : KEY_NAMES)
+    {
+        if (tokenEquals(token, length, key.name))
+        {
+            return key.vkCode;
+        }
+    }
+    return 0;
+}
+
+/// @brief Parses a chord such as `Win+Alt+Left`
+/// @return False if the chord does not have exactly one known key, or does not include Win
+static bool parseChord(const wchar_t *text, int length, UINT *modifiers, BYTE *vkCode)
+{
+    *modifiers = 0;
+    *vkCode = 0;
+
+    const wchar_t *end = text + length;
+    while (text < end)
+    {
+        // Find the next `+`-separated token, trimming spaces
+        const wchar_t *tokenEnd = text;
+        while (tokenEnd < end && *tokenEnd != L'+')
+            tokenEnd++;
+        const wchar_t *next = tokenEnd + 1;
+        while (text < tokenEnd && *text == L' ')
+            text++;
+        while (tokenEnd > text && tokenEnd[-1] == L' ')
+            tokenEnd--;
+        int tokenLength = (int)(tokenEnd - text);
+
+        if (tokenEquals(text, tokenLength, L"Win"))
+            *modifiers |= MOD_WIN;
+        else if (tokenEquals(text, tokenLength, L"Ctrl"))
+            *modifiers |= MOD_CONTROL;
+        else if (tokenEquals(text, tokenLength, L"Alt"))
+            *modifiers |= MOD_ALT;
+        else if (tokenEquals(text, tokenLength, L"Shift"))
+            *modifiers |= MOD_SHIFT;
+        else
+        {
+            if (*vkCode != 0)
+            {
+                return false; // Only one non-modifier key per chord
+            }
+
+            *vkCode = parseKeyName(text, tokenLength);
+            if (*vkCode == 0)
+            {
+                return false; // Unknown key
+            }
+        }
+
+        text = next;
+    }
+
+    // Hotkeys swallow the key, so a chord without Win (e.g. `Ctrl+Z`) would take it away from every application
+    return *vkCode != 0 && (*modifiers & MOD_WIN);
+}
+
+/// @brief Parses an action such as `move -20 0` or `undo`
+static bool parseAction(const wchar_t *text, HotkeyAction *action)
+{
+    static const struct
+    {
+        const wchar_t *name;
+        HotkeyActionKind kind;
+    } ACTION_NAMES[] = {
+        {L"move", HOTKEY_MOVE},
+        {L"resize", HOTKEY_RESIZE},
+        {L"monitor", HOTKEY_MONITOR},
+        {L"opacity", HOTKEY_OPACITY},
+        {L"maximize", HOTKEY_MAXIMIZE},
+        {L"minimize", HOTKEY_MINIMIZE},
+        {L"topmost", HOTKEY_TOPMOST},
+        {L"undo", HOTKEY_UNDO},
+        {L"redo", HOTKEY_REDO},
+        {L"desktop", HOTKEY_DESKTOP},
+        {L"sendtodesktop", HOTKEY_SEND_TO_DESKTOP},
+    };
+
+    while (*text == L' ')
+        text++;
+    const wchar_t *nameEnd = text;
+    while (*nameEnd && *nameEnd != L' ')
+        nameEnd++;
+
+    for (const auto &entry : ACTION_NAMES)
+    {
+        if (tokenEquals(text, (int)(nameEnd - text), entry.name))
+        {
+            wchar_t *argEnd;
+            action->kind = entry.kind;
+            action->x = (int)wcstol(nameEnd, &argEnd, 10);
+            action->y = (int)wcstol(argEnd, &argEnd, 10);
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Adds a `<chord>=<action>` entry to the trie. Later entries override earlier ones.
+static bool bindHotkey(const wchar_t *entry)
+{
+    const wchar_t *separator = wcschr(entry, L'=');
+    if (!separator)
+    {
+        return false;
+    }
+
+    UINT modifiers;
+    BYTE vkCode;
+    HotkeyAction action;
+    if (!parseChord(entry, (int)(separator - entry), &modifiers, &vkCode) || !parseAction(separator + 1, &action))
+    {
+        return false;
+    }
+
+    // A chord that is bound again keeps its slot, so only new chords count towards the limit
+    BYTE index = s_bindings[modifiers][vkCode];
+    if (!index)
+    {
+        if (s_actionCount == MAX_HOTKEYS)
+        {
+            return false;
+        }
+        index = (BYTE)++s_actionCount;
+        s_bindings[modifiers][vkCode] = index;
+    }
+    s_actions[index] = action;
+    return true;
+}
+
+// LOADING
+// -------
+
+/// @brief Compiles the bindings from the [Hotkeys] section of `winctrl.ini` (next to the
+/// executable) into the lookup tables. Falls back to the default bindings if there is no such section.
+/// @return The number of bindings
+int loadHotkeys()
+{
+    ZeroMemory(s_bindings, sizeof(s_bindings));
+    s_actionCount = 0;
+
+    // The section comes back as `key=value\0key=value\0\0`
+    static wchar_t section[16 * 1024];
+    wchar_t path[MAX_PATH];
+    DWORD length = 0;
+    if (getAppFilePath(L".ini", path, MAX_PATH))
+    {
+        length = GetPrivateProfileSectionW(L"Hotkeys", section, sizeof(section) / sizeof(wchar_t), path);
+    }
+
+    int bound = 0;
+    if (length > 0)
+    {
+        for (const wchar_t *entry = section; *entry; entry += lstrlenW(entry) + 1)
+        {
+            // Lines that fail to parse are skipped, so one typo does not disable every hotkey
+            bound += bindHotkey(entry) ? 1 : 0;
+        }
+    }
+    else
+    {
+        for (const wchar_t *entry : DEFAULT_HOTKEYS)
+        {
+            bound += bindHotkey(entry) ? 1 : 0;
+        }
+    }
+
+    return bound;
+}
+
+// DISPATCH
+// --------
+
+/// @brief Looks up the action bound to a key pressed with the given modifiers (MOD_* flags)
+/// @return NULL if the chord is not bound
+const HotkeyAction *matchHotkey(UINT modifiers, DWORD vkCode)
+{
+    BYTE index = s_bindings[modifiers & (MODIFIER_COMBINATIONS - 1)][vkCode & 0xFF];
+    return index ? &s_actions[index] : NULL;
+}
+
+void performHotkeyAction(const HotkeyAction *action, HWND hWnd)
+{
+    // Switching desktops is the only action that does not need a window
+    if (action->kind == HOTKEY_DESKTOP)
+    {
+        if (Feature::VirtualDesktopScroll)
+            switchToDesktop(action->x - 1);
+        return;
+    }
+
+    if (!hWnd)
+    {
+        return;
+    }
+
+    // A hotkey takes over the window from any animation still running, except that toggling
+    // maximize turns an unfinished maximize or restore around (see `toggleWindowMaximized`)
+    if (action->kind != HOTKEY_MAXIMIZE)
+    {
+        cancelWindowAnimation(hWnd);
+    }
+
+    switch (action->kind)
+    {
+    case HOTKEY_MOVE:
+        if (Feature::Move)
+            moveWindowBy(hWnd, action->x, action->y);
+        break;
+    case HOTKEY_RESIZE:
+        if (Feature::Resize)
+            resizeWindowBy(hWnd, action->x, action->y);
+        break;
+    case HOTKEY_MONITOR:
+        if (Feature::Move)
+            moveWindowToMonitor(hWnd, action->x - 1);
+        break;
+    case HOTKEY_OPACITY:
+        if (Feature::Transparency)
+            adjustWindowAlpha(hWnd, action->x);
+        break;
+    case HOTKEY_MAXIMIZE:
+        toggleWindowMaximized(hWnd);
+        break;
+    case HOTKEY_MINIMIZE:
+        minimizeWindow(hWnd);
+        break;
+    case HOTKEY_TOPMOST:
+        toggleAlwaysOnTop(hWnd);
+        break;
+    case HOTKEY_UNDO:
+        undoGeometryChange(hWnd);
+        break;
+    case HOTKEY_REDO:
+        redoGeometryChange(hWnd);
+        break;
+    case HOTKEY_SEND_TO_DESKTOP:
+        moveWindowToDesktop(hWnd, action->x - 1);
+        break;
+    case HOTKEY_NONE:
+    default:
+        break;
+    }
+}
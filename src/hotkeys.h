@@ -0,0 +1,37 @@
+#ifndef HOTKEYS_H
+#define HOTKEYS_H
+
+#include <windows.h>
+
+// HOTKEY ACTIONS
+
+enum HotkeyActionKind
+{
+    HOTKEY_NONE,
+    HOTKEY_MOVE,           // Move the window by (x, y) pixels
+    HOTKEY_RESIZE,         // Grow the window by (x, y) pixels
+    HOTKEY_MONITOR,        // Move the window to monitor x (1-based)
+    HOTKEY_OPACITY,        // Change the opacity of the window by x (out of 255)
+    HOTKEY_MAXIMIZE,       // Toggle between maximized and restored
+    HOTKEY_MINIMIZE,       // Minimize the window
+    HOTKEY_TOPMOST,        // Toggle always on top
+    HOTKEY_UNDO,           // Undo the last geometry change
+    HOTKEY_REDO,           // Redo the last undone geometry change
+    HOTKEY_DESKTOP,        // Switch to virtual desktop x (1-based)
+    HOTKEY_SEND_TO_DESKTOP // Move the window to virtual desktop x (1-based)
+};
+
+struct HotkeyAction
+{
+    HotkeyActionKind kind;
+    int x;
+    int y;
+};
+
+// HOTKEYS
+
+int loadHotkeys();
+const HotkeyAction *matchHotkey(UINT modifiers, DWORD vkCode);
+void performHotkeyAction(const HotkeyAction *action, HWND hWnd);
+
+#endif // HOTKEYS_H
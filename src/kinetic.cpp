@@ -0,0 +1,117 @@
+#include <math.h>
+
+#include "kinetic.h"
+
+// A thrown window keeps moving with the velocity of the cursor at release, and friction slows it
+// down exponentially. Its path is planned in one go when it is let go of: the glide itself is
+// animated with EASE_GLIDE, which follows the same decay, so the window leaves the cursor at the
+// cursor's own speed.
+
+// HELPER FUNCTIONS
+// ----------------
+
+static void offsetRect(AnimationRect *rect, int dx, int dy)
+{
+    rect->left += dx;
+    rect->top += dy;
+    rect->right += dx;
+    rect->bottom += dy;
+}
+
+/// @brief Stops a glide along one axis at the edge it is heading for
+/// @param start, end The leading edge of the window before and after the glide
+/// @param edge The edge of the bounds the window is heading for
+/// @param direction 1 if the window moves towards larger coordinates, -1 if towards smaller ones
+/// @return How far the glide would have gone past the edge. A window that was already past the
+/// edge when it was let go of is not pulled back, but it goes no further.
+static int clampGlide(int start, int *end, int edge, int direction)
+{
+    int limit = direction > 0 ? (start > edge ? start : edge) : (start < edge ? start : edge);
+    int overshoot = (*end - limit) * direction;
+    if (overshoot <= 0)
+    {
+        return 0;
+    }
+    *end = limit;
+    return overshoot;
+}
+
+// PLANNING
+// --------
+
+/// @brief Plans the glide of a window let go of with the given velocity
+/// @param window The window rect at release
+/// @param bounds The area the window comes to rest in, usually the work area of its monitor
+/// @return False if the window is too slow to be thrown
+bool planThrow(const AnimationRect &window, float velocityX, float velocityY, const AnimationRect &bounds, const ThrowSettings &settings, ThrowPlan *plan)
+{
+    float speed = sqrtf(velocityX * velocityX + velocityY * velocityY);
+    if (speed < settings.minSpeed || speed == 0)
+    {
+        return false;
+    }
+    if (speed > settings.maxSpeed)
+    {
+        velocityX *= settings.maxSpeed / speed;
+        velocityY *= settings.maxSpeed / speed;
+    }
+
+    // Decaying from `velocity`, the glide would cover `velocity * glideTime` until it stops
+    // completely; it is cut off once the decay reaches GLIDE_DECAY
+    float travel = settings.glideTime * (1 - expf(-GLIDE_DECAY));
+    int dx = (int)lroundf(velocityX * travel);
+    int dy = (int)lroundf(velocityY * travel);
+
+    AnimationRect to = window;
+    offsetRect(&to, dx, dy);
+
+    // Stop at the edges the window is heading for
+    int overshootX = 0, overshootY = 0;
+    if (dx > 0)
+    {
+        int right = to.right;
+        overshootX = clampGlide(window.right, &right, bounds.right, 1);
+        offsetRect(&to, right - to.right, 0);
+    }
+    else if (dx < 0)
+    {
+        int left = to.left;
+        overshootX = clampGlide(window.left, &left, bounds.left, -1);
+        offsetRect(&to, left - to.left, 0);
+    }
+    if (dy > 0)
+    {
+        int bottom = to.bottom;
+        overshootY = clampGlide(window.bottom, &bottom, bounds.bottom, 1);
+        offsetRect(&to, 0, bottom - to.bottom);
+    }
+    else if (dy < 0)
+    {
+        int top = to.top;
+        overshootY = clampGlide(window.top, &top, bounds.top, -1);
+        offsetRect(&to, 0, top - to.top);
+    }
+
+    // Thrown hard into an edge, the window snaps to that half of the bounds, or the quarter of the corner
+    bool isSnappedX = overshootX > settings.snapDistance;
+    bool isSnappedY = overshootY > settings.snapDistance;
+    if (isSnappedX || isSnappedY)
+    {
+        int middleX = bounds.left + (bounds.right - bounds.left) / 2;
+        int middleY = bounds.top + (bounds.bottom - bounds.top) / 2;
+        to = bounds;
+        if (isSnappedX && dx > 0)
+            to.left = middleX;
+        if (isSnappedX && dx < 0)
+            to.right = middleX;
+        if (isSnappedY && dy > 0)
+            to.top = middleY;
+        if (isSnappedY && dy < 0)
+            to.bottom = middleY;
+    }
+
+    plan->to = to;
+    plan->duration = settings.glideTime * GLIDE_DECAY;
+    plan->isSnapped = isSnappedX || isSnappedY;
+    return true;
+}
@@ -0,0 +1,27 @@
+#ifndef KINETIC_H
+#define KINETIC_H
+
+#include "animation.h"
+
+// THROW
+
+/// Speeds are in pixels per millisecond, times in milliseconds, distances in pixels
+struct ThrowSettings
+{
+    float minSpeed = 1.0f;    // Windows let go of more slowly just stay where they are
+    float maxSpeed = 8.0f;    // Faster throws are slowed down to this, so a flick cannot fling a window across all monitors
+    float glideTime = 100.0f; // How quickly friction stops the window: it glides about `speed * glideTime` pixels
+    int snapDistance = 48;    // A window that would glide this far past the edge of its monitor snaps to a half (or a quarter in a corner)
+};
+
+/// Where a thrown window comes to rest, and how long it takes to get there
+struct ThrowPlan
+{
+    AnimationRect to;
+    double duration;
+    bool isSnapped; // The window was thrown into an edge, and fills a half or quarter of the monitor
+};
+
+bool planThrow(const AnimationRect &window, float velocityX, float velocityY, const AnimationRect &bounds, const ThrowSettings &settings, ThrowPlan *plan);
+
+#endif // KINETIC_H
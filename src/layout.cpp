@@ -0,0 +1,653 @@
+#include <windows.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "layout.h"
+#include "helpers.h"
+
+// CONSTANTS
+// ---------
+
+/// Identifies a winctrl layout file ("WCLY")
+static const uint32_t LAYOUT_MAGIC = 0x594C4357;
+/// Bumped whenever the layout of `WindowRecord` or `LayoutFileHeader` changes
+static const uint32_t LAYOUT_VERSION = 2;
+/// The maximum number of monitors considered when restoring a layout
+static const int MAX_MONITORS = 16;
+/// The maximum number of windows a snapshot can hold
+static const int MAX_LAYOUT_WINDOWS = 512;
+/// The number of display configurations (e.g. docked and undocked) that keep a snapshot of their own
+static const int MAX_LAYOUT_DISPLAYS = 4;
+
+// SNAPSHOT
+// --------
+
+/// A compact, fixed-size record of the layout of a single window
+struct WindowRecord
+{
+    uint64_t hWnd;      // The handle at snapshot time. Only trusted if the other keys still match
+    uint32_t imageHash; // Hash of the owning process' image file name
+    uint32_t classHash; // Hash of the window class name
+    uint32_t titleHash; // Hash of the window title
+    RECT normalRect;    // The restored position from the window placement, in screen coordinates
+    RECT windowRect;    // The actual on-screen rect (screen coordinates)
+    RECT monitorRect;   // The bounds of the monitor the window was on
+    RECT workRect;      // The work area of that monitor
+    uint8_t showCmd;    // SW_SHOWNORMAL, SW_SHOWMAXIMIZED or SW_SHOWMINIMIZED
+    uint8_t alpha;      // The layered-window opacity, 255 if the window is opaque
+    uint16_t reserved;
+};
+
+/// The header of the on-disk snapshot, followed by `count` records
+struct LayoutFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t count;
+    uint32_t displays; // The display configuration the snapshot was taken on
+};
+
+/// A window that is currently on the desktop, identified the same way as a `WindowRecord`
+struct LiveWindow
+{
+    HWND hWnd;
+    uint32_t imageHash;
+    uint32_t classHash;
+    uint32_t titleHash;
+    bool claimed;
+};
+
+/// Remembers the image hash of each process seen during a single pass, so that
+/// a process with many windows is only opened once
+struct ImageCacheEntry
+{
+    DWORD pid;
+    uint32_t imageHash;
+};
+
+/// The snapshot of one display configuration
+struct LayoutSnapshot
+{
+    uint32_t displays; // Hash of the monitors the snapshot was taken on (see `hashDisplays`)
+    uint32_t savedAt;  // When it was last saved, in snapshots taken since startup. 0 if unused
+    int count;
+    WindowRecord records[MAX_LAYOUT_WINDOWS];
+};
+
+/// One snapshot per display configuration, so that a layout taken while docked survives a
+/// snapshot taken while undocked. These are static arrays rather than containers, so they need no
+/// initializer at startup and their pages are only brought in once a snapshot is taken.
+static LayoutSnapshot s_snapshots[MAX_LAYOUT_DISPLAYS];
+static uint32_t s_snapshotsTaken = 0;
+
+// HELPER FUNCTIONS
+// ----------------
+
+/// @brief Hashes the image file name (e.g. `notepad.exe`) of the process that owns the window
+static uint32_t hashProcessImage(HWND hWnd, std::vector<ImageCacheEntry> &cache)
+{
+    DWORD pid = 0;
+    GetWindowThreadProcessId(hWnd, &pid);
+
+    for (const auto &entry : cache)
+    {
+        if (entry.pid == pid)
+        {
+            return entry.imageHash;
+        }
+    }
+
+    uint32_t imageHash = 0;
+    HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (hProcess)
+    {
+        wchar_t path[MAX_PATH];
+        DWORD size = MAX_PATH;
+        if (QueryFullProcessImageNameW(hProcess, 0, path, &size))
+        {
+            // Only the file name is used, so that a reinstalled application still matches
+            const wchar_t *name = path;
+            for (const wchar_t *p = path; *p; p++)
+            {
+                if (*p == L'\\')
+                {
+                    name = p + 1;
+                }
+            }
+            imageHash = hashString(name, true);
+        }
+        CloseHandle(hProcess);
+    }
+
+    cache.push_back({pid, imageHash});
+    return imageHash;
+}
+
+/// @brief Fills in the keys used to match a window across snapshots
+static LiveWindow describeWindow(HWND hWnd, std::vector<ImageCacheEntry> &cache)
+{
+    wchar_t text[256];
+    LiveWindow live = {hWnd, hashProcessImage(hWnd, cache), 0, 0, false};
+
+    GetClassNameW(hWnd, text, sizeof(text) / sizeof(wchar_t));
+    live.classHash = hashString(text, false);
+
+    text[0] = L'\0';
+    GetWindowTextW(hWnd, text, sizeof(text) / sizeof(wchar_t));
+    live.titleHash = hashString(text, false);
+
+    return live;
+}
+
+/// @brief Determines whether a window takes part in layout snapshots.
+/// Only visible, unowned application windows are considered.
+static bool isLayoutWindow(HWND hWnd)
+{
+    if (!IsWindowVisible(hWnd) || GetWindow(hWnd, GW_OWNER) != NULL)
+    {
+        return false;
+    }
+
+    if (GetWindowLongPtr(hWnd, GWL_EXSTYLE) & WS_EX_TOOLWINDOW)
+    {
+        return false;
+    }
+
+    return !isExcludedWindow(hWnd);
+}
+
+static BOOL CALLBACK collectLayoutWindow(HWND hWnd, LPARAM lParam)
+{
+    if (isLayoutWindow(hWnd))
+    {
+        ((std::vector<HWND> *)lParam)->push_back(hWnd);
+    }
+    return TRUE;
+}
+
+/// @brief Collects every eligible top-level window, in z-order
+static std::vector<HWND> collectLayoutWindows()
+{
+    std::vector<HWND> windows;
+    windows.reserve(256);
+    EnumWindows(collectLayoutWindow, (LPARAM)&windows);
+    return windows;
+}
+
+struct MonitorList
+{
+    RECT rects[MAX_MONITORS];
+    RECT workRects[MAX_MONITORS];
+    int count;
+};
+
+static BOOL CALLBACK collectMonitor(HMONITOR hMonitor, HDC, LPRECT, LPARAM lParam)
+{
+    MonitorList *monitors = (MonitorList *)lParam;
+    MONITORINFO info = {sizeof(MONITORINFO)};
+    if (monitors->count < MAX_MONITORS && GetMonitorInfo(hMonitor, &info))
+    {
+        monitors->rects[monitors->count] = info.rcMonitor;
+        monitors->workRects[monitors->count++] = info.rcWork;
+    }
+    return TRUE;
+}
+
+static MonitorList collectMonitors()
+{
+    MonitorList monitors = {};
+    EnumDisplayMonitors(NULL, NULL, collectMonitor, (LPARAM)&monitors);
+    return monitors;
+}
+
+/// @brief Identifies a display configuration by the bounds of its monitors, in any order
+static uint32_t hashDisplays(const MonitorList &monitors)
+{
+    uint32_t hash = 0;
+    for (int i = 0; i < monitors.count; i++)
+    {
+        const RECT &r = monitors.rects[i];
+        const LONG values[] = {r.left, r.top, r.right, r.bottom};
+        uint32_t monitorHash = 2166136261u;
+        for (LONG value : values)
+        {
+            monitorHash = (monitorHash ^ (uint32_t)value) * 16777619u;
+        }
+        hash += monitorHash;
+    }
+    return hash ? hash : 1; // 0 marks an unused snapshot
+}
+
+static bool sameRect(const RECT &a, const RECT &b)
+{
+    return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+}
+
+static RECT offsetRect(RECT rect, int dx, int dy)
+{
+    rect.left += dx;
+    rect.right += dx;
+    rect.top += dy;
+    rect.bottom += dy;
+    return rect;
+}
+
+/// @brief Finds the monitor a recorded monitor has become: the same one if it is still there,
+/// else the one that overlaps it the most, else the closest one
+static int findMonitor(const MonitorList &monitors, const RECT &recorded)
+{
+    int best = -1;
+    long long bestOverlap = 0;
+    for (int i = 0; i < monitors.count; i++)
+    {
+        const RECT &r = monitors.rects[i];
+        if (sameRect(r, recorded))
+        {
+            return i;
+        }
+
+        long long width = (long long)std::min(r.right, recorded.right) - std::max(r.left, recorded.left);
+        long long height = (long long)std::min(r.bottom, recorded.bottom) - std::max(r.top, recorded.top);
+        if (width > 0 && height > 0 && width * height > bestOverlap)
+        {
+            best = i;
+            bestOverlap = width * height;
+        }
+    }
+    if (best != -1)
+    {
+        return best;
+    }
+
+    long long bestDistance = 0;
+    for (int i = 0; i < monitors.count; i++)
+    {
+        const RECT &r = monitors.rects[i];
+        long long dx = ((long long)r.left + r.right - recorded.left - recorded.right) / 2;
+        long long dy = ((long long)r.top + r.bottom - recorded.top - recorded.bottom) / 2;
+        if (best == -1 || dx * dx + dy * dy < bestDistance)
+        {
+            best = i;
+            bestDistance = dx * dx + dy * dy;
+        }
+    }
+    return best;
+}
+
+static LONG scaleCoordinate(LONG value, LONG fromStart, LONG fromSize, LONG toStart, LONG toSize)
+{
+    return toStart + (LONG)((long long)(value - fromStart) * toSize / (fromSize > 0 ? fromSize : 1));
+}
+
+/// @brief Maps a rect from one work area into another, keeping its place and size relative to the
+/// work area, and keeping it inside
+static RECT mapRect(const RECT &rect, const RECT &from, const RECT &to)
+{
+    LONG fromWidth = from.right - from.left, fromHeight = from.bottom - from.top;
+    LONG toWidth = to.right - to.left, toHeight = to.bottom - to.top;
+
+    RECT mapped = {scaleCoordinate(rect.left, from.left, fromWidth, to.left, toWidth),
+                   scaleCoordinate(rect.top, from.top, fromHeight, to.top, toHeight),
+                   scaleCoordinate(rect.right, from.left, fromWidth, to.left, toWidth),
+                   scaleCoordinate(rect.bottom, from.top, fromHeight, to.top, toHeight)};
+
+    // A window that stuck out of its old work area is pulled back in
+    mapped = offsetRect(mapped, std::max(0, (int)(to.left - mapped.left)), std::max(0, (int)(to.top - mapped.top)));
+    mapped = offsetRect(mapped, std::min(0, (int)(to.right - mapped.right)), std::min(0, (int)(to.bottom - mapped.bottom)));
+    mapped.left = std::max(mapped.left, to.left);
+    mapped.top = std::max(mapped.top, to.top);
+    return mapped;
+}
+
+// SNAPSHOTS
+// ---------
+
+static LayoutSnapshot *findSnapshot(uint32_t displays)
+{
+    for (LayoutSnapshot &snapshot : s_snapshots)
+    {
+        if (snapshot.savedAt && snapshot.displays == displays)
+        {
+            return &snapshot;
+        }
+    }
+    return NULL;
+}
+
+static LayoutSnapshot *latestSnapshot()
+{
+    LayoutSnapshot *latest = NULL;
+    for (LayoutSnapshot &snapshot : s_snapshots)
+    {
+        if (snapshot.savedAt && (!latest || snapshot.savedAt > latest->savedAt))
+        {
+            latest = &snapshot;
+        }
+    }
+    return latest;
+}
+
+/// @brief The snapshot to save for a display configuration: its own, else an unused one, else
+/// the one saved longest ago
+static LayoutSnapshot *snapshotToSave(uint32_t displays)
+{
+    LayoutSnapshot *snapshot = findSnapshot(displays);
+    if (!snapshot)
+    {
+        // Unused snapshots count as saved at 0, so they are taken first
+        snapshot = &s_snapshots[0];
+        for (LayoutSnapshot &candidate : s_snapshots)
+        {
+            if (candidate.savedAt < snapshot->savedAt)
+            {
+                snapshot = &candidate;
+            }
+        }
+    }
+
+    snapshot->displays = displays;
+    snapshot->savedAt = ++s_snapshotsTaken;
+    snapshot->count = 0;
+    return snapshot;
+}
+
+static bool writeLayoutFile(const LayoutSnapshot &snapshot)
+{
+    // The snapshot is stored next to the executable as `<name>.layout`
+    wchar_t path[MAX_PATH];
+    if (!getAppFilePath(L".layout", path, MAX_PATH))
+    {
+        return false;
+    }
+
+    HANDLE hFile = CreateFileW(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LayoutFileHeader header = {LAYOUT_MAGIC, LAYOUT_VERSION, sizeof(WindowRecord), (uint32_t)snapshot.count, snapshot.displays};
+    DWORD recordBytes = (DWORD)(snapshot.count * sizeof(WindowRecord));
+    DWORD written = 0;
+    bool ok = WriteFile(hFile, &header, sizeof(header), &written, NULL) && written == sizeof(header);
+    ok = ok && WriteFile(hFile, snapshot.records, recordBytes, &written, NULL) && written == recordBytes;
+
+    CloseHandle(hFile);
+    return ok;
+}
+
+/// @brief Loads the snapshot saved by an earlier run, as the snapshot of the displays it was taken on
+static bool readLayoutFile()
+{
+    // The snapshot is stored next to the executable as `<name>.layout`
+    wchar_t path[MAX_PATH];
+    if (!getAppFilePath(L".layout", path, MAX_PATH))
+    {
+        return false;
+    }
+
+    HANDLE hFile = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LayoutFileHeader header = {};
+    DWORD read = 0;
+    bool ok = ReadFile(hFile, &header, sizeof(header), &read, NULL) && read == sizeof(header) &&
+              header.magic == LAYOUT_MAGIC && header.version == LAYOUT_VERSION &&
+              header.recordSize == sizeof(WindowRecord) && header.count <= MAX_LAYOUT_WINDOWS;
+    if (ok)
+    {
+        LayoutSnapshot *snapshot = snapshotToSave(header.displays);
+        DWORD recordBytes = (DWORD)(header.count * sizeof(WindowRecord));
+        ok = ReadFile(hFile, snapshot->records, recordBytes, &read, NULL) && read == recordBytes;
+        snapshot->count = ok ? (int)header.count : 0;
+        snapshot->savedAt = ok ? snapshot->savedAt : 0;
+    }
+
+    CloseHandle(hFile);
+    return ok;
+}
+
+// SAVE
+// ----
+
+bool hasLayout()
+{
+    const LayoutSnapshot *snapshot = latestSnapshot();
+    return snapshot && snapshot->count > 0;
+}
+
+/// @brief Captures the geometry, state, monitor and opacity of every eligible window, as the
+/// snapshot of the current display configuration.
+/// @param persist Whether to also write the snapshot to disk, so it survives a restart
+/// @return True if at least one window was captured
+bool saveLayout(bool persist)
+{
+    std::vector<HWND> windows = collectLayoutWindows();
+    std::vector<ImageCacheEntry> imageCache;
+    MonitorList monitors = collectMonitors();
+    LayoutSnapshot *snapshot = snapshotToSave(hashDisplays(monitors));
+
+    for (HWND hWnd : windows)
+    {
+        if (snapshot->count == MAX_LAYOUT_WINDOWS)
+        {
+            break;
+        }
+
+        WINDOWPLACEMENT placement = {sizeof(WINDOWPLACEMENT)};
+        if (!GetWindowPlacement(hWnd, &placement))
+        {
+            continue;
+        }
+
+        LiveWindow live = describeWindow(hWnd, imageCache);
+
+        WindowRecord &record = snapshot->records[snapshot->count];
+        record = {};
+        record.hWnd = (uint64_t)(ULONG_PTR)hWnd;
+        record.imageHash = live.imageHash;
+        record.classHash = live.classHash;
+        record.titleHash = live.titleHash;
+        POINT offset = workspaceOffset(hWnd);
+        record.normalRect = offsetRect(placement.rcNormalPosition, offset.x, offset.y);
+        GetWindowRect(hWnd, &record.windowRect);
+
+        MONITORINFO monitorInfo = {sizeof(MONITORINFO)};
+        GetMonitorInfo(MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST), &monitorInfo);
+        record.monitorRect = monitorInfo.rcMonitor;
+        record.workRect = monitorInfo.rcWork;
+
+        if (IsIconic(hWnd))
+            record.showCmd = SW_SHOWMINIMIZED;
+        else if (IsZoomed(hWnd))
+            record.showCmd = SW_SHOWMAXIMIZED;
+        else
+            record.showCmd = SW_SHOWNORMAL;
+
+        record.alpha = 255;
+        if (GetWindowLongPtr(hWnd, GWL_EXSTYLE) & WS_EX_LAYERED)
+        {
+            BYTE alpha;
+            DWORD flags = 0;
+            if (GetLayeredWindowAttributes(hWnd, NULL, &alpha, &flags) && (flags & LWA_ALPHA))
+            {
+                record.alpha = alpha;
+            }
+        }
+
+        snapshot->count++;
+    }
+
+    if (persist)
+    {
+        writeLayoutFile(*snapshot);
+    }
+
+    return snapshot->count > 0;
+}
+
+// RESTORE
+// -------
+
+/// @brief Scores how likely it is that a live window is the one a record was taken from.
+/// The process image and class must match; the title and handle only break ties.
+/// @return 0 if the window cannot be the recorded one
+static int matchScore(const WindowRecord &record, const LiveWindow &live)
+{
+    if (record.imageHash != live.imageHash || record.classHash != live.classHash)
+    {
+        return 0;
+    }
+
+    int score = 1;
+    if (record.titleHash == live.titleHash)
+    {
+        score += 2;
+    }
+    if (record.hWnd == (uint64_t)(ULONG_PTR)live.hWnd)
+    {
+        score += 4;
+    }
+    return score;
+}
+
+static void restoreAlpha(HWND hWnd, BYTE alpha)
+{
+    LONG_PTR exStyle = GetWindowLongPtr(hWnd, GWL_EXSTYLE);
+    if (!(exStyle & WS_EX_LAYERED))
+    {
+        if (alpha == 255)
+        {
+            return; // Already opaque
+        }
+        SetWindowLongPtr(hWnd, GWL_EXSTYLE, exStyle | WS_EX_LAYERED);
+    }
+    SetLayeredWindowAttributes(hWnd, 0, alpha, LWA_ALPHA);
+}
+
+/// @brief Moves every window that can be matched to a snapshot back to its recorded place.
+/// The snapshot of the current displays is used if there is one. Otherwise the latest snapshot is,
+/// and each window goes to the monitor that took the place of its own (or the nearest one), scaled
+/// into its work area. Windows in the normal state are moved in a single deferred batch.
+/// @return The number of windows that were matched
+int restoreLayout()
+{
+    MonitorList monitors = collectMonitors();
+    uint32_t displays = hashDisplays(monitors);
+    if (!findSnapshot(displays) && !latestSnapshot())
+    {
+        readLayoutFile();
+    }
+
+    const LayoutSnapshot *snapshot = findSnapshot(displays);
+    if (!snapshot)
+    {
+        snapshot = latestSnapshot();
+    }
+    if (!snapshot || snapshot->count == 0 || monitors.count == 0)
+    {
+        return 0;
+    }
+
+    std::vector<HWND> windows = collectLayoutWindows();
+    std::vector<ImageCacheEntry> imageCache;
+    std::vector<LiveWindow> live;
+    live.reserve(windows.size());
+    for (HWND hWnd : windows)
+    {
+        live.push_back(describeWindow(hWnd, imageCache));
+    }
+
+    // Match in rounds of decreasing confidence, so that a record with a weak match
+    // cannot claim a window that another record matches exactly
+    std::vector<int> matches(snapshot->count, -1);
+    static const int MIN_SCORES[] = {7, 3, 1};
+    for (int minScore : MIN_SCORES)
+    {
+        for (int i = 0; i < snapshot->count; i++)
+        {
+            if (matches[i] != -1)
+            {
+                continue;
+            }
+
+            int best = -1;
+            int bestScore = minScore - 1;
+            for (size_t j = 0; j < live.size(); j++)
+            {
+                int score = live[j].claimed ? 0 : matchScore(snapshot->records[i], live[j]);
+                if (score > bestScore)
+                {
+                    best = (int)j;
+                    bestScore = score;
+                }
+            }
+
+            if (best != -1)
+            {
+                matches[i] = best;
+                live[best].claimed = true;
+            }
+        }
+    }
+
+    int restored = 0;
+    std::vector<WindowPosition> positions;
+    positions.reserve(snapshot->count);
+
+    for (int i = 0; i < snapshot->count; i++)
+    {
+        if (matches[i] == -1)
+        {
+            continue;
+        }
+
+        const WindowRecord &record = snapshot->records[i];
+        HWND hWnd = live[matches[i]].hWnd;
+        restored++;
+
+        restoreAlpha(hWnd, record.alpha);
+
+        // A window whose monitor is gone goes to the monitor that took its place
+        int monitor = findMonitor(monitors, record.monitorRect);
+        RECT windowRect = record.windowRect;
+        RECT normalRect = record.normalRect;
+        if (!sameRect(monitors.rects[monitor], record.monitorRect) || !sameRect(monitors.workRects[monitor], record.workRect))
+        {
+            windowRect = mapRect(record.windowRect, record.workRect, monitors.workRects[monitor]);
+            normalRect = mapRect(record.normalRect, record.workRect, monitors.workRects[monitor]);
+        }
+
+        if (record.showCmd == SW_SHOWNORMAL && !IsZoomed(hWnd) && !IsIconic(hWnd))
+        {
+            RECT current;
+            GetWindowRect(hWnd, &current);
+            if (sameRect(current, windowRect))
+            {
+                continue;
+            }
+
+            positions.push_back({hWnd, windowRect});
+        }
+        else
+        {
+            // State changes cannot be deferred, so maximized and minimized windows go through their
+            // placement. A maximized window maximizes on the monitor of its normal rect.
+            POINT offset = workspaceOffset(hWnd);
+            WINDOWPLACEMENT placement = {sizeof(WINDOWPLACEMENT)};
+            GetWindowPlacement(hWnd, &placement);
+            placement.flags = WPF_ASYNCWINDOWPLACEMENT;
+            placement.rcNormalPosition = offsetRect(normalRect, -offset.x, -offset.y);
+            placement.showCmd = record.showCmd == SW_SHOWMINIMIZED ? SW_SHOWMINNOACTIVE : record.showCmd;
+            SetWindowPlacement(hWnd, &placement);
+        }
+    }
+
+    placeWindows(positions.data(), (int)positions.size(), SWP_NOZORDER | SWP_NOACTIVATE | SWP_NOOWNERZORDER);
+    return restored;
+}
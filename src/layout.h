@@ -0,0 +1,12 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <windows.h>
+
+// LAYOUT SNAPSHOT
+
+bool saveLayout(bool persist);
+int restoreLayout();
+bool hasLayout();
+
+#endif // LAYOUT_H
@@ -1,22 +1,88 @@
-#include <iostream>
+// Needed for GetSystemTimePreciseAsFileTime (Windows 8+)
+#define _WIN32_WINNT 0x0602
+
 #include <windows.h>
-#include <cmath>
+#include <psapi.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "hooks.h"
+#include "helpers.h"
+
+// STARTUP STATS
+// -------------
+
+// How long to wait before sampling the steady-state working set
+const UINT STEADY_STATE_DELAY_MS = 5000;
+
+static ULONGLONG fileTimeToTicks(FILETIME fileTime)
+{
+    ULARGE_INTEGER ticks;
+    ticks.LowPart = fileTime.dwLowDateTime;
+    ticks.HighPart = fileTime.dwHighDateTime;
+    return ticks.QuadPart;
+}
+
+/// @brief The time since the process was created, in milliseconds
+static double millisecondsSinceProcessStart()
+{
+    FILETIME creationTime, exitTime, kernelTime, userTime, now;
+    GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime);
+    GetSystemTimePreciseAsFileTime(&now);
+    return (fileTimeToTicks(now) - fileTimeToTicks(creationTime)) / 10000.0; // FILETIME ticks are 100ns
+}
+
+static void printWorkingSet(const char *label)
+{
+    PROCESS_MEMORY_COUNTERS counters = {};
+    counters.cb = sizeof(counters);
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    printf("%s: working set %lu KiB (peak %lu KiB)\n", label,
+           (unsigned long)(counters.WorkingSetSize / 1024), (unsigned long)(counters.PeakWorkingSetSize / 1024));
+}
+
+// Samples the working set once the process has settled down, then exits
+static void CALLBACK SteadyStateTimerProc(HWND hWnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime)
+{
+    KillTimer(NULL, idEvent);
+    printWorkingSet("Steady state");
+    PostQuitMessage(0);
+}
 
 // MAIN
 // ----
 
-/// Main entrypoint of the application
-int main()
+/// Main entrypoint of the application.
+/// Pass `--startup-stats` to report the time until the hooks are installed and
+/// the steady-state working set, and exit.
+int main(int argc, char *argv[])
 {
+    bool reportStartupStats = argc > 1 && strcmp(argv[1], "--startup-stats") == 0;
+
+    // A windows-subsystem build (-mwindows) has no console, so report to the one it was started from,
+    // unless the output is redirected
+    if (reportStartupStats && !GetStdHandle(STD_OUTPUT_HANDLE) && AttachConsole(ATTACH_PARENT_PROCESS))
+    {
+        freopen("CONOUT$", "w", stdout);
+    }
+
     // Register keyboard and mouse hooks
     if (!setupHooks())
     {
-        std::cerr << "Failed to setup hooks!" << std::endl;
+        fputs("Failed to setup hooks!\n", stderr);
         return EXIT_FAILURE;
     }
 
+    if (reportStartupStats)
+    {
+        printf("Hooks installed after %.2f ms\n", millisecondsSinceProcessStart());
+        printWorkingSet("Startup");
+        SetTimer(NULL, 0, STEADY_STATE_DELAY_MS, SteadyStateTimerProc);
+    }
+
+    // Nothing touched during startup is needed again until the first window action
+    trimWorkingSet();
+
     // A message loop to keep our program running in the background listening for events
     // This is essential for our hook to work
     MSG msg;
@@ -0,0 +1,166 @@
+#ifndef PLUGINAPI_H
+#define PLUGINAPI_H
+
+#include <stdint.h>
+
+// PLUGIN API
+//
+// The C interface between winctrl and action plugins. A plugin is a DLL in the `plugins` folder
+// next to the executable; it binds its handlers to gestures once, when it is loaded, and winctrl
+// calls a handler whenever its gesture is performed. Handlers see a read-only view of the window
+// under the cursor and change windows only by submitting commands, which winctrl applies after the
+// handler returns.
+//
+// The interface is plain C, so plugins can be written in any language and built with any compiler.
+// It only ever grows: new fields go at the end of the structs that carry a `size`, and new
+// commands get new kinds. A plugin built against an older version keeps working.
+//
+// A plugin exports (see `WINCTRL_PLUGIN_EXPORT`):
+//
+//     uint32_t winctrlPluginVersion(void);          // returns WINCTRL_PLUGIN_API_VERSION
+//     int winctrlPluginLoad(const WinCtrlHost *);   // binds its handlers; nonzero rejects the plugin
+//     void winctrlPluginUnload(void);               // optional
+//
+// Handlers run on the message loop of winctrl, after the mouse hook has passed the gesture on, so
+// a slow handler does not stall the mouse. It still holds up the next gestures and hotkeys, so
+// handlers should return quickly and must not wait for other windows.
+
+#define WINCTRL_PLUGIN_API_VERSION 1
+
+#ifdef _WIN32
+#define WINCTRL_CALL __cdecl
+#define WINCTRL_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define WINCTRL_CALL
+#define WINCTRL_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // GESTURES
+
+    /// Gestures are performed while holding the Win key, and possibly more modifiers
+    enum WinCtrlGestureButton
+    {
+        WINCTRL_BUTTON_LEFT = 0,
+        WINCTRL_BUTTON_MIDDLE = 1,
+    };
+
+    /// A double-click is always preceded by a click
+    enum WinCtrlGestureKind
+    {
+        WINCTRL_GESTURE_CLICK = 0,
+        WINCTRL_GESTURE_DOUBLE_CLICK = 1,
+        WINCTRL_GESTURE_LONG_PRESS = 2,
+    };
+
+    /// The modifiers held besides the Win key
+    enum WinCtrlModifiers
+    {
+        WINCTRL_MOD_CTRL = 1 << 0,
+        WINCTRL_MOD_SHIFT = 1 << 1,
+        WINCTRL_MOD_ALT = 1 << 2,
+    };
+
+/// The id of a gesture, between 0 and WINCTRL_GESTURE_COUNT - 1
+#define WINCTRL_GESTURE_ID(button, kind, modifiers) ((((modifiers) * 3) + (kind)) * 2 + (button))
+#define WINCTRL_GESTURE_COUNT 48
+
+    // WINDOW VIEW
+
+    typedef struct WinCtrlRect
+    {
+        int32_t left;
+        int32_t top;
+        int32_t right;
+        int32_t bottom;
+    } WinCtrlRect;
+
+    enum WinCtrlWindowFlags
+    {
+        WINCTRL_WINDOW_MAXIMIZED = 1 << 0,
+        WINCTRL_WINDOW_MINIMIZED = 1 << 1,
+        WINCTRL_WINDOW_TOPMOST = 1 << 2,
+    };
+
+    /// @brief The window under the cursor when the gesture was performed. Coordinates are in
+    /// screen pixels. `window` is NULL (and the rects are empty) if there is no window to act on.
+    typedef struct WinCtrlWindowView
+    {
+        uint32_t size;     // sizeof(WinCtrlWindowView) of winctrl
+        uint32_t flags;    // WinCtrlWindowFlags
+        void *window;      // The HWND, to pass back in commands
+        uint32_t processId;
+        int32_t cursorX;
+        int32_t cursorY;
+        WinCtrlRect rect;     // The window
+        WinCtrlRect workArea; // Its monitor, without the taskbar
+        WinCtrlRect monitor;  // Its whole monitor
+    } WinCtrlWindowView;
+
+    // COMMANDS
+
+    enum WinCtrlCommandKind
+    {
+        WINCTRL_COMMAND_SET_RECT = 1,        // Move and size the window to `rect`, restoring it first if needed
+        WINCTRL_COMMAND_MOVE_TO_MONITOR = 2, // Move the window to monitor `value` (1-based)
+        WINCTRL_COMMAND_TOGGLE_MAXIMIZED = 3,
+        WINCTRL_COMMAND_MINIMIZE = 4,
+        WINCTRL_COMMAND_TOGGLE_TOPMOST = 5,
+        WINCTRL_COMMAND_ADJUST_OPACITY = 6,  // Change the opacity of the window by `value` (out of 255)
+        WINCTRL_COMMAND_SWITCH_DESKTOP = 7,  // Switch to virtual desktop `value` (1-based); needs no window
+        WINCTRL_COMMAND_SEND_TO_DESKTOP = 8, // Move the window to virtual desktop `value` (1-based)
+        WINCTRL_COMMAND_UNDO = 9,            // Undo the last geometry change of the window
+        WINCTRL_COMMAND_REDO = 10,
+    };
+
+    /// @brief A change to a window. The layout of this struct never changes.
+    typedef struct WinCtrlCommand
+    {
+        uint32_t kind; // WinCtrlCommandKind
+        int32_t value;
+        void *window;
+        WinCtrlRect rect;
+    } WinCtrlCommand;
+
+    // HOST
+
+    /// @brief Handles a gesture. Return nonzero if it was handled; otherwise the built-in action
+    /// of the gesture (if any) runs as well.
+    typedef int(WINCTRL_CALL *WinCtrlActionProc)(void *userData, const WinCtrlWindowView *view);
+
+    enum WinCtrlResult
+    {
+        WINCTRL_OK = 0,
+        WINCTRL_ERROR_INVALID = -1, // An unknown gesture, or no handler
+        WINCTRL_ERROR_TAKEN = -2,   // Another plugin already bound the gesture
+        WINCTRL_ERROR_LOCKED = -3,  // Gestures can only be bound from `winctrlPluginLoad`
+    };
+
+    /// @brief What winctrl offers to a plugin. Pass `context` back in every call.
+    typedef struct WinCtrlHost
+    {
+        uint32_t size;    // sizeof(WinCtrlHost) of winctrl
+        uint32_t version; // WINCTRL_PLUGIN_API_VERSION of winctrl
+        void *context;
+
+        /// Binds a handler to a gesture (see WINCTRL_GESTURE_ID). Returns a WinCtrlResult
+        int(WINCTRL_CALL *bind)(void *context, uint32_t gesture, WinCtrlActionProc action, void *userData);
+
+        /// Queues commands, to be applied in order once the handler returns; all new rects are applied
+        /// together, in one batch. Only works from within a handler. Returns how many were queued
+        uint32_t(WINCTRL_CALL *submit)(void *context, const WinCtrlCommand *commands, uint32_t count);
+    } WinCtrlHost;
+
+    typedef uint32_t(WINCTRL_CALL *WinCtrlPluginVersionProc)(void);
+    typedef int(WINCTRL_CALL *WinCtrlPluginLoadProc)(const WinCtrlHost *host);
+    typedef void(WINCTRL_CALL *WinCtrlPluginUnloadProc)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PLUGINAPI_H
@@ -0,0 +1,315 @@
+#include <windows.h>
+
+#include "pluginhost.h"
+#include "plugins.h"
+#include "hotkeys.h"
+#include "helpers.h"
+#include "history.h"
+#include "winctrl.h"
+#include "animator.h"
+
+// The Windows side of action plugins (see pluginapi.h).
+//
+// Plugins are the DLLs in the `plugins` folder next to the executable. They are loaded once, when
+// the hooks are installed, and stay loaded until they are removed. Commands other than new rects
+// go through the same functions as the hotkeys; new rects are applied in one batch (see `placeWindows`).
+//
+// Handlers never run inside the mouse hook: the hook only queues the gesture and arms a timer, and
+// the handlers run when the message loop gets to it, so a slow plugin cannot delay the input of
+// the whole desktop or get the hook removed.
+
+// BACKEND
+// -------
+
+class WindowsPluginBackend : public PluginBackend
+{
+public:
+    void *findSymbol(void *library, const char *name) override { return (void *)GetProcAddress((HMODULE)library, name); }
+    void closeLibrary(void *library) override { FreeLibrary((HMODULE)library); }
+    void apply(const WinCtrlCommand *commands, int count) override;
+};
+
+static WindowsPluginBackend s_backend;
+static PluginRegistry s_plugins;
+
+static const struct
+{
+    WinCtrlCommandKind command;
+    HotkeyActionKind action;
+} COMMAND_ACTIONS[] = {
+    {WINCTRL_COMMAND_MOVE_TO_MONITOR, HOTKEY_MONITOR},
+    {WINCTRL_COMMAND_TOGGLE_MAXIMIZED, HOTKEY_MAXIMIZE},
+    {WINCTRL_COMMAND_MINIMIZE, HOTKEY_MINIMIZE},
+    {WINCTRL_COMMAND_TOGGLE_TOPMOST, HOTKEY_TOPMOST},
+    {WINCTRL_COMMAND_ADJUST_OPACITY, HOTKEY_OPACITY},
+    {WINCTRL_COMMAND_SWITCH_DESKTOP, HOTKEY_DESKTOP},
+    {WINCTRL_COMMAND_SEND_TO_DESKTOP, HOTKEY_SEND_TO_DESKTOP},
+    {WINCTRL_COMMAND_UNDO, HOTKEY_UNDO},
+    {WINCTRL_COMMAND_REDO, HOTKEY_REDO},
+};
+
+/// @brief Whether a plugin may act on a window. Plugins can pass any handle, so it is checked
+/// the same way as the window under the cursor.
+static bool isPluginTarget(HWND hWnd)
+{
+    return hWnd && IsWindow(hWnd) && !isExcludedWindow(hWnd);
+}
+
+void WindowsPluginBackend::apply(const WinCtrlCommand *commands, int count)
+{
+    WindowPosition positions[PluginRegistry::MAX_COMMANDS] = {};
+    int positionCount = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        const WinCtrlCommand &command = commands[i];
+        HWND hWnd = (HWND)command.window;
+
+        if (command.kind == WINCTRL_COMMAND_SET_RECT)
+        {
+            const WinCtrlRect &r = command.rect;
+            if (!isPluginTarget(hWnd) || r.right <= r.left || r.bottom <= r.top)
+            {
+                continue;
+            }
+
+            cancelWindowAnimation(hWnd);
+            recordGeometryChange(hWnd);
+
+            // Only windows in the normal state can be placed by a batch
+            if (IsZoomed(hWnd) || IsIconic(hWnd))
+            {
+                ShowWindow(hWnd, SW_SHOWNOACTIVATE);
+            }
+
+            if (positionCount < PluginRegistry::MAX_COMMANDS)
+            {
+                positions[positionCount++] = {hWnd, {r.left, r.top, r.right, r.bottom}};
+            }
+            continue;
+        }
+
+        for (const auto &entry : COMMAND_ACTIONS)
+        {
+            if (entry.command == command.kind)
+            {
+                // Switching desktops needs no window, so `performHotkeyAction` checks the window itself
+                HotkeyAction action = {entry.action, command.value, 0};
+                performHotkeyAction(&action, isPluginTarget(hWnd) ? hWnd : NULL);
+                break;
+            }
+        }
+    }
+
+    placeWindows(positions, positionCount, SWP_NOZORDER | SWP_NOACTIVATE | SWP_NOOWNERZORDER);
+}
+
+// WINDOW VIEW
+// -----------
+
+static WinCtrlRect toPluginRect(const RECT &rect)
+{
+    WinCtrlRect result = {(int32_t)rect.left, (int32_t)rect.top, (int32_t)rect.right, (int32_t)rect.bottom};
+    return result;
+}
+
+/// @brief Fills the view of the window under the cursor that handlers get to see
+static void describeWindow(HWND hWnd, POINT pt, WinCtrlWindowView *view)
+{
+    *view = WinCtrlWindowView();
+    view->size = sizeof(WinCtrlWindowView);
+    view->cursorX = pt.x;
+    view->cursorY = pt.y;
+
+    RECT rect;
+    if (!hWnd || !GetWindowRect(hWnd, &rect))
+    {
+        return;
+    }
+
+    DWORD processId = 0;
+    GetWindowThreadProcessId(hWnd, &processId);
+
+    view->window = hWnd;
+    view->processId = processId;
+    view->rect = toPluginRect(rect);
+    view->flags |= IsZoomed(hWnd) ? WINCTRL_WINDOW_MAXIMIZED : 0;
+    view->flags |= IsIconic(hWnd) ? WINCTRL_WINDOW_MINIMIZED : 0;
+    view->flags |= (GetWindowLong(hWnd, GWL_EXSTYLE) & WS_EX_TOPMOST) ? WINCTRL_WINDOW_TOPMOST : 0;
+
+    MONITORINFO monitor = {sizeof(MONITORINFO)};
+    if (GetMonitorInfoW(MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST), &monitor))
+    {
+        view->workArea = toPluginRect(monitor.rcWork);
+        view->monitor = toPluginRect(monitor.rcMonitor);
+    }
+}
+
+// DISPATCH
+// --------
+
+/// @brief The plugin gesture id of a recognized gesture, or -1 if plugins cannot bind it.
+/// Drags stay with the built-in move and resize
+static int getPluginGestureId(Gesture gesture, UINT modifiers)
+{
+    int kind;
+    switch (gesture.kind)
+    {
+    case GESTURE_CLICK:
+        kind = WINCTRL_GESTURE_CLICK;
+        break;
+    case GESTURE_DOUBLE_CLICK:
+        kind = WINCTRL_GESTURE_DOUBLE_CLICK;
+        break;
+    case GESTURE_LONG_PRESS:
+        kind = WINCTRL_GESTURE_LONG_PRESS;
+        break;
+    default:
+        return -1;
+    }
+
+    int button = gesture.button == GESTURE_LEFT ? WINCTRL_BUTTON_LEFT : WINCTRL_BUTTON_MIDDLE;
+    int pluginModifiers = ((modifiers & MOD_CONTROL) ? WINCTRL_MOD_CTRL : 0) |
+                          ((modifiers & MOD_SHIFT) ? WINCTRL_MOD_SHIFT : 0) |
+                          ((modifiers & MOD_ALT) ? WINCTRL_MOD_ALT : 0);
+    return WINCTRL_GESTURE_ID(button, kind, pluginModifiers);
+}
+
+// Gestures queued by the hook for the message loop. Each stays queued for a few milliseconds at
+// most, so a handful is plenty; when it is full, the built-in action runs instead.
+const int MAX_PENDING_GESTURES = 8;
+
+struct PendingGesture
+{
+    Gesture gesture;
+    uint32_t id;
+    POINT pt;
+    HWND hWnd; // The window under the cursor when the gesture happened
+};
+
+static PendingGesture s_pendingGestures[MAX_PENDING_GESTURES];
+static int s_pendingGestureCount = 0;
+static GestureFallbackProc s_fallback = NULL;
+static UINT_PTR s_dispatchTimer = 0;
+
+/// @brief Runs the handlers of the queued gestures, in the order they happened
+static void CALLBACK PluginDispatchTimerProc(HWND, UINT, UINT_PTR, DWORD)
+{
+    KillTimer(NULL, s_dispatchTimer);
+    s_dispatchTimer = 0;
+
+    for (int i = 0; i < s_pendingGestureCount; i++)
+    {
+        const PendingGesture &pending = s_pendingGestures[i];
+        WinCtrlWindowView view;
+        describeWindow(pending.hWnd, pending.pt, &view);
+        if (!s_plugins.dispatch(pending.id, &view) && s_fallback)
+        {
+            s_fallback(pending.gesture, pending.pt);
+        }
+    }
+    s_pendingGestureCount = 0;
+}
+
+/// @brief Hands a gesture to the plugin that bound it. Unbound gestures cost a single lookup.
+/// The handler runs later, from the message loop, and if it declines the gesture, `fallback`
+/// performs the built-in action there.
+/// @param modifiers The held modifiers, as MOD_* flags
+/// @return True if a plugin takes the gesture, so its built-in action must not run now
+bool dispatchPluginGesture(Gesture gesture, UINT modifiers, POINT pt, GestureFallbackProc fallback)
+{
+    int id = getPluginGestureId(gesture, modifiers);
+    if (id < 0 || !s_plugins.isBound((uint32_t)id) || s_pendingGestureCount == MAX_PENDING_GESTURES)
+    {
+        return false;
+    }
+
+    if (!s_dispatchTimer)
+    {
+        s_dispatchTimer = SetTimer(NULL, 0, 0, PluginDispatchTimerProc);
+        if (!s_dispatchTimer)
+        {
+            return false;
+        }
+    }
+
+    PendingGesture &pending = s_pendingGestures[s_pendingGestureCount++];
+    pending.gesture = gesture;
+    pending.id = (uint32_t)id;
+    pending.pt = pt;
+    pending.hWnd = getTargetWindow(pt);
+    s_fallback = fallback;
+    return true;
+}
+
+// LOADING
+// -------
+
+/// @brief Loads the plugins in the `plugins` folder next to the executable. Plugins are only
+/// loaded once, so calling this again keeps the ones already loaded.
+/// @return The number of plugins loaded
+int loadPlugins()
+{
+    if (s_plugins.pluginCount() > 0)
+    {
+        return s_plugins.pluginCount();
+    }
+    s_plugins.setBackend(&s_backend);
+
+    // Everything up to the last backslash of the executable's path is its folder
+    wchar_t folder[MAX_PATH];
+    DWORD length = GetModuleFileNameW(NULL, folder, MAX_PATH);
+    while (length > 0 && folder[length - 1] != L'\\')
+    {
+        length--;
+    }
+    if (length == 0 || length + lstrlenW(L"plugins\\*.dll") >= MAX_PATH)
+    {
+        return 0;
+    }
+    lstrcpyW(folder + length, L"plugins\\");
+    length += lstrlenW(L"plugins\\");
+
+    wchar_t pattern[MAX_PATH];
+    lstrcpyW(pattern, folder);
+    lstrcatW(pattern, L"*.dll");
+
+    WIN32_FIND_DATAW found;
+    HANDLE search = FindFirstFileW(pattern, &found);
+    if (search == INVALID_HANDLE_VALUE)
+    {
+        return 0;
+    }
+
+    do
+    {
+        if (length + lstrlenW(found.cFileName) >= MAX_PATH)
+        {
+            continue;
+        }
+
+        wchar_t path[MAX_PATH];
+        lstrcpyW(path, folder);
+        lstrcatW(path, found.cFileName);
+
+        bool isLoaded = s_plugins.load(LoadLibraryW(path));
+
+        char message[MAX_PATH + 64];
+        wsprintfA(message, "winctrl: %s plugin %ls\n", isLoaded ? "loaded" : "rejected", found.cFileName);
+        OutputDebugStringA(message);
+    } while (FindNextFileW(search, &found));
+    FindClose(search);
+
+    return s_plugins.pluginCount();
+}
+
+void unloadPlugins()
+{
+    if (s_dispatchTimer)
+    {
+        KillTimer(NULL, s_dispatchTimer);
+        s_dispatchTimer = 0;
+    }
+    s_pendingGestureCount = 0;
+    s_plugins.unloadAll();
+}
@@ -0,0 +1,17 @@
+#ifndef PLUGINHOST_H
+#define PLUGINHOST_H
+
+#include <windows.h>
+
+#include "gestures.h"
+
+// PLUGINS
+
+/// @brief Performs the built-in action of a gesture that a plugin declined
+typedef bool (*GestureFallbackProc)(Gesture gesture, POINT pt);
+
+int loadPlugins();
+void unloadPlugins();
+bool dispatchPluginGesture(Gesture gesture, UINT modifiers, POINT pt, GestureFallbackProc fallback);
+
+#endif // PLUGINHOST_H
@@ -0,0 +1,162 @@
+#include "plugins.h"
+
+// SETUP
+// -----
+
+void PluginRegistry::setBackend(PluginBackend *backend)
+{
+    m_backend = backend;
+    m_host.size = sizeof(WinCtrlHost);
+    m_host.version = WINCTRL_PLUGIN_API_VERSION;
+    m_host.context = this;
+    m_host.bind = bind;
+    m_host.submit = submit;
+}
+
+// LOADING
+// -------
+
+/// @brief Resolves the entry points of a library and lets the plugin bind its handlers. Takes
+/// over the library: it is closed again if it is not a compatible plugin, or rejects loading.
+/// @return True if the plugin was loaded
+bool PluginRegistry::load(void *library)
+{
+    if (!m_backend || !library)
+    {
+        return false;
+    }
+
+    WinCtrlPluginVersionProc version = (WinCtrlPluginVersionProc)m_backend->findSymbol(library, "winctrlPluginVersion");
+    WinCtrlPluginLoadProc loadPlugin = (WinCtrlPluginLoadProc)m_backend->findSymbol(library, "winctrlPluginLoad");
+    uint32_t pluginVersion = version ? version() : 0;
+
+    // A plugin built against a newer version may rely on things this one does not have
+    if (m_pluginCount >= MAX_PLUGINS || !loadPlugin || pluginVersion < 1 || pluginVersion > WINCTRL_PLUGIN_API_VERSION)
+    {
+        m_backend->closeLibrary(library);
+        return false;
+    }
+
+    m_isLoading = true;
+    int result = loadPlugin(&m_host);
+    m_isLoading = false;
+
+    if (result != 0)
+    {
+        // Take back whatever it bound before it gave up
+        for (Binding &binding : m_bindings)
+        {
+            if (binding.action && binding.plugin == m_pluginCount)
+            {
+                binding = Binding();
+            }
+        }
+        m_backend->closeLibrary(library);
+        return false;
+    }
+
+    Plugin &plugin = m_plugins[m_pluginCount++];
+    plugin.library = library;
+    plugin.unload = (WinCtrlPluginUnloadProc)m_backend->findSymbol(library, "winctrlPluginUnload");
+    return true;
+}
+
+/// @brief Unloads all plugins, the last loaded first
+void PluginRegistry::unloadAll()
+{
+    for (Binding &binding : m_bindings)
+    {
+        binding = Binding();
+    }
+
+    while (m_pluginCount > 0)
+    {
+        Plugin &plugin = m_plugins[--m_pluginCount];
+        if (plugin.unload)
+        {
+            plugin.unload();
+        }
+        m_backend->closeLibrary(plugin.library);
+        plugin = Plugin();
+    }
+}
+
+int PluginRegistry::bindingCount() const
+{
+    int count = 0;
+    for (const Binding &binding : m_bindings)
+    {
+        count += binding.action ? 1 : 0;
+    }
+    return count;
+}
+
+// HOST FUNCTIONS
+// --------------
+
+int WINCTRL_CALL PluginRegistry::bind(void *context, uint32_t gesture, WinCtrlActionProc action, void *userData)
+{
+    PluginRegistry *registry = (PluginRegistry *)context;
+    if (!registry->m_isLoading)
+    {
+        return WINCTRL_ERROR_LOCKED;
+    }
+    if (gesture >= WINCTRL_GESTURE_COUNT || !action)
+    {
+        return WINCTRL_ERROR_INVALID;
+    }
+
+    // The first plugin to bind a gesture keeps it
+    Binding &binding = registry->m_bindings[gesture];
+    if (binding.action)
+    {
+        return WINCTRL_ERROR_TAKEN;
+    }
+
+    binding.action = action;
+    binding.userData = userData;
+    binding.plugin = registry->m_pluginCount;
+    return WINCTRL_OK;
+}
+
+uint32_t WINCTRL_CALL PluginRegistry::submit(void *context, const WinCtrlCommand *commands, uint32_t count)
+{
+    PluginRegistry *registry = (PluginRegistry *)context;
+    if (!registry->m_isDispatching || !commands)
+    {
+        return 0;
+    }
+
+    uint32_t queued = 0;
+    while (queued < count && registry->m_commandCount < MAX_COMMANDS)
+    {
+        registry->m_commands[registry->m_commandCount++] = commands[queued++];
+    }
+    return queued;
+}
+
+// DISPATCH
+// --------
+
+/// @brief Calls the handler bound to a gesture, then applies the commands it submitted
+/// @return True if the handler handled the gesture, so its built-in action must not run
+bool PluginRegistry::dispatch(uint32_t gesture, const WinCtrlWindowView *view)
+{
+    if (!isBound(gesture))
+    {
+        return false;
+    }
+
+    const Binding &binding = m_bindings[gesture];
+    m_commandCount = 0;
+    m_isDispatching = true;
+    bool isHandled = binding.action(binding.userData, view) != 0;
+    m_isDispatching = false;
+
+    if (m_commandCount > 0)
+    {
+        m_backend->apply(m_commands, m_commandCount);
+        m_commandCount = 0;
+    }
+    return isHandled;
+}
@@ -0,0 +1,73 @@
+#ifndef PLUGINS_H
+#define PLUGINS_H
+
+#include "pluginapi.h"
+
+// PLUGIN BACKEND
+
+/// @brief What the platform offers for plugins: finding their entry points, and applying the
+/// commands they submit. Libraries are opaque handles (e.g. an `HMODULE`).
+class PluginBackend
+{
+public:
+    /// Finds an exported function of a library, or returns null
+    virtual void *findSymbol(void *library, const char *name) = 0;
+    /// Unloads a library
+    virtual void closeLibrary(void *library) = 0;
+    /// Applies the commands a handler submitted, all new rects in a single batch
+    virtual void apply(const WinCtrlCommand *commands, int count) = 0;
+};
+
+// PLUGIN REGISTRY
+
+/// @brief Loads action plugins and dispatches gestures to them. All bindings are made while the
+/// plugins load, into a flat table indexed by gesture id, so a gesture costs one lookup, and
+/// nothing more if no plugin bound it.
+class PluginRegistry
+{
+public:
+    static const int MAX_PLUGINS = 16;
+    static const int MAX_COMMANDS = 16; // Per handler call
+
+    void setBackend(PluginBackend *backend);
+
+    bool load(void *library);
+    void unloadAll();
+
+    /// @brief Whether a plugin handles the gesture. Cheap enough for every gesture
+    bool isBound(uint32_t gesture) const { return gesture < WINCTRL_GESTURE_COUNT && m_bindings[gesture].action; }
+    bool dispatch(uint32_t gesture, const WinCtrlWindowView *view);
+
+    int pluginCount() const { return m_pluginCount; }
+    int bindingCount() const;
+
+private:
+    static int WINCTRL_CALL bind(void *context, uint32_t gesture, WinCtrlActionProc action, void *userData);
+    static uint32_t WINCTRL_CALL submit(void *context, const WinCtrlCommand *commands, uint32_t count);
+
+    struct Binding
+    {
+        WinCtrlActionProc action;
+        void *userData;
+        int plugin; // The index of the plugin that made the binding
+    };
+
+    struct Plugin
+    {
+        void *library;
+        WinCtrlPluginUnloadProc unload;
+    };
+
+    PluginBackend *m_backend;
+    WinCtrlHost m_host;
+    Binding m_bindings[WINCTRL_GESTURE_COUNT];
+    Plugin m_plugins[MAX_PLUGINS];
+    int m_pluginCount;
+    bool m_isLoading; // Gestures are only bound while a plugin loads, into the next slot of `m_plugins`
+
+    WinCtrlCommand m_commands[MAX_COMMANDS];
+    int m_commandCount;
+    bool m_isDispatching; // Commands are only accepted from within a handler
+};
+
+#endif // PLUGINS_H
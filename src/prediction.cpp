@@ -0,0 +1,178 @@
+#include <math.h>
+
+#include "prediction.h"
+
+// HELPER FUNCTIONS
+// ----------------
+
+/// @brief Extrapolates one axis by `horizon` milliseconds
+/// @param velocity In pixels per millisecond, at the time of the newest sample
+/// @param acceleration In pixels per millisecond squared
+static float extrapolate(float velocity, float acceleration, float horizon, float damping)
+{
+    // Decelerating: predict with the full deceleration, but no further than where the cursor comes to rest
+    if (velocity * acceleration < 0)
+    {
+        float timeToRest = -velocity / acceleration;
+        if (timeToRest < horizon)
+        {
+            horizon = timeToRest;
+        }
+        return velocity * horizon + 0.5f * acceleration * horizon * horizon;
+    }
+
+    // Accelerating (or steady): only trust part of the acceleration, since it is the noisier estimate
+    return velocity * horizon + 0.5f * damping * acceleration * horizon * horizon;
+}
+
+// SAMPLES
+// -------
+
+void MotionPredictor::addSample(int x, int y, uint32_t time)
+{
+    // After a pause, the old samples describe a motion that has already ended
+    if (m_count > 0 && time - m_samples[m_newest].time >= settings.stopTime)
+    {
+        m_count = 0;
+    }
+
+    m_newest = (m_newest + 1) % RING_SIZE;
+    m_samples[m_newest] = {x, y, time};
+    if (m_count < RING_SIZE)
+    {
+        m_count++;
+    }
+}
+
+void MotionPredictor::reset()
+{
+    m_count = 0;
+}
+
+// ESTIMATION
+// ----------
+
+/// @brief Estimates the velocity (in pixels per millisecond) at the time of the newest sample,
+/// and the acceleration (in pixels per millisecond squared)
+/// @return False if there are not enough samples to tell
+bool MotionPredictor::estimate(float *velocityX, float *velocityY, float *accelerationX, float *accelerationY) const
+{
+    if (m_count == 0)
+    {
+        return false;
+    }
+
+    const Sample &newest = m_samples[m_newest];
+
+    // Find the oldest sample within the estimation window
+    int oldestAge = 0;
+    for (int age = 1; age < m_count; age++)
+    {
+        const Sample &sample = m_samples[(m_newest - age + RING_SIZE) % RING_SIZE];
+        if (newest.time - sample.time > settings.window)
+        {
+            break;
+        }
+        oldestAge = age;
+    }
+
+    const Sample &oldest = m_samples[(m_newest - oldestAge + RING_SIZE) % RING_SIZE];
+    uint32_t span = newest.time - oldest.time;
+    if (span == 0)
+    {
+        return false; // Not enough history (or all samples share a timestamp)
+    }
+
+    // Split the window in two halves by time. The velocities over each half give the
+    // acceleration; this is more robust than differencing single samples, whose timestamps
+    // only have millisecond resolution.
+    int middleAge = oldestAge;
+    for (int age = 1; age < oldestAge; age++)
+    {
+        const Sample &sample = m_samples[(m_newest - age + RING_SIZE) % RING_SIZE];
+        if (newest.time - sample.time >= span / 2)
+        {
+            middleAge = age;
+            break;
+        }
+    }
+
+    const Sample &middle = m_samples[(m_newest - middleAge + RING_SIZE) % RING_SIZE];
+    uint32_t newerSpan = newest.time - middle.time;
+    uint32_t olderSpan = middle.time - oldest.time;
+
+    if (newerSpan > 0 && olderSpan > 0)
+    {
+        float newerX = (newest.x - middle.x) / (float)newerSpan;
+        float newerY = (newest.y - middle.y) / (float)newerSpan;
+        float olderX = (middle.x - oldest.x) / (float)olderSpan;
+        float olderY = (middle.y - oldest.y) / (float)olderSpan;
+
+        // The half velocities are measured at the midpoints of their halves
+        float between = (newerSpan + olderSpan) / 2.0f;
+        *accelerationX = (newerX - olderX) / between;
+        *accelerationY = (newerY - olderY) / between;
+
+        // Carry the newer velocity forward from its midpoint to the newest sample
+        *velocityX = newerX + *accelerationX * (newerSpan / 2.0f);
+        *velocityY = newerY + *accelerationY * (newerSpan / 2.0f);
+    }
+    else
+    {
+        *velocityX = (newest.x - oldest.x) / (float)span;
+        *velocityY = (newest.y - oldest.y) / (float)span;
+        *accelerationX = 0;
+        *accelerationY = 0;
+    }
+    return true;
+}
+
+/// @brief The velocity of the cursor at the time of the newest sample, in pixels per millisecond.
+/// Zero if the cursor came to rest before it (see `PredictionSettings::stopTime`).
+void MotionPredictor::velocity(float *x, float *y) const
+{
+    float accelerationX, accelerationY;
+    if (!estimate(x, y, &accelerationX, &accelerationY))
+    {
+        *x = 0;
+        *y = 0;
+    }
+}
+
+// PREDICTION
+// ----------
+
+/// @brief Predicts where the cursor will be `settings.horizon` milliseconds after the newest sample.
+/// Without enough samples to tell, the newest position is returned as is.
+void MotionPredictor::predict(int *x, int *y) const
+{
+    if (m_count == 0)
+    {
+        return;
+    }
+
+    const Sample &newest = m_samples[m_newest];
+    *x = newest.x;
+    *y = newest.y;
+
+    float velocityX, velocityY, accelerationX, accelerationY;
+    if (!estimate(&velocityX, &velocityY, &accelerationX, &accelerationY))
+    {
+        return;
+    }
+
+    float horizon = (float)settings.horizon;
+    float dx = extrapolate(velocityX, accelerationX, horizon, settings.damping);
+    float dy = extrapolate(velocityY, accelerationY, horizon, settings.damping);
+
+    // Limit how far ahead the window can get, e.g. on a sudden flick
+    float distance = sqrtf(dx * dx + dy * dy);
+    if (distance > settings.maxDistance)
+    {
+        dx *= settings.maxDistance / distance;
+        dy *= settings.maxDistance / distance;
+    }
+
+    *x = newest.x + (int)lroundf(dx);
+    *y = newest.y + (int)lroundf(dy);
+}
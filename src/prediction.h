@@ -0,0 +1,54 @@
+#ifndef PREDICTION_H
+#define PREDICTION_H
+
+#include <stdint.h>
+
+// PREDICTION
+
+/// Times are in milliseconds, distances in pixels
+struct PredictionSettings
+{
+    uint32_t horizon = 16;  // How far ahead of the newest sample to predict (about one frame of compositor latency)
+    uint32_t window = 64;   // Only samples this recent are used to estimate the motion
+    uint32_t stopTime = 32; // A gap this long between samples means the cursor came to rest in between
+    float damping = 0.5f;   // How much of an increasing acceleration is trusted (0-1)
+    int maxDistance = 96;   // Never predict further ahead than this
+};
+
+// PREDICTOR
+
+/// @brief Extrapolates cursor motion, so that a dragged window can be placed where the cursor
+/// will be when the frame is presented rather than where it was when the event was generated.
+/// Velocity and acceleration are estimated from a small fixed ring of recent samples; the
+/// velocity alone is also what a thrown window glides off with.
+/// When the cursor decelerates, the prediction never goes past the point where it would come
+/// to rest, so stopping does not overshoot. Never allocates; times are the millisecond
+/// timestamps of the events (e.g. `MSLLHOOKSTRUCT::time`) and may wrap around.
+class MotionPredictor
+{
+public:
+    PredictionSettings settings;
+
+    void addSample(int x, int y, uint32_t time);
+    void predict(int *x, int *y) const;
+    void velocity(float *x, float *y) const;
+    void reset();
+
+private:
+    static const int RING_SIZE = 16;
+
+    struct Sample
+    {
+        int x;
+        int y;
+        uint32_t time;
+    };
+
+    bool estimate(float *velocityX, float *velocityY, float *accelerationX, float *accelerationY) const;
+
+    Sample m_samples[RING_SIZE] = {};
+    int m_newest = 0; // Index of the newest sample
+    int m_count = 0;
+};
+
+#endif // PREDICTION_H
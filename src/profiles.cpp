@@ -0,0 +1,307 @@
+#include <windows.h>
+#include <stdint.h>
+#include <wchar.h>
+#include <algorithm>
+
+#include "profiles.h"
+#include "helpers.h"
+
+// CONSTANTS
+// ---------
+
+/// The maximum number of profiles read from the config file
+const int MAX_PROFILES = 64;
+
+/// The profile cache is set-associative: a window maps to one set, whose ways are all probed at once
+const int CACHE_SETS = 16;
+const int CACHE_WAYS = 4;
+
+/// The behavior of windows that match no profile
+static const AppProfile DEFAULT_PROFILE = {false, DEFAULT_MIN_WINDOW_SIZE, DEFAULT_ALPHA_STEP, true};
+
+// STATE
+// -----
+
+struct ProfileRule
+{
+    uint32_t imageHash; // 0 matches any image
+    uint32_t classHash; // 0 matches any class
+    AppProfile profile;
+};
+
+static ProfileRule s_rules[MAX_PROFILES];
+static int s_ruleCount = 0;
+
+/// Resolving the profile of a window means reading its class, finding its process, opening it and
+/// querying its path, which is far too slow to do on every action. The resolved profile is therefore
+/// cached per window, so that a lookup is a single probe without any system call.
+/// A window cannot outlive its process, and window handles carry a reuse counter, so an entry stays
+/// valid as long as its process runs. Entries whose process is open learn that it exited from a
+/// thread-pool wait. Entries whose process cannot be opened (e.g. a protected one) re-check the
+/// thread and process of their window instead, so a handle that comes back for another process is
+/// never given a stale profile.
+struct CacheEntry
+{
+    HWND hWnd; // NULL if the entry is free
+    const AppProfile *profile;
+    DWORD lastUsed;  // For evicting the least recently used entry of a set
+    HANDLE hProcess; // NULL if the process could not be opened
+    HANDLE hWait;    // Waits for the process to exit
+    DWORD pid;       // The thread and process of the window, checked on every hit if the process is not open
+    DWORD threadId;
+    /// The generation of the entry, times two, plus one once its process has exited. The wait
+    /// callback only flags the generation it was registered for, so evicting an entry never has
+    /// to wait for a callback that is already running (see `releaseEntry`).
+    volatile LONG state;
+};
+
+static CacheEntry s_cache[CACHE_SETS][CACHE_WAYS];
+static DWORD s_cacheClock = 0;
+
+// MATCHING
+// --------
+
+/// @brief Finds the most specific profile for a window
+static const AppProfile *matchProfile(uint32_t imageHash, uint32_t classHash)
+{
+    const AppProfile *best = &DEFAULT_PROFILE;
+    int bestScore = 0;
+
+    for (int i = 0; i < s_ruleCount; i++)
+    {
+        const ProfileRule &rule = s_rules[i];
+        if ((rule.imageHash && rule.imageHash != imageHash) || (rule.classHash && rule.classHash != classHash))
+        {
+            continue;
+        }
+
+        // An image is more specific than a class, and both together are the most specific
+        int score = (rule.imageHash ? 2 : 0) + (rule.classHash ? 1 : 0);
+        if (score > bestScore)
+        {
+            best = &rule.profile;
+            bestScore = score;
+        }
+    }
+
+    return best;
+}
+
+// CACHE
+// -----
+
+/// The callback context: the index of the entry in the low bits, the generation above them
+const int CACHE_INDEX_BITS = 8;
+static_assert(CACHE_SETS * CACHE_WAYS <= 1 << CACHE_INDEX_BITS, "cache index must fit the wait context");
+/// Generations wrap around within what fits above the index, even in a 32-bit context
+const LONG MAX_GENERATION = 0xFFFFFF;
+
+static CacheEntry &entryAt(ULONG_PTR index) { return s_cache[index / CACHE_WAYS][index % CACHE_WAYS]; }
+
+/// @brief Runs on a thread-pool thread once a cached process exits. The entry is static, so it is
+/// always safe to touch, but it may have been reused since; then its generation moved on and the
+/// exchange does nothing.
+static void CALLBACK ProcessExitCallback(PVOID context, BOOLEAN timedOut)
+{
+    ULONG_PTR value = (ULONG_PTR)context;
+    LONG generation = (LONG)(value >> CACHE_INDEX_BITS);
+    CacheEntry &entry = entryAt(value & ((1 << CACHE_INDEX_BITS) - 1));
+    InterlockedCompareExchange(&entry.state, generation * 2 + 1, generation * 2);
+}
+
+static bool hasExited(const CacheEntry &entry) { return entry.state & 1; }
+
+/// @brief Frees an entry without waiting: the wait is unregistered without a completion event, and a
+/// callback that is already queued or running finds the entry in a newer generation
+static void releaseEntry(CacheEntry &entry)
+{
+    LONG generation = ((entry.state >> 1) + 1) & MAX_GENERATION;
+    InterlockedExchange(&entry.state, generation * 2);
+
+    if (entry.hWait)
+    {
+        UnregisterWaitEx(entry.hWait, NULL); // Fails with ERROR_IO_PENDING if the callback is queued, which is fine
+    }
+    if (entry.hProcess)
+    {
+        CloseHandle(entry.hProcess);
+    }
+
+    entry.hWnd = NULL;
+    entry.profile = NULL;
+    entry.lastUsed = 0;
+    entry.hProcess = NULL;
+    entry.hWait = NULL;
+    entry.pid = 0;
+    entry.threadId = 0;
+}
+
+/// @brief Resolves the class and process image of a window and matches the profile
+static void fillEntry(CacheEntry &entry, HWND hWnd, const wchar_t *className)
+{
+    wchar_t classBuffer[256];
+    if (!className)
+    {
+        classBuffer[0] = L'\0';
+        GetClassNameW(hWnd, classBuffer, sizeof(classBuffer) / sizeof(wchar_t));
+        className = classBuffer;
+    }
+    uint32_t classHash = hashString(className, true);
+
+    entry.hWnd = hWnd;
+    entry.threadId = GetWindowThreadProcessId(hWnd, &entry.pid);
+
+    uint32_t imageHash = 0;
+    entry.hProcess = entry.pid ? OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | SYNCHRONIZE, FALSE, entry.pid) : NULL;
+    if (entry.hProcess)
+    {
+        wchar_t path[MAX_PATH];
+        DWORD size = MAX_PATH;
+        if (QueryFullProcessImageNameW(entry.hProcess, 0, path, &size))
+        {
+            const wchar_t *name = wcsrchr(path, L'\\');
+            imageHash = hashString(name ? name + 1 : path, true);
+        }
+
+        ULONG_PTR context = ((ULONG_PTR)(entry.state >> 1) << CACHE_INDEX_BITS) | (ULONG_PTR)(&entry - &s_cache[0][0]);
+        if (!RegisterWaitForSingleObject(&entry.hWait, entry.hProcess, ProcessExitCallback, (PVOID)context, INFINITE, WT_EXECUTEONLYONCE))
+        {
+            entry.hWait = NULL;
+        }
+    }
+
+    // A process that cannot be opened can still match a profile by its class
+    entry.profile = matchProfile(imageHash, classHash);
+}
+
+/// @brief Whether a cached entry still describes its window
+static bool isCurrent(const CacheEntry &entry)
+{
+    if (hasExited(entry))
+    {
+        return false;
+    }
+    if (entry.hWait)
+    {
+        return true;
+    }
+
+    // Without a wait on the process, check that the handle still belongs to the same thread
+    DWORD pid = 0;
+    return GetWindowThreadProcessId(entry.hWnd, &pid) == entry.threadId && pid == entry.pid;
+}
+
+/// @brief Clears the cache and closes all process handles it holds
+void clearAppProfileCache()
+{
+    for (auto &set : s_cache)
+    {
+        for (CacheEntry &entry : set)
+        {
+            if (entry.hWnd)
+            {
+                releaseEntry(entry);
+            }
+        }
+    }
+}
+
+// LOOKUP
+// ------
+
+/// @brief Gets the profile of the application a window belongs to. Costs a single cache probe,
+/// unless this is the first time the window is seen.
+/// @param className The class name of the window, if the caller already has it
+const AppProfile *getAppProfile(HWND hWnd, const wchar_t *className)
+{
+    if (!hWnd || s_ruleCount == 0)
+    {
+        return &DEFAULT_PROFILE;
+    }
+
+    // Window handles are multiples of 4, so the low bits carry no information
+    ULONG_PTR key = (ULONG_PTR)hWnd >> 2;
+    CacheEntry *set = s_cache[(key ^ (key >> 4)) & (CACHE_SETS - 1)];
+    CacheEntry *victim = &set[0];
+    for (int way = 0; way < CACHE_WAYS; way++)
+    {
+        CacheEntry &entry = set[way];
+        if (entry.hWnd == hWnd)
+        {
+            if (isCurrent(entry))
+            {
+                entry.lastUsed = ++s_cacheClock;
+                return entry.profile;
+            }
+
+            // The window is gone, and its handle now belongs to another one
+            victim = &entry;
+            break;
+        }
+
+        // Prefer a free entry, otherwise evict the least recently used one
+        if (victim->hWnd != NULL && (entry.hWnd == NULL || entry.lastUsed < victim->lastUsed))
+        {
+            victim = &entry;
+        }
+    }
+
+    if (victim->hWnd)
+    {
+        releaseEntry(*victim);
+    }
+    fillEntry(*victim, hWnd, className);
+    victim->lastUsed = ++s_cacheClock;
+    return victim->profile;
+}
+
+// LOADING
+// -------
+
+/// @brief Reads the `[Profile.<name>]` sections of `winctrl.ini` (next to the executable)
+/// @return The number of profiles
+int loadAppProfiles()
+{
+    clearAppProfileCache();
+    s_ruleCount = 0;
+
+    wchar_t path[MAX_PATH];
+    if (!getAppFilePath(L".ini", path, MAX_PATH))
+    {
+        return 0;
+    }
+
+    // The section names come back as `name\0name\0\0`
+    static wchar_t sections[8 * 1024];
+    if (GetPrivateProfileSectionNamesW(sections, sizeof(sections) / sizeof(wchar_t), path) == 0)
+    {
+        return 0;
+    }
+
+    for (const wchar_t *section = sections; *section && s_ruleCount < MAX_PROFILES; section += lstrlenW(section) + 1)
+    {
+        if (_wcsnicmp(section, L"Profile.", 8) != 0)
+        {
+            continue;
+        }
+
+        wchar_t image[MAX_PATH];
+        wchar_t className[256];
+        GetPrivateProfileStringW(section, L"Image", L"", image, MAX_PATH, path);
+        GetPrivateProfileStringW(section, L"Class", L"", className, 256, path);
+        if (!image[0] && !className[0])
+        {
+            continue; // A profile without either would apply to every window
+        }
+
+        ProfileRule &rule = s_rules[s_ruleCount++];
+        rule.imageHash = image[0] ? hashString(image, true) : 0;
+        rule.classHash = className[0] ? hashString(className, true) : 0;
+        rule.profile.exclude = GetPrivateProfileIntW(section, L"Exclude", 0, path) != 0;
+        rule.profile.minWindowSize = std::max(1, (int)GetPrivateProfileIntW(section, L"MinWindowSize", DEFAULT_MIN_WINDOW_SIZE, path));
+        rule.profile.alphaStep = std::max(1, std::min(255, (int)GetPrivateProfileIntW(section, L"AlphaStep", DEFAULT_ALPHA_STEP, path)));
+        rule.profile.liveResize = GetPrivateProfileIntW(section, L"LiveResize", 1, path) != 0;
+    }
+
+    return s_ruleCount;
+}
@@ -0,0 +1,39 @@
+#ifndef PROFILES_H
+#define PROFILES_H
+
+#include <windows.h>
+
+// APPLICATION PROFILES
+//
+// Per-application behavior, read from the `[Profile.<name>]` sections of `winctrl.ini`:
+//
+//   [Profile.Firefox]
+//   Image=firefox.exe          ; The process image file name. Optional if Class is given
+//   Class=MozillaWindowClass   ; The window class name. Optional if Image is given
+//   Exclude=1                  ; Never move, resize or otherwise touch these windows
+//   MinWindowSize=300          ; The smallest width/height a resize may produce
+//   AlphaStep=10               ; How much one wheel step changes the opacity (out of 255)
+//   LiveResize=0               ; Only resize once the button is released
+//
+// A profile that names both the image and the class wins over one that names only the image,
+// which wins over one that names only the class. Windows that match no profile use the defaults.
+
+/// The smallest width/height of a window, unless its profile says otherwise
+const int DEFAULT_MIN_WINDOW_SIZE = 100;
+
+/// How much one wheel step changes the opacity, unless the window's profile says otherwise
+const int DEFAULT_ALPHA_STEP = 5;
+
+struct AppProfile
+{
+    bool exclude;
+    int minWindowSize;
+    int alphaStep;
+    bool liveResize;
+};
+
+int loadAppProfiles();
+const AppProfile *getAppProfile(HWND hWnd, const wchar_t *className = NULL);
+void clearAppProfileCache();
+
+#endif // PROFILES_H
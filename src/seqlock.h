@@ -0,0 +1,80 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// SEQLOCK
+//
+// Lets a single writer publish a value that any number of readers copy without taking a lock,
+// including readers in other processes that share the memory. The writer never waits for the
+// readers: it makes the sequence odd, writes the value, and makes the sequence even again. A
+// reader copies the value and keeps the copy only if the sequence was even and unchanged around it.
+//
+// The value is copied a word at a time with relaxed atomics, so that a torn copy is merely
+// discarded rather than being a data race. It must be trivially copyable, and a whole number of
+// 32-bit words in size. Uses the GCC atomic builtins, which MinGW and Clang provide as well.
+
+/// A 32-bit word that may alias the words of any value
+typedef uint32_t __attribute__((may_alias)) SeqlockWord;
+
+/// @brief Publishes `value` to `shared`. Only one thread may ever write.
+template <typename T>
+inline void seqlockWrite(uint32_t *sequence, T *shared, const T &value)
+{
+    static_assert(sizeof(T) % sizeof(SeqlockWord) == 0, "Seqlock values must be a whole number of words");
+
+    uint32_t start = __atomic_load_n(sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(sequence, start + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE); // The odd sequence is visible before any of the new words
+
+    SeqlockWord *target = (SeqlockWord *)shared;
+    const SeqlockWord *source = (const SeqlockWord *)&value;
+    for (size_t i = 0; i < sizeof(T) / sizeof(SeqlockWord); i++)
+    {
+        __atomic_store_n(&target[i], source[i], __ATOMIC_RELAXED);
+    }
+
+    __atomic_store_n(sequence, start + 2, __ATOMIC_RELEASE); // All new words are visible before the even sequence
+}
+
+/// @brief Copies the value published to `shared` into `value`
+/// @return False if a write was in progress or happened meanwhile, in which case `value` is torn
+template <typename T>
+inline bool seqlockTryRead(const uint32_t *sequence, const T *shared, T *value)
+{
+    static_assert(sizeof(T) % sizeof(SeqlockWord) == 0, "Seqlock values must be a whole number of words");
+
+    uint32_t before = __atomic_load_n(sequence, __ATOMIC_ACQUIRE);
+    if (before & 1)
+    {
+        return false;
+    }
+
+    const SeqlockWord *source = (const SeqlockWord *)shared;
+    SeqlockWord *target = (SeqlockWord *)value;
+    for (size_t i = 0; i < sizeof(T) / sizeof(SeqlockWord); i++)
+    {
+        target[i] = __atomic_load_n(&source[i], __ATOMIC_RELAXED);
+    }
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE); // The words are read before the sequence is checked again
+    return __atomic_load_n(sequence, __ATOMIC_RELAXED) == before;
+}
+
+/// @brief Copies the value published to `shared`, retrying while writes get in the way
+/// @return False if no consistent copy was made within `maxAttempts`
+template <typename T>
+inline bool seqlockRead(const uint32_t *sequence, const T *shared, T *value, int maxAttempts = 1000)
+{
+    for (int attempt = 0; attempt < maxAttempts; attempt++)
+    {
+        if (seqlockTryRead(sequence, shared, value))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif // SEQLOCK_H
@@ -0,0 +1,482 @@
+#include <windows.h>
+#include <objbase.h>
+#include <shobjidl.h>
+#include <string.h>
+
+#include "shelldesktops.h"
+
+// The virtual desktop backend of the Windows shell.
+//
+// Windows has no public API to switch desktops, or to move the windows of other processes between
+// them. Explorer does both through undocumented interfaces of its own, which it hands out through
+// the service provider of its "immersive shell". Their IIDs change whenever a Windows release
+// changes them, so only the releases listed in `SHELL_VERSIONS` are used. On any other, switches go
+// through Win+Ctrl+Left/Right instead: all steps are sent in a single batch, and keys the user is
+// already holding are not pressed (or released) again. The desktops are then read from the
+// registry, where Explorer keeps the ids of all desktops and of the current one; they are only read
+// again once the registry reports a change.
+//
+// Every call may wait on Explorer, so the backend is only used from the thread pool, never from the
+// hooks. The work item that uses it initializes COM, and disconnects the backend (see
+// `disconnectShellDesktops`) before it uninitializes it.
+
+// CONSTANTS
+// ---------
+
+/// The most desktops we keep track of
+const int MAX_DESKTOPS = 64;
+
+static const wchar_t EXPLORER_KEY[] = L"Software\\Microsoft\\Windows\\CurrentVersion\\Explorer";
+static const wchar_t VIRTUAL_DESKTOPS_KEY[] = L"Software\\Microsoft\\Windows\\CurrentVersion\\Explorer\\VirtualDesktops";
+
+// {C2F03A33-21F5-47FA-B4BB-156362A2F239}
+static const CLSID CLSID_IMMERSIVE_SHELL = {0xc2f03a33, 0x21f5, 0x47fa, {0xb4, 0xbb, 0x15, 0x63, 0x62, 0xa2, 0xf2, 0x39}};
+// {6D5140C1-7436-11CE-8034-00AA006009FA}
+static const IID IID_SERVICE_PROVIDER = {0x6d5140c1, 0x7436, 0x11ce, {0x80, 0x34, 0x00, 0xaa, 0x00, 0x60, 0x09, 0xfa}};
+// {C5E0CDCA-7B6E-41B2-9FC4-D93975CC467B}
+static const GUID SID_VIRTUAL_DESKTOP_MANAGER = {0xc5e0cdca, 0x7b6e, 0x41b2, {0x9f, 0xc4, 0xd9, 0x39, 0x75, 0xcc, 0x46, 0x7b}};
+// {1841C6D7-4F9D-42C0-AF41-8747538F10E5}
+static const IID IID_APPLICATION_VIEW_COLLECTION = {0x1841c6d7, 0x4f9d, 0x42c0, {0xaf, 0x41, 0x87, 0x47, 0x53, 0x8f, 0x10, 0xe5}};
+
+/// @brief The IIDs of the desktop manager of one Windows release, and of the desktops it hands out
+struct ShellVersion
+{
+    IID manager;
+    IID desktop;
+};
+
+/// The releases whose interfaces have the methods below in this order, newest first
+static const ShellVersion SHELL_VERSIONS[] = {
+    // Windows 11 24H2
+    {{0x53f5ca0b, 0x158f, 0x4124, {0x90, 0x0c, 0x05, 0x71, 0x58, 0x06, 0x0b, 0x27}},
+     {0x3f07f4be, 0xb107, 0x441a, {0xaf, 0x0f, 0x39, 0xd8, 0x25, 0x29, 0x07, 0x2c}}},
+    // Windows 11 22H2 and 23H2
+    {{0xa3175f2d, 0x239c, 0x4bd2, {0x8a, 0xa0, 0xee, 0xba, 0x8b, 0x0b, 0x13, 0x8e}},
+     {0x3f07f4be, 0xb107, 0x441a, {0xaf, 0x0f, 0x39, 0xd8, 0x25, 0x29, 0x07, 0x2c}}},
+    // Windows 10
+    {{0xf31574d6, 0xb682, 0x4cdc, {0xbd, 0x56, 0x18, 0x27, 0x86, 0x0a, 0xbe, 0xc6}},
+     {0xff72ffdd, 0xbe7e, 0x43fc, {0x9c, 0x03, 0xad, 0x81, 0x68, 0x1e, 0x88, 0xe4}}},
+};
+
+// Flag for when a key is pressed
+const int KEY_PRESSED_FLAG = 0x8000;
+
+// SHELL INTERFACES
+// ----------------
+
+// Explorer's interfaces, up to the last method used. Only the order of the methods matters.
+
+struct IApplicationView : IUnknown
+{
+};
+
+struct IVirtualDesktop : IUnknown
+{
+    virtual HRESULT STDMETHODCALLTYPE IsViewVisible(IApplicationView *view, BOOL *isVisible) = 0;
+    virtual HRESULT STDMETHODCALLTYPE GetID(GUID *id) = 0;
+};
+
+struct IVirtualDesktopManagerInternal : IUnknown
+{
+    virtual HRESULT STDMETHODCALLTYPE GetCount(int *count) = 0;
+    virtual HRESULT STDMETHODCALLTYPE MoveViewToDesktop(IApplicationView *view, IVirtualDesktop *desktop) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CanViewMoveDesktops(IApplicationView *view, BOOL *canMove) = 0;
+    virtual HRESULT STDMETHODCALLTYPE GetCurrentDesktop(IVirtualDesktop **desktop) = 0;
+    virtual HRESULT STDMETHODCALLTYPE GetDesktops(IObjectArray **desktops) = 0;
+    virtual HRESULT STDMETHODCALLTYPE GetAdjacentDesktop(IVirtualDesktop *from, int direction, IVirtualDesktop **desktop) = 0;
+    virtual HRESULT STDMETHODCALLTYPE SwitchDesktop(IVirtualDesktop *desktop) = 0;
+};
+
+struct IApplicationViewCollection : IUnknown
+{
+    virtual HRESULT STDMETHODCALLTYPE GetViews(IObjectArray **views) = 0;
+    virtual HRESULT STDMETHODCALLTYPE GetViewsByZOrder(IObjectArray **views) = 0;
+    virtual HRESULT STDMETHODCALLTYPE GetViewsByAppUserModelId(LPCWSTR id, IObjectArray **views) = 0;
+    virtual HRESULT STDMETHODCALLTYPE GetViewForHwnd(HWND hWnd, IApplicationView **view) = 0;
+};
+
+// BACKEND
+// -------
+
+class ShellDesktopBackend : public DesktopBackend
+{
+public:
+    bool query(int *count, int *current) override;
+    bool activate(int index) override;
+    bool step(int steps) override;
+    bool moveWindow(void *window, int index) override;
+    double now() override;
+
+    void disconnect();
+    void close();
+
+private:
+    bool connect();
+    IVirtualDesktop *getDesktop(int index);
+
+    bool queryRegistry(int *count, int *current);
+    bool hasRegistryChanged();
+    bool readRegistry(int *count, int *current);
+    int readDesktopIds(GUID *ids);
+    bool readCurrentDesktopId(GUID *id);
+
+    IVirtualDesktopManagerInternal *m_manager = nullptr; // Connected on first use
+    IApplicationViewCollection *m_views = nullptr;
+    const ShellVersion *m_version = nullptr;
+    bool m_isUnsupported = false; // Explorer offers none of the versions we know
+
+    HKEY m_explorerKey = NULL;
+    HANDLE m_registryChanged = NULL; // Signaled by the registry when anything under the Explorer key changes
+    bool m_isCached = false;
+    int m_cachedCount = 0;
+    int m_cachedCurrent = 0;
+};
+
+static ShellDesktopBackend s_backend;
+
+DesktopBackend *getShellDesktopBackend() { return &s_backend; }
+
+void disconnectShellDesktops() { s_backend.disconnect(); }
+
+void closeShellDesktops() { s_backend.close(); }
+
+// SHELL
+// -----
+
+/// @brief Gets the desktop manager (and the views, to move windows with) from Explorer
+/// @return False if Explorer is not running, or offers none of the versions we know
+bool ShellDesktopBackend::connect()
+{
+    if (m_manager || m_isUnsupported)
+    {
+        return m_manager != nullptr;
+    }
+
+    IServiceProvider *shell;
+    if (FAILED(CoCreateInstance(CLSID_IMMERSIVE_SHELL, NULL, CLSCTX_LOCAL_SERVER, IID_SERVICE_PROVIDER, (void **)&shell)))
+    {
+        // Explorer may just be restarting, so this is tried again next time
+        return false;
+    }
+
+    for (const ShellVersion &version : SHELL_VERSIONS)
+    {
+        if (SUCCEEDED(shell->QueryService(SID_VIRTUAL_DESKTOP_MANAGER, version.manager, (void **)&m_manager)))
+        {
+            m_version = &version;
+            break;
+        }
+        m_manager = nullptr;
+    }
+
+    if (m_manager && FAILED(shell->QueryService(IID_APPLICATION_VIEW_COLLECTION, IID_APPLICATION_VIEW_COLLECTION, (void **)&m_views)))
+    {
+        m_views = nullptr;
+    }
+    shell->Release();
+
+    m_isUnsupported = !m_manager;
+    return m_manager != nullptr;
+}
+
+/// @brief Releases Explorer's interfaces. The next call connects again.
+void ShellDesktopBackend::disconnect()
+{
+    if (m_views)
+    {
+        m_views->Release();
+        m_views = nullptr;
+    }
+    if (m_manager)
+    {
+        m_manager->Release();
+        m_manager = nullptr;
+    }
+}
+
+/// @brief Disconnects, and stops watching the registry. The next call starts over, and looks for
+/// Explorer's interfaces again.
+void ShellDesktopBackend::close()
+{
+    disconnect();
+    if (m_explorerKey)
+    {
+        RegCloseKey(m_explorerKey);
+        m_explorerKey = NULL;
+    }
+    if (m_registryChanged)
+    {
+        CloseHandle(m_registryChanged);
+        m_registryChanged = NULL;
+    }
+    m_isUnsupported = false;
+    m_isCached = false;
+}
+
+/// @return The desktop with the given index, which the caller must release, or NULL
+IVirtualDesktop *ShellDesktopBackend::getDesktop(int index)
+{
+    IObjectArray *desktops;
+    if (FAILED(m_manager->GetDesktops(&desktops)))
+    {
+        return NULL;
+    }
+
+    IVirtualDesktop *desktop;
+    if (FAILED(desktops->GetAt((UINT)index, m_version->desktop, (void **)&desktop)))
+    {
+        desktop = NULL;
+    }
+    desktops->Release();
+    return desktop;
+}
+
+// BOOKKEEPING
+// -----------
+
+bool ShellDesktopBackend::query(int *count, int *current)
+{
+    if (!connect())
+    {
+        return queryRegistry(count, current);
+    }
+
+    IVirtualDesktop *currentDesktop;
+    GUID currentId;
+    if (FAILED(m_manager->GetCount(count)) || FAILED(m_manager->GetCurrentDesktop(&currentDesktop)))
+    {
+        return false;
+    }
+    HRESULT result = currentDesktop->GetID(&currentId);
+    currentDesktop->Release();
+    if (FAILED(result))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < *count; i++)
+    {
+        IVirtualDesktop *desktop = getDesktop(i);
+        GUID id;
+        bool isCurrent = desktop && SUCCEEDED(desktop->GetID(&id)) && IsEqualGUID(id, currentId);
+        if (desktop)
+        {
+            desktop->Release();
+        }
+        if (isCurrent)
+        {
+            *current = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Reads the desktops from the registry, unless it did not change since they were last read
+bool ShellDesktopBackend::queryRegistry(int *count, int *current)
+{
+    // Always asked, so that the first call starts watching the registry
+    bool hasChanged = hasRegistryChanged();
+    if (!m_isCached || hasChanged)
+    {
+        m_isCached = readRegistry(&m_cachedCount, &m_cachedCurrent);
+        if (!m_isCached)
+        {
+            return false;
+        }
+    }
+
+    *count = m_cachedCount;
+    *current = m_cachedCurrent;
+    return true;
+}
+
+/// @brief Whether anything under the Explorer key changed since the last call. Explorer keeps much
+/// more than the desktops there, but a change elsewhere only costs reading them again. Without a
+/// watch on the key, everything counts as changed.
+bool ShellDesktopBackend::hasRegistryChanged()
+{
+    if (!m_explorerKey)
+    {
+        // Signaled from the start, so that the first call reads the desktops and starts the watch
+        if (!m_registryChanged)
+        {
+            m_registryChanged = CreateEventW(NULL, FALSE, TRUE, NULL);
+        }
+        if (!m_registryChanged || RegOpenKeyExW(HKEY_CURRENT_USER, EXPLORER_KEY, 0, KEY_NOTIFY, &m_explorerKey) != ERROR_SUCCESS)
+        {
+            m_explorerKey = NULL;
+            return true;
+        }
+    }
+
+    if (WaitForSingleObject(m_registryChanged, 0) != WAIT_OBJECT_0)
+    {
+        return false;
+    }
+
+    // Watched again before the desktops are read, so that a change made while reading them is not
+    // missed. The watch outlives the pool thread that starts it.
+    if (RegNotifyChangeKeyValue(m_explorerKey, TRUE, REG_NOTIFY_CHANGE_LAST_SET | REG_NOTIFY_THREAD_AGNOSTIC, m_registryChanged, TRUE) != ERROR_SUCCESS)
+    {
+        SetEvent(m_registryChanged);
+    }
+    return true;
+}
+
+bool ShellDesktopBackend::readRegistry(int *count, int *current)
+{
+    GUID ids[MAX_DESKTOPS];
+    GUID currentId;
+    *count = readDesktopIds(ids);
+
+    // The list only appears once a second desktop has been created
+    if (*count <= 1)
+    {
+        *count = 1;
+        *current = 0;
+        return true;
+    }
+
+    if (!readCurrentDesktopId(&currentId))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < *count; i++)
+    {
+        if (memcmp(&ids[i], &currentId, sizeof(GUID)) == 0)
+        {
+            *current = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Reads the ids of all desktops, in order
+/// @return The number of desktops, or 0 if the registry has no list
+int ShellDesktopBackend::readDesktopIds(GUID *ids)
+{
+    DWORD size = MAX_DESKTOPS * sizeof(GUID);
+    if (RegGetValueW(HKEY_CURRENT_USER, VIRTUAL_DESKTOPS_KEY, L"VirtualDesktopIDs", RRF_RT_REG_BINARY, NULL, ids, &size) != ERROR_SUCCESS)
+    {
+        return 0;
+    }
+    return (int)(size / sizeof(GUID));
+}
+
+bool ShellDesktopBackend::readCurrentDesktopId(GUID *id)
+{
+    DWORD size = sizeof(GUID);
+
+    // Windows 11 keeps the current desktop next to the list...
+    if (RegGetValueW(HKEY_CURRENT_USER, VIRTUAL_DESKTOPS_KEY, L"CurrentVirtualDesktop", RRF_RT_REG_BINARY, NULL, id, &size) == ERROR_SUCCESS)
+    {
+        return true;
+    }
+
+    // ...while Windows 10 keeps it per logon session
+    DWORD sessionId = 0;
+    ProcessIdToSessionId(GetCurrentProcessId(), &sessionId);
+    wchar_t key[128];
+    wsprintfW(key, L"Software\\Microsoft\\Windows\\CurrentVersion\\Explorer\\SessionInfo\\%lu\\VirtualDesktops", sessionId);
+    size = sizeof(GUID);
+    return RegGetValueW(HKEY_CURRENT_USER, key, L"CurrentVirtualDesktop", RRF_RT_REG_BINARY, NULL, id, &size) == ERROR_SUCCESS;
+}
+
+// SWITCHING
+// ---------
+
+bool ShellDesktopBackend::activate(int index)
+{
+    IVirtualDesktop *desktop = connect() ? getDesktop(index) : NULL;
+    if (!desktop)
+    {
+        return false;
+    }
+
+    HRESULT result = m_manager->SwitchDesktop(desktop);
+    desktop->Release();
+    return SUCCEEDED(result);
+}
+
+static void addKey(INPUT *inputs, int *count, WORD vkCode, bool isKeyUp)
+{
+    INPUT &input = inputs[(*count)++];
+    input.type = INPUT_KEYBOARD;
+    input.ki.wVk = vkCode;
+    input.ki.dwFlags = isKeyUp ? KEYEVENTF_KEYUP : 0;
+}
+
+/// @brief Sends Win+Ctrl+Left/Right `steps` times as one batch of input
+bool ShellDesktopBackend::step(int steps)
+{
+    if (steps == 0)
+    {
+        return false;
+    }
+
+    WORD arrow = steps < 0 ? VK_LEFT : VK_RIGHT;
+    int taps = steps < 0 ? -steps : steps;
+    if (taps > MAX_DESKTOPS)
+    {
+        taps = MAX_DESKTOPS;
+    }
+
+    // Pressing (and releasing) a Win key that the user is still holding would end their chord,
+    // and could open the Start Menu, so only the keys that are not down yet are sent
+    bool isWinHeld = (GetAsyncKeyState(VK_LWIN) & KEY_PRESSED_FLAG) || (GetAsyncKeyState(VK_RWIN) & KEY_PRESSED_FLAG);
+    bool isCtrlHeld = GetAsyncKeyState(VK_CONTROL) & KEY_PRESSED_FLAG;
+
+    INPUT inputs[4 + 2 * MAX_DESKTOPS] = {};
+    int count = 0;
+    if (!isWinHeld)
+        addKey(inputs, &count, VK_LWIN, false);
+    if (!isCtrlHeld)
+        addKey(inputs, &count, VK_CONTROL, false);
+    for (int i = 0; i < taps; i++)
+    {
+        addKey(inputs, &count, arrow, false);
+        addKey(inputs, &count, arrow, true);
+    }
+    if (!isCtrlHeld)
+        addKey(inputs, &count, VK_CONTROL, true);
+    if (!isWinHeld)
+        addKey(inputs, &count, VK_LWIN, true);
+
+    return SendInput(count, inputs, sizeof(INPUT)) == (UINT)count;
+}
+
+/// @brief Moves a window, of any process, to another desktop. Needs Explorer's interfaces: there is
+/// no keyboard shortcut for it.
+bool ShellDesktopBackend::moveWindow(void *window, int index)
+{
+    if (!connect() || !m_views)
+    {
+        return false;
+    }
+
+    IApplicationView *view;
+    if (FAILED(m_views->GetViewForHwnd((HWND)window, &view)))
+    {
+        return false;
+    }
+
+    IVirtualDesktop *desktop = getDesktop(index);
+    HRESULT result = desktop ? m_manager->MoveViewToDesktop(view, desktop) : E_FAIL;
+    if (desktop)
+    {
+        desktop->Release();
+    }
+    view->Release();
+    return SUCCEEDED(result);
+}
+
+double ShellDesktopBackend::now()
+{
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return counter.QuadPart * 1000.0 / frequency.QuadPart;
+}
@@ -0,0 +1,12 @@
+#ifndef SHELLDESKTOPS_H
+#define SHELLDESKTOPS_H
+
+#include "desktops.h"
+
+// SHELL DESKTOP BACKEND
+
+DesktopBackend *getShellDesktopBackend();
+void disconnectShellDesktops();
+void closeShellDesktops();
+
+#endif // SHELLDESKTOPS_H
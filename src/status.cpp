@@ -0,0 +1,198 @@
+#include <windows.h>
+
+#include "status.h"
+#include "statusblock.h"
+#include "seqlock.h"
+#include "features.h"
+
+// Publishes the health of winctrl to a named shared memory segment (see statusblock.h). The hooks
+// only bump counters; a thread timer turns them into rates and publishes them every 250 ms. The
+// block is written with seqlock semantics, so readers never block winctrl, and winctrl never
+// waits for a reader.
+
+// CONSTANTS
+// ---------
+
+/// How often the status is published
+const UINT PUBLISH_INTERVAL_MS = 250;
+
+/// The rates cover this many publish intervals, i.e. one second
+const int RATE_INTERVALS = 4;
+
+/// How long the latest input may be newer than the latest hook event before the hooks count as removed
+const DWORD RESPONSIVE_TOLERANCE_MS = 1000;
+
+// STATE
+// -----
+
+static HANDLE s_mapping = NULL;
+static StatusBlock *s_block = NULL;
+static UINT_PTR s_publishTimer = 0;
+static bool s_areHooksInstalled = false;
+
+static LARGE_INTEGER s_frequency;
+
+static uint64_t s_totalEvents = 0;
+static uint64_t s_totalActions = 0;
+static DWORD s_lastEventTime = 0;
+static uint32_t s_lastLatency = 0;
+static uint32_t s_intervalMaxLatency = 0; // The slowest event since the last publish
+
+/// The totals and slowest event of the last publish intervals, for the rates over the last second
+static uint64_t s_eventHistory[RATE_INTERVALS];
+static uint64_t s_actionHistory[RATE_INTERVALS];
+static uint32_t s_latencyHistory[RATE_INTERVALS];
+static int s_nextInterval = 0;
+
+// COUNTING
+// --------
+
+void countStatusAction()
+{
+    s_totalActions++;
+}
+
+/// @brief Counts a hook event that began at `start`
+/// @param eventTime The timestamp of the event (e.g. `MSLLHOOKSTRUCT::time`)
+void endStatusEvent(DWORD eventTime, const LARGE_INTEGER &start)
+{
+    LARGE_INTEGER end;
+    HOOK_PLATFORM_CALL("endStatusEvent: QueryPerformanceCounter");
+    QueryPerformanceCounter(&end);
+
+    s_totalEvents++;
+    s_lastEventTime = eventTime;
+    s_lastLatency = s_frequency.QuadPart ? (uint32_t)((end.QuadPart - start.QuadPart) * 1000000 / s_frequency.QuadPart) : 0;
+    if (s_lastLatency > s_intervalMaxLatency)
+    {
+        s_intervalMaxLatency = s_lastLatency;
+    }
+}
+
+// PUBLISHING
+// ----------
+
+static uint32_t getFeatureBits()
+{
+    uint32_t features = 0;
+    features |= Feature::isWinCtrlEnabled ? STATUS_FEATURE_ENABLED : 0;
+    features |= Feature::Move ? STATUS_FEATURE_MOVE : 0;
+    features |= Feature::Resize ? STATUS_FEATURE_RESIZE : 0;
+    features |= Feature::Transparency ? STATUS_FEATURE_TRANSPARENCY : 0;
+    features |= Feature::VirtualDesktopScroll ? STATUS_FEATURE_VIRTUAL_DESKTOP_SCROLL : 0;
+    features |= Feature::AutoRestoreLayout ? STATUS_FEATURE_AUTO_RESTORE_LAYOUT : 0;
+    features |= Feature::Hotkeys ? STATUS_FEATURE_HOTKEYS : 0;
+    features |= Feature::PredictiveDrag ? STATUS_FEATURE_PREDICTIVE_DRAG : 0;
+    features |= Feature::Animations ? STATUS_FEATURE_ANIMATIONS : 0;
+    features |= Feature::KineticThrow ? STATUS_FEATURE_KINETIC_THROW : 0;
+    return features;
+}
+
+/// @brief Whether the hooks have seen the latest input. The system removes hooks that take too
+/// long without telling us, which shows as input that never reaches them.
+static bool areHooksResponsive()
+{
+    LASTINPUTINFO lastInput = {sizeof(LASTINPUTINFO)};
+    if (!s_areHooksInstalled || !GetLastInputInfo(&lastInput))
+    {
+        return s_areHooksInstalled;
+    }
+
+    // Both are `GetTickCount` times, so the difference is right across wraparound
+    int inputAhead = (int)(lastInput.dwTime - s_lastEventTime);
+    return inputAhead <= (int)RESPONSIVE_TOLERANCE_MS;
+}
+
+static void CALLBACK PublishTimerProc(HWND hWnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime)
+{
+    // The oldest slot holds the totals from one second ago
+    int slot = s_nextInterval;
+    uint64_t eventsInWindow = s_totalEvents - s_eventHistory[slot];
+    uint64_t actionsInWindow = s_totalActions - s_actionHistory[slot];
+    s_eventHistory[slot] = s_totalEvents;
+    s_actionHistory[slot] = s_totalActions;
+    s_latencyHistory[slot] = s_intervalMaxLatency;
+    s_intervalMaxLatency = 0;
+    s_nextInterval = (slot + 1) % RATE_INTERVALS;
+
+    StatusData data = {};
+    data.publishTime = GetTickCount64();
+    data.totalEvents = s_totalEvents;
+    data.totalActions = s_totalActions;
+    data.processId = GetCurrentProcessId();
+    data.flags = (s_areHooksInstalled ? STATUS_HOOKS_INSTALLED : 0) | (areHooksResponsive() ? STATUS_HOOKS_RESPONSIVE : 0);
+    data.features = getFeatureBits();
+    data.eventsPerSecond = (uint32_t)(eventsInWindow * 1000 / (RATE_INTERVALS * PUBLISH_INTERVAL_MS));
+    data.actionsPerSecond = (uint32_t)(actionsInWindow * 1000 / (RATE_INTERVALS * PUBLISH_INTERVAL_MS));
+    data.lastHookLatency = s_lastLatency;
+    for (int i = 0; i < RATE_INTERVALS; i++)
+    {
+        if (s_latencyHistory[i] > data.maxHookLatency)
+        {
+            data.maxHookLatency = s_latencyHistory[i];
+        }
+    }
+
+    seqlockWrite(&s_block->header.sequence, &s_block->data, data);
+}
+
+// SETUP AND TEARDOWN
+// ------------------
+
+/// @brief Creates the status block and starts publishing to it. If another process already
+/// publishes under the same name (e.g. a second instance), this one stays quiet, since a seqlock
+/// only allows one writer.
+void setupStatus(bool areHooksInstalled)
+{
+    s_areHooksInstalled = areHooksInstalled;
+    s_lastEventTime = GetTickCount(); // Input from before the hooks were installed never reached them
+    QueryPerformanceFrequency(&s_frequency);
+    if (s_block)
+    {
+        return;
+    }
+
+    s_mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(StatusBlock), STATUS_MAPPING_NAME);
+    if (!s_mapping || GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        teardownStatus();
+        return;
+    }
+
+    s_block = (StatusBlock *)MapViewOfFile(s_mapping, FILE_MAP_WRITE, 0, 0, sizeof(StatusBlock));
+    if (!s_block)
+    {
+        teardownStatus();
+        return;
+    }
+
+    // The memory starts out zeroed; the magic goes in last, so a reader never sees a half-made header
+    s_block->header.version = STATUS_VERSION;
+    s_block->header.size = sizeof(StatusBlock);
+    PublishTimerProc(NULL, 0, 0, 0);
+    __atomic_store_n(&s_block->header.magic, STATUS_MAGIC, __ATOMIC_RELEASE);
+
+    s_publishTimer = SetTimer(NULL, 0, PUBLISH_INTERVAL_MS, PublishTimerProc);
+}
+
+/// @brief Stops publishing. The last status shows the hooks as removed, for readers that still have it mapped.
+void teardownStatus()
+{
+    if (s_publishTimer)
+    {
+        KillTimer(NULL, s_publishTimer);
+        s_publishTimer = 0;
+    }
+    if (s_block)
+    {
+        s_areHooksInstalled = false;
+        PublishTimerProc(NULL, 0, 0, 0);
+        UnmapViewOfFile(s_block);
+        s_block = NULL;
+    }
+    if (s_mapping)
+    {
+        CloseHandle(s_mapping);
+        s_mapping = NULL;
+    }
+}
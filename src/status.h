@@ -0,0 +1,31 @@
+#ifndef STATUS_H
+#define STATUS_H
+
+#include <windows.h>
+
+#include "budget.h"
+
+// LIVE STATUS
+
+void setupStatus(bool areHooksInstalled);
+void teardownStatus();
+
+void countStatusAction();
+void endStatusEvent(DWORD eventTime, const LARGE_INTEGER &start);
+
+/// @brief Counts a hook event for the live status, and measures how long it takes to handle.
+/// Both `QueryPerformanceCounter` calls are accounted against the hook budget (see budget.h).
+struct StatusEventScope
+{
+    DWORD eventTime;
+    LARGE_INTEGER start;
+
+    StatusEventScope(DWORD time) : eventTime(time)
+    {
+        HOOK_PLATFORM_CALL("StatusEventScope: QueryPerformanceCounter");
+        QueryPerformanceCounter(&start);
+    }
+    ~StatusEventScope() { endStatusEvent(eventTime, start); }
+};
+
+#endif // STATUS_H
@@ -0,0 +1,73 @@
+#ifndef STATUSBLOCK_H
+#define STATUSBLOCK_H
+
+#include <stdint.h>
+
+// STATUS BLOCK
+//
+// The layout of the live status winctrl publishes in the named shared memory segment
+// `Local\WinCtrlStatus`, for monitoring tools to sample (see tools/status_reader.cpp).
+// The header never changes. Newer versions only append fields to `StatusData` and grow `size`,
+// so a reader of an older version keeps working by reading the prefix it knows.
+// `StatusData` is published with seqlock semantics (see seqlock.h), using `sequence`.
+
+#define STATUS_MAPPING_NAME L"Local\\WinCtrlStatus"
+
+const uint32_t STATUS_MAGIC = 0x54534357; // "WCST"
+const uint32_t STATUS_VERSION = 1;
+
+/// Bits of `StatusData::flags`
+enum StatusFlags
+{
+    STATUS_HOOKS_INSTALLED = 1 << 0,  // The mouse and keyboard hooks were installed
+    STATUS_HOOKS_RESPONSIVE = 1 << 1, // The hooks have seen the latest input, so the system has not removed them
+};
+
+/// Bits of `StatusData::features`, one per toggle of the tray menu
+enum StatusFeatures
+{
+    STATUS_FEATURE_ENABLED = 1 << 0,
+    STATUS_FEATURE_MOVE = 1 << 1,
+    STATUS_FEATURE_RESIZE = 1 << 2,
+    STATUS_FEATURE_TRANSPARENCY = 1 << 3,
+    STATUS_FEATURE_VIRTUAL_DESKTOP_SCROLL = 1 << 4,
+    STATUS_FEATURE_AUTO_RESTORE_LAYOUT = 1 << 5,
+    STATUS_FEATURE_HOTKEYS = 1 << 6,
+    STATUS_FEATURE_PREDICTIVE_DRAG = 1 << 7,
+    STATUS_FEATURE_ANIMATIONS = 1 << 8,
+    STATUS_FEATURE_KINETIC_THROW = 1 << 9,
+};
+
+struct StatusHeader
+{
+    uint32_t magic;    // STATUS_MAGIC once the block has been initialized
+    uint32_t version;  // STATUS_VERSION of the writer
+    uint32_t size;     // The size of the whole block, in bytes
+    uint32_t sequence; // Odd while `StatusData` is being written
+};
+
+/// Times are in milliseconds, latencies in microseconds
+struct StatusData
+{
+    uint64_t publishTime; // `GetTickCount64` at the last update, which happens every 250 ms
+    uint64_t totalEvents; // Mouse and keyboard events seen by the hooks
+    uint64_t totalActions;
+    uint32_t processId;
+    uint32_t flags;    // StatusFlags
+    uint32_t features; // StatusFeatures
+    uint32_t eventsPerSecond;
+    uint32_t actionsPerSecond;
+    uint32_t lastHookLatency; // How long the latest hook event took to handle
+    uint32_t maxHookLatency;  // The slowest hook event of the last second
+    uint32_t reserved;
+};
+
+struct StatusBlock
+{
+    StatusHeader header;
+    StatusData data;
+};
+
+static_assert(sizeof(StatusHeader) == 16 && sizeof(StatusData) == 56, "The status layout is shared with other processes, and must not change");
+
+#endif // STATUSBLOCK_H
@@ -3,14 +3,32 @@
 
 #include <windows.h>
 #include <shellapi.h> // For Shell_NotifyIcon
-#include <iostream>   // For std::cerr, though for a GUI app, error logging might go elsewhere
 
 #include "hooks.h"
+#include "helpers.h"
 #include "winctrl.h"
+#include "layout.h"
 #include "resources.h"
 
 // Custom message for tray icon notifications
 #define WM_TRAYICON (WM_USER + 1)
+// Custom message that finishes startup once the hooks are installed
+#define WM_DEFERRED_SETUP (WM_USER + 2)
+
+// Timer that periodically snapshots the window layout while auto-restore is enabled,
+// so that arrangements the user makes between display changes are kept too
+#define IDT_LAYOUT_SNAPSHOT 1
+// Timer that restores the layout once the displays have settled after a change
+#define IDT_LAYOUT_RESTORE 2
+
+// How often the window layout is snapshotted while auto-restore is enabled
+const UINT LAYOUT_SNAPSHOT_INTERVAL_MS = 60 * 1000;
+// How long to wait after the last display change before restoring the layout.
+// The system keeps rearranging windows for a while after a display change.
+const UINT LAYOUT_RESTORE_DELAY_MS = 2000;
+
+// Whether a display change happened and the layout has not been restored yet
+static bool s_isDisplayChangePending = false;
 
 // Global variable for the hidden window handle
 HWND g_hWnd;
@@ -52,9 +70,15 @@ const wchar_t *helpMessage =
     L"Features:\n"
     L"- Win + Left Mouse Button Click: Maximize/Restore\n"
     L"- Win + Left Mouse Button Drag: Drag Window\n"
+    L"- Win + Left Mouse Button Hold: Toggle Always on Top\n"
+    L"- Win + Middle Mouse Button Double-Click: Minimize\n"
     L"- Win + Middle Mouse Button Drag: Resize Window\n"
     L"- Win + Ctrl + Scroll: Adjust Transparency\n"
-    L"- Win + Scroll: Switch Virtual Desktop\n\n"
+    L"- Win + Scroll: Switch Virtual Desktop\n"
+    L"- Win + Ctrl + Z / Y: Undo/Redo Window Move or Resize\n"
+    L"- Win + Alt + Arrows: Move Window (+ Shift: Resize)\n"
+    L"- Win + Alt + PageUp / PageDown: Adjust Transparency\n\n"
+    L"The window layout can be saved and restored from the tray menu.\n"
     L"Right-click the tray icon for more options and to toggle features.";
 
 // WINDOW PROCEDURE
@@ -65,8 +89,12 @@ LRESULT CALLBACK WindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
     switch (uMsg)
     {
-    case WM_CREATE:
+    case WM_DEFERRED_SETUP:
+        // Adding the icon is a round trip to Explorer, so it waits until the hooks are running
         AddTrayIcon(hWnd);
+
+        // Nothing touched during startup is needed again until the first window action
+        trimWorkingSet();
         break;
 
     case WM_TRAYICON:
@@ -97,6 +125,15 @@ LRESULT CALLBACK WindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
             AppendMenu(hMenu, otherFeaturesFlags | (Feature::Resize ? MF_CHECKED : MF_UNCHECKED), 1004, L"Enable Resizing");
             AppendMenu(hMenu, otherFeaturesFlags | (Feature::Transparency ? MF_CHECKED : MF_UNCHECKED), 1005, L"Enable Transparency");
             AppendMenu(hMenu, otherFeaturesFlags | (Feature::VirtualDesktopScroll ? MF_CHECKED : MF_UNCHECKED), 1006, L"Enable Virtual Desktop Switching");
+            AppendMenu(hMenu, otherFeaturesFlags | (Feature::Hotkeys ? MF_CHECKED : MF_UNCHECKED), 1010, L"Enable Keyboard Shortcuts");
+            AppendMenu(hMenu, otherFeaturesFlags | (Feature::PredictiveDrag ? MF_CHECKED : MF_UNCHECKED), 1011, L"Predict Drag Motion");
+            AppendMenu(hMenu, otherFeaturesFlags | (Feature::Animations ? MF_CHECKED : MF_UNCHECKED), 1012, L"Animate Maximize/Restore");
+            AppendMenu(hMenu, otherFeaturesFlags | (Feature::KineticThrow ? MF_CHECKED : MF_UNCHECKED), 1013, L"Throw Windows");
+
+            AppendMenu(hMenu, MF_SEPARATOR, 0, NULL); // Separator
+            AppendMenu(hMenu, MF_STRING, 1007, L"Save Window Layout");
+            AppendMenu(hMenu, MF_STRING | (hasLayout() ? 0 : MF_GRAYED), 1008, L"Restore Window Layout");
+            AppendMenu(hMenu, MF_STRING | (Feature::AutoRestoreLayout ? MF_CHECKED : MF_UNCHECKED), 1009, L"Restore Layout on Display Change");
 
             AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);    // Separator
             AppendMenu(hMenu, MF_STRING, 1001, L"Exit"); // Menu item with ID 1001
@@ -136,6 +173,69 @@ LRESULT CALLBACK WindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
         case 1006: // "Enable Virtual Desktop Switching" clicked
             Feature::toggleVirtualDesktopScroll();
             break;
+        case 1010: // "Enable Keyboard Shortcuts" clicked
+            Feature::toggleHotkeys();
+            break;
+        case 1011: // "Predict Drag Motion" clicked
+            Feature::togglePredictiveDrag();
+            break;
+        case 1012: // "Animate Maximize/Restore" clicked
+            Feature::toggleAnimations();
+            break;
+        case 1013: // "Throw Windows" clicked
+            Feature::toggleKineticThrow();
+            break;
+        case 1007: // "Save Window Layout" clicked
+            saveLayout(true);
+            break;
+        case 1008: // "Restore Window Layout" clicked
+            restoreLayout();
+            break;
+        case 1009: // "Restore Layout on Display Change" clicked
+            Feature::toggleAutoRestoreLayout();
+            if (Feature::AutoRestoreLayout)
+            {
+                saveLayout(false);
+                SetTimer(hWnd, IDT_LAYOUT_SNAPSHOT, LAYOUT_SNAPSHOT_INTERVAL_MS, NULL);
+            }
+            else
+            {
+                KillTimer(hWnd, IDT_LAYOUT_SNAPSHOT);
+                KillTimer(hWnd, IDT_LAYOUT_RESTORE);
+                s_isDisplayChangePending = false;
+            }
+            break;
+        }
+        break;
+
+    case WM_DISPLAYCHANGE:
+        if (Feature::AutoRestoreLayout && hasLayout())
+        {
+            // Hold off snapshots until the layout is restored, and (re)start the settle delay
+            s_isDisplayChangePending = true;
+            SetTimer(hWnd, IDT_LAYOUT_RESTORE, LAYOUT_RESTORE_DELAY_MS, NULL);
+        }
+        break;
+
+    case WM_TIMER:
+        switch (wParam)
+        {
+        case IDT_LAYOUT_SNAPSHOT:
+            // Never snapshot the scrambled layout between a display change and its restore
+            if (!s_isDisplayChangePending)
+            {
+                saveLayout(false);
+            }
+            break;
+        case IDT_LAYOUT_RESTORE:
+            KillTimer(hWnd, IDT_LAYOUT_RESTORE);
+            restoreLayout();
+            s_isDisplayChangePending = false;
+
+            // Snapshot the new display configuration right away, so that its layout is
+            // restored as-is when it comes back, rather than mapped from another one
+            saveLayout(false);
+            break;
         }
         break;
 
@@ -165,24 +265,29 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     wc.lpszClassName = L"WinCtrlTrayClass";
     RegisterClassEx(&wc);
 
-    // Create a hidden window to receive messages
-    g_hWnd = CreateWindowEx(0, L"WinCtrlTrayClass", L"WinCtrl Hidden Window",
-                            0, 0, 0, 0, 0, HWND_MESSAGE, NULL, hInstance, NULL);
+    // Create a hidden window to receive messages.
+    // Note: This is a hidden top-level window rather than a message-only window (HWND_MESSAGE),
+    //  because message-only windows do not receive broadcasts such as WM_DISPLAYCHANGE.
+    g_hWnd = CreateWindowEx(WS_EX_TOOLWINDOW, L"WinCtrlTrayClass", L"WinCtrl Hidden Window",
+                            0, 0, 0, 0, 0, NULL, NULL, hInstance, NULL);
     if (!g_hWnd)
     {
-        std::cerr << "Failed to create hidden window!" << std::endl;
+        MessageBox(NULL, L"Failed to create hidden window!", L"WinCtrl", MB_OK | MB_ICONERROR);
         return 1;
     }
 
     // Setup hooks
     if (!setupHooks())
     {
-        std::cerr << "Failed to setup hooks!" << std::endl;
-        DeleteTrayIcon(g_hWnd); // Clean up tray icon if hooks fail
+        MessageBox(NULL, L"Failed to setup hooks!", L"WinCtrl", MB_OK | MB_ICONERROR);
         DestroyWindow(g_hWnd);
         return 1;
     }
 
+    // The tray icon is added from the message loop, and the menu and help text are only built
+    // when they are first shown, so the hooks are installed as early as possible
+    PostMessage(g_hWnd, WM_DEFERRED_SETUP, 0, 0);
+
     // Message loop
     MSG msg;
     while (GetMessage(&msg, NULL, 0, 0))
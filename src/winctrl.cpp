@@ -1,11 +1,18 @@
 #include <chrono>
 #include <cmath>
+#include <algorithm>
+#include <objbase.h>
 
 #include "winctrl.h"
 #include "helpers.h"
-
-// A window cannot be resized below this many pixels
-const int MIN_WINDOW_SIZE = 100;
+#include "history.h"
+#include "budget.h"
+#include "profiles.h"
+#include "prediction.h"
+#include "shelldesktops.h"
+#include "animator.h"
+#include "constraints.h"
+#include "geometry.h"
 
 // STATE
 // -----
@@ -19,7 +26,7 @@ static bool s_isResizing = false;
 static HWND s_draggedWindow = NULL;
 /// The position of the mouse at the start of the delta
 static POINT s_initialMousePos;
-/// The window rect at the start of the delta
+/// The window rect at the start of the drag or resize
 static RECT s_initialWindowRect;
 
 enum ResizeRegion
@@ -39,19 +46,83 @@ enum ResizeRegion
 /// Determines the corner or edge to resize from
 static ResizeRegion s_activeResizeRegion = NONE;
 
-bool s_isMiddleMouseButtonDown = false;
-std::chrono::steady_clock::time_point s_middleMouseButtonDownTime;
-POINT s_middleMouseButtonDownPos;
-
-bool s_isLeftMouseButtonDown = false;
-std::chrono::steady_clock::time_point s_isLeftMouseButtonDownTime;
-POINT s_isLeftMouseButtonDownPos;
+/// The profile of the window being resized, looked up once when the resize starts
+static const AppProfile *s_resizeProfile = NULL;
+/// The rect to apply when the resize ends, for windows whose profile disables live resizing
+static RECT s_pendingResizeRect;
+static bool s_hasPendingResize = false;
+
+/// Keeps the resize within the size limits of the window (see constraints.h)
+static ResizeConstraints s_constraints;
+/// The pending query of the size limits of the window being resized, or 0 once it was answered
+static LONG s_resizeLimitsQuery = 0;
+/// The edges the active resize region moves (see `ResizeEdges`)
+static int s_resizeEdges = 0;
+/// The rect most recently requested for the window being resized
+static RECT s_lastResizeRect;
+/// Reports size changes of the window being resized, to learn the limits its application enforces
+static HWINEVENTHOOK s_resizeObserver = NULL;
 
 // DRAG
 // ----
 
+/// How often to check whether a predicted drag has come to rest
+const UINT SETTLE_INTERVAL_MS = 16;
+
+/// Tracks the cursor while dragging. It extrapolates the cursor, so that the window keeps up with it
+/// (Feature::PredictiveDrag), and measures the velocity a window is thrown with (Feature::KineticThrow)
+static MotionPredictor s_predictor;
+/// How thrown windows glide
+static ThrowSettings s_throwSettings;
+/// Checks whether the cursor has come to rest while the window is still at a predicted position
+static UINT_PTR s_settleTimer = 0;
+/// Whether the window is at a predicted position rather than under the cursor
+static bool s_isAhead = false;
+/// The latest cursor position and time of the drag
+static POINT s_lastMousePos;
+static DWORD s_lastMoveTime;
+
 bool isDragging() { return s_isDragging; }
 
+/// @brief Moves the dragged window to follow the cursor at the given position
+static void placeDraggedWindow(POINT pt)
+{
+    int newX = s_initialWindowRect.left + (pt.x - s_initialMousePos.x);
+    int newY = s_initialWindowRect.top + (pt.y - s_initialMousePos.y);
+
+    HOOK_PLATFORM_CALL("placeDraggedWindow: SetWindowPos");
+    SetWindowPos(s_draggedWindow, NULL, newX, newY, 0, 0, SWP_NOSIZE | SWP_NOZORDER);
+}
+
+// Once no more movement arrives, the prediction has nothing left to hide, so the window snaps to the cursor
+static void CALLBACK SettleTimerProc(HWND hWnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime)
+{
+    if (s_isDragging && s_isAhead && dwTime - s_lastMoveTime >= s_predictor.settings.stopTime)
+    {
+        placeDraggedWindow(s_lastMousePos);
+        s_isAhead = false;
+        s_predictor.reset();
+    }
+}
+
+/// @brief Reads the `[Drag]` section of `winctrl.ini`. `PredictionHorizon` sets how far ahead
+/// (in milliseconds) a predictive drag places the window, which should match the display latency.
+/// `ThrowSpeed` (in pixels per second) is how fast a window must be let go of to be thrown, and
+/// `ThrowGlide` (in milliseconds) how long it keeps gliding.
+void loadDragSettings()
+{
+    wchar_t path[MAX_PATH];
+    if (getAppFilePath(L".ini", path, MAX_PATH))
+    {
+        PredictionSettings defaults;
+        s_predictor.settings.horizon = GetPrivateProfileIntW(L"Drag", L"PredictionHorizon", defaults.horizon, path);
+
+        ThrowSettings throwDefaults;
+        s_throwSettings.minSpeed = GetPrivateProfileIntW(L"Drag", L"ThrowSpeed", (int)(throwDefaults.minSpeed * 1000), path) / 1000.0f;
+        s_throwSettings.glideTime = GetPrivateProfileIntW(L"Drag", L"ThrowGlide", (int)throwDefaults.glideTime, path);
+    }
+}
+
 void startDragging(MSLLHOOKSTRUCT *pMouse)
 {
     HWND hWnd = WindowFromPoint(pMouse->pt);      // Get the window handle under the cursor
@@ -64,22 +135,66 @@ void startDragging(MSLLHOOKSTRUCT *pMouse)
         return;
     }
 
+    // The drag takes over from any animation still running, and starts from where that left the window
+    cancelWindowAnimation(s_draggedWindow);
+
+    // Remember where the window was, so the drag can be undone
+    beginGeometryChange(s_draggedWindow);
+
     if (isFullscreen(s_draggedWindow))
     {
         ShowWindow(s_draggedWindow, SW_RESTORE);
     }
 
-    s_isDragging = true;            // Start dragging
-    s_isResizing = false;           // Ensure only one mode is active
-    s_initialMousePos = pMouse->pt; // Store the initial mouse position
+    s_isDragging = true;                                  // Start dragging
+    s_isResizing = false;                                 // Ensure only one mode is active
+    s_initialMousePos = pMouse->pt;                       // Store the initial mouse position
+    GetWindowRect(s_draggedWindow, &s_initialWindowRect); // Store the initial window rect
+
+    s_predictor.reset();
+    s_predictor.addSample(pMouse->pt.x, pMouse->pt.y, pMouse->time);
+    s_isAhead = false;
+    if (Feature::PredictiveDrag)
+    {
+        s_settleTimer = SetTimer(NULL, s_settleTimer, SETTLE_INTERVAL_MS, SettleTimerProc);
+    }
 }
 
 void stopDragging(MSLLHOOKSTRUCT *pMouse)
 {
+    if (s_settleTimer)
+    {
+        KillTimer(NULL, s_settleTimer);
+        s_settleTimer = 0;
+    }
+
+    // The window ends up exactly under the cursor, wherever the prediction had put it
+    if (s_isDragging && s_isAhead)
+    {
+        placeDraggedWindow(pMouse->pt);
+        s_isAhead = false;
+    }
+
     // If the window was dragged to the top edge, maximize it
     if (s_isDragging && pMouse->pt.y == 0)
     {
-        ShowWindow(s_draggedWindow, SW_MAXIMIZE);
+        if (!animateMaximize(s_draggedWindow))
+        {
+            ShowWindow(s_draggedWindow, SW_MAXIMIZE);
+        }
+    }
+    // Otherwise, a window let go of while still moving glides on with the velocity of the cursor
+    else if (s_isDragging && Feature::KineticThrow)
+    {
+        float velocityX, velocityY;
+        s_predictor.addSample(pMouse->pt.x, pMouse->pt.y, pMouse->time);
+        s_predictor.velocity(&velocityX, &velocityY);
+        animateThrow(s_draggedWindow, velocityX, velocityY, s_throwSettings);
+    }
+
+    if (s_isDragging)
+    {
+        commitGeometryChange();
     }
 
     s_isDragging = false;   // Stop dragging. This will prevent the WM_MOUSEMOVE logic from running until the next drag starts
@@ -93,26 +208,196 @@ void performDrag(MSLLHOOKSTRUCT *pMouse)
         return;
     }
 
-    // Get the current position of the window
-    RECT windowRect;
-    GetWindowRect(s_draggedWindow, &windowRect);
+    s_lastMousePos = pMouse->pt;
+    s_lastMoveTime = pMouse->time;
 
-    // Calculate the window's new top-left coordinates
-    int newX = windowRect.left + (pMouse->pt.x - s_initialMousePos.x);
-    int newY = windowRect.top + (pMouse->pt.y - s_initialMousePos.y);
+    // The samples come from the hook's own timestamps, so tracking the cursor costs no platform calls
+    s_predictor.addSample(pMouse->pt.x, pMouse->pt.y, pMouse->time);
 
-    // Move the window to the new coordinates
-    SetWindowPos(s_draggedWindow, NULL, newX, newY, 0, 0, SWP_NOSIZE | SWP_NOZORDER);
+    // Place the window where the cursor will be by the time the frame is shown, rather than where it was
+    POINT pt = pMouse->pt;
+    if (Feature::PredictiveDrag && s_settleTimer)
+    {
+        int x = pt.x, y = pt.y;
+        s_predictor.predict(&x, &y);
+        s_isAhead = x != pt.x || y != pt.y;
+        pt.x = x;
+        pt.y = y;
+    }
 
-    // Update the mouse position for the next movement
-    s_initialMousePos = pMouse->pt;
+    // Only the one call that moves the window is made per mouse move (see budget.h)
+    placeDraggedWindow(pt);
 }
 
 // RESIZE
 // ------
 
+/// How long to wait for a window to report its size limits, before going with the defaults
+const UINT MINMAXINFO_TIMEOUT_MS = 50;
+
 bool isResizing() { return s_isResizing; }
 
+static bool isSameRect(const RECT &a, const RECT &b)
+{
+    return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+}
+
+static GeometryRect toGeometryRect(const RECT &rect) { return {(int)rect.left, (int)rect.top, (int)rect.right, (int)rect.bottom}; }
+
+/// @brief The edges of the window that dragging from a region moves. The center moves all of them.
+static int getResizeEdges(ResizeRegion region)
+{
+    switch (region)
+    {
+    case TOP_LEFT:
+        return EDGE_TOP | EDGE_LEFT;
+    case TOP:
+        return EDGE_TOP;
+    case TOP_RIGHT:
+        return EDGE_TOP | EDGE_RIGHT;
+    case RIGHT:
+        return EDGE_RIGHT;
+    case BOTTOM_RIGHT:
+        return EDGE_BOTTOM | EDGE_RIGHT;
+    case BOTTOM:
+        return EDGE_BOTTOM;
+    case BOTTOM_LEFT:
+        return EDGE_BOTTOM | EDGE_LEFT;
+    case LEFT:
+        return EDGE_LEFT;
+    case CENTER:
+        return EDGE_LEFT | EDGE_TOP | EDGE_RIGHT | EDGE_BOTTOM;
+    case NONE:
+    default:
+        return 0;
+    }
+}
+
+/// @brief The size limits of a window until it reports its own: the system defaults, with the
+/// profile's minimum size on top
+static SizeLimits defaultSizeLimits(int minWindowSize)
+{
+    SizeLimits limits;
+    limits.minWidth = std::max(minWindowSize, GetSystemMetrics(SM_CXMINTRACK));
+    limits.minHeight = std::max(minWindowSize, GetSystemMetrics(SM_CYMINTRACK));
+    limits.maxWidth = GetSystemMetrics(SM_CXMAXTRACK);
+    limits.maxHeight = GetSystemMetrics(SM_CYMAXTRACK);
+    return limits;
+}
+
+/// @brief Asks a window for its minimum and maximum tracking size, as the system does before it
+/// resizes a window itself. The profile's minimum size applies on top. Hung windows keep the
+/// system defaults. This waits for the window, so it runs on the thread pool (see `requestSizeLimits`).
+static SizeLimits querySizeLimits(HWND hWnd, int minWindowSize)
+{
+    MINMAXINFO info = {};
+    info.ptMinTrackSize.x = GetSystemMetrics(SM_CXMINTRACK);
+    info.ptMinTrackSize.y = GetSystemMetrics(SM_CYMINTRACK);
+    info.ptMaxTrackSize.x = GetSystemMetrics(SM_CXMAXTRACK);
+    info.ptMaxTrackSize.y = GetSystemMetrics(SM_CYMAXTRACK);
+
+    DWORD_PTR result;
+    SendMessageTimeoutW(hWnd, WM_GETMINMAXINFO, 0, (LPARAM)&info, SMTO_ABORTIFHUNG | SMTO_ERRORONEXIT, MINMAXINFO_TIMEOUT_MS, &result);
+
+    SizeLimits limits;
+    limits.minWidth = std::max(minWindowSize, (int)info.ptMinTrackSize.x);
+    limits.minHeight = std::max(minWindowSize, (int)info.ptMinTrackSize.y);
+    limits.maxWidth = info.ptMaxTrackSize.x;
+    limits.maxHeight = info.ptMaxTrackSize.y;
+    return limits;
+}
+
+/// How many size limit queries can be in flight. A query only outlives its resize or zoom if the
+/// window is slow to answer, so a few are plenty; with none free, the defaults stay.
+const int SIZE_LIMITS_QUERIES = 4;
+
+/// @brief A query of the size limits of a window, answered on the thread pool. While `isBusy`, it
+/// belongs to the pool thread; `answered` is the generation of the last query it answered. Both are
+/// only accessed with Interlocked functions. Every member has a constant initializer, so the queries
+/// need no code to run at startup.
+struct SizeLimitsQuery
+{
+    LONG isBusy = 0;
+    LONG answered = 0;
+    LONG generation = 0;
+    HWND hWnd = NULL;
+    int minWindowSize = 0;
+    SizeLimits limits;
+};
+
+static SizeLimitsQuery s_sizeLimitsQueries[SIZE_LIMITS_QUERIES];
+static LONG s_sizeLimitsGeneration = 0;
+
+static DWORD WINAPI SizeLimitsQueryProc(LPVOID context)
+{
+    SizeLimitsQuery *query = (SizeLimitsQuery *)context;
+    query->limits = querySizeLimits(query->hWnd, query->minWindowSize);
+    InterlockedExchange(&query->answered, query->generation);
+    InterlockedExchange(&query->isBusy, 0);
+    return 0;
+}
+
+/// @brief Starts asking a window for its size limits on the thread pool, so that the hook never
+/// waits for a slow or hung application
+/// @return The generation of the query (see `takeSizeLimits`), or 0 if none could be started
+static LONG requestSizeLimits(HWND hWnd, int minWindowSize)
+{
+    // Generation 0 stands for no query
+    s_sizeLimitsGeneration = (s_sizeLimitsGeneration & 0x3FFFFFFF) + 1;
+    LONG generation = s_sizeLimitsGeneration;
+
+    // A window from an earlier resize may still be answering in this slot
+    SizeLimitsQuery &query = s_sizeLimitsQueries[generation % SIZE_LIMITS_QUERIES];
+    if (InterlockedCompareExchange(&query.isBusy, 1, 0) != 0)
+    {
+        return 0;
+    }
+
+    query.generation = generation;
+    query.hWnd = hWnd;
+    query.minWindowSize = minWindowSize;
+    if (!QueueUserWorkItem(SizeLimitsQueryProc, &query, WT_EXECUTEDEFAULT))
+    {
+        InterlockedExchange(&query.isBusy, 0);
+        return 0;
+    }
+    return generation;
+}
+
+/// @brief Takes the answer to a query, once the window has given it. Cheap enough for every mouse move
+static bool takeSizeLimits(LONG generation, SizeLimits *limits)
+{
+    if (generation == 0)
+    {
+        return false;
+    }
+
+    const SizeLimitsQuery &query = s_sizeLimitsQueries[generation % SIZE_LIMITS_QUERIES];
+    if (InterlockedCompareExchange((LONG *)&query.answered, generation, generation) != generation)
+    {
+        return false;
+    }
+    *limits = query.limits;
+    return true;
+}
+
+// Called after the window being resized has changed its size. A size other than the requested one
+// means its application corrected the request, which reveals a limit it did not report.
+static void CALLBACK ResizeObserverProc(HWINEVENTHOOK hWinEventHook, DWORD event, HWND hWnd,
+                                        LONG idObject, LONG idChild, DWORD idEventThread, DWORD dwmsEventTime)
+{
+    if (!s_isResizing || hWnd != s_draggedWindow || idObject != OBJID_WINDOW || idChild != CHILDID_SELF)
+    {
+        return;
+    }
+
+    RECT actual;
+    GetWindowRect(hWnd, &actual);
+    const RECT &requested = s_lastResizeRect;
+    s_constraints.observe(requested.right - requested.left, requested.bottom - requested.top,
+                          actual.right - actual.left, actual.bottom - actual.top);
+}
+
 void startResizing(MSLLHOOKSTRUCT *pMouse)
 {
     HWND hWnd = WindowFromPoint(pMouse->pt);      // Get the window handle under the cursor
@@ -125,11 +410,28 @@ void startResizing(MSLLHOOKSTRUCT *pMouse)
         return;
     }
 
+    cancelWindowAnimation(s_draggedWindow);
+    beginGeometryChange(s_draggedWindow); // Remember the original size, so the resize can be undone
+    s_resizeProfile = getAppProfile(s_draggedWindow);
+    s_hasPendingResize = false;
+
     s_isResizing = true;                                  // Start resizing
     s_isDragging = false;                                 // Ensure only one mode is active
     s_initialMousePos = pMouse->pt;                       // Store the initial mouse position
     GetWindowRect(s_draggedWindow, &s_initialWindowRect); // Store the initial window rect
+    s_lastResizeRect = s_initialWindowRect;
 
+    // Learn the size limits once, so that the resize never asks for a size the window refuses.
+    // The window answers on the thread pool, and the resize keeps the defaults until it has
+    s_constraints.begin(defaultSizeLimits(s_resizeProfile->minWindowSize));
+    s_resizeLimitsQuery = requestSizeLimits(s_draggedWindow, s_resizeProfile->minWindowSize);
+    if (s_resizeProfile->liveResize && !s_resizeObserver)
+    {
+        DWORD processId;
+        DWORD threadId = GetWindowThreadProcessId(s_draggedWindow, &processId);
+        s_resizeObserver = SetWinEventHook(EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_LOCATIONCHANGE, NULL,
+                                           ResizeObserverProc, processId, threadId, WINEVENT_OUTOFCONTEXT);
+    }
 
     // Determine the resize region based on a 3x3 grid
     RECT rect = s_initialWindowRect;
@@ -168,10 +470,30 @@ void startResizing(MSLLHOOKSTRUCT *pMouse)
         else
             s_activeResizeRegion = BOTTOM_RIGHT;
     }
+    s_resizeEdges = getResizeEdges(s_activeResizeRegion);
 }
 
 void stopResizing()
 {
+    // Windows that do not resize live get their final size only now
+    if (s_isResizing && s_hasPendingResize)
+    {
+        RECT rect = s_pendingResizeRect;
+        SetWindowPos(s_draggedWindow, NULL, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top, SWP_NOZORDER);
+        s_hasPendingResize = false;
+    }
+
+    if (s_isResizing)
+    {
+        commitGeometryChange();
+    }
+
+    if (s_resizeObserver)
+    {
+        UnhookWinEvent(s_resizeObserver);
+        s_resizeObserver = NULL;
+    }
+
     s_isResizing = false;        // Stop resizing
     s_draggedWindow = NULL;      // Reset the dragged window handle
     s_activeResizeRegion = NONE; // Reset the active resize region
@@ -179,132 +501,345 @@ void stopResizing()
 
 void performResize(MSLLHOOKSTRUCT *pMouse)
 {
+    SizeLimits limits;
+    if (takeSizeLimits(s_resizeLimitsQuery, &limits))
+    {
+        s_constraints.begin(limits);
+        s_resizeLimitsQuery = 0;
+    }
 
     // Calculate the change in mouse position from the start
     int dx = pMouse->pt.x - s_initialMousePos.x;
     int dy = pMouse->pt.y - s_initialMousePos.y;
 
-    // Determine the dimensions of the new window
-    int newX = s_initialWindowRect.left;
-    int newY = s_initialWindowRect.top;
-    int newWidth = s_initialWindowRect.right - s_initialWindowRect.left;
-    int newHeight = s_initialWindowRect.bottom - s_initialWindowRect.top;
+    GeometryRect initial = toGeometryRect(s_initialWindowRect);
+    GeometryRect rect;
+    if (s_activeResizeRegion == CENTER)
+    {
+        // Zoom about the center: dragging down or right grows the window, up or left shrinks it.
+        // Each side moves by the mouse movement, the horizontal part scaled by the aspect ratio.
+        int height = initial.height() + 2 * dy + (int)divideRounded((int64_t)2 * dx * initial.height(), initial.width());
+        Fixed scale = clampScale(fixedRatio(height, initial.height()), initial.width(), initial.height(), s_constraints.limits());
+        rect = zoomAboutCenter(initial, scaleLength(initial.height(), scale));
+    }
+    else
+    {
+        rect = moveEdges(initial, s_resizeEdges, dx, dy);
+    }
+
+    // Keep the window within its size limits, moving only the edges being dragged
+    s_constraints.clamp(s_resizeEdges, &rect.left, &rect.top, &rect.right, &rect.bottom);
+    RECT newRect = {rect.left, rect.top, rect.right, rect.bottom};
 
-    // Adjust the dimensions based on which region is active
-    switch (s_activeResizeRegion)
+    // Some applications repaint too slowly to follow the mouse, so they are only resized at the end
+    if (s_resizeProfile && !s_resizeProfile->liveResize)
     {
-    case TOP_LEFT:
-        newX = s_initialWindowRect.left + dx;
-        newY = s_initialWindowRect.top + dy;
-        newWidth = s_initialWindowRect.right - newX;
-        newHeight = s_initialWindowRect.bottom - newY;
-        break;
-    case TOP:
-        newY = s_initialWindowRect.top + dy;
-        newHeight = s_initialWindowRect.bottom - newY;
-        break;
-    case TOP_RIGHT:
-        newY = s_initialWindowRect.top + dy;
-        newWidth = (s_initialWindowRect.right + dx) - s_initialWindowRect.left;
-        newHeight = s_initialWindowRect.bottom - newY;
-        break;
-    case RIGHT:
-        newWidth = (s_initialWindowRect.right + dx) - s_initialWindowRect.left;
-        break;
-    case BOTTOM_RIGHT:
-        newWidth = (s_initialWindowRect.right + dx) - s_initialWindowRect.left;
-        newHeight = (s_initialWindowRect.bottom + dy) - s_initialWindowRect.top;
-        break;
-    case BOTTOM:
-        newHeight = (s_initialWindowRect.bottom + dy) - s_initialWindowRect.top;
-        break;
-    case BOTTOM_LEFT:
-        newX = s_initialWindowRect.left + dx;
-        newWidth = s_initialWindowRect.right - newX;
-        newHeight = (s_initialWindowRect.bottom + dy) - s_initialWindowRect.top;
-        break;
-    case LEFT:
-        newX = s_initialWindowRect.left + dx;
-        newWidth = s_initialWindowRect.right - newX;
-        break;
-    case CENTER:
+        s_pendingResizeRect = newRect;
+        s_hasPendingResize = true;
+        return;
+    }
+
+    // Once a limit is reached, further mouse movement leaves the rect as it is, and needs no update
+    if (isSameRect(newRect, s_lastResizeRect))
     {
-        // Resize from the center, maintaining aspect ratio based on vertical mouse movement
-        // We use 'dy' (vertical mouse movement) as the primary driver for size change.
-        float aspectRatio = (float)newWidth / (float)newHeight;
-        int sizeChange = dy * 2; // Multiply by 2 to make the resizing more sensitive
+        return;
+    }
+    s_lastResizeRect = newRect;
 
-        // Calculate new width and height based on the aspect ratio and size change.
-        // The width change is proportional to the height change, scaled by the aspect ratio.
-        newWidth += (int)(sizeChange * aspectRatio);
-        newHeight += sizeChange;
+    // Command the window to resize to the new dimensions
+    HOOK_PLATFORM_CALL("performResize: SetWindowPos");
+    SetWindowPos(s_draggedWindow, NULL, rect.left, rect.top, rect.width(), rect.height(), SWP_NOZORDER);
+}
 
-        // Reposition the window to keep its center stationary
-        // The adjustment is half of the total size change in each dimension.
-        newX -= (int)((sizeChange * aspectRatio) / 2);
-        newY -= sizeChange / 2;
-        break;
+// SCROLL ZOOM
+// -----------
+
+/// How often a burst of wheel notches is applied, so the window is resized at most once a frame
+const UINT ZOOM_FRAME_MS = 16;
+/// Wheel notches this close together (and at the same spot) continue the same zoom
+const DWORD ZOOM_SESSION_MS = 1000;
+/// How far the cursor may wander before the next notch starts a new zoom
+const int ZOOM_ANCHOR_SLOP = 4;
+/// How much one notch of the wheel scales the window (1.1 in 16.16 fixed point)
+const Fixed ZOOM_STEP = 72090;
+/// The most notches a zoom can go in either direction (about 10x)
+const int MAX_ZOOM_STEPS = 24;
+
+/// The window being zoomed, and the rect and cursor position it started from. Every step is
+/// computed from these, so zooming back by as many notches returns the window to the same rect.
+static HWND s_zoomWindow = NULL;
+static RECT s_zoomInitialRect;
+static POINT s_zoomAnchor;
+static SizeLimits s_zoomLimits;
+/// The pending query of the size limits of the window being zoomed, or 0 once it was answered
+static LONG s_zoomLimitsQuery = 0;
+/// The wheel movement of the zoom so far, and how much of it the window already shows
+static int s_zoomDelta = 0;
+static int s_zoomAppliedSteps = 0;
+static DWORD s_lastZoomTime = 0;
+static UINT_PTR s_zoomTimer = 0;
+
+/// @brief Sets the limits the zoom keeps to. A window already smaller than its minimum may stay so
+static void setZoomLimits(const SizeLimits &limits)
+{
+    s_zoomLimits = limits;
+    s_zoomLimits.minWidth = std::min(s_zoomLimits.minWidth, (int)(s_zoomInitialRect.right - s_zoomInitialRect.left));
+    s_zoomLimits.minHeight = std::min(s_zoomLimits.minHeight, (int)(s_zoomInitialRect.bottom - s_zoomInitialRect.top));
+}
+
+static bool isZoomWithinLimits(const GeometryRect &initial, int steps)
+{
+    Fixed scale = powerFixed(ZOOM_STEP, steps);
+    return clampScale(scale, initial.width(), initial.height(), s_zoomLimits) == scale;
+}
+
+// Applies the notches that came in since the last frame in one update, then stops once the wheel rests
+static void CALLBACK ZoomTimerProc(HWND hWnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime)
+{
+    SizeLimits limits;
+    if (takeSizeLimits(s_zoomLimitsQuery, &limits))
+    {
+        setZoomLimits(limits);
+        s_zoomLimitsQuery = 0;
     }
-    case NONE:
-    default:
-        break;
+
+    int steps = s_zoomDelta / WHEEL_DELTA;
+    if (!s_zoomWindow || steps == s_zoomAppliedSteps)
+    {
+        KillTimer(NULL, s_zoomTimer);
+        s_zoomTimer = 0;
+        return;
     }
 
-    // Enforce a minimum window size
-    if (newWidth < MIN_WINDOW_SIZE)
+    // Notches past a limit are dropped (all but the one that reaches it), so that turning the
+    // wheel back responds at once
+    GeometryRect initial = toGeometryRect(s_zoomInitialRect);
+    int direction = steps > 0 ? 1 : -1;
+    while (steps != 0 && !isZoomWithinLimits(initial, steps - direction))
     {
-        newWidth = MIN_WINDOW_SIZE;
+        steps -= direction;
     }
-    if (newHeight < MIN_WINDOW_SIZE)
+    s_zoomDelta = steps * WHEEL_DELTA;
+    if (steps == s_zoomAppliedSteps)
     {
-        newHeight = MIN_WINDOW_SIZE;
+        return; // Already at the limit
     }
+    s_zoomAppliedSteps = steps;
 
-    // Command the window to resize to the new dimensions
-    SetWindowPos(s_draggedWindow, NULL, newX, newY, newWidth, newHeight, SWP_NOZORDER);
+    Fixed scale = clampScale(powerFixed(ZOOM_STEP, steps), initial.width(), initial.height(), s_zoomLimits);
+    GeometryRect rect = zoomAbout(initial, s_zoomAnchor.x, s_zoomAnchor.y, scale);
+    SetWindowPos(s_zoomWindow, NULL, rect.left, rect.top, rect.width(), rect.height(), SWP_NOZORDER | SWP_NOACTIVATE);
+}
+
+/// @brief Zooms the window under the cursor about the cursor point: scrolling up grows it, scrolling
+/// down shrinks it, keeping its aspect ratio. Wheel bursts are coalesced into one update per frame.
+/// @return False if there is no window to zoom
+bool handleZoomWheel(MSLLHOOKSTRUCT *pMouse)
+{
+    POINT pt = pMouse->pt;
+    bool isSameZoom = s_zoomWindow && pMouse->time - s_lastZoomTime < ZOOM_SESSION_MS &&
+                      abs(pt.x - s_zoomAnchor.x) <= ZOOM_ANCHOR_SLOP && abs(pt.y - s_zoomAnchor.y) <= ZOOM_ANCHOR_SLOP;
+
+    if (!isSameZoom)
+    {
+        HWND hWnd = getTargetWindow(pt);
+        RECT rect;
+        if (!hWnd || isFullscreen(hWnd) || !GetWindowRect(hWnd, &rect) || rect.right <= rect.left || rect.bottom <= rect.top)
+        {
+            return false;
+        }
+
+        cancelWindowAnimation(hWnd);
+        recordGeometryChange(hWnd); // The whole zoom is undone in one step
+
+        s_zoomWindow = hWnd;
+        s_zoomInitialRect = rect;
+        s_zoomAnchor = pt;
+        int minWindowSize = getAppProfile(hWnd)->minWindowSize;
+        setZoomLimits(defaultSizeLimits(minWindowSize));
+        s_zoomLimitsQuery = requestSizeLimits(hWnd, minWindowSize);
+        s_zoomDelta = 0;
+        s_zoomAppliedSteps = 0;
+    }
+
+    short wheelDelta = HIWORD(pMouse->mouseData);
+    s_zoomDelta = std::max(-MAX_ZOOM_STEPS * WHEEL_DELTA, std::min(MAX_ZOOM_STEPS * WHEEL_DELTA, s_zoomDelta + wheelDelta));
+    s_lastZoomTime = pMouse->time;
+
+    if (!s_zoomTimer)
+    {
+        s_zoomTimer = SetTimer(NULL, 0, ZOOM_FRAME_MS, ZoomTimerProc);
+    }
+    return true;
 }
 
 // VIRTUAL DESKTOP SCROLL
 // ----------------------
 
 static const std::chrono::milliseconds THROTTLE_TIME(500);
-static std::chrono::steady_clock::time_point s_lastSwitchTime = std::chrono::steady_clock::now();
+static std::chrono::steady_clock::time_point s_lastSwitchTime; // Starts at the epoch, so the first switch is never throttled
+
+/// Switches desktops through the shell (see shelldesktops.cpp). Only used on the thread pool.
+static VirtualDesktops s_desktops;
+
+/// How many windows can wait to be moved to another desktop at once
+const int MAX_DESKTOP_MOVES = 4;
+
+/// How long teardown waits for a desktop request that is being carried out
+const DWORD DESKTOP_WORK_TIMEOUT_MS = 1000;
 
-static void simulateVirtualDesktopSwitch(bool scrollUp)
+/// @brief What the hooks asked of the virtual desktops and the thread pool has not done yet.
+/// Requests that arrive in the meantime are merged, so a burst of scrolls becomes a single switch.
+struct DesktopRequests
 {
-    INPUT inputs[6] = {};
-    ZeroMemory(inputs, sizeof(inputs));
+    bool hasSwitch;
+    int switchIndex;
+    int switchDelta; // Desktops to move by after switching to `switchIndex` (if `hasSwitch`)
+    int moveCount;
+    HWND movedWindows[MAX_DESKTOP_MOVES];
+    int moveTargets[MAX_DESKTOP_MOVES];
+};
 
-    // We simulate the virtual desktop switch by sending a sequence of key events (Win + Ctrl + Left/Right Arrow)
+static SRWLOCK s_desktopLock = SRWLOCK_INIT;
+static DesktopRequests s_desktopRequests; // Guarded by `s_desktopLock`
+/// Whether a work item is queued or running. It is only cleared under the lock, once there is nothing left to do.
+static volatile LONG s_isDesktopWorkQueued = 0;
 
-    // Press Win
-    inputs[0].type = INPUT_KEYBOARD;
-    inputs[0].ki.wVk = VK_LWIN;
+// Carries out the desktop requests on the thread pool: Explorer can take a while to answer, COM
+// must not run on the hook thread, and neither must the registry reads of the keyboard fallback
+static DWORD WINAPI DesktopWorkProc(LPVOID)
+{
+    HRESULT comResult = CoInitializeEx(NULL, COINIT_MULTITHREADED);
+    for (;;)
+    {
+        AcquireSRWLockExclusive(&s_desktopLock);
+        DesktopRequests requests = s_desktopRequests;
+        s_desktopRequests = DesktopRequests();
+        bool isDone = !requests.hasSwitch && requests.switchDelta == 0 && requests.moveCount == 0;
+        if (isDone)
+        {
+            InterlockedExchange(&s_isDesktopWorkQueued, 0);
+        }
+        ReleaseSRWLockExclusive(&s_desktopLock);
+        if (isDone)
+        {
+            break;
+        }
 
-    // Press Ctrl
-    inputs[1].type = INPUT_KEYBOARD;
-    inputs[1].ki.wVk = VK_CONTROL;
+        for (int i = 0; i < requests.moveCount; i++)
+        {
+            s_desktops.moveWindowTo(requests.movedWindows[i], requests.moveTargets[i]);
+        }
+        if (requests.hasSwitch)
+        {
+            s_desktops.switchTo(requests.switchIndex);
+        }
+        if (requests.switchDelta != 0)
+        {
+            s_desktops.switchBy(requests.switchDelta);
+        }
+    }
 
-    // Press Left or Right Arrow
-    inputs[2].type = INPUT_KEYBOARD;
-    inputs[2].ki.wVk = scrollUp ? VK_LEFT : VK_RIGHT;
+    disconnectShellDesktops();
+    if (SUCCEEDED(comResult))
+    {
+        CoUninitialize();
+    }
+    return 0;
+}
 
-    // Release Left or Right Arrow
-    inputs[3].type = INPUT_KEYBOARD;
-    inputs[3].ki.wVk = scrollUp ? VK_LEFT : VK_RIGHT;
-    inputs[3].ki.dwFlags = KEYEVENTF_KEYUP;
+/// @brief Makes sure a work item will pick up the requests. Call after adding one.
+static bool queueDesktopWork()
+{
+    // A queued work item takes every request added before it finds none left
+    if (InterlockedCompareExchange(&s_isDesktopWorkQueued, 1, 0) != 0)
+    {
+        return true;
+    }
+    if (!QueueUserWorkItem(DesktopWorkProc, NULL, WT_EXECUTEDEFAULT))
+    {
+        // The requests stay, for the next one to queue
+        InterlockedExchange(&s_isDesktopWorkQueued, 0);
+        return false;
+    }
+    return true;
+}
 
-    // Release Ctrl
-    inputs[4].type = INPUT_KEYBOARD;
-    inputs[4].ki.wVk = VK_CONTROL;
-    inputs[4].ki.dwFlags = KEYEVENTF_KEYUP;
+/// @brief Asks for a switch to the desktop with the given index, replacing the switches not carried out yet
+static bool requestDesktopSwitch(int index)
+{
+    AcquireSRWLockExclusive(&s_desktopLock);
+    s_desktopRequests.hasSwitch = true;
+    s_desktopRequests.switchIndex = index;
+    s_desktopRequests.switchDelta = 0;
+    ReleaseSRWLockExclusive(&s_desktopLock);
+    return queueDesktopWork();
+}
 
-    // Release Win
-    inputs[5].type = INPUT_KEYBOARD;
-    inputs[5].ki.wVk = VK_LWIN;
-    inputs[5].ki.dwFlags = KEYEVENTF_KEYUP;
+/// @brief Asks for a switch to the desktop `delta` places to the right (or left, if negative), after
+/// the switches not carried out yet
+static bool requestDesktopStep(int delta)
+{
+    AcquireSRWLockExclusive(&s_desktopLock);
+    s_desktopRequests.switchDelta += delta;
+    ReleaseSRWLockExclusive(&s_desktopLock);
+    return queueDesktopWork();
+}
 
-    SendInput(6, inputs, sizeof(INPUT));
+void setupVirtualDesktops()
+{
+    s_desktops.setBackend(getShellDesktopBackend());
+}
+
+/// @brief Drops the requests not carried out yet, waits for the one in progress, and stops the backend
+void teardownVirtualDesktops()
+{
+    AcquireSRWLockExclusive(&s_desktopLock);
+    s_desktopRequests = DesktopRequests();
+    ReleaseSRWLockExclusive(&s_desktopLock);
+
+    for (DWORD waited = 0; s_isDesktopWorkQueued && waited < DESKTOP_WORK_TIMEOUT_MS; waited += 10)
+    {
+        Sleep(10);
+    }
+    closeShellDesktops();
+}
+
+/// @brief Switches to the virtual desktop with the given (0-based) index, on the thread pool
+/// @return False if the switch could not be queued
+bool switchToDesktop(int index)
+{
+    if (!requestDesktopSwitch(index))
+    {
+        return false;
+    }
+
+    s_lastSwitchTime = std::chrono::steady_clock::now();
+    return true;
+}
+
+/// @brief Moves a window, of any process, to the virtual desktop with the given (0-based) index, on
+/// the thread pool. Needs Explorer's own interfaces (see shelldesktops.cpp), so on Windows releases
+/// they are not known for, nothing happens.
+/// @return False if the move could not be queued
+bool moveWindowToDesktop(HWND hWnd, int index)
+{
+    AcquireSRWLockExclusive(&s_desktopLock);
+    DesktopRequests &requests = s_desktopRequests;
+    int slot = 0;
+    while (slot < requests.moveCount && requests.movedWindows[slot] != hWnd)
+    {
+        slot++;
+    }
+    bool hasSlot = slot < MAX_DESKTOP_MOVES;
+    if (hasSlot)
+    {
+        requests.movedWindows[slot] = hWnd;
+        requests.moveTargets[slot] = index;
+        requests.moveCount = std::max(requests.moveCount, slot + 1);
+    }
+    ReleaseSRWLockExclusive(&s_desktopLock);
+    return hasSlot && queueDesktopWork();
 }
 
 bool handleMouseWheel(MSLLHOOKSTRUCT *pMouse)
@@ -312,18 +847,9 @@ bool handleMouseWheel(MSLLHOOKSTRUCT *pMouse)
     auto now = std::chrono::steady_clock::now();
     if (std::chrono::duration_cast<std::chrono::milliseconds>(now - s_lastSwitchTime) > THROTTLE_TIME)
     {
-        // Extract the scroll direction from the mouseData
+        // Extract the scroll direction from the mouseData. Scrolling up goes to the desktop on the left
         short wheelDelta = HIWORD(pMouse->mouseData);
-        if (wheelDelta > 0)
-        {
-            // Scroll Up
-            simulateVirtualDesktopSwitch(true);
-        }
-        else
-        {
-            // Scroll Down
-            simulateVirtualDesktopSwitch(false);
-        }
+        requestDesktopStep(wheelDelta > 0 ? -1 : 1);
 
         // Update the lastSwitchTime to inform the throttle check
         s_lastSwitchTime = now;
@@ -337,27 +863,25 @@ bool handleMouseWheel(MSLLHOOKSTRUCT *pMouse)
 // TRANSPARENCY
 // ------------
 
-bool handleTransparency(MSLLHOOKSTRUCT *pMouse)
+/// @brief Changes the opacity of a window, keeping it between ~10% and fully opaque
+void adjustWindowAlpha(HWND hWnd, int delta)
 {
-    HWND hWnd = WindowFromPoint(pMouse->pt);
-    HWND targetWnd = GetAncestor(hWnd, GA_ROOT);
-
-    if (isExcludedWindow(targetWnd))
+    if (!hWnd)
     {
-        return false;
+        return;
     }
 
     // Ensure the window has the layered extended style
-    LONG_PTR exStyle = GetWindowLongPtr(targetWnd, GWL_EXSTYLE);
+    LONG_PTR exStyle = GetWindowLongPtr(hWnd, GWL_EXSTYLE);
     if (!(exStyle & WS_EX_LAYERED))
     {
-        SetWindowLongPtr(targetWnd, GWL_EXSTYLE, exStyle | WS_EX_LAYERED);
+        SetWindowLongPtr(hWnd, GWL_EXSTYLE, exStyle | WS_EX_LAYERED);
     }
 
     // Get current alpha
     BYTE currentAlpha;
     DWORD flags;
-    GetLayeredWindowAttributes(targetWnd, NULL, &currentAlpha, &flags);
+    GetLayeredWindowAttributes(hWnd, NULL, &currentAlpha, &flags);
 
     // If the window has no transparency set yet, default to fully opaque
     if (!(flags & LWA_ALPHA))
@@ -365,22 +889,26 @@ bool handleTransparency(MSLLHOOKSTRUCT *pMouse)
         currentAlpha = 255;
     }
 
-    // Determine scroll direction
-    short wheelDelta = HIWORD(pMouse->mouseData);
-    int alphaChange = 5; // Amount to change alpha by
+    int newAlpha = std::max(25, std::min(255, currentAlpha + delta)); // Min alpha of ~10%
 
-    if (wheelDelta > 0)
+    // Apply the new alpha value
+    SetLayeredWindowAttributes(hWnd, 0, (BYTE)newAlpha, LWA_ALPHA);
+}
+
+bool handleTransparency(MSLLHOOKSTRUCT *pMouse)
+{
+    HWND targetWnd = getTargetWindow(pMouse->pt);
+    if (!targetWnd)
     {
-        // Scroll Up - Increase opacity
-        currentAlpha = std::min(255, currentAlpha + alphaChange);
-    }
-    else
-    {                                                            // Scroll Down - Decrease opacity
-        currentAlpha = std::max(25, currentAlpha - alphaChange); // Min alpha of ~10%
+        return false;
     }
 
-    // Apply the new alpha value
-    SetLayeredWindowAttributes(targetWnd, 0, currentAlpha, LWA_ALPHA);
+    // Determine scroll direction
+    short wheelDelta = HIWORD(pMouse->mouseData);
+    int alphaChange = getAppProfile(targetWnd)->alphaStep; // Amount to change alpha by
+
+    // Scroll Up - Increase opacity, Scroll Down - Decrease opacity
+    adjustWindowAlpha(targetWnd, wheelDelta > 0 ? alphaChange : -alphaChange);
 
     return true; // Event handled
 }
@@ -388,22 +916,189 @@ bool handleTransparency(MSLLHOOKSTRUCT *pMouse)
 // MAXIMIZE/RESTORE ACTIONS
 // ------------------------
 
-void toggleMaximizeRestore(MSLLHOOKSTRUCT *pMouse)
+void toggleWindowMaximized(HWND hWnd)
 {
-    HWND hWnd = WindowFromPoint(pMouse->pt);
-    HWND targetWnd = GetAncestor(hWnd, GA_ROOT);
+    if (!hWnd)
+    {
+        return;
+    }
 
-    if (isExcludedWindow(targetWnd))
+    // A window that is still being maximized counts as maximized, and one that is still being
+    // restored as restored. Toggling it again turns the animation around, which undoes the
+    // unfinished toggle, so it records no step of its own.
+    RECT normalRect;
+    switch (cancelWindowAnimation(hWnd, &normalRect))
     {
+    case TRANSITION_MAXIMIZE:
+        reverseMaximize(hWnd, normalRect);
         return;
+    case TRANSITION_RESTORE:
+        reverseRestore(hWnd, normalRect);
+        return;
+    default:
+        break;
     }
 
-    if (IsZoomed(targetWnd))
+    recordGeometryChange(hWnd);
+
+    if (IsZoomed(hWnd))
     {
-        ShowWindow(targetWnd, SW_RESTORE);
+        if (!animateRestore(hWnd))
+            ShowWindow(hWnd, SW_RESTORE);
     }
     else
     {
-        ShowWindow(targetWnd, SW_MAXIMIZE);
+        if (!animateMaximize(hWnd))
+            ShowWindow(hWnd, SW_MAXIMIZE);
+    }
+}
+
+void toggleMaximizeRestore(MSLLHOOKSTRUCT *pMouse)
+{
+    toggleWindowMaximized(getTargetWindow(pMouse->pt));
+}
+
+void minimizeWindow(HWND hWnd)
+{
+    if (hWnd)
+    {
+        ShowWindow(hWnd, SW_MINIMIZE);
     }
 }
+
+// ALWAYS ON TOP
+// -------------
+
+void toggleAlwaysOnTop(HWND hWnd)
+{
+    if (!hWnd)
+    {
+        return;
+    }
+
+    bool isTopmost = GetWindowLongPtr(hWnd, GWL_EXSTYLE) & WS_EX_TOPMOST;
+    SetWindowPos(hWnd, isTopmost ? HWND_NOTOPMOST : HWND_TOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE);
+}
+
+// KEYBOARD ACTIONS
+// ----------------
+
+/// @brief Moves a window by the given offset
+void moveWindowBy(HWND hWnd, int dx, int dy)
+{
+    if (!hWnd || IsZoomed(hWnd))
+    {
+        return;
+    }
+
+    recordGeometryChange(hWnd);
+
+    RECT rect;
+    GetWindowRect(hWnd, &rect);
+    SetWindowPos(hWnd, NULL, rect.left + dx, rect.top + dy, 0, 0, SWP_NOSIZE | SWP_NOZORDER | SWP_NOACTIVATE);
+}
+
+/// @brief Grows (or shrinks) a window by the given amount, keeping its top-left corner in place
+void resizeWindowBy(HWND hWnd, int dWidth, int dHeight)
+{
+    if (!hWnd || IsZoomed(hWnd))
+    {
+        return;
+    }
+
+    recordGeometryChange(hWnd);
+
+    RECT rect;
+    GetWindowRect(hWnd, &rect);
+    int minWindowSize = getAppProfile(hWnd)->minWindowSize;
+    int newWidth = std::max(minWindowSize, (int)(rect.right - rect.left) + dWidth);
+    int newHeight = std::max(minWindowSize, (int)(rect.bottom - rect.top) + dHeight);
+    SetWindowPos(hWnd, NULL, 0, 0, newWidth, newHeight, SWP_NOMOVE | SWP_NOZORDER | SWP_NOACTIVATE);
+}
+
+struct MonitorSearch
+{
+    int remaining;
+    HMONITOR hMonitor;
+};
+
+static BOOL CALLBACK findMonitorByIndex(HMONITOR hMonitor, HDC, LPRECT, LPARAM lParam)
+{
+    MonitorSearch *search = (MonitorSearch *)lParam;
+    if (search->remaining-- == 0)
+    {
+        search->hMonitor = hMonitor;
+        return FALSE; // Stop enumerating
+    }
+    return TRUE;
+}
+
+/// @brief Moves a window to the monitor with the given (0-based) index, in the order the
+/// system enumerates them. The window keeps its relative position within the work area.
+void moveWindowToMonitor(HWND hWnd, int monitorIndex)
+{
+    if (!hWnd || monitorIndex < 0)
+    {
+        return;
+    }
+
+    MonitorSearch search = {monitorIndex, NULL};
+    EnumDisplayMonitors(NULL, NULL, findMonitorByIndex, (LPARAM)&search);
+    HMONITOR hSource = MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST);
+    if (!search.hMonitor || search.hMonitor == hSource)
+    {
+        return;
+    }
+
+    MONITORINFO source = {sizeof(MONITORINFO)};
+    MONITORINFO target = {sizeof(MONITORINFO)};
+    GetMonitorInfo(hSource, &source);
+    GetMonitorInfo(search.hMonitor, &target);
+
+    recordGeometryChange(hWnd);
+
+    // A maximized window has to be restored to move, and is maximized again on the new monitor
+    bool wasMaximized = IsZoomed(hWnd);
+    if (wasMaximized)
+    {
+        ShowWindow(hWnd, SW_RESTORE);
+    }
+
+    RECT rect;
+    GetWindowRect(hWnd, &rect);
+    int width = rect.right - rect.left;
+    int height = rect.bottom - rect.top;
+    int newX = target.rcWork.left + (rect.left - source.rcWork.left);
+    int newY = target.rcWork.top + (rect.top - source.rcWork.top);
+
+    // Keep the window inside the new work area where possible
+    newX = std::max((int)target.rcWork.left, std::min(newX, (int)target.rcWork.right - width));
+    newY = std::max((int)target.rcWork.top, std::min(newY, (int)target.rcWork.bottom - height));
+
+    SetWindowPos(hWnd, NULL, newX, newY, 0, 0, SWP_NOSIZE | SWP_NOZORDER | SWP_NOACTIVATE);
+
+    if (wasMaximized)
+    {
+        ShowWindow(hWnd, SW_MAXIMIZE);
+    }
+}
+
+// HELPER FUNCTIONS
+// ----------------
+
+/// @brief Gets the top-level window at the given point.
+/// @return NULL if there is no window, or if it is excluded from winctrl's operations
+HWND getTargetWindow(POINT pt)
+{
+    HOOK_PLATFORM_CALL("getTargetWindow: WindowFromPoint");
+    HWND hWnd = WindowFromPoint(pt);
+    HOOK_PLATFORM_CALL("getTargetWindow: GetAncestor");
+    HWND targetWnd = GetAncestor(hWnd, GA_ROOT);
+
+    if (isExcludedWindow(targetWnd))
+    {
+        return NULL;
+    }
+
+    return targetWnd;
+}
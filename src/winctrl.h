@@ -2,20 +2,11 @@
 #define WINCTRL_H
 
 #include <windows.h>
-#include <chrono>
 
 #include "features.h"
 
 // STATE
 
-extern bool s_isMiddleMouseButtonDown;
-extern std::chrono::steady_clock::time_point s_middleMouseButtonDownTime;
-extern POINT s_middleMouseButtonDownPos;
-
-extern bool s_isLeftMouseButtonDown;
-extern std::chrono::steady_clock::time_point s_isLeftMouseButtonDownTime;
-extern POINT s_isLeftMouseButtonDownPos;
-
 bool isDragging();
 bool isResizing();
 
@@ -24,25 +15,47 @@ bool isResizing();
 void startDragging(MSLLHOOKSTRUCT *pMouse);
 void stopDragging(MSLLHOOKSTRUCT *pMouse);
 void performDrag(MSLLHOOKSTRUCT *pMouse);
+void loadDragSettings();
 
 // RESIZE ACTIONS
 
 void startResizing(MSLLHOOKSTRUCT *pMouse);
 void stopResizing();
 void performResize(MSLLHOOKSTRUCT *pMouse);
+bool handleZoomWheel(MSLLHOOKSTRUCT *pMouse);
 
 // MAXIMIZE/RESTORE ACTIONS
 
 void toggleMaximizeRestore(MSLLHOOKSTRUCT *pMouse);
+void toggleWindowMaximized(HWND hWnd);
+void minimizeWindow(HWND hWnd);
+
+// ALWAYS ON TOP
+
+void toggleAlwaysOnTop(HWND hWnd);
 
 // VIRTUAL DESKTOP
 
 bool handleMouseWheel(MSLLHOOKSTRUCT *pMouse);
+bool switchToDesktop(int index);
+bool moveWindowToDesktop(HWND hWnd, int index);
+void setupVirtualDesktops();
+void teardownVirtualDesktops();
+
+// TRANSPARENCY
 
 bool handleTransparency(MSLLHOOKSTRUCT *pMouse);
+void adjustWindowAlpha(HWND hWnd, int delta);
+
+// KEYBOARD ACTIONS
+
+void moveWindowBy(HWND hWnd, int dx, int dy);
+void resizeWindowBy(HWND hWnd, int dWidth, int dHeight);
+void moveWindowToMonitor(HWND hWnd, int monitorIndex);
 
 // HELPER FUNCTIONS
 
+HWND getTargetWindow(POINT pt);
 bool isExcludedWindow(HWND hWnd);
 bool isFullscreen(HWND hWnd);
 
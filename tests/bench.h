@@ -0,0 +1,47 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <time.h>
+
+// BENCHMARKS
+//
+// Each benchmark is a plain program that times a loop and prints the cost of one iteration.
+// The numbers are only comparable between runs on the same machine.
+
+static double benchSeconds()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/// @brief Runs `body(i)` for `iterations` iterations after a warm-up, and prints the time per iteration
+/// @return The nanoseconds per iteration
+template <typename Body>
+static double bench(const char *name, long iterations, Body body)
+{
+    for (long i = 0; i < iterations / 10; i++)
+    {
+        body(i);
+    }
+
+    double start = benchSeconds();
+    for (long i = 0; i < iterations; i++)
+    {
+        body(i);
+    }
+    double nanoseconds = (benchSeconds() - start) * 1e9 / iterations;
+
+    printf("%-48s %10.1f ns/op\n", name, nanoseconds);
+    return nanoseconds;
+}
+
+/// Keeps the compiler from optimizing away a result the benchmark does not otherwise use
+template <typename T>
+static void benchKeep(const T &value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+#endif // BENCH_H
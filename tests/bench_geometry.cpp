@@ -0,0 +1,37 @@
+#include <stdio.h>
+
+#include "bench.h"
+#include "geometry.h"
+
+// The cost of the fixed-point geometry of one mouse move of a resize, and of one frame of a zoom
+
+/// A tenth per wheel notch, as the zoom of winctrl
+const Fixed ZOOM_STEP = 72090;
+
+int main()
+{
+    const long ITERATIONS = 10 * 1000 * 1000;
+    const GeometryRect initial = {-1537, 211, -736, 812};
+    SizeLimits limits;
+    limits.minWidth = 300;
+    limits.minHeight = 200;
+    limits.maxWidth = 2400;
+    limits.maxHeight = 1600;
+
+    bench("geometry: resize an edge", ITERATIONS, [&](long i) {
+        benchKeep(moveEdges(initial, EDGE_TOP | EDGE_LEFT, (int)(i % 401) - 200, (int)(i % 301) - 150));
+    });
+
+    bench("geometry: resize the center", ITERATIONS, [&](long i) {
+        int height = initial.height() + (int)(i % 801) - 400;
+        Fixed scale = clampScale(fixedRatio(height, initial.height()), initial.width(), initial.height(), limits);
+        benchKeep(zoomAboutCenter(initial, scaleLength(initial.height(), scale)));
+    });
+
+    bench("geometry: zoom about the cursor", ITERATIONS, [&](long i) {
+        Fixed scale = clampScale(powerFixed(ZOOM_STEP, (int)(i % 49) - 24), initial.width(), initial.height(), limits);
+        benchKeep(zoomAbout(initial, initial.left + (int)(i % 800), initial.top + (int)(i % 600), scale));
+    });
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <windows.h>
+
+#include "bench.h"
+#include "events.h"
+#include "gestures.h"
+
+// The cost of recognizing one event, alone and through the mouse hook, for each kind of event the
+// hook sees while the Win key is held
+
+int main()
+{
+    const long ITERATIONS = 10 * 1000 * 1000;
+
+    GestureRecognizer gestures;
+    bench("recognizer: move while idle", ITERATIONS, [&](long i) {
+        benchKeep(gestures.move(i & 1023, 100, (uint32_t)i));
+    });
+
+    gestures.buttonDown(GESTURE_LEFT, 100, 100, 0);
+    bench("recognizer: move while pressed", ITERATIONS, [&](long i) {
+        benchKeep(gestures.move(100 + (i & 3), 100, 10));
+    });
+
+    gestures.move(200, 100, 20);
+    bench("recognizer: move while dragging", ITERATIONS, [&](long i) {
+        benchKeep(gestures.move(i & 1023, 100, (uint32_t)i));
+    });
+
+    bench("recognizer: press and release (click)", ITERATIONS, [&](long i) {
+        uint32_t time = (uint32_t)i * 1000;
+        gestures.buttonDown(GESTURE_LEFT, 100, 100, time);
+        benchKeep(gestures.buttonUp(GESTURE_LEFT, 100, 100, time + 50));
+    });
+
+    gestures.buttonDown(GESTURE_LEFT, 100, 100, 0);
+    bench("recognizer: poll while pressed", ITERATIONS, [&](long i) {
+        benchKeep(gestures.poll(100));
+    });
+
+    // Through the hook, with a window under the cursor to act on
+    fakewin::reset();
+    fakewin::createWindow(L"Notepad", {0, 0, 1920, 1040});
+    sendKey(VK_LWIN, true);
+
+    const long HOOK_ITERATIONS = 1000 * 1000;
+    bench("hook: move with Win held, no button", HOOK_ITERATIONS, [&](long i) {
+        benchKeep(sendMouse(WM_MOUSEMOVE, 100 + (i & 255), 100));
+    });
+
+    bench("hook: click with Win held", HOOK_ITERATIONS / 10, [&](long i) {
+        fakewin::advance(1000);
+        click(WM_MBUTTONDOWN, 100, 100);
+    });
+
+    sendKey(VK_LWIN, false);
+    return 0;
+}
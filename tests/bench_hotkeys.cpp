@@ -0,0 +1,66 @@
+#include <windows.h>
+#include <stdio.h>
+
+#include "bench.h"
+#include "events.h"
+#include "features.h"
+#include "hooks.h"
+#include "hotkeys.h"
+
+// The cost of matching a key press against 250 bindings, and of a key press through the hook,
+// bound or not
+
+int main()
+{
+    fakewin::reset();
+    fakewin::addMonitor({0, 0, 1920, 1080}, {0, 0, 1920, 1040});
+    static const wchar_t *const PREFIXES[] = {L"Win+", L"Win+Alt+", L"Win+Ctrl+", L"Win+Shift+",
+                                              L"Win+Alt+Shift+", L"Win+Ctrl+Shift+", L"Win+Ctrl+Alt+"};
+    const wchar_t KEYS[] = L"ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    int count = 0;
+    for (const wchar_t *prefix : PREFIXES)
+    {
+        for (int k = 0; KEYS[k] && count < 250; k++, count++)
+        {
+            wchar_t chord[32];
+            swprintf(chord, 32, L"%ls%lc", prefix, KEYS[k]);
+            fakewin::setIni(L"Hotkeys", chord, L"opacity 0");
+        }
+    }
+
+    const long ITERATIONS = 10 * 1000 * 1000;
+    bench("hotkeys: load 250 bindings", 10000, [&](long i) {
+        benchKeep(loadHotkeys());
+    });
+
+    bench("hotkeys: match, bound", ITERATIONS, [&](long i) {
+        benchKeep(matchHotkey(MOD_WIN | MOD_ALT, KEYS[i % 36]));
+    });
+
+    bench("hotkeys: match, not bound", ITERATIONS, [&](long i) {
+        benchKeep(matchHotkey(MOD_ALT, KEYS[i % 36]));
+    });
+
+    // Through the hook, with a window under the cursor to act on
+    Feature::Animations = false;
+    fakewin::createWindow(L"Notepad", {100, 100, 900, 700});
+    fakewin::setCursor(400, 400);
+    setupHooks();
+
+    const long HOOK_ITERATIONS = 1000 * 1000;
+    bench("hook: typing, no modifiers", HOOK_ITERATIONS, [&](long i) {
+        benchKeep(sendKey(KEYS[i % 36], (i & 1) == 0));
+    });
+
+    sendKey(VK_LWIN, true);
+    sendKey(VK_LMENU, true);
+    bench("hook: bound chord", HOOK_ITERATIONS / 10, [&](long i) {
+        benchKeep(sendKey(KEYS[i % 36], true));
+        fakewin::clearSentInput();
+    });
+    sendKey(VK_LMENU, false);
+    sendKey(VK_LWIN, false);
+
+    teardownHooks();
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <windows.h>
+#include <stdio.h>
+
+#include "bench.h"
+#include "fakewin.h"
+#include "layout.h"
+
+// The cost of saving and restoring the layout of a busy desktop: 200 windows of 20 processes,
+// spread over two monitors
+
+const int WINDOWS = 200;
+const int PROCESSES = 20;
+
+static HWND s_windows[WINDOWS];
+
+static RECT rectOf(int index, int shift)
+{
+    int x = (index * 37 + shift) % 3200;
+    int y = (index * 23 + shift) % 600;
+    return {x, y, x + 600, y + 400};
+}
+
+static void moveAll(int shift)
+{
+    for (int i = 0; i < WINDOWS; i++)
+    {
+        RECT r = rectOf(i, shift);
+        SetWindowPos(s_windows[i], NULL, r.left, r.top, r.right - r.left, r.bottom - r.top, SWP_NOZORDER);
+    }
+}
+
+int main()
+{
+    fakewin::reset();
+    fakewin::addMonitor({0, 0, 1920, 1080}, {0, 0, 1920, 1040});
+    fakewin::addMonitor({1920, 0, 3840, 1080}, {1920, 0, 3840, 1040});
+    for (int i = 0; i < PROCESSES; i++)
+    {
+        wchar_t image[64];
+        swprintf(image, 64, L"C:\\Apps\\app%d.exe", i);
+        fakewin::addProcess(1000 + i, image, 1);
+    }
+    for (int i = 0; i < WINDOWS; i++)
+    {
+        wchar_t title[32];
+        swprintf(title, 32, L"Document %d", i);
+        s_windows[i] = fakewin::createWindow(i % 2 ? L"AppFrame" : L"AppDialog", rectOf(i, 0), 1000 + i % PROCESSES, title);
+    }
+
+    const long ITERATIONS = 2000;
+    bench("layout: save 200 windows", ITERATIONS, [&](long i) {
+        benchKeep(saveLayout(false));
+    });
+
+    bench("layout: restore 200 windows in place", ITERATIONS, [&](long i) {
+        benchKeep(restoreLayout());
+    });
+
+    bench("layout: restore 200 moved windows", ITERATIONS, [&](long i) {
+        moveAll(1 + (int)(i & 7));
+        benchKeep(restoreLayout());
+        fakewin::deliverWinEvents();
+    });
+
+    // The right monitor is gone, so every window on it is mapped onto the left one
+    fakewin::clearMonitors();
+    fakewin::addMonitor({0, 0, 1920, 1080}, {0, 0, 1920, 1040});
+    bench("layout: restore 200 windows onto fewer monitors", ITERATIONS, [&](long i) {
+        moveAll(1 + (int)(i & 7));
+        benchKeep(restoreLayout());
+        fakewin::deliverWinEvents();
+    });
+
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include <windows.h>
+
+#include "bench.h"
+#include "fakewin.h"
+#include "profiles.h"
+
+// The cost of looking up the profile of a window: a cache hit, a hit for a process that cannot be
+// opened (which re-checks the window's thread), and a miss that resolves the process
+
+const int WINDOWS = 256;
+
+int main()
+{
+    fakewin::reset();
+    fakewin::setIni(L"Profile.Browser", L"Image", L"browser.exe");
+    fakewin::setIni(L"Profile.Console", L"Class", L"ConsoleWindowClass");
+    loadAppProfiles();
+    fakewin::addProcess(400, L"browser.exe", 1);
+    fakewin::addProcess(500, L"console.exe", 2, false);
+
+    HWND browser = fakewin::createWindow(L"BrowserFrame", {0, 0, 800, 600}, 400);
+    HWND console = fakewin::createWindow(L"ConsoleWindowClass", {0, 0, 800, 600}, 500);
+    HWND windows[WINDOWS];
+    for (int i = 0; i < WINDOWS - 2; i++)
+    {
+        windows[i] = fakewin::createWindow(L"BrowserFrame", {0, 0, 800, 600}, 400);
+    }
+
+    const long ITERATIONS = 10 * 1000 * 1000;
+    bench("profile: cached", ITERATIONS, [&](long i) {
+        benchKeep(getAppProfile(browser));
+    });
+
+    bench("profile: cached, unopenable process", ITERATIONS / 10, [&](long i) {
+        benchKeep(getAppProfile(console));
+    });
+
+    // More windows than the cache holds, so every lookup misses and evicts
+    bench("profile: miss", ITERATIONS / 100, [&](long i) {
+        benchKeep(getAppProfile(windows[i % (WINDOWS - 2)]));
+    });
+
+    clearAppProfileCache();
+    return 0;
+}
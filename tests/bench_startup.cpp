@@ -0,0 +1,119 @@
+#include <windows.h>
+#include <stdio.h>
+
+#include "animator.h"
+#include "bench.h"
+#include "fakewin.h"
+#include "features.h"
+#include "hooks.h"
+#include "hotkeys.h"
+#include "pluginapi.h"
+#include "pluginhost.h"
+#include "profiles.h"
+#include "winctrl.h"
+
+// The cost of each step of startup with a typical winctrl.ini and one plugin: parsing the
+// settings into the hotkey and profile tables, loading the plugin into the gesture registry, the
+// first desktop switch (which connects to Explorer, or reads the registry where it cannot), and
+// setupHooks as a whole, up to the hooks being installed
+
+static int WINCTRL_CALL doNothing(void *userData, const WinCtrlWindowView *view) { return 0; }
+static uint32_t WINCTRL_CALL pluginVersion() { return WINCTRL_PLUGIN_API_VERSION; }
+
+/// @brief Binds a click and a long press, as a typical plugin
+static int WINCTRL_CALL loadPlugin(const WinCtrlHost *host)
+{
+    host->bind(host->context, WINCTRL_GESTURE_ID(WINCTRL_BUTTON_LEFT, WINCTRL_GESTURE_CLICK, WINCTRL_MOD_CTRL), doNothing, NULL);
+    host->bind(host->context, WINCTRL_GESTURE_ID(WINCTRL_BUTTON_MIDDLE, WINCTRL_GESTURE_LONG_PRESS, 0), doNothing, NULL);
+    return 0;
+}
+
+static const fakewin::Symbol PLUGIN_SYMBOLS[] = {
+    {"winctrlPluginVersion", (void *)pluginVersion},
+    {"winctrlPluginLoad", (void *)loadPlugin},
+};
+
+/// @brief A winctrl.ini as it looks after some use: a screenful of hotkeys and a few profiles
+static void writeSettings()
+{
+    static const wchar_t *const HOTKEYS[][2] = {
+        {L"Win+Alt+Up", L"opacity +10"},     {L"Win+Alt+Down", L"opacity -10"},
+        {L"Win+Alt+T", L"topmost"},          {L"Win+Alt+M", L"minimize"},
+        {L"Win+Alt+X", L"maximize"},         {L"Win+Alt+C", L"center"},
+        {L"Win+Alt+Left", L"snap left"},     {L"Win+Alt+Right", L"snap right"},
+        {L"Win+Alt+Z", L"undo"},             {L"Win+Alt+Y", L"redo"},
+        {L"Win+Ctrl+F1", L"desktop 1"},      {L"Win+Ctrl+F2", L"desktop 2"},
+        {L"Win+Ctrl+F3", L"desktop 3"},      {L"Win+Ctrl+F4", L"desktop 4"},
+        {L"Win+Ctrl+Shift+F1", L"sendtodesktop 1"}, {L"Win+Ctrl+Shift+F2", L"sendtodesktop 2"},
+        {L"Win+Ctrl+Shift+F3", L"sendtodesktop 3"}, {L"Win+Ctrl+Shift+F4", L"sendtodesktop 4"},
+        {L"Win+Alt+1", L"opacity 25"},       {L"Win+Alt+0", L"opacity 100"},
+    };
+    for (const auto &hotkey : HOTKEYS)
+    {
+        fakewin::setIni(L"Hotkeys", hotkey[0], hotkey[1]);
+    }
+
+    fakewin::setIni(L"Profile.Browser", L"Image", L"browser.exe");
+    fakewin::setIni(L"Profile.Browser", L"MinWindowSize", L"300");
+    fakewin::setIni(L"Profile.BrowserPopup", L"Image", L"browser.exe");
+    fakewin::setIni(L"Profile.BrowserPopup", L"Class", L"Popup");
+    fakewin::setIni(L"Profile.BrowserPopup", L"Exclude", L"1");
+    fakewin::setIni(L"Profile.Console", L"Class", L"ConsoleWindowClass");
+    fakewin::setIni(L"Profile.Console", L"AlphaStep", L"20");
+    fakewin::setIni(L"Profile.Console", L"LiveResize", L"0");
+
+    fakewin::setIni(L"Drag", L"PredictionHorizon", L"12");
+    fakewin::setIni(L"Drag", L"ThrowSpeed", L"1500");
+    fakewin::setIni(L"Animation", L"Duration", L"120");
+}
+
+/// @brief The first switch after setup: connecting to Explorer (or reading the registry) and switching
+static void benchFirstSwitch(const char *name, fakewin::ShellRelease release)
+{
+    fakewin::setShellRelease(release);
+    bench(name, 10000, [&](long i) {
+        fakewin::setDesktops(4, 0);
+        setupVirtualDesktops();
+        benchKeep(switchToDesktop(2));
+        fakewin::runThreadPool();
+        teardownVirtualDesktops();
+    });
+}
+
+int main()
+{
+    fakewin::reset();
+    fakewin::addMonitor({0, 0, 1920, 1080}, {0, 0, 1920, 1040});
+    fakewin::addLibrary(L"plugin.dll", PLUGIN_SYMBOLS, 2);
+    writeSettings();
+    Feature::Animations = false;
+
+    const long ITERATIONS = 10000;
+    bench("startup: parse the hotkeys", ITERATIONS, [&](long i) {
+        benchKeep(loadHotkeys());
+    });
+
+    bench("startup: parse the profiles", ITERATIONS, [&](long i) {
+        benchKeep(loadAppProfiles());
+    });
+
+    bench("startup: drag and animation settings", ITERATIONS, [&](long i) {
+        loadDragSettings();
+        loadAnimationSettings();
+    });
+
+    bench("startup: load and unload a plugin", ITERATIONS, [&](long i) {
+        benchKeep(loadPlugins());
+        unloadPlugins();
+    });
+
+    benchFirstSwitch("startup: first switch, through Explorer", fakewin::SHELL_WINDOWS_11);
+    benchFirstSwitch("startup: first switch, through the registry", fakewin::SHELL_UNKNOWN);
+
+    bench("startup: setupHooks, until hooked", ITERATIONS, [&](long i) {
+        benchKeep(setupHooks());
+        teardownHooks();
+    });
+
+    return 0;
+}
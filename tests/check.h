@@ -0,0 +1,64 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+#include <string.h>
+
+// CHECKS
+//
+// Each test is a plain program: every failed check prints where it failed, and `CHECK_RESULT`
+// makes the program exit with 1 if any check failed.
+
+static int s_failedChecks = 0;
+
+#define CHECK(condition)                                                                 \
+    do                                                                                   \
+    {                                                                                    \
+        if (!(condition))                                                                \
+        {                                                                                \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            s_failedChecks++;                                                            \
+        }                                                                                \
+    } while (0)
+
+#define CHECK_EQUAL(actual, expected)                                                                  \
+    do                                                                                                 \
+    {                                                                                                  \
+        long long actualValue = (long long)(actual);                                                   \
+        long long expectedValue = (long long)(expected);                                               \
+        if (actualValue != expectedValue)                                                              \
+        {                                                                                              \
+            fprintf(stderr, "%s:%d: check failed: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, \
+                    actualValue, expectedValue);                                                       \
+            s_failedChecks++;                                                                          \
+        }                                                                                              \
+    } while (0)
+
+#define CHECK_RECT(actual, expectedLeft, expectedTop, expectedRight, expectedBottom)                              \
+    do                                                                                                        \
+    {                                                                                                         \
+        RECT actualRect = (actual);                                                                           \
+        RECT expectedRect = {(expectedLeft), (expectedTop), (expectedRight), (expectedBottom)};              \
+        if (memcmp(&actualRect, &expectedRect, sizeof(RECT)) != 0)                                            \
+        {                                                                                                     \
+            fprintf(stderr, "%s:%d: check failed: %s is {%d, %d, %d, %d}, expected {%d, %d, %d, %d}\n", __FILE__, \
+                    __LINE__, #actual, (int)actualRect.left, (int)actualRect.top, (int)actualRect.right,      \
+                    (int)actualRect.bottom, (int)expectedRect.left, (int)expectedRect.top,                    \
+                    (int)expectedRect.right, (int)expectedRect.bottom);                                       \
+            s_failedChecks++;                                                                                 \
+        }                                                                                                     \
+    } while (0)
+
+#define CHECK_RESULT()                                                               \
+    do                                                                               \
+    {                                                                                \
+        if (s_failedChecks)                                                          \
+        {                                                                            \
+            fprintf(stderr, "%s: %d check(s) failed\n", __FILE__, s_failedChecks);   \
+            return 1;                                                                \
+        }                                                                            \
+        printf("%s: passed\n", __FILE__);                                            \
+        return 0;                                                                    \
+    } while (0)
+
+#endif // CHECK_H
@@ -0,0 +1,42 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <windows.h>
+
+#include "fakewin.h"
+
+// INPUT EVENTS
+//
+// Feeds mouse and keyboard events to the hooks, as the system would, stamped with the fake clock
+
+LRESULT CALLBACK MouseProc(int nCode, WPARAM wParam, LPARAM lParam);
+LRESULT CALLBACK KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam);
+
+static LRESULT sendMouse(UINT message, int x, int y, short wheelDelta = 0)
+{
+    fakewin::setCursor(x, y);
+    MSLLHOOKSTRUCT mouse = {};
+    mouse.pt = {x, y};
+    mouse.mouseData = (DWORD)(WORD)wheelDelta << 16;
+    mouse.time = fakewin::now();
+    return MouseProc(HC_ACTION, message, (LPARAM)&mouse);
+}
+
+static LRESULT sendKey(DWORD vkCode, bool isDown)
+{
+    fakewin::setKeyDown(vkCode, isDown);
+    KBDLLHOOKSTRUCT keyboard = {};
+    keyboard.vkCode = vkCode;
+    keyboard.time = fakewin::now();
+    return KeyboardProc(HC_ACTION, isDown ? WM_KEYDOWN : WM_KEYUP, (LPARAM)&keyboard);
+}
+
+/// @brief Presses and releases a button in place, quickly enough to be a click
+static void click(UINT downMessage, int x, int y)
+{
+    sendMouse(downMessage, x, y);
+    fakewin::advance(50);
+    sendMouse(downMessage + 1, x, y);
+}
+
+#endif // EVENTS_H
@@ -0,0 +1,2643 @@
+#include <windows.h>
+#include <psapi.h>
+#include <dwmapi.h>
+#include <objbase.h>
+#include <algorithm>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <wctype.h>
+
+#include "fakewin.h"
+
+// The simulated desktop behind windows.h (see fakewin.h). All of its state lives in fixed arrays,
+// so no function here allocates. A recursive lock keeps the desktop consistent while real threads
+// (such as the animation thread) use it alongside the test.
+
+using namespace fakewin;
+
+// CONSTANTS
+// ---------
+
+const int MAX_TIMERS = 32;
+const int MAX_HANDLES = 256;
+const int MAX_WIN_EVENT_HOOKS = 8;
+const int MAX_QUEUED_WIN_EVENTS = 256;
+const int MAX_WORK_ITEMS = 64;
+const int MAX_PROCESSES = 32;
+const int MAX_INI_ENTRIES = 256;
+const int MAX_REGISTRY_VALUES = 8;
+const int MAX_FILES = 4;
+const int MAX_FILE_SIZE = 128 * 1024;
+const int MAX_SENT_INPUTS = 512;
+const int MAX_CALL_NAMES = 128;
+const int MAX_DEFERRED_POSITIONS = 256;
+const int MAX_LIBRARIES = 8;
+const int MAX_OPEN_KEYS = 4;
+const int MAX_DESKTOPS = 8;
+
+/// How long waits on real threads may take before a test gives up on them, in milliseconds
+const int REAL_WAIT_LIMIT_MS = 2000;
+
+const int SYSTEM_MIN_TRACK_X = 136;
+const int SYSTEM_MIN_TRACK_Y = 39;
+const int SYSTEM_MAX_TRACK_X = 7700;
+const int SYSTEM_MAX_TRACK_Y = 4350;
+
+const DWORD CURRENT_PROCESS_ID = 4;
+
+// STATE
+// -----
+
+enum HandleKind
+{
+    HANDLE_FREE,
+    HANDLE_THREAD,
+    HANDLE_EVENT,
+    HANDLE_PROCESS,
+    HANDLE_FILE,
+    HANDLE_MAPPING,
+    HANDLE_WAIT,
+    HANDLE_HOOK,
+};
+
+struct FakeHandle
+{
+    HandleKind kind;
+
+    // Threads
+    pthread_t thread;
+    LPTHREAD_START_ROUTINE start;
+    void *parameter;
+    volatile bool isFinished;
+
+    // Events
+    volatile bool isSignaled;
+    bool isManualReset;
+
+    // Processes
+    DWORD processId;
+
+    // Files
+    int file;
+    DWORD position;
+
+    // Mappings
+    void *view;
+    wchar_t mappingName[64];
+    bool isOpenedMapping; // Opened by name, so the view belongs to the handle that created it
+
+    // Waits
+    FakeHandle *waitedProcess;
+    WAITORTIMERCALLBACK callback;
+    void *context;
+    bool isCallbackQueued; // The process exited, and the callback waits for the thread pool
+    bool hasCallbackRun;
+};
+
+struct Timer
+{
+    UINT_PTR id; // 0 if the slot is free
+    UINT elapse;
+    TIMERPROC proc;
+    ULONGLONG due; // In microseconds
+};
+
+struct WinEventHook
+{
+    bool isActive;
+    DWORD eventMin;
+    DWORD eventMax;
+    WINEVENTPROC proc;
+    DWORD processId;
+};
+
+struct QueuedWinEvent
+{
+    DWORD event;
+    HWND hWnd;
+};
+
+struct WorkItem
+{
+    LPTHREAD_START_ROUTINE proc;
+    void *context;
+};
+
+struct Process
+{
+    DWORD processId; // 0 if the slot is free
+    wchar_t image[64];
+    ULONGLONG creationTime;
+    bool isAlive;
+    bool canOpen;
+};
+
+struct IniEntry
+{
+    wchar_t section[64];
+    wchar_t key[64];
+    wchar_t value[256];
+};
+
+struct RegistryValue
+{
+    wchar_t key[160];
+    wchar_t name[64];
+    BYTE data[1024];
+    DWORD size;
+};
+
+struct OpenKey
+{
+    bool isOpen;
+    wchar_t path[160];
+    bool isSubtreeWatched;
+    HANDLE changed; // Signaled (once) when a value under the key is set. NULL while not watched
+};
+
+struct File
+{
+    wchar_t path[MAX_PATH];
+    bool exists;
+    DWORD size;
+    BYTE data[MAX_FILE_SIZE];
+};
+
+struct Library
+{
+    wchar_t fileName[64];
+    const Symbol *symbols;
+    int symbolCount;
+    bool isLoaded;
+};
+
+struct Monitor
+{
+    RECT monitor;
+    RECT work;
+};
+
+struct DeferredPosition
+{
+    HWND hWnd;
+    HWND hWndInsertAfter;
+    int x, y, cx, cy;
+    UINT flags;
+};
+
+static pthread_mutex_t s_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+static Window s_windows[MAX_WINDOWS];
+static uintptr_t s_nextHandle = 0; // Never reset, so handles are unique across the tests of a program
+static Monitor s_monitors[MAX_MONITORS];
+static int s_monitorCount = 0;
+
+static POINT s_cursor;
+static bool s_keys[256];
+
+static volatile ULONGLONG s_timeUs = 0;
+static Timer s_timers[MAX_TIMERS];
+static UINT_PTR s_nextTimerId = 0x100;
+
+static FakeHandle s_handles[MAX_HANDLES];
+static WinEventHook s_winEventHooks[MAX_WIN_EVENT_HOOKS];
+static QueuedWinEvent s_winEvents[MAX_QUEUED_WIN_EVENTS];
+static int s_winEventCount = 0;
+static WorkItem s_workItems[MAX_WORK_ITEMS];
+static int s_workItemCount = 0;
+
+static Process s_processes[MAX_PROCESSES];
+static IniEntry s_ini[MAX_INI_ENTRIES];
+static int s_iniCount = 0;
+static RegistryValue s_registry[MAX_REGISTRY_VALUES];
+static int s_registryCount = 0;
+static OpenKey s_openKeys[MAX_OPEN_KEYS];
+
+static int s_desktopCount = 1;
+static int s_currentDesktop = 0;
+static ShellRelease s_shellRelease = SHELL_UNKNOWN;
+static int s_shellReferences = 0;
+static File s_files[MAX_FILES];
+static Library s_libraries[MAX_LIBRARIES];
+static int s_libraryCount = 0;
+static int s_librarySearch = 0; // The next library `FindNextFileW` reports
+
+static INPUT s_sentInputs[MAX_SENT_INPUTS];
+static int s_sentInputCount = 0;
+
+static pthread_t s_hookThread;
+static const char *s_callNames[MAX_CALL_NAMES];
+static int s_callCounts[MAX_CALL_NAMES];
+static int s_callNameCount = 0;
+static int s_totalCalls = 0;
+static int s_blockingUnregisters = 0;
+
+static thread_local DWORD t_lastError = 0;
+
+static DeferredPosition s_deferred[MAX_DEFERRED_POSITIONS];
+static int s_deferredCount = 0;
+static bool s_isDeferring = false;
+static int s_failingDeferredPosition = -1;
+
+// Frames and the apply gate, for threads other than the hook thread
+static volatile int s_frameTokens = 0;
+static volatile bool s_isUnlimitedFrames = true;
+static volatile int s_parkedThreads = 0;   // Waiting for a frame, or for an event
+static volatile int s_flushingThreads = 0; // Waiting for a frame
+static volatile int s_framesPresented = 0;
+static volatile bool s_isGateClosed = false;
+static volatile int s_gatedThreads = 0;
+
+struct Lock
+{
+    Lock() { pthread_mutex_lock(&s_mutex); }
+    ~Lock() { pthread_mutex_unlock(&s_mutex); }
+};
+
+// HELPER FUNCTIONS
+// ----------------
+
+static bool isHookThread() { return pthread_equal(pthread_self(), s_hookThread); }
+
+/// @brief Counts a platform call made on the hook thread. Functions that only touch memory (string
+/// functions, interlocked operations) are not platform calls, and are not counted.
+static void countCall(const char *function)
+{
+    if (!isHookThread())
+    {
+        return;
+    }
+
+    Lock lock;
+    s_totalCalls++;
+    for (int i = 0; i < s_callNameCount; i++)
+    {
+        if (s_callNames[i] == function)
+        {
+            s_callCounts[i]++;
+            return;
+        }
+    }
+    if (s_callNameCount < MAX_CALL_NAMES)
+    {
+        s_callNames[s_callNameCount] = function;
+        s_callCounts[s_callNameCount++] = 1;
+    }
+}
+
+#define PLATFORM_CALL() countCall(__func__)
+
+static void sleepMicroseconds(int microseconds)
+{
+    timespec duration = {0, microseconds * 1000L};
+    nanosleep(&duration, NULL);
+}
+
+/// @brief Spins until `condition` holds, for at most REAL_WAIT_LIMIT_MS of real time
+template <typename Condition>
+static bool waitFor(Condition condition, DWORD timeoutMs = REAL_WAIT_LIMIT_MS)
+{
+    for (DWORD waited = 0; !condition(); waited++)
+    {
+        if (timeoutMs != INFINITE && waited >= timeoutMs * 10)
+        {
+            return false;
+        }
+        sleepMicroseconds(100);
+    }
+    return true;
+}
+
+static int width(const RECT &rect) { return rect.right - rect.left; }
+static int height(const RECT &rect) { return rect.bottom - rect.top; }
+
+static Window *findWindow(HWND hWnd)
+{
+    if (!hWnd)
+    {
+        return NULL;
+    }
+    for (Window &window : s_windows)
+    {
+        if (window.hWnd == hWnd && window.isAlive)
+        {
+            return &window;
+        }
+    }
+    return NULL;
+}
+
+static Process *findProcess(DWORD processId)
+{
+    for (Process &process : s_processes)
+    {
+        if (process.processId == processId && processId != 0)
+        {
+            return &process;
+        }
+    }
+    return NULL;
+}
+
+static FakeHandle *newHandle(HandleKind kind)
+{
+    Lock lock;
+    for (FakeHandle &handle : s_handles)
+    {
+        if (handle.kind == HANDLE_FREE)
+        {
+            handle = FakeHandle();
+            handle.kind = kind;
+            return &handle;
+        }
+    }
+    return NULL;
+}
+
+static FakeHandle *toHandle(HANDLE handle, HandleKind kind)
+{
+    FakeHandle *fake = (FakeHandle *)handle;
+    if (fake < s_handles || fake >= s_handles + MAX_HANDLES || fake->kind != kind)
+    {
+        return NULL;
+    }
+    return fake;
+}
+
+static POINT workspaceOffset(const Window &window)
+{
+    POINT offset = {0, 0};
+    if (s_monitorCount > 0 && !(window.exStyle & WS_EX_TOOLWINDOW))
+    {
+        offset.x = s_monitors[0].work.left - s_monitors[0].monitor.left;
+        offset.y = s_monitors[0].work.top - s_monitors[0].monitor.top;
+    }
+    return offset;
+}
+
+static RECT offsetRect(RECT rect, int dx, int dy)
+{
+    rect.left += dx;
+    rect.right += dx;
+    rect.top += dy;
+    rect.bottom += dy;
+    return rect;
+}
+
+static int nearestMonitor(const RECT &rect)
+{
+    int best = 0;
+    long long bestArea = -1;
+    long long bestDistance = -1;
+    for (int i = 0; i < s_monitorCount; i++)
+    {
+        const RECT &m = s_monitors[i].monitor;
+        long long overlapX = (long long)std::min(rect.right, m.right) - std::max(rect.left, m.left);
+        long long overlapY = (long long)std::min(rect.bottom, m.bottom) - std::max(rect.top, m.top);
+        long long area = overlapX > 0 && overlapY > 0 ? overlapX * overlapY : 0;
+        long long dx = (rect.left + rect.right) / 2 - (m.left + m.right) / 2;
+        long long dy = (rect.top + rect.bottom) / 2 - (m.top + m.bottom) / 2;
+        long long distance = dx * dx + dy * dy;
+        if (area > bestArea || (area == bestArea && (bestDistance < 0 || distance < bestDistance)))
+        {
+            best = i;
+            bestArea = area;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+static HMONITOR toMonitorHandle(int index) { return s_monitorCount ? (HMONITOR)(uintptr_t)(index + 1) : NULL; }
+
+static void queueWinEvent(DWORD event, HWND hWnd)
+{
+    if (s_winEventCount < MAX_QUEUED_WIN_EVENTS)
+    {
+        s_winEvents[s_winEventCount++] = {event, hWnd};
+    }
+}
+
+/// @brief Moves and sizes a window the way its application would: the size is kept within the
+/// limits the window enforces
+static void placeWindow(Window &window, int x, int y, int cx, int cy, UINT flags)
+{
+    RECT rect = window.rect;
+    if (!(flags & SWP_NOSIZE))
+    {
+        if (window.minTrack.x)
+            cx = std::max(cx, (int)window.minTrack.x);
+        if (window.minTrack.y)
+            cy = std::max(cy, (int)window.minTrack.y);
+        if (window.maxTrack.x)
+            cx = std::min(cx, (int)window.maxTrack.x);
+        if (window.maxTrack.y)
+            cy = std::min(cy, (int)window.maxTrack.y);
+        rect.right = rect.left + cx;
+        rect.bottom = rect.top + cy;
+    }
+    if (!(flags & SWP_NOMOVE))
+    {
+        rect = offsetRect(rect, x - rect.left, y - rect.top);
+    }
+
+    bool isChanged = memcmp(&rect, &window.rect, sizeof(RECT)) != 0;
+    window.rect = rect;
+    if (!window.isZoomed && !window.isIconic)
+    {
+        POINT offset = workspaceOffset(window);
+        window.normalRect = offsetRect(rect, -offset.x, -offset.y);
+    }
+    if (isChanged)
+    {
+        queueWinEvent(EVENT_OBJECT_LOCATIONCHANGE, window.hWnd);
+    }
+}
+
+static void showWindow(Window &window, int command)
+{
+    POINT offset = workspaceOffset(window);
+    switch (command)
+    {
+    case SW_MAXIMIZE:
+        window.isZoomed = true;
+        window.isIconic = false;
+        window.rect = s_monitorCount ? s_monitors[nearestMonitor(window.rect)].work : window.rect;
+        break;
+    case SW_MINIMIZE:
+    case SW_SHOWMINIMIZED:
+    case SW_SHOWMINNOACTIVE:
+        window.isIconic = true;
+        break;
+    case SW_RESTORE:
+    case SW_SHOWNORMAL:
+    case SW_SHOWNOACTIVATE:
+        if (window.isIconic && window.isZoomed && command == SW_RESTORE)
+        {
+            window.isIconic = false; // A minimized maximized window restores to maximized
+            break;
+        }
+        window.isZoomed = false;
+        window.isIconic = false;
+        window.rect = offsetRect(window.normalRect, offset.x, offset.y);
+        break;
+    default:
+        break;
+    }
+    queueWinEvent(EVENT_OBJECT_LOCATIONCHANGE, window.hWnd);
+}
+
+/// @brief Threads other than the hook thread wait here while the test holds the apply gate
+static void passApplyGate()
+{
+    if (isHookThread() || !s_isGateClosed)
+    {
+        return;
+    }
+    __atomic_add_fetch(&s_gatedThreads, 1, __ATOMIC_SEQ_CST);
+    waitFor([] { return !s_isGateClosed; });
+    __atomic_sub_fetch(&s_gatedThreads, 1, __ATOMIC_SEQ_CST);
+}
+
+static size_t copyString(wchar_t *target, size_t size, const wchar_t *source)
+{
+    size_t length = wcslen(source);
+    if (length >= size)
+    {
+        length = size - 1;
+    }
+    wmemcpy(target, source, length);
+    target[length] = L'\0';
+    return length;
+}
+
+// TEST INTERFACE
+// --------------
+
+void fakewin::reset()
+{
+    Lock lock;
+    for (Window &window : s_windows)
+    {
+        window = Window();
+    }
+    s_monitorCount = 0;
+    s_cursor = {0, 0};
+    memset(s_keys, 0, sizeof(s_keys));
+    s_timeUs = 1000 * 1000 * 1000ULL; // Far from 0, so that times in the past stay positive
+    memset(s_timers, 0, sizeof(s_timers));
+    for (FakeHandle &handle : s_handles)
+    {
+        if (handle.kind == HANDLE_THREAD && !handle.isFinished)
+        {
+            continue; // Still running, its owner has not been torn down
+        }
+        handle = FakeHandle();
+    }
+    memset(s_winEventHooks, 0, sizeof(s_winEventHooks));
+    s_winEventCount = 0;
+    s_workItemCount = 0;
+    memset(s_processes, 0, sizeof(s_processes));
+    s_iniCount = 0;
+    s_registryCount = 0;
+    memset(s_openKeys, 0, sizeof(s_openKeys));
+    s_desktopCount = 1;
+    s_currentDesktop = 0;
+    s_shellRelease = SHELL_UNKNOWN;
+    s_shellReferences = 0;
+    for (File &file : s_files)
+    {
+        file.exists = false;
+        file.size = 0;
+    }
+    s_libraryCount = 0;
+    s_sentInputCount = 0;
+    s_hookThread = pthread_self();
+    s_deferredCount = 0;
+    s_isDeferring = false;
+    s_failingDeferredPosition = -1;
+    s_isUnlimitedFrames = true;
+    s_isGateClosed = false;
+    resetCalls();
+    s_blockingUnregisters = 0;
+}
+
+HWND fakewin::createWindow(const wchar_t *className, RECT rect, DWORD processId, const wchar_t *title)
+{
+    HWND hWnd = (HWND)(uintptr_t)(0x10000 + 4 * ++s_nextHandle);
+    HWND created = createWindowWithHandle(hWnd, className, rect, processId);
+    if (created)
+    {
+        copyString(window(created)->title, 64, title);
+    }
+    return created;
+}
+
+HWND fakewin::createWindowWithHandle(HWND hWnd, const wchar_t *className, RECT rect, DWORD processId)
+{
+    Lock lock;
+    for (Window &window : s_windows)
+    {
+        if (window.isAlive)
+        {
+            continue;
+        }
+
+        window = Window();
+        window.hWnd = hWnd;
+        window.isAlive = true;
+        window.isVisible = true;
+        window.rect = rect;
+        POINT offset = workspaceOffset(window);
+        window.normalRect = offsetRect(rect, -offset.x, -offset.y);
+        window.style = WS_CAPTION | WS_THICKFRAME | WS_VISIBLE;
+        window.alpha = 255;
+        window.processId = processId;
+        window.threadId = processId + 1;
+        copyString(window.className, 64, className);
+        return hWnd;
+    }
+    return NULL;
+}
+
+void fakewin::failDeferredPosition(int index)
+{
+    Lock lock;
+    s_failingDeferredPosition = index;
+}
+
+void fakewin::destroyWindow(HWND hWnd)
+{
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    if (window)
+    {
+        window->isAlive = false;
+        queueWinEvent(EVENT_OBJECT_DESTROY, hWnd);
+    }
+}
+
+Window *fakewin::window(HWND hWnd) { return findWindow(hWnd); }
+
+int fakewin::addMonitor(RECT monitor, RECT work)
+{
+    if (s_monitorCount == MAX_MONITORS)
+    {
+        return -1;
+    }
+    s_monitors[s_monitorCount] = {monitor, work};
+    return s_monitorCount++;
+}
+
+void fakewin::clearMonitors() { s_monitorCount = 0; }
+
+void fakewin::setCursor(int x, int y) { s_cursor = {x, y}; }
+void fakewin::setKeyDown(int vkCode, bool isDown) { s_keys[vkCode & 0xFF] = isDown; }
+
+DWORD fakewin::now() { return (DWORD)(s_timeUs / 1000); }
+void fakewin::advance(DWORD milliseconds) { advanceMicroseconds(milliseconds * 1000ULL); }
+void fakewin::advanceMicroseconds(ULONGLONG microseconds) { __atomic_add_fetch(&s_timeUs, microseconds, __ATOMIC_SEQ_CST); }
+
+/// @brief Calls the procedure of every timer that is due, as the message loop would
+/// @return The number of timers that fired
+int fakewin::fireTimers()
+{
+    int fired = 0;
+    for (int i = 0; i < MAX_TIMERS; i++)
+    {
+        Timer timer = s_timers[i];
+        if (!timer.id || timer.due > s_timeUs)
+        {
+            continue;
+        }
+
+        s_timers[i].due = s_timeUs + timer.elapse * 1000ULL;
+        timer.proc(NULL, WM_TIMER, timer.id, now());
+        fired++;
+    }
+    return fired;
+}
+
+int fakewin::timerCount()
+{
+    int count = 0;
+    for (const Timer &timer : s_timers)
+    {
+        count += timer.id ? 1 : 0;
+    }
+    return count;
+}
+
+/// @brief Delivers the queued WinEvents to the hooks that asked for them
+int fakewin::deliverWinEvents()
+{
+    int delivered = 0;
+    for (int i = 0; i < s_winEventCount; i++)
+    {
+        QueuedWinEvent event = s_winEvents[i];
+        Window *window = findWindow(event.hWnd);
+        for (const WinEventHook &hook : s_winEventHooks)
+        {
+            if (!hook.isActive || event.event < hook.eventMin || event.event > hook.eventMax)
+            {
+                continue;
+            }
+            if (hook.processId && (!window || window->processId != hook.processId))
+            {
+                continue;
+            }
+            hook.proc((HWINEVENTHOOK)&hook, event.event, event.hWnd, OBJID_WINDOW, CHILDID_SELF, 0, now());
+            delivered++;
+        }
+    }
+    s_winEventCount = 0;
+    return delivered;
+}
+
+/// @brief Runs the queued work items and wait callbacks on the calling thread
+int fakewin::runThreadPool()
+{
+    int ran = 0;
+    for (int i = 0; i < s_workItemCount; i++)
+    {
+        s_workItems[i].proc(s_workItems[i].context);
+        ran++;
+    }
+    s_workItemCount = 0;
+
+    for (FakeHandle &handle : s_handles)
+    {
+        if (handle.kind == HANDLE_WAIT && handle.isCallbackQueued)
+        {
+            handle.isCallbackQueued = false;
+            handle.hasCallbackRun = true;
+            handle.callback(handle.context, FALSE);
+            ran++;
+            if (!handle.waitedProcess)
+            {
+                handle = FakeHandle(); // Unregistered while the callback was queued
+            }
+        }
+    }
+    return ran;
+}
+
+void fakewin::pump()
+{
+    runThreadPool();
+    deliverWinEvents();
+    fireTimers();
+}
+
+void fakewin::resetCalls()
+{
+    Lock lock;
+    s_callNameCount = 0;
+    s_totalCalls = 0;
+}
+
+int fakewin::calls() { return s_totalCalls; }
+
+int fakewin::calls(const char *function)
+{
+    for (int i = 0; i < s_callNameCount; i++)
+    {
+        if (strcmp(s_callNames[i], function) == 0)
+        {
+            return s_callCounts[i];
+        }
+    }
+    return 0;
+}
+
+const char *fakewin::callName(int index) { return index < s_callNameCount ? s_callNames[index] : NULL; }
+int fakewin::blockingUnregisters() { return s_blockingUnregisters; }
+
+int fakewin::sentInputCount() { return s_sentInputCount; }
+const INPUT &fakewin::sentInput(int index) { return s_sentInputs[index]; }
+void fakewin::clearSentInput() { s_sentInputCount = 0; }
+
+void fakewin::addProcess(DWORD processId, const wchar_t *image, ULONGLONG creationTime, bool canOpen)
+{
+    Process *process = findProcess(processId);
+    for (int i = 0; !process && i < MAX_PROCESSES; i++)
+    {
+        if (s_processes[i].processId == 0)
+        {
+            process = &s_processes[i];
+        }
+    }
+    if (!process)
+    {
+        return;
+    }
+
+    process->processId = processId;
+    copyString(process->image, 64, image);
+    process->creationTime = creationTime;
+    process->isAlive = true;
+    process->canOpen = canOpen;
+}
+
+void fakewin::addLibrary(const wchar_t *fileName, const Symbol *symbols, int count)
+{
+    if (s_libraryCount == MAX_LIBRARIES)
+    {
+        return;
+    }
+    Library &library = s_libraries[s_libraryCount++];
+    copyString(library.fileName, 64, fileName);
+    library.symbols = symbols;
+    library.symbolCount = count;
+    library.isLoaded = false;
+}
+
+int fakewin::loadedLibraries()
+{
+    int count = 0;
+    for (int i = 0; i < s_libraryCount; i++)
+    {
+        count += s_libraries[i].isLoaded ? 1 : 0;
+    }
+    return count;
+}
+
+/// @brief Ends a process. The waits on it complete through the thread pool (see `runThreadPool`).
+void fakewin::endProcess(DWORD processId)
+{
+    Process *process = findProcess(processId);
+    if (!process)
+    {
+        return;
+    }
+
+    process->processId = 0;
+    for (FakeHandle &handle : s_handles)
+    {
+        if (handle.kind == HANDLE_WAIT && handle.waitedProcess && handle.waitedProcess->processId == processId &&
+            !handle.hasCallbackRun)
+        {
+            handle.isCallbackQueued = true;
+        }
+    }
+}
+
+int fakewin::openHandles()
+{
+    int count = 0;
+    for (const FakeHandle &handle : s_handles)
+    {
+        count += handle.kind != HANDLE_FREE && handle.kind != HANDLE_THREAD ? 1 : 0;
+    }
+    return count;
+}
+
+int fakewin::activeWaits()
+{
+    int count = 0;
+    for (const FakeHandle &handle : s_handles)
+    {
+        count += handle.kind == HANDLE_WAIT ? 1 : 0;
+    }
+    return count;
+}
+
+void fakewin::setIni(const wchar_t *section, const wchar_t *key, const wchar_t *value)
+{
+    for (int i = 0; i < s_iniCount; i++)
+    {
+        if (wcscasecmp(s_ini[i].section, section) == 0 && wcscasecmp(s_ini[i].key, key) == 0)
+        {
+            copyString(s_ini[i].value, 256, value);
+            return;
+        }
+    }
+    if (s_iniCount < MAX_INI_ENTRIES)
+    {
+        IniEntry &entry = s_ini[s_iniCount++];
+        copyString(entry.section, 64, section);
+        copyString(entry.key, 64, key);
+        copyString(entry.value, 256, value);
+    }
+}
+
+void fakewin::setRegistryValue(const wchar_t *key, const wchar_t *name, const void *data, DWORD size)
+{
+    RegistryValue *value = NULL;
+    for (int i = 0; i < s_registryCount; i++)
+    {
+        if (wcscmp(s_registry[i].key, key) == 0 && wcscmp(s_registry[i].name, name) == 0)
+        {
+            value = &s_registry[i];
+        }
+    }
+    if (!value && s_registryCount < MAX_REGISTRY_VALUES)
+    {
+        value = &s_registry[s_registryCount++];
+    }
+    if (!value || size > sizeof(value->data))
+    {
+        return;
+    }
+
+    copyString(value->key, 160, key);
+    copyString(value->name, 64, name);
+    memcpy(value->data, data, size);
+    value->size = size;
+
+    // Signals the watches on the key, and on the keys above it that watch their subtree
+    size_t keyLength = wcslen(key);
+    for (OpenKey &openKey : s_openKeys)
+    {
+        size_t length = wcslen(openKey.path);
+        bool isUnder = length < keyLength && openKey.isSubtreeWatched && key[length] == L'\\';
+        if (openKey.isOpen && openKey.changed && wcsncmp(openKey.path, key, length) == 0 && (length == keyLength || isUnder))
+        {
+            SetEvent(openKey.changed);
+            openKey.changed = NULL;
+        }
+    }
+}
+
+void fakewin::setUnlimitedFrames(bool isUnlimited) { s_isUnlimitedFrames = isUnlimited; }
+
+/// @brief Lets the thread waiting in `DwmFlush` go on to its next frame, and waits until it has
+/// computed and applied that frame (and is waiting again, for a frame or an event)
+/// @return False if no thread waits for a frame, or it did not come back within the time limit
+bool fakewin::presentFrame()
+{
+    if (s_flushingThreads == 0)
+    {
+        return false;
+    }
+    int target = s_framesPresented + 1;
+    __atomic_add_fetch(&s_frameTokens, 1, __ATOMIC_SEQ_CST);
+    return waitFor([target] { return s_framesPresented >= target && s_parkedThreads > 0; });
+}
+
+/// @brief Lets the thread waiting in `DwmFlush` go on to its next frame, without waiting for it
+void fakewin::releaseFrame() { __atomic_add_fetch(&s_frameTokens, 1, __ATOMIC_SEQ_CST); }
+
+/// @brief Waits until another thread waits for a frame
+bool fakewin::waitUntilParked()
+{
+    return waitFor([] { return s_flushingThreads > 0; });
+}
+
+void fakewin::setApplyGate(bool isClosed) { s_isGateClosed = isClosed; }
+
+bool fakewin::waitUntilGated()
+{
+    return waitFor([] { return s_gatedThreads > 0; });
+}
+
+// WINDOWS
+// -------
+
+HWND WindowFromPoint(POINT pt)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    for (int i = MAX_WINDOWS - 1; i >= 0; i--)
+    {
+        const Window &window = s_windows[i];
+        if (window.isAlive && window.isVisible && !window.isIconic && pt.x >= window.rect.left && pt.x < window.rect.right &&
+            pt.y >= window.rect.top && pt.y < window.rect.bottom)
+        {
+            return window.hWnd;
+        }
+    }
+    return NULL;
+}
+
+HWND GetAncestor(HWND hWnd, UINT)
+{
+    PLATFORM_CALL();
+    return hWnd;
+}
+
+HWND GetWindow(HWND hWnd, UINT command)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    return window && command == GW_OWNER ? window->owner : NULL;
+}
+
+BOOL IsWindow(HWND hWnd)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    return findWindow(hWnd) != NULL;
+}
+
+BOOL IsWindowVisible(HWND hWnd)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    return window && window->isVisible;
+}
+
+BOOL IsZoomed(HWND hWnd)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    return window && window->isZoomed && !window->isIconic;
+}
+
+BOOL IsIconic(HWND hWnd)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    return window && window->isIconic;
+}
+
+BOOL IsHungAppWindow(HWND hWnd)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    return window && window->isHung;
+}
+
+BOOL IsWindowArranged(HWND) { return FALSE; }
+
+BOOL GetWindowRect(HWND hWnd, RECT *rect)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    if (!window)
+    {
+        return FALSE;
+    }
+    *rect = window->rect;
+    return TRUE;
+}
+
+BOOL SetWindowPos(HWND hWnd, HWND hWndInsertAfter, int x, int y, int cx, int cy, UINT flags)
+{
+    PLATFORM_CALL();
+    passApplyGate();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    if (!window)
+    {
+        return FALSE;
+    }
+
+    if (hWndInsertAfter == HWND_TOPMOST)
+        window->exStyle |= WS_EX_TOPMOST;
+    else if (hWndInsertAfter == HWND_NOTOPMOST)
+        window->exStyle &= ~(LONG_PTR)WS_EX_TOPMOST;
+
+    placeWindow(*window, x, y, cx, cy, flags);
+    return TRUE;
+}
+
+HDWP BeginDeferWindowPos(int)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    s_isDeferring = true;
+    s_deferredCount = 0;
+    return (HDWP)&s_deferred;
+}
+
+HDWP DeferWindowPos(HDWP hdwp, HWND hWnd, HWND hWndInsertAfter, int x, int y, int cx, int cy, UINT flags)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    if (hdwp != (HDWP)&s_deferred || !findWindow(hWnd) || s_deferredCount == MAX_DEFERRED_POSITIONS ||
+        s_deferredCount == s_failingDeferredPosition)
+    {
+        s_isDeferring = false; // The whole batch is abandoned, as the system does
+        return NULL;
+    }
+    s_deferred[s_deferredCount++] = {hWnd, hWndInsertAfter, x, y, cx, cy, flags};
+    return hdwp;
+}
+
+BOOL EndDeferWindowPos(HDWP hdwp)
+{
+    PLATFORM_CALL();
+    passApplyGate();
+    Lock lock;
+    if (hdwp != (HDWP)&s_deferred || !s_isDeferring)
+    {
+        return FALSE;
+    }
+    for (int i = 0; i < s_deferredCount; i++)
+    {
+        const DeferredPosition &position = s_deferred[i];
+        Window *window = findWindow(position.hWnd);
+        if (window)
+        {
+            placeWindow(*window, position.x, position.y, position.cx, position.cy, position.flags);
+        }
+    }
+    s_isDeferring = false;
+    s_deferredCount = 0;
+    return TRUE;
+}
+
+BOOL ShowWindow(HWND hWnd, int command)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    if (!window)
+    {
+        return FALSE;
+    }
+    bool wasVisible = window->isVisible;
+    showWindow(*window, command);
+    return wasVisible;
+}
+
+BOOL ShowWindowAsync(HWND hWnd, int command) { return ShowWindow(hWnd, command); }
+
+BOOL GetWindowPlacement(HWND hWnd, WINDOWPLACEMENT *placement)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    if (!window)
+    {
+        return FALSE;
+    }
+    placement->flags = 0;
+    placement->showCmd = window->isIconic ? SW_SHOWMINIMIZED : (window->isZoomed ? SW_SHOWMAXIMIZED : SW_SHOWNORMAL);
+    placement->ptMinPosition = {-1, -1};
+    placement->ptMaxPosition = {-1, -1};
+    placement->rcNormalPosition = window->normalRect;
+    return TRUE;
+}
+
+BOOL SetWindowPlacement(HWND hWnd, const WINDOWPLACEMENT *placement)
+{
+    PLATFORM_CALL();
+    passApplyGate();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    if (!window)
+    {
+        return FALSE;
+    }
+    window->normalRect = placement->rcNormalPosition;
+    switch (placement->showCmd)
+    {
+    case SW_MAXIMIZE:
+    {
+        // The window maximizes on the monitor of its normal position
+        POINT offset = workspaceOffset(*window);
+        window->rect = offsetRect(window->normalRect, offset.x, offset.y);
+        window->isIconic = false;
+        window->isZoomed = false;
+        showWindow(*window, SW_MAXIMIZE);
+        break;
+    }
+    case SW_SHOWMINIMIZED:
+    case SW_SHOWMINNOACTIVE:
+    case SW_MINIMIZE:
+        showWindow(*window, SW_MINIMIZE);
+        break;
+    default:
+        window->isIconic = false;
+        window->isZoomed = false;
+        showWindow(*window, SW_SHOWNORMAL);
+        break;
+    }
+    return TRUE;
+}
+
+LONG_PTR GetWindowLongPtr(HWND hWnd, int index)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    if (!window)
+    {
+        return 0;
+    }
+    return index == GWL_EXSTYLE ? window->exStyle : (index == GWL_STYLE ? window->style : 0);
+}
+
+LONG GetWindowLong(HWND hWnd, int index) { return (LONG)GetWindowLongPtr(hWnd, index); }
+
+LONG_PTR SetWindowLongPtr(HWND hWnd, int index, LONG_PTR value)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    if (!window)
+    {
+        return 0;
+    }
+    LONG_PTR *target = index == GWL_EXSTYLE ? &window->exStyle : &window->style;
+    LONG_PTR previous = *target;
+    *target = value;
+    return previous;
+}
+
+BOOL GetLayeredWindowAttributes(HWND hWnd, DWORD *key, BYTE *alpha, DWORD *flags)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    if (!window || !(window->exStyle & WS_EX_LAYERED))
+    {
+        return FALSE;
+    }
+    if (key)
+        *key = 0;
+    if (alpha)
+        *alpha = window->alpha;
+    if (flags)
+        *flags = window->layeredFlags;
+    return TRUE;
+}
+
+BOOL SetLayeredWindowAttributes(HWND hWnd, DWORD, BYTE alpha, DWORD flags)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    if (!window || !(window->exStyle & WS_EX_LAYERED))
+    {
+        return FALSE;
+    }
+    window->alpha = alpha;
+    window->layeredFlags = flags;
+    return TRUE;
+}
+
+int GetClassNameW(HWND hWnd, LPWSTR name, int size)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    if (!window || size <= 0)
+    {
+        return 0;
+    }
+    return (int)copyString(name, size, window->className);
+}
+
+int GetWindowTextW(HWND hWnd, LPWSTR text, int size)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    if (!window || size <= 0)
+    {
+        return 0;
+    }
+    return (int)copyString(text, size, window->title);
+}
+
+DWORD GetWindowThreadProcessId(HWND hWnd, DWORD *processId)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    if (processId)
+    {
+        *processId = window ? window->processId : 0;
+    }
+    return window ? window->threadId : 0;
+}
+
+HWND GetDesktopWindow()
+{
+    PLATFORM_CALL();
+    return (HWND)(uintptr_t)0x10;
+}
+
+HWND GetShellWindow() { return NULL; }
+HWND FindWindowW(LPCWSTR, LPCWSTR) { return NULL; }
+HWND GetForegroundWindow() { return NULL; }
+BOOL SetForegroundWindow(HWND) { return TRUE; }
+
+BOOL EnumWindows(WNDENUMPROC proc, LPARAM lParam)
+{
+    PLATFORM_CALL();
+    for (int i = MAX_WINDOWS - 1; i >= 0; i--)
+    {
+        if (s_windows[i].isAlive && !proc(s_windows[i].hWnd, lParam))
+        {
+            break;
+        }
+    }
+    return TRUE;
+}
+
+LRESULT SendMessageTimeoutW(HWND hWnd, UINT message, WPARAM, LPARAM lParam, UINT, UINT timeout, ULONG_PTR *result)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    if (!window || window->isHung)
+    {
+        SetLastError(ERROR_TIMEOUT);
+        return 0;
+    }
+    if (message == WM_GETMINMAXINFO)
+    {
+        MINMAXINFO *info = (MINMAXINFO *)lParam;
+        if (window->minTrack.x)
+            info->ptMinTrackSize = window->minTrack;
+        if (window->maxTrack.x)
+            info->ptMaxTrackSize = window->maxTrack;
+    }
+    if (result)
+    {
+        *result = 0;
+    }
+    return 1;
+}
+
+LRESULT SendMessage(HWND, UINT, WPARAM, LPARAM) { return 0; }
+
+// MONITORS
+// --------
+
+HMONITOR MonitorFromWindow(HWND hWnd, DWORD)
+{
+    PLATFORM_CALL();
+    Lock lock;
+    Window *window = findWindow(hWnd);
+    return toMonitorHandle(window ? nearestMonitor(window->rect) : 0);
+}
+
+HMONITOR MonitorFromPoint(POINT pt, DWORD flags)
+{
+    PLATFORM_CALL();
+    for (int i = 0; i < s_monitorCount; i++)
+    {
+        const RECT &m = s_monitors[i].monitor;
+        if (pt.x >= m.left && pt.x < m.right && pt.y >= m.top && pt.y < m.bottom)
+        {
+            return toMonitorHandle(i);
+        }
+    }
+    if (flags == MONITOR_DEFAULTTONULL)
+    {
+        return NULL;
+    }
+    RECT point = {pt.x, pt.y, pt.x + 1, pt.y + 1};
+    return toMonitorHandle(flags == MONITOR_DEFAULTTOPRIMARY ? 0 : nearestMonitor(point));
+}
+
+HMONITOR MonitorFromRect(const RECT *rect, DWORD)
+{
+    PLATFORM_CALL();
+    return toMonitorHandle(nearestMonitor(*rect));
+}
+
+BOOL GetMonitorInfoW(HMONITOR hMonitor, MONITORINFO *info)
+{
+    PLATFORM_CALL();
+    int index = (int)(uintptr_t)hMonitor - 1;
+    if (index < 0 || index >= s_monitorCount)
+    {
+        return FALSE;
+    }
+    info->rcMonitor = s_monitors[index].monitor;
+    info->rcWork = s_monitors[index].work;
+    info->dwFlags = index == 0 ? 1 : 0;
+    return TRUE;
+}
+
+BOOL GetMonitorInfo(HMONITOR hMonitor, MONITORINFO *info) { return GetMonitorInfoW(hMonitor, info); }
+
+BOOL EnumDisplayMonitors(HDC, const RECT *, MONITORENUMPROC proc, LPARAM lParam)
+{
+    PLATFORM_CALL();
+    for (int i = 0; i < s_monitorCount; i++)
+    {
+        RECT rect = s_monitors[i].monitor;
+        if (!proc(toMonitorHandle(i), NULL, &rect, lParam))
+        {
+            break;
+        }
+    }
+    return TRUE;
+}
+
+int GetSystemMetrics(int index)
+{
+    PLATFORM_CALL();
+    switch (index)
+    {
+    case SM_CXSCREEN:
+        return s_monitorCount ? width(s_monitors[0].monitor) : 0;
+    case SM_CYSCREEN:
+        return s_monitorCount ? height(s_monitors[0].monitor) : 0;
+    case SM_CXMINTRACK:
+        return SYSTEM_MIN_TRACK_X;
+    case SM_CYMINTRACK:
+        return SYSTEM_MIN_TRACK_Y;
+    case SM_CXMAXTRACK:
+        return SYSTEM_MAX_TRACK_X;
+    case SM_CYMAXTRACK:
+        return SYSTEM_MAX_TRACK_Y;
+    default:
+        return 0;
+    }
+}
+
+BOOL SystemParametersInfo(UINT action, UINT, void *value, UINT)
+{
+    PLATFORM_CALL();
+    if (action == SPI_GETCLIENTAREAANIMATION)
+    {
+        *(BOOL *)value = TRUE;
+    }
+    return TRUE;
+}
+
+BOOL SetRect(RECT *rect, int left, int top, int right, int bottom)
+{
+    *rect = {left, top, right, bottom};
+    return TRUE;
+}
+
+BOOL OffsetRect(RECT *rect, int dx, int dy)
+{
+    *rect = offsetRect(*rect, dx, dy);
+    return TRUE;
+}
+
+// INPUT
+// -----
+
+BOOL GetCursorPos(POINT *pt)
+{
+    PLATFORM_CALL();
+    *pt = s_cursor;
+    return TRUE;
+}
+
+short GetAsyncKeyState(int vkCode)
+{
+    PLATFORM_CALL();
+    bool isDown = s_keys[vkCode & 0xFF];
+    if (vkCode == VK_CONTROL)
+        isDown = s_keys[VK_LCONTROL] || s_keys[VK_RCONTROL] || s_keys[VK_CONTROL];
+    else if (vkCode == VK_SHIFT)
+        isDown = s_keys[VK_LSHIFT] || s_keys[VK_RSHIFT] || s_keys[VK_SHIFT];
+    else if (vkCode == VK_MENU)
+        isDown = s_keys[VK_LMENU] || s_keys[VK_RMENU] || s_keys[VK_MENU];
+    return isDown ? (short)0x8000 : 0;
+}
+
+short GetKeyState(int vkCode) { return GetAsyncKeyState(vkCode); }
+
+UINT SendInput(UINT count, INPUT *inputs, int)
+{
+    PLATFORM_CALL();
+    for (UINT i = 0; i < count && s_sentInputCount < MAX_SENT_INPUTS; i++)
+    {
+        s_sentInputs[s_sentInputCount++] = inputs[i];
+    }
+    return count;
+}
+
+UINT GetDoubleClickTime()
+{
+    PLATFORM_CALL();
+    return 500;
+}
+
+BOOL GetLastInputInfo(LASTINPUTINFO *info)
+{
+    PLATFORM_CALL();
+    info->dwTime = now();
+    return TRUE;
+}
+
+// HOOKS AND TIMERS
+// ----------------
+
+HHOOK SetWindowsHookEx(int, HOOKPROC, HINSTANCE, DWORD)
+{
+    PLATFORM_CALL();
+    return (HHOOK)newHandle(HANDLE_HOOK);
+}
+
+BOOL UnhookWindowsHookEx(HHOOK hHook)
+{
+    PLATFORM_CALL();
+    FakeHandle *handle = toHandle(hHook, HANDLE_HOOK);
+    if (handle)
+    {
+        *handle = FakeHandle();
+    }
+    return handle != NULL;
+}
+
+LRESULT CallNextHookEx(HHOOK, int, WPARAM, LPARAM)
+{
+    PLATFORM_CALL();
+    return 0;
+}
+
+HWINEVENTHOOK SetWinEventHook(DWORD eventMin, DWORD eventMax, HMODULE, WINEVENTPROC proc, DWORD processId, DWORD, DWORD)
+{
+    PLATFORM_CALL();
+    for (WinEventHook &hook : s_winEventHooks)
+    {
+        if (!hook.isActive)
+        {
+            hook = {true, eventMin, eventMax, proc, processId};
+            return (HWINEVENTHOOK)&hook;
+        }
+    }
+    return NULL;
+}
+
+BOOL UnhookWinEvent(HWINEVENTHOOK hHook)
+{
+    PLATFORM_CALL();
+    for (WinEventHook &hook : s_winEventHooks)
+    {
+        if ((HWINEVENTHOOK)&hook == hHook)
+        {
+            hook.isActive = false;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+UINT_PTR SetTimer(HWND, UINT_PTR id, UINT elapse, TIMERPROC proc)
+{
+    PLATFORM_CALL();
+    Timer *slot = NULL;
+    for (Timer &timer : s_timers)
+    {
+        if (id && timer.id == id)
+        {
+            slot = &timer;
+            break;
+        }
+        if (!slot && !timer.id)
+        {
+            slot = &timer;
+        }
+    }
+    if (!slot)
+    {
+        return 0;
+    }
+
+    slot->id = id ? id : s_nextTimerId++;
+    slot->elapse = elapse;
+    slot->proc = proc;
+    slot->due = s_timeUs + elapse * 1000ULL;
+    return slot->id;
+}
+
+BOOL KillTimer(HWND, UINT_PTR id)
+{
+    PLATFORM_CALL();
+    for (Timer &timer : s_timers)
+    {
+        if (id && timer.id == id)
+        {
+            timer = Timer();
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+// MESSAGES
+// --------
+
+BOOL GetMessage(MSG *, HWND, UINT, UINT) { return FALSE; }
+BOOL PeekMessage(MSG *, HWND, UINT, UINT, UINT) { return FALSE; }
+BOOL TranslateMessage(const MSG *) { return TRUE; }
+LRESULT DispatchMessage(const MSG *) { return 0; }
+void PostQuitMessage(int) {}
+BOOL PostThreadMessage(DWORD, UINT, WPARAM, LPARAM) { return TRUE; }
+BOOL PostMessage(HWND, UINT, WPARAM, LPARAM) { return TRUE; }
+LRESULT DefWindowProc(HWND, UINT, WPARAM, LPARAM) { return 0; }
+ATOM RegisterClassEx(const WNDCLASSEX *) { return 1; }
+HWND CreateWindowEx(DWORD, LPCWSTR, LPCWSTR, DWORD, int, int, int, int, HWND, HMENU, HINSTANCE, LPVOID) { return NULL; }
+BOOL DestroyWindow(HWND hWnd)
+{
+    destroyWindow(hWnd);
+    return TRUE;
+}
+
+HICON LoadIcon(HINSTANCE, LPCWSTR) { return NULL; }
+HMODULE GetModuleHandle(LPCWSTR) { return NULL; }
+BOOL Shell_NotifyIcon(DWORD, NOTIFYICONDATA *) { return TRUE; }
+int MessageBox(HWND, LPCWSTR, LPCWSTR, UINT) { return 0; }
+int MessageBoxW(HWND, LPCWSTR, LPCWSTR, UINT) { return 0; }
+HMENU CreatePopupMenu() { return NULL; }
+BOOL AppendMenu(HMENU, UINT, UINT_PTR, LPCWSTR) { return TRUE; }
+BOOL TrackPopupMenu(HMENU, UINT, int, int, int, HWND, const RECT *) { return TRUE; }
+BOOL DestroyMenu(HMENU) { return TRUE; }
+
+// TIME
+// ----
+
+DWORD GetTickCount()
+{
+    PLATFORM_CALL();
+    return now();
+}
+
+ULONGLONG GetTickCount64()
+{
+    PLATFORM_CALL();
+    return s_timeUs / 1000;
+}
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER *counter)
+{
+    PLATFORM_CALL();
+    counter->QuadPart = (LONGLONG)s_timeUs;
+    return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER *frequency)
+{
+    PLATFORM_CALL();
+    frequency->QuadPart = 1000 * 1000;
+    return TRUE;
+}
+
+void GetSystemTimeAsFileTime(FILETIME *time)
+{
+    ULONGLONG ticks = s_timeUs * 10;
+    time->dwLowDateTime = (DWORD)ticks;
+    time->dwHighDateTime = (DWORD)(ticks >> 32);
+}
+
+void GetSystemTimePreciseAsFileTime(FILETIME *time) { GetSystemTimeAsFileTime(time); }
+
+// PROCESSES
+// ---------
+
+HANDLE GetCurrentProcess() { return INVALID_HANDLE_VALUE; }
+DWORD GetCurrentProcessId() { return CURRENT_PROCESS_ID; }
+DWORD GetCurrentThreadId() { return (DWORD)(uintptr_t)pthread_self(); }
+
+BOOL ProcessIdToSessionId(DWORD, DWORD *sessionId)
+{
+    PLATFORM_CALL();
+    *sessionId = 1;
+    return TRUE;
+}
+
+HANDLE OpenProcess(DWORD, BOOL, DWORD processId)
+{
+    PLATFORM_CALL();
+    Process *process = findProcess(processId);
+    if (!process || !process->canOpen)
+    {
+        return NULL;
+    }
+    FakeHandle *handle = newHandle(HANDLE_PROCESS);
+    if (handle)
+    {
+        handle->processId = processId;
+    }
+    return handle;
+}
+
+BOOL QueryFullProcessImageNameW(HANDLE hProcess, DWORD, LPWSTR path, DWORD *size)
+{
+    PLATFORM_CALL();
+    FakeHandle *handle = toHandle(hProcess, HANDLE_PROCESS);
+    Process *process = handle ? findProcess(handle->processId) : NULL;
+    if (!process)
+    {
+        return FALSE;
+    }
+    wchar_t fullPath[MAX_PATH];
+    swprintf(fullPath, MAX_PATH, L"C:\\Apps\\%ls", process->image);
+    *size = (DWORD)copyString(path, *size, fullPath);
+    return TRUE;
+}
+
+BOOL GetProcessTimes(HANDLE hProcess, FILETIME *creation, FILETIME *exit, FILETIME *kernel, FILETIME *user)
+{
+    PLATFORM_CALL();
+    ULONGLONG creationTime = 0;
+    if (hProcess != INVALID_HANDLE_VALUE)
+    {
+        FakeHandle *handle = toHandle(hProcess, HANDLE_PROCESS);
+        Process *process = handle ? findProcess(handle->processId) : NULL;
+        if (!process)
+        {
+            return FALSE;
+        }
+        creationTime = process->creationTime;
+    }
+    creation->dwLowDateTime = (DWORD)creationTime;
+    creation->dwHighDateTime = (DWORD)(creationTime >> 32);
+    *exit = *kernel = *user = FILETIME();
+    return TRUE;
+}
+
+BOOL SetProcessWorkingSetSize(HANDLE, SIZE_T, SIZE_T)
+{
+    PLATFORM_CALL();
+    return TRUE;
+}
+
+BOOL GetProcessMemoryInfo(HANDLE, PROCESS_MEMORY_COUNTERS *counters, DWORD)
+{
+    memset(counters, 0, sizeof(*counters));
+    return TRUE;
+}
+
+BOOL K32GetProcessMemoryInfo(HANDLE process, PROCESS_MEMORY_COUNTERS *counters, DWORD size) { return GetProcessMemoryInfo(process, counters, size); }
+BOOL EmptyWorkingSet(HANDLE) { return TRUE; }
+
+BOOL CloseHandle(HANDLE hObject)
+{
+    PLATFORM_CALL();
+    FakeHandle *handle = (FakeHandle *)hObject;
+    if (handle < s_handles || handle >= s_handles + MAX_HANDLES || handle->kind == HANDLE_FREE)
+    {
+        return FALSE;
+    }
+
+    Lock lock;
+    if (handle->kind == HANDLE_THREAD)
+    {
+        if (handle->isFinished)
+            pthread_join(handle->thread, NULL);
+        else
+            pthread_detach(handle->thread);
+    }
+    if (handle->kind == HANDLE_MAPPING && !handle->isOpenedMapping)
+    {
+        free(handle->view);
+    }
+    *handle = FakeHandle();
+    return TRUE;
+}
+
+// THREAD POOL
+// -----------
+
+BOOL QueueUserWorkItem(LPTHREAD_START_ROUTINE proc, PVOID context, DWORD)
+{
+    PLATFORM_CALL();
+    if (s_workItemCount == MAX_WORK_ITEMS)
+    {
+        return FALSE;
+    }
+    s_workItems[s_workItemCount++] = {proc, context};
+    return TRUE;
+}
+
+BOOL RegisterWaitForSingleObject(HANDLE *wait, HANDLE hObject, WAITORTIMERCALLBACK callback, void *context, DWORD, DWORD)
+{
+    PLATFORM_CALL();
+    FakeHandle *process = toHandle(hObject, HANDLE_PROCESS);
+    FakeHandle *handle = process ? newHandle(HANDLE_WAIT) : NULL;
+    if (!handle)
+    {
+        return FALSE;
+    }
+    handle->waitedProcess = process;
+    handle->callback = callback;
+    handle->context = context;
+    handle->isCallbackQueued = !findProcess(process->processId);
+    *wait = handle;
+    return TRUE;
+}
+
+/// @brief Unregisters a wait. Without a completion event this does not wait for a queued callback:
+/// it fails with ERROR_IO_PENDING, and the callback still runs. With INVALID_HANDLE_VALUE, it blocks
+/// until the callback is done, which tests count as a stall (see `blockingUnregisters`).
+BOOL UnregisterWaitEx(HANDLE hWait, HANDLE completion)
+{
+    PLATFORM_CALL();
+    FakeHandle *handle = toHandle(hWait, HANDLE_WAIT);
+    if (!handle)
+    {
+        return FALSE;
+    }
+
+    if (handle->isCallbackQueued)
+    {
+        if (completion == INVALID_HANDLE_VALUE)
+        {
+            s_blockingUnregisters++;
+            handle->isCallbackQueued = false;
+            handle->callback(handle->context, FALSE);
+        }
+        else
+        {
+            handle->waitedProcess = NULL; // Freed once the thread pool has run the callback
+            SetLastError(ERROR_IO_PENDING);
+            return FALSE;
+        }
+    }
+
+    *handle = FakeHandle();
+    return TRUE;
+}
+
+BOOL UnregisterWait(HANDLE hWait) { return UnregisterWaitEx(hWait, NULL); }
+
+// THREADS AND SYNCHRONIZATION
+// ---------------------------
+
+static void *runThread(void *parameter)
+{
+    FakeHandle *handle = (FakeHandle *)parameter;
+    handle->start(handle->parameter);
+    handle->isFinished = true;
+    return NULL;
+}
+
+HANDLE CreateThread(SECURITY_ATTRIBUTES *, SIZE_T, LPTHREAD_START_ROUTINE start, LPVOID parameter, DWORD, DWORD *threadId)
+{
+    PLATFORM_CALL();
+    FakeHandle *handle = newHandle(HANDLE_THREAD);
+    if (!handle)
+    {
+        return NULL;
+    }
+    handle->start = start;
+    handle->parameter = parameter;
+    if (pthread_create(&handle->thread, NULL, runThread, handle) != 0)
+    {
+        *handle = FakeHandle();
+        return NULL;
+    }
+    if (threadId)
+    {
+        *threadId = (DWORD)(uintptr_t)handle->thread;
+    }
+    return handle;
+}
+
+HANDLE CreateEventW(SECURITY_ATTRIBUTES *, BOOL isManualReset, BOOL isSignaled, LPCWSTR)
+{
+    PLATFORM_CALL();
+    FakeHandle *handle = newHandle(HANDLE_EVENT);
+    if (handle)
+    {
+        handle->isManualReset = isManualReset;
+        handle->isSignaled = isSignaled;
+    }
+    return handle;
+}
+
+BOOL SetEvent(HANDLE hEvent)
+{
+    PLATFORM_CALL();
+    FakeHandle *handle = toHandle(hEvent, HANDLE_EVENT);
+    if (handle)
+    {
+        __atomic_store_n(&handle->isSignaled, true, __ATOMIC_SEQ_CST);
+    }
+    return handle != NULL;
+}
+
+BOOL ResetEvent(HANDLE hEvent)
+{
+    FakeHandle *handle = toHandle(hEvent, HANDLE_EVENT);
+    if (handle)
+    {
+        __atomic_store_n(&handle->isSignaled, false, __ATOMIC_SEQ_CST);
+    }
+    return handle != NULL;
+}
+
+DWORD WaitForSingleObject(HANDLE hObject, DWORD timeoutMs)
+{
+    PLATFORM_CALL();
+    FakeHandle *handle = (FakeHandle *)hObject;
+    if (handle < s_handles || handle >= s_handles + MAX_HANDLES)
+    {
+        return WAIT_TIMEOUT;
+    }
+
+    if (handle->kind == HANDLE_THREAD)
+    {
+        return waitFor([handle] { return handle->isFinished; }, timeoutMs) ? WAIT_OBJECT_0 : WAIT_TIMEOUT;
+    }
+
+    if (handle->kind == HANDLE_EVENT)
+    {
+        bool isParked = !isHookThread();
+        if (isParked)
+            __atomic_add_fetch(&s_parkedThreads, 1, __ATOMIC_SEQ_CST);
+
+        bool isSignaled = waitFor(
+            [handle] {
+                return handle->isManualReset ? handle->isSignaled : __atomic_exchange_n(&handle->isSignaled, false, __ATOMIC_SEQ_CST);
+            },
+            isParked ? INFINITE : timeoutMs);
+
+        if (isParked)
+            __atomic_sub_fetch(&s_parkedThreads, 1, __ATOMIC_SEQ_CST);
+        return isSignaled ? WAIT_OBJECT_0 : WAIT_TIMEOUT;
+    }
+    return WAIT_TIMEOUT;
+}
+
+void Sleep(DWORD milliseconds)
+{
+    PLATFORM_CALL();
+    sleepMicroseconds(milliseconds * 1000);
+}
+
+void InitializeSRWLock(SRWLOCK *lock) { lock->Ptr = NULL; }
+
+void AcquireSRWLockExclusive(SRWLOCK *lock)
+{
+    void *expected = NULL;
+    while (!__atomic_compare_exchange_n(&lock->Ptr, &expected, (void *)1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+        expected = NULL;
+        sched_yield();
+    }
+}
+
+void ReleaseSRWLockExclusive(SRWLOCK *lock) { __atomic_store_n(&lock->Ptr, (void *)NULL, __ATOMIC_RELEASE); }
+
+/// A condition variable is a generation count: waking bumps it, and sleepers wait for it to change
+BOOL SleepConditionVariableSRW(CONDITION_VARIABLE *condition, SRWLOCK *lock, DWORD timeoutMs, DWORD)
+{
+    PLATFORM_CALL();
+    uintptr_t generation = (uintptr_t)__atomic_load_n(&condition->Ptr, __ATOMIC_SEQ_CST);
+    ReleaseSRWLockExclusive(lock);
+    bool isWoken = waitFor([condition, generation] { return (uintptr_t)__atomic_load_n(&condition->Ptr, __ATOMIC_SEQ_CST) != generation; },
+                           timeoutMs);
+    AcquireSRWLockExclusive(lock);
+    if (!isWoken)
+    {
+        SetLastError(ERROR_TIMEOUT);
+    }
+    return isWoken;
+}
+
+void WakeAllConditionVariable(CONDITION_VARIABLE *condition) { __atomic_add_fetch((uintptr_t *)&condition->Ptr, 1, __ATOMIC_SEQ_CST); }
+void WakeConditionVariable(CONDITION_VARIABLE *condition) { WakeAllConditionVariable(condition); }
+
+void InitializeCriticalSection(CRITICAL_SECTION *) {}
+void EnterCriticalSection(CRITICAL_SECTION *) {}
+void LeaveCriticalSection(CRITICAL_SECTION *) {}
+void DeleteCriticalSection(CRITICAL_SECTION *) {}
+
+LONG InterlockedExchange(volatile LONG *target, LONG value) { return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST); }
+
+LONG InterlockedCompareExchange(volatile LONG *target, LONG exchange, LONG comparand)
+{
+    __atomic_compare_exchange_n(target, &comparand, exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return comparand;
+}
+
+LONG InterlockedIncrement(volatile LONG *target) { return __atomic_add_fetch(target, 1, __ATOMIC_SEQ_CST); }
+
+DWORD GetLastError() { return t_lastError; }
+void SetLastError(DWORD error) { t_lastError = error; }
+
+// COMPOSITION
+// -----------
+
+/// @brief Threads other than the hook thread wait here for the test to present the next frame
+HRESULT DwmFlush()
+{
+    PLATFORM_CALL();
+    if (isHookThread())
+    {
+        return S_OK;
+    }
+
+    __atomic_add_fetch(&s_parkedThreads, 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&s_flushingThreads, 1, __ATOMIC_SEQ_CST);
+    waitFor([] {
+        if (s_isUnlimitedFrames)
+        {
+            return true;
+        }
+        int tokens = __atomic_load_n(&s_frameTokens, __ATOMIC_SEQ_CST);
+        return tokens > 0 && __atomic_compare_exchange_n(&s_frameTokens, &tokens, tokens - 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    },
+            INFINITE);
+    __atomic_sub_fetch(&s_flushingThreads, 1, __ATOMIC_SEQ_CST);
+    __atomic_sub_fetch(&s_parkedThreads, 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&s_framesPresented, 1, __ATOMIC_SEQ_CST);
+
+    if (s_isUnlimitedFrames)
+    {
+        sleepMicroseconds(200);
+    }
+    return S_OK;
+}
+
+// SETTINGS
+// --------
+
+DWORD GetModuleFileNameW(HMODULE, LPWSTR path, DWORD size)
+{
+    PLATFORM_CALL();
+    return (DWORD)copyString(path, size, L"C:\\WinCtrl\\winctrl.exe");
+}
+
+static const IniEntry *findIniEntry(LPCWSTR section, LPCWSTR key)
+{
+    for (int i = 0; i < s_iniCount; i++)
+    {
+        if (wcscasecmp(s_ini[i].section, section) == 0 && wcscasecmp(s_ini[i].key, key) == 0)
+        {
+            return &s_ini[i];
+        }
+    }
+    return NULL;
+}
+
+DWORD GetPrivateProfileStringW(LPCWSTR section, LPCWSTR key, LPCWSTR fallback, LPWSTR value, DWORD size, LPCWSTR)
+{
+    PLATFORM_CALL();
+    const IniEntry *entry = findIniEntry(section, key);
+    return (DWORD)copyString(value, size, entry ? entry->value : fallback);
+}
+
+UINT GetPrivateProfileIntW(LPCWSTR section, LPCWSTR key, int fallback, LPCWSTR)
+{
+    PLATFORM_CALL();
+    const IniEntry *entry = findIniEntry(section, key);
+    return entry ? (UINT)wcstol(entry->value, NULL, 10) : (UINT)fallback;
+}
+
+/// @brief Appends `text` and its terminator to a double-null-terminated list
+static bool appendToList(LPWSTR list, DWORD size, DWORD *length, const wchar_t *text)
+{
+    size_t textLength = wcslen(text);
+    if (*length + textLength + 2 > size)
+    {
+        return false;
+    }
+    wmemcpy(list + *length, text, textLength + 1);
+    *length += (DWORD)textLength + 1;
+    list[*length] = L'\0';
+    return true;
+}
+
+DWORD GetPrivateProfileSectionW(LPCWSTR section, LPWSTR list, DWORD size, LPCWSTR)
+{
+    PLATFORM_CALL();
+    DWORD length = 0;
+    list[0] = list[1] = L'\0';
+    for (int i = 0; i < s_iniCount; i++)
+    {
+        if (wcscasecmp(s_ini[i].section, section) != 0)
+        {
+            continue;
+        }
+        wchar_t line[324];
+        swprintf(line, 324, L"%ls=%ls", s_ini[i].key, s_ini[i].value);
+        if (!appendToList(list, size, &length, line))
+        {
+            break;
+        }
+    }
+    return length;
+}
+
+DWORD GetPrivateProfileSectionNamesW(LPWSTR list, DWORD size, LPCWSTR)
+{
+    PLATFORM_CALL();
+    DWORD length = 0;
+    list[0] = list[1] = L'\0';
+    for (int i = 0; i < s_iniCount; i++)
+    {
+        bool isListed = false;
+        for (int j = 0; j < i && !isListed; j++)
+        {
+            isListed = wcscasecmp(s_ini[j].section, s_ini[i].section) == 0;
+        }
+        if (!isListed && !appendToList(list, size, &length, s_ini[i].section))
+        {
+            break;
+        }
+    }
+    return length;
+}
+
+LONG RegGetValueW(HKEY, LPCWSTR key, LPCWSTR name, DWORD, DWORD *, void *data, DWORD *size)
+{
+    PLATFORM_CALL();
+    for (int i = 0; i < s_registryCount; i++)
+    {
+        const RegistryValue &value = s_registry[i];
+        if (wcscmp(value.key, key) != 0 || wcscmp(value.name, name) != 0)
+        {
+            continue;
+        }
+        if (*size < value.size)
+        {
+            *size = value.size;
+            return 234; // ERROR_MORE_DATA
+        }
+        memcpy(data, value.data, value.size);
+        *size = value.size;
+        return ERROR_SUCCESS;
+    }
+    return 2; // ERROR_FILE_NOT_FOUND
+}
+
+/// @brief Opens a key that has values, or keys with values, under it
+LONG RegOpenKeyExW(HKEY, LPCWSTR path, DWORD, DWORD, HKEY *result)
+{
+    PLATFORM_CALL();
+    size_t length = wcslen(path);
+    bool exists = false;
+    for (int i = 0; i < s_registryCount; i++)
+    {
+        const wchar_t *key = s_registry[i].key;
+        exists |= wcsncmp(key, path, length) == 0 && (key[length] == 0 || key[length] == L'\\');
+    }
+
+    for (OpenKey &openKey : s_openKeys)
+    {
+        if (exists && !openKey.isOpen)
+        {
+            openKey = OpenKey();
+            openKey.isOpen = true;
+            copyString(openKey.path, 160, path);
+            *result = (HKEY)&openKey;
+            return ERROR_SUCCESS;
+        }
+    }
+    return 2; // ERROR_FILE_NOT_FOUND
+}
+
+static OpenKey *toOpenKey(HKEY hKey)
+{
+    OpenKey *openKey = (OpenKey *)hKey;
+    return openKey >= s_openKeys && openKey < s_openKeys + MAX_OPEN_KEYS && openKey->isOpen ? openKey : NULL;
+}
+
+/// @brief Watches a key until the next change. Only asynchronous watches are simulated.
+LONG RegNotifyChangeKeyValue(HKEY hKey, BOOL watchSubtree, DWORD, HANDLE event, BOOL isAsynchronous)
+{
+    PLATFORM_CALL();
+    OpenKey *openKey = toOpenKey(hKey);
+    if (!openKey || !isAsynchronous)
+    {
+        return 6; // ERROR_INVALID_HANDLE
+    }
+    openKey->isSubtreeWatched = watchSubtree;
+    openKey->changed = event;
+    return ERROR_SUCCESS;
+}
+
+LONG RegCloseKey(HKEY hKey)
+{
+    PLATFORM_CALL();
+    OpenKey *openKey = toOpenKey(hKey);
+    if (!openKey)
+    {
+        return 6; // ERROR_INVALID_HANDLE
+    }
+    openKey->isOpen = false;
+    return ERROR_SUCCESS;
+}
+
+// FILES
+// -----
+
+HANDLE CreateFileW(LPCWSTR path, DWORD access, DWORD, SECURITY_ATTRIBUTES *, DWORD disposition, DWORD, HANDLE)
+{
+    PLATFORM_CALL();
+    File *file = NULL;
+    for (File &candidate : s_files)
+    {
+        if (candidate.exists && wcscmp(candidate.path, path) == 0)
+        {
+            file = &candidate;
+        }
+    }
+    if (!file && disposition == OPEN_EXISTING)
+    {
+        return INVALID_HANDLE_VALUE;
+    }
+    for (int i = 0; !file && i < MAX_FILES; i++)
+    {
+        if (!s_files[i].exists)
+        {
+            file = &s_files[i];
+            copyString(file->path, MAX_PATH, path);
+            file->exists = true;
+        }
+    }
+
+    FakeHandle *handle = file ? newHandle(HANDLE_FILE) : NULL;
+    if (!handle)
+    {
+        return INVALID_HANDLE_VALUE;
+    }
+    if (disposition == CREATE_ALWAYS || (access & GENERIC_WRITE && disposition != OPEN_EXISTING))
+    {
+        file->size = 0;
+    }
+    handle->file = (int)(file - s_files);
+    handle->position = 0;
+    return handle;
+}
+
+BOOL WriteFile(HANDLE hFile, const void *data, DWORD size, DWORD *written, void *)
+{
+    PLATFORM_CALL();
+    FakeHandle *handle = toHandle(hFile, HANDLE_FILE);
+    if (!handle || handle->position + size > MAX_FILE_SIZE)
+    {
+        return FALSE;
+    }
+    File &file = s_files[handle->file];
+    memcpy(file.data + handle->position, data, size);
+    handle->position += size;
+    file.size = std::max(file.size, handle->position);
+    *written = size;
+    return TRUE;
+}
+
+BOOL ReadFile(HANDLE hFile, void *data, DWORD size, DWORD *read, void *)
+{
+    PLATFORM_CALL();
+    FakeHandle *handle = toHandle(hFile, HANDLE_FILE);
+    if (!handle)
+    {
+        return FALSE;
+    }
+    File &file = s_files[handle->file];
+    DWORD available = file.size - handle->position;
+    *read = std::min(size, available);
+    memcpy(data, file.data + handle->position, *read);
+    handle->position += *read;
+    return TRUE;
+}
+
+/// @brief Lists the libraries added with `addLibrary`, whatever the pattern
+HANDLE FindFirstFileW(LPCWSTR, WIN32_FIND_DATAW *found)
+{
+    PLATFORM_CALL();
+    s_librarySearch = 0;
+    return FindNextFileW(&s_librarySearch, found) ? &s_librarySearch : INVALID_HANDLE_VALUE;
+}
+
+BOOL FindNextFileW(HANDLE, WIN32_FIND_DATAW *found)
+{
+    if (s_librarySearch >= s_libraryCount)
+    {
+        return FALSE;
+    }
+    *found = WIN32_FIND_DATAW();
+    copyString(found->cFileName, MAX_PATH, s_libraries[s_librarySearch++].fileName);
+    return TRUE;
+}
+
+BOOL FindClose(HANDLE) { return TRUE; }
+
+HANDLE CreateFileMappingW(HANDLE, SECURITY_ATTRIBUTES *, DWORD, DWORD, DWORD size, LPCWSTR name)
+{
+    PLATFORM_CALL();
+    SetLastError(0);
+    FakeHandle *handle = newHandle(HANDLE_MAPPING);
+    if (handle)
+    {
+        handle->view = calloc(1, size);
+        copyString(handle->mappingName, 64, name ? name : L"");
+    }
+    return handle;
+}
+
+/// @brief Opens a mapping created by name, as a reader in another process would
+HANDLE OpenFileMappingW(DWORD, BOOL, LPCWSTR name)
+{
+    PLATFORM_CALL();
+    void *view = NULL;
+    {
+        Lock lock;
+        for (FakeHandle &handle : s_handles)
+        {
+            if (handle.kind == HANDLE_MAPPING && !handle.isOpenedMapping && wcscmp(handle.mappingName, name) == 0)
+            {
+                view = handle.view;
+            }
+        }
+    }
+    FakeHandle *opened = view ? newHandle(HANDLE_MAPPING) : NULL;
+    if (opened)
+    {
+        opened->view = view;
+        opened->isOpenedMapping = true;
+    }
+    return opened;
+}
+
+LPVOID MapViewOfFile(HANDLE hMapping, DWORD, DWORD, DWORD, SIZE_T)
+{
+    PLATFORM_CALL();
+    FakeHandle *handle = toHandle(hMapping, HANDLE_MAPPING);
+    return handle ? handle->view : NULL;
+}
+
+BOOL UnmapViewOfFile(const void *)
+{
+    PLATFORM_CALL();
+    return TRUE;
+}
+
+// LIBRARIES AND COM
+// -----------------
+
+/// @brief Loads a library added with `addLibrary`, found by the file name at the end of the path
+HMODULE LoadLibraryW(LPCWSTR path)
+{
+    PLATFORM_CALL();
+    const wchar_t *fileName = wcsrchr(path, L'\\') ? wcsrchr(path, L'\\') + 1 : path;
+    for (int i = 0; i < s_libraryCount; i++)
+    {
+        if (wcscasecmp(s_libraries[i].fileName, fileName) == 0)
+        {
+            s_libraries[i].isLoaded = true;
+            return (HMODULE)&s_libraries[i];
+        }
+    }
+    return NULL;
+}
+
+FARPROC GetProcAddress(HMODULE hModule, LPCSTR name)
+{
+    PLATFORM_CALL();
+    const Library *library = (const Library *)hModule;
+    for (int i = 0; library && i < library->symbolCount; i++)
+    {
+        if (strcmp(library->symbols[i].name, name) == 0)
+        {
+            return (FARPROC)library->symbols[i].address;
+        }
+    }
+    return NULL;
+}
+
+BOOL FreeLibrary(HMODULE hModule)
+{
+    PLATFORM_CALL();
+    ((Library *)hModule)->isLoaded = false;
+    return TRUE;
+}
+
+// EXPLORER
+// --------
+
+// Explorer's side of the interfaces shelldesktops.cpp uses, with the methods in the same order. Its
+// objects are static, and count the references they hand out in `s_shellReferences`.
+
+// {C2F03A33-21F5-47FA-B4BB-156362A2F239}
+static const GUID IMMERSIVE_SHELL_CLSID = {0xc2f03a33, 0x21f5, 0x47fa, {0xb4, 0xbb, 0x15, 0x63, 0x62, 0xa2, 0xf2, 0x39}};
+// {6D5140C1-7436-11CE-8034-00AA006009FA}
+static const GUID SERVICE_PROVIDER_IID = {0x6d5140c1, 0x7436, 0x11ce, {0x80, 0x34, 0x00, 0xaa, 0x00, 0x60, 0x09, 0xfa}};
+// {C5E0CDCA-7B6E-41B2-9FC4-D93975CC467B}
+static const GUID DESKTOP_MANAGER_SID = {0xc5e0cdca, 0x7b6e, 0x41b2, {0x9f, 0xc4, 0xd9, 0x39, 0x75, 0xcc, 0x46, 0x7b}};
+// {1841C6D7-4F9D-42C0-AF41-8747538F10E5}
+static const GUID VIEW_COLLECTION_IID = {0x1841c6d7, 0x4f9d, 0x42c0, {0xaf, 0x41, 0x87, 0x47, 0x53, 0x8f, 0x10, 0xe5}};
+
+/// The IIDs of the desktop manager and of the desktops, by `ShellRelease`
+static const struct
+{
+    GUID manager;
+    GUID desktop;
+} SHELL_IIDS[] = {
+    {{0x0badf00d, 0, 0, {0}}, {0x0badf00d, 0, 0, {1}}}, // A release winctrl does not know
+    {{0xf31574d6, 0xb682, 0x4cdc, {0xbd, 0x56, 0x18, 0x27, 0x86, 0x0a, 0xbe, 0xc6}},
+     {0xff72ffdd, 0xbe7e, 0x43fc, {0x9c, 0x03, 0xad, 0x81, 0x68, 0x1e, 0x88, 0xe4}}},
+    {{0xa3175f2d, 0x239c, 0x4bd2, {0x8a, 0xa0, 0xee, 0xba, 0x8b, 0x0b, 0x13, 0x8e}},
+     {0x3f07f4be, 0xb107, 0x441a, {0xaf, 0x0f, 0x39, 0xd8, 0x25, 0x29, 0x07, 0x2c}}},
+    {{0x53f5ca0b, 0x158f, 0x4124, {0x90, 0x0c, 0x05, 0x71, 0x58, 0x06, 0x0b, 0x27}},
+     {0x3f07f4be, 0xb107, 0x441a, {0xaf, 0x0f, 0x39, 0xd8, 0x25, 0x29, 0x07, 0x2c}}},
+};
+
+static const wchar_t VIRTUAL_DESKTOPS_KEY[] = L"Software\\Microsoft\\Windows\\CurrentVersion\\Explorer\\VirtualDesktops";
+
+static GUID desktopId(int index)
+{
+    GUID id = {};
+    id.Data1 = 0x1000 + index;
+    return id;
+}
+
+/// @brief Writes the desktops to the registry, as Explorer does. It only lists them once there is a second one.
+static void writeDesktops()
+{
+    if (s_desktopCount <= 1)
+    {
+        return;
+    }
+
+    GUID ids[MAX_DESKTOPS];
+    for (int i = 0; i < s_desktopCount; i++)
+    {
+        ids[i] = desktopId(i);
+    }
+    setRegistryValue(VIRTUAL_DESKTOPS_KEY, L"VirtualDesktopIDs", ids, s_desktopCount * sizeof(GUID));
+    setRegistryValue(VIRTUAL_DESKTOPS_KEY, L"CurrentVirtualDesktop", &ids[s_currentDesktop], sizeof(GUID));
+}
+
+class FakeShellObject
+{
+public:
+    virtual HRESULT QueryInterface(REFIID, void **object)
+    {
+        *object = NULL;
+        return E_NOINTERFACE;
+    }
+    virtual ULONG AddRef() { return ++s_shellReferences; }
+    virtual ULONG Release() { return --s_shellReferences; }
+
+    template <typename T> static HRESULT handOut(T *object, void **result)
+    {
+        object->AddRef();
+        *result = object;
+        return S_OK;
+    }
+};
+
+class FakeView : public FakeShellObject
+{
+public:
+    HWND hWnd;
+};
+
+class FakeDesktop : public FakeShellObject
+{
+public:
+    int index;
+
+    virtual HRESULT IsViewVisible(FakeView *view, BOOL *isVisible)
+    {
+        Window *window = findWindow(view->hWnd);
+        *isVisible = window && window->desktop == index;
+        return S_OK;
+    }
+    virtual HRESULT GetID(GUID *id)
+    {
+        *id = desktopId(index);
+        return S_OK;
+    }
+};
+
+static FakeDesktop s_desktopObjects[MAX_DESKTOPS];
+static FakeView s_views[MAX_WINDOWS];
+
+class FakeDesktopArray : public FakeShellObject
+{
+public:
+    virtual HRESULT GetCount(UINT *count)
+    {
+        *count = s_desktopCount;
+        return S_OK;
+    }
+    virtual HRESULT GetAt(UINT index, REFIID iid, void **object)
+    {
+        *object = NULL;
+        if (index >= (UINT)s_desktopCount || !IsEqualGUID(iid, SHELL_IIDS[s_shellRelease].desktop))
+        {
+            return E_NOINTERFACE;
+        }
+        s_desktopObjects[index].index = index;
+        return handOut(&s_desktopObjects[index], object);
+    }
+};
+
+static FakeDesktopArray s_desktopArray;
+
+class FakeDesktopManager : public FakeShellObject
+{
+public:
+    virtual HRESULT GetCount(int *count)
+    {
+        *count = s_desktopCount;
+        return S_OK;
+    }
+    virtual HRESULT MoveViewToDesktop(FakeView *view, FakeDesktop *desktop)
+    {
+        Window *window = findWindow(view->hWnd);
+        if (!window)
+        {
+            return E_FAIL;
+        }
+        window->desktop = desktop->index;
+        return S_OK;
+    }
+    virtual HRESULT CanViewMoveDesktops(FakeView *, BOOL *canMove)
+    {
+        *canMove = TRUE;
+        return S_OK;
+    }
+    virtual HRESULT GetCurrentDesktop(FakeDesktop **desktop)
+    {
+        s_desktopObjects[s_currentDesktop].index = s_currentDesktop;
+        return handOut(&s_desktopObjects[s_currentDesktop], (void **)desktop);
+    }
+    virtual HRESULT GetDesktops(FakeDesktopArray **desktops) { return handOut(&s_desktopArray, (void **)desktops); }
+    virtual HRESULT GetAdjacentDesktop(FakeDesktop *, int, FakeDesktop **desktop)
+    {
+        *desktop = NULL;
+        return E_FAIL;
+    }
+    virtual HRESULT SwitchDesktop(FakeDesktop *desktop)
+    {
+        s_currentDesktop = desktop->index;
+        writeDesktops();
+        return S_OK;
+    }
+};
+
+class FakeViewCollection : public FakeShellObject
+{
+public:
+    // Not simulated
+    virtual HRESULT GetViews(void **views) { return QueryInterface(VIEW_COLLECTION_IID, views); }
+    virtual HRESULT GetViewsByZOrder(void **views) { return QueryInterface(VIEW_COLLECTION_IID, views); }
+    virtual HRESULT GetViewsByAppUserModelId(LPCWSTR, void **views) { return QueryInterface(VIEW_COLLECTION_IID, views); }
+    virtual HRESULT GetViewForHwnd(HWND hWnd, FakeView **view)
+    {
+        Window *window = findWindow(hWnd);
+        if (!window)
+        {
+            *view = NULL;
+            return E_FAIL;
+        }
+        FakeView *found = &s_views[window - s_windows];
+        found->hWnd = hWnd;
+        return handOut(found, (void **)view);
+    }
+};
+
+static FakeDesktopManager s_desktopManager;
+static FakeViewCollection s_viewCollection;
+
+class FakeImmersiveShell : public FakeShellObject
+{
+public:
+    virtual HRESULT QueryService(REFGUID service, REFIID iid, void **object)
+    {
+        if (IsEqualGUID(service, DESKTOP_MANAGER_SID) && IsEqualGUID(iid, SHELL_IIDS[s_shellRelease].manager))
+        {
+            return handOut(&s_desktopManager, object);
+        }
+        if (IsEqualGUID(service, VIEW_COLLECTION_IID) && IsEqualGUID(iid, VIEW_COLLECTION_IID))
+        {
+            return handOut(&s_viewCollection, object);
+        }
+        return QueryInterface(iid, object);
+    }
+};
+
+static FakeImmersiveShell s_immersiveShell;
+
+void fakewin::setDesktops(int count, int current)
+{
+    s_desktopCount = std::min(count, MAX_DESKTOPS);
+    s_currentDesktop = current;
+    writeDesktops();
+}
+
+void fakewin::setShellRelease(ShellRelease release) { s_shellRelease = release; }
+int fakewin::currentDesktop() { return s_currentDesktop; }
+int fakewin::shellReferences() { return s_shellReferences; }
+
+HRESULT CoInitializeEx(void *, DWORD)
+{
+    PLATFORM_CALL();
+    return S_OK;
+}
+
+void CoUninitialize()
+{
+    PLATFORM_CALL();
+}
+
+/// @brief Only creates Explorer's immersive shell, which every release has
+HRESULT CoCreateInstance(REFCLSID clsid, void *, DWORD, REFIID iid, void **object)
+{
+    PLATFORM_CALL();
+    if (IsEqualGUID(clsid, IMMERSIVE_SHELL_CLSID) && IsEqualGUID(iid, SERVICE_PROVIDER_IID))
+    {
+        return FakeShellObject::handOut(&s_immersiveShell, object);
+    }
+    *object = NULL;
+    return E_NOINTERFACE;
+}
+
+// DEBUGGING AND CONSOLE
+// ---------------------
+
+void OutputDebugStringA(LPCSTR)
+{
+    PLATFORM_CALL();
+}
+
+void OutputDebugStringW(LPCWSTR)
+{
+    PLATFORM_CALL();
+}
+
+HANDLE GetStdHandle(DWORD) { return NULL; }
+BOOL WriteConsoleW(HANDLE, const void *, DWORD, DWORD *, void *) { return TRUE; }
+BOOL WriteConsoleA(HANDLE, const void *, DWORD, DWORD *, void *) { return TRUE; }
+BOOL AttachConsole(DWORD) { return FALSE; }
+
+// STRINGS
+// -------
+
+LPWSTR lstrcpy(LPWSTR target, LPCWSTR source) { return wcscpy(target, source); }
+LPWSTR lstrcpyW(LPWSTR target, LPCWSTR source) { return wcscpy(target, source); }
+LPWSTR lstrcatW(LPWSTR target, LPCWSTR source) { return wcscat(target, source); }
+int lstrlenW(LPCWSTR text) { return text ? (int)wcslen(text) : 0; }
+int lstrcmpW(LPCWSTR a, LPCWSTR b) { return wcscmp(a, b); }
+int lstrcmpiW(LPCWSTR a, LPCWSTR b) { return wcscasecmp(a, b); }
+
+LPWSTR lstrcpynW(LPWSTR target, LPCWSTR source, int size)
+{
+    copyString(target, size, source);
+    return target;
+}
+
+int _wcsnicmp(const wchar_t *a, const wchar_t *b, size_t count) { return wcsncasecmp(a, b, count); }
+int _wcsicmp(const wchar_t *a, const wchar_t *b) { return wcscasecmp(a, b); }
+int _wtoi(const wchar_t *text) { return (int)wcstol(text, NULL, 10); }
+
+int wsprintfW(LPWSTR buffer, LPCWSTR format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int length = vswprintf(buffer, 1024, format, args);
+    va_end(args);
+    return length;
+}
+
+int wsprintfA(LPSTR buffer, LPCSTR format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, 1024, format, args);
+    va_end(args);
+    return length;
+}
@@ -0,0 +1,151 @@
+#ifndef FAKEWIN_H
+#define FAKEWIN_H
+
+#include <windows.h>
+
+// FAKE WINDOWS
+//
+// A small simulated desktop behind the functions declared in windows.h, so that the platform code
+// of winctrl runs unchanged in the tests. It has windows (with a placement, styles, opacity, a
+// class, a title and an owning process), monitors, a cursor, a keyboard, a clock that only moves
+// when the test says so, thread timers, WinEvent hooks, a thread pool, processes, plugin libraries,
+// an ini file, a registry and the virtual desktops of Explorer.
+//
+// The thread that calls `reset` plays the hook thread: the platform calls it makes are counted
+// (see `calls`), and its timers, WinEvents and thread pool callbacks run when the test pumps them.
+// Threads created by the code under test are real threads. Nothing here allocates after `reset`,
+// so allocation counts of the code under test are not disturbed.
+
+namespace fakewin
+{
+    const int MAX_WINDOWS = 256;
+    const int MAX_MONITORS = 8;
+
+    struct Window
+    {
+        HWND hWnd;
+        bool isAlive;
+        RECT rect;       // Screen coordinates
+        RECT normalRect; // Workspace coordinates, like `WINDOWPLACEMENT::rcNormalPosition`
+        bool isZoomed;
+        bool isIconic;
+        bool isVisible;
+        LONG_PTR style;
+        LONG_PTR exStyle;
+        BYTE alpha;
+        DWORD layeredFlags;
+        DWORD processId;
+        DWORD threadId;
+        HWND owner;
+        wchar_t className[64];
+        wchar_t title[64];
+        POINT minTrack; // What the window reports for WM_GETMINMAXINFO, and enforces. 0 keeps the system default
+        POINT maxTrack;
+        bool isHung; // Does not answer messages
+        int desktop; // The virtual desktop it is on (0-based)
+    };
+
+    // DESKTOP
+
+    void reset();
+
+    HWND createWindow(const wchar_t *className, RECT rect, DWORD processId = 100, const wchar_t *title = L"");
+    HWND createWindowWithHandle(HWND hWnd, const wchar_t *className, RECT rect, DWORD processId = 100);
+    void destroyWindow(HWND hWnd);
+    Window *window(HWND hWnd);
+
+    int addMonitor(RECT monitor, RECT work);
+    void clearMonitors();
+
+    void setCursor(int x, int y);
+    void setKeyDown(int vkCode, bool isDown);
+
+    /// Makes the `DeferWindowPos` call with the given index (counted from 0 in every batch) fail
+    /// and abandon the batch, as when the system runs out of memory. -1 lets every call succeed.
+    void failDeferredPosition(int index);
+
+    // CLOCK
+
+    DWORD now();
+    void advance(DWORD milliseconds);
+    void advanceMicroseconds(ULONGLONG microseconds);
+
+    // MESSAGE LOOP
+
+    int fireTimers();
+    int timerCount();
+    int deliverWinEvents();
+    int runThreadPool();
+    void pump();
+
+    // PLATFORM CALLS
+
+    void resetCalls();
+    int calls();
+    int calls(const char *function);
+    const char *callName(int index);
+    int blockingUnregisters();
+
+    // INPUT
+
+    int sentInputCount();
+    const INPUT &sentInput(int index);
+    void clearSentInput();
+
+    // PROCESSES
+
+    void addProcess(DWORD processId, const wchar_t *image, ULONGLONG creationTime, bool canOpen = true);
+    void endProcess(DWORD processId);
+    int openHandles();
+    int activeWaits();
+
+    // LIBRARIES
+    //
+    // The DLLs in the `plugins` folder next to the executable, each exporting the given functions
+
+    struct Symbol
+    {
+        const char *name;
+        void *address;
+    };
+
+    void addLibrary(const wchar_t *fileName, const Symbol *symbols, int count);
+    int loadedLibraries();
+
+    // SETTINGS
+
+    void setIni(const wchar_t *section, const wchar_t *key, const wchar_t *value);
+    void setRegistryValue(const wchar_t *key, const wchar_t *name, const void *data, DWORD size);
+
+    // VIRTUAL DESKTOPS
+
+    // The desktops of Explorer, as it keeps them in the registry and hands them out through the
+    // interfaces of its own that shelldesktops.cpp uses. Those only match for the releases of
+    // Windows listed here; on `SHELL_UNKNOWN`, the interfaces have IIDs winctrl does not know.
+    enum ShellRelease
+    {
+        SHELL_UNKNOWN,
+        SHELL_WINDOWS_10,
+        SHELL_WINDOWS_11,
+        SHELL_WINDOWS_11_24H2,
+    };
+
+    void setDesktops(int count, int current);
+    void setShellRelease(ShellRelease release);
+    int currentDesktop();
+    int shellReferences(); // References to Explorer's objects not released yet
+
+    // ANIMATION THREAD
+    //
+    // Other threads wait in `DwmFlush` until the test presents a frame, so the test decides when each
+    // frame happens. With the apply gate closed, they also wait before moving windows.
+
+    void setUnlimitedFrames(bool isUnlimited);
+    bool presentFrame();
+    void releaseFrame();
+    bool waitUntilParked();
+    void setApplyGate(bool isClosed);
+    bool waitUntilGated();
+}
+
+#endif // FAKEWIN_H
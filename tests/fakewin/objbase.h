@@ -0,0 +1,11 @@
+#pragma once
+#include <windows.h>
+#define STDMETHODCALLTYPE
+#define COINIT_MULTITHREADED 0
+#define CLSCTX_LOCAL_SERVER 4
+#define E_NOINTERFACE ((HRESULT)0x80004002)
+#define E_FAIL ((HRESULT)0x80004005)
+typedef uint32_t ULONG;
+struct IUnknown {
+  virtual HRESULT QueryInterface(REFIID, void**) = 0; virtual ULONG AddRef() = 0; virtual ULONG Release() = 0;
+};
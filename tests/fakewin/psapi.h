@@ -0,0 +1,3 @@
+#pragma once
+#include <windows.h>
+BOOL GetProcessMemoryInfo(HANDLE, PROCESS_MEMORY_COUNTERS*, DWORD); BOOL K32GetProcessMemoryInfo(HANDLE, PROCESS_MEMORY_COUNTERS*, DWORD); BOOL EmptyWorkingSet(HANDLE);
@@ -0,0 +1,8 @@
+#pragma once
+#include <objbase.h>
+struct IServiceProvider : IUnknown {
+  virtual HRESULT QueryService(REFGUID, REFIID, void**) = 0;
+};
+struct IObjectArray : IUnknown {
+  virtual HRESULT GetCount(UINT*) = 0; virtual HRESULT GetAt(UINT, REFIID, void**) = 0;
+};
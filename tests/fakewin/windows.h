@@ -0,0 +1,295 @@
+#pragma once
+// A declarations-only stand-in for the Windows headers, so that the platform code of winctrl
+// compiles on Linux for the tests. The types follow the LLP64 model of Windows (DWORD and LONG are
+// 32 bits). Everything declared here is implemented by the simulated desktop in fakewin.cpp.
+#include <stddef.h>
+#include <stdint.h>
+#include <wchar.h>
+#define CALLBACK
+#define WINAPI
+#define APIENTRY
+typedef int BOOL; typedef unsigned char BYTE; typedef unsigned short WORD; typedef uint32_t DWORD;
+typedef int32_t LONG; typedef unsigned int UINT; typedef intptr_t LONG_PTR; typedef uintptr_t ULONG_PTR; typedef uintptr_t UINT_PTR;
+typedef uintptr_t WPARAM; typedef intptr_t LPARAM; typedef intptr_t LRESULT; typedef size_t SIZE_T; typedef long long LONGLONG; typedef unsigned long long ULONGLONG;
+typedef wchar_t WCHAR; typedef const wchar_t* LPCWSTR; typedef wchar_t* LPWSTR; typedef char* LPSTR; typedef const char* LPCSTR; typedef void* LPVOID; typedef void* HANDLE; typedef DWORD* LPDWORD; typedef int32_t HRESULT; typedef WORD ATOM;
+typedef LPCWSTR LPCTSTR; typedef LPWSTR LPTSTR; typedef WCHAR TCHAR;
+struct HWND__; typedef HWND__* HWND; struct HHOOK__; typedef HHOOK__* HHOOK; struct HMENU__; typedef HMENU__* HMENU;
+struct HICON__; typedef HICON__* HICON; typedef HICON HCURSOR; struct HINSTANCE__; typedef HINSTANCE__* HINSTANCE; typedef HINSTANCE HMODULE;
+struct HMONITOR__; typedef HMONITOR__* HMONITOR; struct HDWP__; typedef HDWP__* HDWP; struct HKEY__; typedef HKEY__* HKEY; struct HBRUSH__; typedef HBRUSH__* HBRUSH;
+struct HWINEVENTHOOK__; typedef HWINEVENTHOOK__* HWINEVENTHOOK;
+typedef void* FARPROC;
+#define TRUE 1
+#define FALSE 0
+#ifndef NULL
+#define NULL 0
+#endif
+typedef struct tagPOINT { LONG x; LONG y; } POINT;
+typedef struct tagRECT { LONG left, top, right, bottom; } RECT;
+typedef struct { DWORD cbSize; RECT rcMonitor; RECT rcWork; DWORD dwFlags; } MONITORINFO;
+typedef struct { DWORD cbSize; RECT rcMonitor; RECT rcWork; DWORD dwFlags; WCHAR szDevice[32]; } MONITORINFOEXW;
+typedef struct { UINT length; UINT flags; UINT showCmd; POINT ptMinPosition; POINT ptMaxPosition; RECT rcNormalPosition; } WINDOWPLACEMENT;
+typedef struct { POINT ptReserved; POINT ptMaxSize; POINT ptMaxPosition; POINT ptMinTrackSize; POINT ptMaxTrackSize; } MINMAXINFO;
+typedef struct { POINT pt; DWORD mouseData; DWORD flags; DWORD time; ULONG_PTR dwExtraInfo; } MSLLHOOKSTRUCT;
+typedef struct { DWORD vkCode; DWORD scanCode; DWORD flags; DWORD time; ULONG_PTR dwExtraInfo; } KBDLLHOOKSTRUCT;
+typedef struct { LONG dx, dy; DWORD mouseData, dwFlags, time; ULONG_PTR dwExtraInfo; } MOUSEINPUT;
+typedef struct { WORD wVk; WORD wScan; DWORD dwFlags; DWORD time; ULONG_PTR dwExtraInfo; } KEYBDINPUT;
+typedef struct { DWORD type; union { MOUSEINPUT mi; KEYBDINPUT ki; }; } INPUT;
+typedef struct { HWND hwnd; UINT message; WPARAM wParam; LPARAM lParam; DWORD time; POINT pt; } MSG;
+typedef LRESULT (*HOOKPROC)(int, WPARAM, LPARAM);
+typedef LRESULT (*WNDPROC)(HWND, UINT, WPARAM, LPARAM);
+typedef void (*TIMERPROC)(HWND, UINT, UINT_PTR, DWORD);
+typedef BOOL (*WNDENUMPROC)(HWND, LPARAM);
+struct HDC__; typedef HDC__* HDC; typedef RECT* LPRECT;
+typedef BOOL (*MONITORENUMPROC)(HMONITOR, HDC, LPRECT, LPARAM);
+typedef struct { UINT cbSize; UINT style; WNDPROC lpfnWndProc; int cbClsExtra; int cbWndExtra; HINSTANCE hInstance; HICON hIcon; HCURSOR hCursor; HBRUSH hbrBackground; LPCWSTR lpszMenuName; LPCWSTR lpszClassName; HICON hIconSm; } WNDCLASSEX;
+typedef struct { DWORD cbSize; HWND hWnd; UINT uID; UINT uFlags; UINT uCallbackMessage; HICON hIcon; WCHAR szTip[128]; } NOTIFYICONDATA;
+typedef union { struct { DWORD LowPart; LONG HighPart; }; LONGLONG QuadPart; } LARGE_INTEGER;
+typedef struct { DWORD dwLowDateTime; DWORD dwHighDateTime; } FILETIME;
+typedef struct { DWORD Data1; WORD Data2; WORD Data3; BYTE Data4[8]; } GUID;
+typedef struct { DWORD nLength; void* lpSecurityDescriptor; BOOL bInheritHandle; } SECURITY_ATTRIBUTES;
+typedef struct { long dummy; } CRITICAL_SECTION;
+typedef struct { void* Ptr; } SRWLOCK;
+#define SRWLOCK_INIT {0}
+typedef DWORD (*LPTHREAD_START_ROUTINE)(LPVOID);
+typedef void* PVOID; typedef unsigned char BOOLEAN;
+typedef void (*WAITORTIMERCALLBACK)(PVOID, BOOLEAN);
+#define HC_ACTION 0
+#define WH_MOUSE_LL 14
+#define WH_KEYBOARD_LL 13
+#define WM_USER 0x400
+#define WM_CREATE 1
+#define WM_DESTROY 2
+#define WM_COMMAND 0x111
+#define WM_TIMER 0x113
+#define WM_DISPLAYCHANGE 0x7E
+#define WM_GETMINMAXINFO 0x24
+#define WM_MOUSEMOVE 0x200
+#define WM_LBUTTONDOWN 0x201
+#define WM_LBUTTONUP 0x202
+#define WM_RBUTTONDOWN 0x204
+#define WM_RBUTTONUP 0x205
+#define WM_MBUTTONDOWN 0x207
+#define WM_MBUTTONUP 0x208
+#define WM_MOUSEWHEEL 0x20A
+#define WM_MOUSEHWHEEL 0x20E
+#define WM_KEYDOWN 0x100
+#define WM_KEYUP 0x101
+#define WM_SYSKEYDOWN 0x104
+#define WM_SYSKEYUP 0x105
+#define WM_QUIT 0x12
+#define VK_LWIN 0x5B
+#define VK_RWIN 0x5C
+#define VK_CONTROL 0x11
+#define VK_SHIFT 0x10
+#define VK_MENU 0x12
+#define VK_LCONTROL 0xA2
+#define VK_RCONTROL 0xA3
+#define VK_LSHIFT 0xA0
+#define VK_RSHIFT 0xA1
+#define VK_LMENU 0xA4
+#define VK_RMENU 0xA5
+#define VK_LEFT 0x25
+#define VK_UP 0x26
+#define VK_RIGHT 0x27
+#define VK_DOWN 0x28
+#define VK_PRIOR 0x21
+#define VK_NEXT 0x22
+#define VK_HOME 0x24
+#define VK_END 0x23
+#define VK_ESCAPE 0x1B
+#define VK_RETURN 0x0D
+#define VK_SPACE 0x20
+#define VK_TAB 0x09
+#define VK_F1 0x70
+#define VK_OEM_PLUS 0xBB
+#define VK_OEM_MINUS 0xBD
+#define INPUT_KEYBOARD 1
+#define KEYEVENTF_KEYUP 2
+#define KEYEVENTF_EXTENDEDKEY 1
+#define GA_ROOT 2
+#define SWP_NOSIZE 1
+#define SWP_NOMOVE 2
+#define SWP_NOZORDER 4
+#define SWP_NOACTIVATE 0x10
+#define SWP_NOOWNERZORDER 0x200
+#define SWP_ASYNCWINDOWPOS 0x4000
+#define SWP_NOCOPYBITS 0x100
+#define HWND_TOPMOST ((HWND)-1)
+#define HWND_NOTOPMOST ((HWND)-2)
+#define HWND_MESSAGE ((HWND)-3)
+#define SW_RESTORE 9
+#define SW_MAXIMIZE 3
+#define SW_SHOWMAXIMIZED 3
+#define SW_SHOWNORMAL 1
+#define SW_SHOWMINIMIZED 2
+#define SW_MINIMIZE 6
+#define SW_SHOWMINNOACTIVE 7
+#define SW_SHOWNOACTIVATE 4
+#define GWL_STYLE (-16)
+#define GWL_EXSTYLE (-20)
+#define WS_CAPTION 0xC00000L
+#define WS_THICKFRAME 0x40000L
+#define WS_VISIBLE 0x10000000L
+#define WS_CHILD 0x40000000L
+#define WS_EX_LAYERED 0x80000
+#define WS_EX_TOOLWINDOW 0x80
+#define WS_EX_TOPMOST 0x8
+#define WS_EX_NOACTIVATE 0x08000000L
+#define WS_EX_APPWINDOW 0x40000
+#define LWA_ALPHA 2
+#define SM_CXSCREEN 0
+#define SM_CYSCREEN 1
+#define MONITOR_DEFAULTTONEAREST 2
+#define MONITOR_DEFAULTTONULL 0
+#define MONITOR_DEFAULTTOPRIMARY 1
+#define WPF_ASYNCWINDOWPLACEMENT 4
+#define SMTO_ABORTIFHUNG 2
+#define SMTO_BLOCK 1
+#define MF_STRING 0
+#define MF_CHECKED 8
+#define MF_UNCHECKED 0
+#define MF_GRAYED 1
+#define MF_SEPARATOR 0x800
+#define MF_POPUP 0x10
+#define TPM_LEFTALIGN 0
+#define TPM_LEFTBUTTON 0
+#define TPM_BOTTOMALIGN 0x20
+#define MB_OK 0
+#define MB_ICONINFORMATION 0x40
+#define MB_ICONERROR 0x10
+#define NIF_ICON 2
+#define NIF_MESSAGE 1
+#define NIF_TIP 4
+#define NIM_ADD 0
+#define NIM_DELETE 2
+#define NIM_MODIFY 1
+#define MAX_PATH 260
+#define INFINITE 0xFFFFFFFF
+#define WAIT_OBJECT_0 0
+#define WAIT_TIMEOUT 258
+#define PROCESS_QUERY_LIMITED_INFORMATION 0x1000
+#define SYNCHRONIZE 0x100000
+#define WT_EXECUTEONLYONCE 8
+#define WT_EXECUTEDEFAULT 0
+#define INVALID_HANDLE_VALUE ((HANDLE)(intptr_t)-1)
+#define GENERIC_READ 0x80000000
+#define GENERIC_WRITE 0x40000000
+#define CREATE_ALWAYS 2
+#define OPEN_EXISTING 3
+#define FILE_ATTRIBUTE_NORMAL 0x80
+#define FILE_SHARE_READ 1
+#define PAGE_READWRITE 4
+#define FILE_MAP_READ 4
+#define FILE_MAP_WRITE 2
+#define FILE_MAP_ALL_ACCESS 0xF001F
+#define HKEY_CURRENT_USER ((HKEY)(ULONG_PTR)0x80000001)
+#define KEY_READ 0x20019
+#define ERROR_SUCCESS 0L
+#define RRF_RT_REG_BINARY 8
+#define RRF_RT_REG_DWORD 0x10
+#define S_OK 0
+#define SUCCEEDED(x) ((x) >= 0)
+#define FAILED(x) ((x) < 0)
+#define CLSCTX_ALL 0x17
+#define CLSCTX_INPROC_SERVER 1
+#define COINIT_APARTMENTTHREADED 2
+#define PM_REMOVE 1
+#define QS_ALLINPUT 0x4FF
+#define EVENT_OBJECT_DESTROY 0x8001
+#define WINEVENT_OUTOFCONTEXT 0
+#define OBJID_WINDOW 0
+#define LOWORD(l) ((WORD)((ULONG_PTR)(l) & 0xffff))
+#define HIWORD(l) ((WORD)(((ULONG_PTR)(l) >> 16) & 0xffff))
+#define GET_WHEEL_DELTA_WPARAM(w) ((short)HIWORD(w))
+#define WHEEL_DELTA 120
+#define MAKEINTRESOURCE(i) ((LPWSTR)((ULONG_PTR)((WORD)(i))))
+#define ZeroMemory(p,n) memset((p),0,(n))
+#define CopyMemory(d,s,n) memcpy((d),(s),(n))
+#define STATUS_WAIT_0 0
+#include <string.h>
+HWND WindowFromPoint(POINT); HWND GetAncestor(HWND, UINT); BOOL ShowWindow(HWND, int); BOOL ShowWindowAsync(HWND,int); BOOL GetWindowRect(HWND, RECT*); BOOL SetWindowPos(HWND, HWND, int, int, int, int, UINT);
+UINT SendInput(UINT, INPUT*, int); LONG_PTR GetWindowLongPtr(HWND, int); LONG_PTR SetWindowLongPtr(HWND, int, LONG_PTR); LONG GetWindowLong(HWND, int);
+BOOL GetLayeredWindowAttributes(HWND, DWORD*, BYTE*, DWORD*); BOOL SetLayeredWindowAttributes(HWND, DWORD, BYTE, DWORD); BOOL IsZoomed(HWND); BOOL IsIconic(HWND); BOOL IsWindow(HWND); BOOL IsWindowVisible(HWND);
+int GetClassNameW(HWND, LPWSTR, int); int GetWindowTextW(HWND, LPWSTR, int); HWND GetDesktopWindow(); HWND FindWindowW(LPCWSTR, LPCWSTR); HWND GetShellWindow(); int GetSystemMetrics(int);
+LRESULT CallNextHookEx(HHOOK, int, WPARAM, LPARAM); short GetAsyncKeyState(int); short GetKeyState(int); HHOOK SetWindowsHookEx(int, HOOKPROC, HINSTANCE, DWORD); BOOL UnhookWindowsHookEx(HHOOK);
+BOOL GetMessage(MSG*, HWND, UINT, UINT); BOOL PeekMessage(MSG*, HWND, UINT, UINT, UINT); BOOL TranslateMessage(const MSG*); LRESULT DispatchMessage(const MSG*); void PostQuitMessage(int); BOOL PostThreadMessage(DWORD, UINT, WPARAM, LPARAM); BOOL PostMessage(HWND, UINT, WPARAM, LPARAM);
+HICON LoadIcon(HINSTANCE, LPCWSTR); HMODULE GetModuleHandle(LPCWSTR); LPWSTR lstrcpy(LPWSTR, LPCWSTR); int lstrcmpW(LPCWSTR, LPCWSTR); int lstrcmpiW(LPCWSTR, LPCWSTR); int lstrlenW(LPCWSTR); LPWSTR lstrcpynW(LPWSTR, LPCWSTR, int);
+BOOL Shell_NotifyIcon(DWORD, NOTIFYICONDATA*); int MessageBox(HWND, LPCWSTR, LPCWSTR, UINT); int MessageBoxW(HWND, LPCWSTR, LPCWSTR, UINT); BOOL GetCursorPos(POINT*); HMENU CreatePopupMenu(); BOOL AppendMenu(HMENU, UINT, UINT_PTR, LPCWSTR);
+BOOL SetForegroundWindow(HWND); HWND GetForegroundWindow(); BOOL TrackPopupMenu(HMENU, UINT, int, int, int, HWND, const RECT*); BOOL DestroyMenu(HMENU); LRESULT DefWindowProc(HWND, UINT, WPARAM, LPARAM);
+ATOM RegisterClassEx(const WNDCLASSEX*); HWND CreateWindowEx(DWORD, LPCWSTR, LPCWSTR, DWORD, int, int, int, int, HWND, HMENU, HINSTANCE, LPVOID); BOOL DestroyWindow(HWND);
+UINT_PTR SetTimer(HWND, UINT_PTR, UINT, TIMERPROC); BOOL KillTimer(HWND, UINT_PTR); DWORD GetTickCount(); ULONGLONG GetTickCount64(); UINT GetDoubleClickTime();
+BOOL GetWindowPlacement(HWND, WINDOWPLACEMENT*); BOOL SetWindowPlacement(HWND, const WINDOWPLACEMENT*); HMONITOR MonitorFromWindow(HWND, DWORD); HMONITOR MonitorFromPoint(POINT, DWORD); HMONITOR MonitorFromRect(const RECT*, DWORD);
+BOOL GetMonitorInfo(HMONITOR, MONITORINFO*); BOOL GetMonitorInfoW(HMONITOR, MONITORINFO*); BOOL EnumDisplayMonitors(HDC, const RECT*, MONITORENUMPROC, LPARAM); BOOL EnumWindows(WNDENUMPROC, LPARAM);
+HDWP BeginDeferWindowPos(int); HDWP DeferWindowPos(HDWP, HWND, HWND, int, int, int, int, UINT); BOOL EndDeferWindowPos(HDWP);
+DWORD GetWindowThreadProcessId(HWND, DWORD*); HANDLE OpenProcess(DWORD, BOOL, DWORD); BOOL CloseHandle(HANDLE); BOOL QueryFullProcessImageNameW(HANDLE, DWORD, LPWSTR, DWORD*);
+DWORD GetModuleFileNameW(HMODULE, LPWSTR, DWORD); DWORD GetPrivateProfileStringW(LPCWSTR, LPCWSTR, LPCWSTR, LPWSTR, DWORD, LPCWSTR); UINT GetPrivateProfileIntW(LPCWSTR, LPCWSTR, int, LPCWSTR);
+DWORD GetPrivateProfileSectionW(LPCWSTR, LPWSTR, DWORD, LPCWSTR); DWORD GetPrivateProfileSectionNamesW(LPWSTR, DWORD, LPCWSTR);
+HANDLE CreateFileW(LPCWSTR, DWORD, DWORD, SECURITY_ATTRIBUTES*, DWORD, DWORD, HANDLE); BOOL WriteFile(HANDLE, const void*, DWORD, DWORD*, void*); BOOL ReadFile(HANDLE, void*, DWORD, DWORD*, void*);
+BOOL QueryPerformanceCounter(LARGE_INTEGER*); BOOL QueryPerformanceFrequency(LARGE_INTEGER*); HANDLE GetCurrentProcess(); DWORD GetCurrentProcessId(); DWORD GetCurrentThreadId(); BOOL GetProcessTimes(HANDLE, FILETIME*, FILETIME*, FILETIME*, FILETIME*);
+void GetSystemTimeAsFileTime(FILETIME*); void GetSystemTimePreciseAsFileTime(FILETIME*); BOOL SetProcessWorkingSetSize(HANDLE, SIZE_T, SIZE_T); void OutputDebugStringW(LPCWSTR); void OutputDebugStringA(LPCSTR);
+HANDLE GetStdHandle(DWORD); BOOL WriteConsoleW(HANDLE, const void*, DWORD, DWORD*, void*); BOOL WriteConsoleA(HANDLE, const void*, DWORD, DWORD*, void*);
+#define STD_OUTPUT_HANDLE ((DWORD)-11)
+#define STD_ERROR_HANDLE ((DWORD)-12)
+int wsprintfW(LPWSTR, LPCWSTR, ...); int wsprintfA(LPSTR, LPCSTR, ...);
+HANDLE CreateThread(SECURITY_ATTRIBUTES*, SIZE_T, LPTHREAD_START_ROUTINE, LPVOID, DWORD, DWORD*); DWORD WaitForSingleObject(HANDLE, DWORD); HANDLE CreateEventW(SECURITY_ATTRIBUTES*, BOOL, BOOL, LPCWSTR); BOOL SetEvent(HANDLE); BOOL ResetEvent(HANDLE);
+void Sleep(DWORD); void InitializeSRWLock(SRWLOCK*); void AcquireSRWLockExclusive(SRWLOCK*); void ReleaseSRWLockExclusive(SRWLOCK*);
+void InitializeCriticalSection(CRITICAL_SECTION*); void EnterCriticalSection(CRITICAL_SECTION*); void LeaveCriticalSection(CRITICAL_SECTION*); void DeleteCriticalSection(CRITICAL_SECTION*);
+BOOL RegisterWaitForSingleObject(HANDLE*, HANDLE, WAITORTIMERCALLBACK, void*, DWORD, DWORD); BOOL UnregisterWait(HANDLE); BOOL UnregisterWaitEx(HANDLE, HANDLE);
+LONG RegGetValueW(HKEY, LPCWSTR, LPCWSTR, DWORD, DWORD*, void*, DWORD*); LONG RegOpenKeyExW(HKEY, LPCWSTR, DWORD, DWORD, HKEY*); LONG RegCloseKey(HKEY);
+LONG RegNotifyChangeKeyValue(HKEY, BOOL, DWORD, HANDLE, BOOL);
+#define KEY_NOTIFY 0x10
+#define REG_NOTIFY_CHANGE_LAST_SET 4
+#define REG_NOTIFY_THREAD_AGNOSTIC 0x10000000L
+HRESULT CoInitializeEx(void*, DWORD); void CoUninitialize(); HRESULT CoCreateInstance(const GUID&, void*, DWORD, const GUID&, void**);
+HANDLE CreateFileMappingW(HANDLE, SECURITY_ATTRIBUTES*, DWORD, DWORD, DWORD, LPCWSTR); HANDLE OpenFileMappingW(DWORD, BOOL, LPCWSTR); LPVOID MapViewOfFile(HANDLE, DWORD, DWORD, DWORD, SIZE_T); BOOL UnmapViewOfFile(const void*);
+HMODULE LoadLibraryW(LPCWSTR); FARPROC GetProcAddress(HMODULE, LPCSTR); BOOL FreeLibrary(HMODULE);
+typedef struct { DWORD dwFileAttributes; FILETIME a,b,c; DWORD h,l,r0,r1; WCHAR cFileName[MAX_PATH]; WCHAR cAlternateFileName[14]; } WIN32_FIND_DATAW;
+HANDLE FindFirstFileW(LPCWSTR, WIN32_FIND_DATAW*); BOOL FindNextFileW(HANDLE, WIN32_FIND_DATAW*); BOOL FindClose(HANDLE);
+LRESULT SendMessageTimeoutW(HWND, UINT, WPARAM, LPARAM, UINT, UINT, ULONG_PTR*); LRESULT SendMessage(HWND, UINT, WPARAM, LPARAM);
+typedef void (*WINEVENTPROC)(HWINEVENTHOOK, DWORD, HWND, LONG, LONG, DWORD, DWORD);
+HWINEVENTHOOK SetWinEventHook(DWORD, DWORD, HMODULE, WINEVENTPROC, DWORD, DWORD, DWORD); BOOL UnhookWinEvent(HWINEVENTHOOK);
+BOOL IsWindowArranged(HWND); BOOL IsHungAppWindow(HWND); DWORD GetLastError(); HWND GetWindow(HWND, UINT);
+#define GW_OWNER 4
+#define EXIT_SUCCESS 0
+#define EXIT_FAILURE 1
+typedef struct { DWORD cb; DWORD PageFaultCount; SIZE_T PeakWorkingSetSize; SIZE_T WorkingSetSize; SIZE_T a,b,c,d; SIZE_T PagefileUsage; SIZE_T PeakPagefileUsage; } PROCESS_MEMORY_COUNTERS;
+#include <stdlib.h>
+
+
+#define CHILDID_SELF 0
+typedef union { struct { DWORD LowPart; DWORD HighPart; }; ULONGLONG QuadPart; } ULARGE_INTEGER;
+#define MOD_ALT 1
+#define MOD_CONTROL 2
+#define MOD_SHIFT 4
+#define MOD_WIN 8
+#define LLKHF_INJECTED 0x10
+int _wcsnicmp(const wchar_t*, const wchar_t*, size_t); int _wtoi(const wchar_t*); int _wcsicmp(const wchar_t*, const wchar_t*);
+LONG InterlockedExchange(volatile LONG *, LONG); BOOL SetRect(RECT*, int, int, int, int);
+typedef GUID CLSID; typedef GUID IID; typedef const GUID &REFCLSID; typedef const GUID &REFIID; typedef const GUID &REFGUID;
+inline BOOL IsEqualGUID(REFGUID a, REFGUID b) { return memcmp(&a, &b, sizeof(GUID)) == 0; }
+HRESULT CoInitializeEx(void*, DWORD); HRESULT CoCreateInstance(REFCLSID, void*, DWORD, REFIID, void**); void CoUninitialize();
+BOOL ProcessIdToSessionId(DWORD, DWORD*);
+#define SUCCEEDED(x) ((x) >= 0)
+#define SPI_GETCLIENTAREAANIMATION 0x1042
+BOOL SystemParametersInfo(UINT, UINT, void*, UINT); BOOL OffsetRect(RECT*, int, int);
+#define SM_CXMINTRACK 34
+#define SM_CYMINTRACK 35
+#define SM_CXMAXTRACK 59
+#define SM_CYMAXTRACK 60
+typedef ULONG_PTR DWORD_PTR;
+#define SMTO_ERRORONEXIT 0x20
+#define EVENT_OBJECT_LOCATIONCHANGE 0x800B
+typedef struct { UINT cbSize; DWORD dwTime; } LASTINPUTINFO;
+BOOL GetLastInputInfo(LASTINPUTINFO*);
+#define ERROR_ALREADY_EXISTS 183L
+LPWSTR lstrcpyW(LPWSTR, LPCWSTR); LPWSTR lstrcatW(LPWSTR, LPCWSTR);
+typedef struct { void* Ptr; } CONDITION_VARIABLE;
+#define CONDITION_VARIABLE_INIT {0}
+BOOL SleepConditionVariableSRW(CONDITION_VARIABLE*, SRWLOCK*, DWORD, DWORD); void WakeAllConditionVariable(CONDITION_VARIABLE*); void WakeConditionVariable(CONDITION_VARIABLE*);
+BOOL QueueUserWorkItem(LPTHREAD_START_ROUTINE, PVOID, DWORD);
+void SetLastError(DWORD);
+#define ERROR_IO_PENDING 997L
+#define ERROR_TIMEOUT 1460L
+LONG InterlockedCompareExchange(volatile LONG *, LONG, LONG); LONG InterlockedIncrement(volatile LONG *);
+BOOL AttachConsole(DWORD);
+#define ATTACH_PARENT_PROCESS ((DWORD)-1)
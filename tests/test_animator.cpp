@@ -0,0 +1,305 @@
+#include <windows.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "animator.h"
+#include "check.h"
+#include "events.h"
+#include "features.h"
+#include "hooks.h"
+#include "hotkeys.h"
+#include "winctrl.h"
+
+// Drives the animation thread frame by frame: it waits in `DwmFlush` until the test presents the
+// next frame, and the clock only moves between frames
+
+const RECT MONITOR = {0, 0, 1920, 1080};
+const RECT WORK_AREA = {0, 0, 1920, 1040};
+const RECT NORMAL = {100, 100, 500, 400};
+
+/// The default `[Animation] Duration`
+const DWORD DURATION_MS = 150;
+
+static void setUp()
+{
+    fakewin::reset();
+    fakewin::addMonitor(MONITOR, WORK_AREA);
+    fakewin::setUnlimitedFrames(false);
+    Feature::Animations = true;
+}
+
+static void tearDown()
+{
+    fakewin::setApplyGate(false);
+    fakewin::setUnlimitedFrames(true);
+    teardownAnimations();
+}
+
+static void nextFrame(DWORD milliseconds)
+{
+    CHECK(fakewin::waitUntilParked());
+    fakewin::advance(milliseconds);
+    CHECK(fakewin::presentFrame());
+}
+
+/// @brief Presents frames until the animation thread has nothing left to animate
+static void finishAnimations()
+{
+    CHECK(fakewin::waitUntilParked());
+    for (DWORD elapsed = 0; elapsed <= 2 * DURATION_MS; elapsed += 16)
+    {
+        fakewin::advance(16);
+        if (!fakewin::presentFrame())
+        {
+            return;
+        }
+    }
+    CHECK(!"the animations did not finish");
+}
+
+static RECT normalRectOf(HWND hWnd)
+{
+    WINDOWPLACEMENT placement = {sizeof(WINDOWPLACEMENT)};
+    GetWindowPlacement(hWnd, &placement);
+    return placement.rcNormalPosition;
+}
+
+static bool isBetween(const RECT &rect, const RECT &from, const RECT &to)
+{
+    return rect.left < from.left && rect.left > to.left && rect.right > from.right && rect.right < to.right;
+}
+
+static void testMaximizeAndRestore()
+{
+    setUp();
+    HWND hWnd = fakewin::createWindow(L"Notepad", NORMAL);
+
+    toggleWindowMaximized(hWnd);
+    CHECK(fakewin::waitUntilParked());
+    nextFrame(50);
+    CHECK(isBetween(fakewin::window(hWnd)->rect, NORMAL, WORK_AREA));
+    CHECK(!IsZoomed(hWnd));
+
+    finishAnimations();
+    CHECK(IsZoomed(hWnd));
+    CHECK_RECT(fakewin::window(hWnd)->rect, 0, 0, 1920, 1040);
+    CHECK_RECT(normalRectOf(hWnd), 100, 100, 500, 400);
+
+    toggleWindowMaximized(hWnd);
+    CHECK(!IsZoomed(hWnd));
+    finishAnimations();
+    CHECK_RECT(fakewin::window(hWnd)->rect, 100, 100, 500, 400);
+
+    tearDown();
+}
+
+static void testToggleWhileMaximizing()
+{
+    setUp();
+    HWND hWnd = fakewin::createWindow(L"Notepad", NORMAL);
+
+    toggleWindowMaximized(hWnd);
+    CHECK(fakewin::waitUntilParked());
+    nextFrame(50);
+    CHECK(isBetween(fakewin::window(hWnd)->rect, NORMAL, WORK_AREA));
+
+    // Still growing, so it counts as maximized: toggling shrinks it back where it came from,
+    // rather than maximizing it with the rect it has mid-way as its normal rect
+    toggleWindowMaximized(hWnd);
+    finishAnimations();
+    CHECK(!IsZoomed(hWnd));
+    CHECK_RECT(fakewin::window(hWnd)->rect, 100, 100, 500, 400);
+    CHECK_RECT(normalRectOf(hWnd), 100, 100, 500, 400);
+
+    // Turning around twice ends maximized, still restoring to the original rect
+    toggleWindowMaximized(hWnd);
+    nextFrame(50);
+    toggleWindowMaximized(hWnd);
+    nextFrame(30);
+    toggleWindowMaximized(hWnd);
+    finishAnimations();
+    CHECK(IsZoomed(hWnd));
+    CHECK_RECT(normalRectOf(hWnd), 100, 100, 500, 400);
+
+    tearDown();
+}
+
+static void testToggleWhileRestoring()
+{
+    setUp();
+    HWND hWnd = fakewin::createWindow(L"Notepad", NORMAL);
+    ShowWindow(hWnd, SW_MAXIMIZE);
+
+    toggleWindowMaximized(hWnd);
+    CHECK(fakewin::waitUntilParked());
+    nextFrame(50);
+    CHECK(!IsZoomed(hWnd));
+    CHECK(isBetween(fakewin::window(hWnd)->rect, NORMAL, WORK_AREA));
+
+    // Still shrinking, so it counts as restored: toggling maximizes it again, keeping the rect it
+    // was being restored to
+    toggleWindowMaximized(hWnd);
+    finishAnimations();
+    CHECK(IsZoomed(hWnd));
+    CHECK_RECT(normalRectOf(hWnd), 100, 100, 500, 400);
+
+    toggleWindowMaximized(hWnd);
+    finishAnimations();
+    CHECK(!IsZoomed(hWnd));
+    CHECK_RECT(fakewin::window(hWnd)->rect, 100, 100, 500, 400);
+
+    tearDown();
+}
+
+static void testAFailedBatchStillMovesEveryWindow()
+{
+    setUp();
+    HWND first = fakewin::createWindow(L"Notepad", NORMAL);
+    HWND second = fakewin::createWindow(L"Notepad", {600, 500, 1000, 800});
+    ShowWindow(first, SW_MAXIMIZE);
+    ShowWindow(second, SW_MAXIMIZE);
+
+    // Every frame moves both windows in one batch, which the system abandons at the second window
+    fakewin::failDeferredPosition(1);
+    toggleWindowMaximized(first);
+    toggleWindowMaximized(second);
+    CHECK(fakewin::waitUntilParked());
+    nextFrame(50);
+    CHECK(isBetween(fakewin::window(first)->rect, NORMAL, WORK_AREA));
+    finishAnimations();
+    CHECK_RECT(fakewin::window(first)->rect, 100, 100, 500, 400);
+    CHECK_RECT(fakewin::window(second)->rect, 600, 500, 1000, 800);
+
+    tearDown();
+}
+
+static void *openGateLater(void *)
+{
+    usleep(5 * 1000);
+    fakewin::setApplyGate(false);
+    return NULL;
+}
+
+static void testCancelWaitsForTheFrameBeingApplied()
+{
+    setUp();
+    HWND hWnd = fakewin::createWindow(L"Notepad", NORMAL);
+
+    toggleWindowMaximized(hWnd);
+    CHECK(fakewin::waitUntilParked());
+
+    // Hold the animation thread right before it moves the window
+    fakewin::setApplyGate(true);
+    fakewin::advance(50);
+    fakewin::releaseFrame();
+    CHECK(fakewin::waitUntilGated());
+    RECT before = fakewin::window(hWnd)->rect;
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, openGateLater, NULL);
+    CHECK_EQUAL(cancelWindowAnimation(hWnd), TRANSITION_MAXIMIZE);
+    pthread_join(thread, NULL);
+
+    // The frame landed before the cancel returned, and nothing moves the window after it
+    RECT cancelled = fakewin::window(hWnd)->rect;
+    CHECK(memcmp(&before, &cancelled, sizeof(RECT)) != 0);
+    CHECK(fakewin::waitUntilParked());
+    fakewin::setUnlimitedFrames(true);
+    usleep(5 * 1000);
+    CHECK(memcmp(&cancelled, &fakewin::window(hWnd)->rect, sizeof(RECT)) == 0);
+    CHECK(!IsZoomed(hWnd));
+
+    tearDown();
+}
+
+static void testCancelDoesNotWaitForeverForAHungWindow()
+{
+    setUp();
+    HWND hWnd = fakewin::createWindow(L"Notepad", NORMAL);
+
+    toggleWindowMaximized(hWnd);
+    CHECK(fakewin::waitUntilParked());
+    fakewin::setApplyGate(true);
+    fakewin::advance(50);
+    fakewin::releaseFrame();
+    CHECK(fakewin::waitUntilGated());
+
+    CHECK_EQUAL(cancelWindowAnimation(hWnd), TRANSITION_MAXIMIZE);
+
+    tearDown();
+}
+
+static void testAMaximizeHotkeyTurnsTheAnimationAround()
+{
+    setUp();
+    fakewin::setIni(L"Hotkeys", L"Win+Alt+M", L"maximize");
+    HWND hWnd = fakewin::createWindow(L"Notepad", NORMAL);
+    fakewin::setCursor(200, 200);
+    CHECK(setupHooks());
+
+    // Hit twice while the window is still growing: it shrinks back, keeping its normal rect
+    sendKey(VK_LWIN, true);
+    sendKey(VK_LMENU, true);
+    CHECK_EQUAL(sendKey('M', true), 1);
+    sendKey('M', false);
+    CHECK(fakewin::waitUntilParked());
+    nextFrame(50);
+    CHECK(isBetween(fakewin::window(hWnd)->rect, NORMAL, WORK_AREA));
+    CHECK_EQUAL(sendKey('M', true), 1);
+    sendKey('M', false);
+    sendKey(VK_LMENU, false);
+    sendKey(VK_LWIN, false);
+    finishAnimations();
+    CHECK(!IsZoomed(hWnd));
+    CHECK_RECT(fakewin::window(hWnd)->rect, 100, 100, 500, 400);
+    CHECK_RECT(normalRectOf(hWnd), 100, 100, 500, 400);
+
+    // A plugin toggles through the same action
+    HotkeyAction maximize = {HOTKEY_MAXIMIZE, 0, 0};
+    performHotkeyAction(&maximize, hWnd);
+    nextFrame(50);
+    performHotkeyAction(&maximize, hWnd);
+    finishAnimations();
+    CHECK(!IsZoomed(hWnd));
+    CHECK_RECT(normalRectOf(hWnd), 100, 100, 500, 400);
+
+    teardownHooks();
+    tearDown();
+}
+
+static void testEveryClickOfADoubleClickToggles()
+{
+    setUp();
+    Feature::Animations = false;
+    HWND hWnd = fakewin::createWindow(L"Notepad", NORMAL);
+
+    sendKey(VK_LWIN, true);
+    click(WM_LBUTTONDOWN, 200, 200);
+    CHECK(IsZoomed(hWnd));
+
+    fakewin::advance(100);
+    click(WM_LBUTTONDOWN, 200, 200);
+    CHECK(!IsZoomed(hWnd));
+
+    // ... and so does a click that follows a double-click
+    fakewin::advance(100);
+    click(WM_LBUTTONDOWN, 200, 200);
+    CHECK(IsZoomed(hWnd));
+    sendKey(VK_LWIN, false);
+
+    tearDown();
+}
+
+int main()
+{
+    testMaximizeAndRestore();
+    testToggleWhileMaximizing();
+    testToggleWhileRestoring();
+    testAFailedBatchStillMovesEveryWindow();
+    testCancelWaitsForTheFrameBeingApplied();
+    testCancelDoesNotWaitForeverForAHungWindow();
+    testAMaximizeHotkeyTurnsTheAnimationAround();
+    testEveryClickOfADoubleClickToggles();
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,273 @@
+#include <windows.h>
+#include <new>
+
+#include "budget.h"
+#include "check.h"
+#include "events.h"
+#include "features.h"
+#include "hooks.h"
+
+// Replays input traces through the counting build of the hooks (-DWINCTRL_HOOK_BUDGET) and checks
+// every event against its budget. The simulated platform counts every call the hook thread makes,
+// annotated or not, so a platform call added to a hook path without `HOOK_PLATFORM_CALL` fails here.
+
+const RECT MONITOR = {0, 0, 1920, 1080};
+const RECT WORK_AREA = {0, 0, 1920, 1040};
+
+static const char *const EVENT_TYPE_NAMES[HOOK_EVENT_TYPES] = {"mouse move", "mouse button", "key", "action"};
+
+static const char *s_trace = "";
+static int s_eventIndex = 0;
+static int s_eventsChecked[HOOK_EVENT_TYPES];
+
+static void startTrace(const char *trace)
+{
+    s_trace = trace;
+    s_eventIndex = 0;
+}
+
+/// @brief Checks the cost of the event just sent, whose platform calls were counted since `resetCalls`
+static void checkEvent()
+{
+    HookEventCost cost = getLastHookEventCost();
+    int platformCalls = fakewin::calls() - fakewin::calls("CallNextHookEx");
+    int budget = getPlatformCallBudget(cost.type);
+    s_eventsChecked[cost.type]++;
+
+    // Nothing may allocate. Only the calls of the frequent events are all annotated; the calls of
+    // window actions are counted by the simulated platform alone, against the same kind of budget
+    bool isAnnotated = cost.type == HOOK_ACTION || platformCalls == cost.platformCalls;
+    bool isWithinBudget = cost.allocations == 0 && platformCalls <= budget && isAnnotated;
+    if (!isWithinBudget)
+    {
+        fprintf(stderr, "%s, event %d (%s): %d allocation(s), %d platform call(s) of which %d annotated (budget %d):",
+                s_trace, s_eventIndex, EVENT_TYPE_NAMES[cost.type], cost.allocations, platformCalls,
+                cost.platformCalls, budget);
+        for (int i = 0; fakewin::callName(i); i++)
+        {
+            fprintf(stderr, " %s x%d", fakewin::callName(i), fakewin::calls(fakewin::callName(i)));
+        }
+        fprintf(stderr, "\n");
+        s_failedChecks++;
+    }
+    s_eventIndex++;
+}
+
+static void mouse(UINT message, int x, int y, short wheelDelta = 0)
+{
+    fakewin::advance(8);
+    fakewin::resetCalls();
+    sendMouse(message, x, y, wheelDelta);
+    checkEvent();
+}
+
+static void key(DWORD vkCode, bool isDown)
+{
+    fakewin::advance(8);
+    fakewin::resetCalls();
+    sendKey(vkCode, isDown);
+    checkEvent();
+}
+
+static void setUp()
+{
+    fakewin::reset();
+    fakewin::addMonitor(MONITOR, WORK_AREA);
+    fakewin::createWindow(L"Notepad", {100, 100, 900, 700});
+    Feature::Animations = false;
+    CHECK(setupHooks());
+}
+
+// TRACES
+// ------
+
+static void traceMovesWithoutWin()
+{
+    startTrace("moves without Win");
+    for (int i = 0; i < 200; i++)
+    {
+        mouse(WM_MOUSEMOVE, 200 + i, 300 + i / 2);
+    }
+    mouse(WM_LBUTTONDOWN, 400, 400);
+    mouse(WM_MOUSEMOVE, 420, 400);
+    mouse(WM_LBUTTONUP, 420, 400);
+    mouse(WM_MOUSEWHEEL, 420, 400, WHEEL_DELTA);
+}
+
+static void traceMovesWithWin()
+{
+    startTrace("moves with Win");
+    key(VK_LWIN, true);
+    for (int i = 0; i < 200; i++)
+    {
+        mouse(WM_MOUSEMOVE, 200 + i, 300);
+    }
+    key(VK_LWIN, false);
+}
+
+static void traceDrag()
+{
+    startTrace("drag");
+    key(VK_LWIN, true);
+    mouse(WM_LBUTTONDOWN, 300, 300);
+    for (int i = 1; i <= 100; i++)
+    {
+        mouse(WM_MOUSEMOVE, 300 + 3 * i, 300 + i);
+    }
+    mouse(WM_LBUTTONUP, 600, 400);
+    key(VK_LWIN, false);
+}
+
+static void traceResize()
+{
+    startTrace("resize");
+    key(VK_LWIN, true);
+    mouse(WM_MBUTTONDOWN, 800, 600);
+    for (int i = 1; i <= 100; i++)
+    {
+        mouse(WM_MOUSEMOVE, 800 + i, 600 + i);
+    }
+    mouse(WM_MBUTTONUP, 900, 700);
+    key(VK_LWIN, false);
+}
+
+static void traceClicksAndWheel()
+{
+    startTrace("clicks and wheel");
+    key(VK_LWIN, true);
+    for (int i = 0; i < 3; i++)
+    {
+        mouse(WM_LBUTTONDOWN, 300, 300);
+        mouse(WM_LBUTTONUP, 300, 300);
+        fakewin::advance(1000);
+    }
+    mouse(WM_MBUTTONDOWN, 300, 300);
+    mouse(WM_MBUTTONUP, 300, 300);
+    key(VK_CONTROL, true);
+    mouse(WM_MOUSEWHEEL, 300, 300, -WHEEL_DELTA);
+    key(VK_CONTROL, false);
+    key(VK_LWIN, false);
+}
+
+static void traceTyping()
+{
+    startTrace("typing");
+    const char *text = "THE QUICK BROWN FOX 0123456789";
+    for (const char *c = text; *c; c++)
+    {
+        key(*c, true);
+        key(*c, false);
+    }
+
+    key(VK_SHIFT, true);
+    key('A', true);
+    key('A', false);
+    key(VK_SHIFT, false);
+
+    // Keys that are not bound, while Win is held
+    key(VK_LWIN, true);
+    key('Q', true);
+    key('Q', false);
+    key(VK_LWIN, false);
+}
+
+static void traceHotkeys()
+{
+    startTrace("hotkeys");
+    key(VK_LWIN, true);
+    key(VK_LMENU, true);
+    key(VK_RIGHT, true);
+    key(VK_RIGHT, false);
+    key(VK_PRIOR, true);
+    key(VK_PRIOR, false);
+    key(VK_LSHIFT, true);
+    key(VK_DOWN, true);
+    key(VK_DOWN, false);
+    key(VK_LSHIFT, false);
+    key(VK_LMENU, false);
+    key(VK_LCONTROL, true);
+    key('Z', true);
+    key('Z', false);
+    key(VK_LCONTROL, false);
+    key(VK_LWIN, false);
+}
+
+/// Wheel turns that might act but do not: throttled desktop switches, and a window action with
+/// no window under the cursor. Only the turns that act are accounted as actions.
+static void traceWheelsThatDoNotAct()
+{
+    startTrace("wheels that do not act");
+    key(VK_LWIN, true);
+    mouse(WM_MOUSEWHEEL, 300, 300, -WHEEL_DELTA);
+    int actions = s_eventsChecked[HOOK_ACTION];
+    for (int i = 0; i < 10; i++)
+    {
+        mouse(WM_MOUSEWHEEL, 300, 300, -WHEEL_DELTA);
+    }
+    key(VK_LCONTROL, true);
+    mouse(WM_MOUSEWHEEL, 1500, 900, WHEEL_DELTA);
+    key(VK_LCONTROL, false);
+    key(VK_LWIN, false);
+    CHECK_EQUAL(s_eventsChecked[HOOK_ACTION], actions);
+}
+
+/// Every form of `new` counts as an allocation, not just the plain one
+static void testEveryAllocationIsCounted()
+{
+    int overBudget = getHookEventsOverBudget();
+
+    beginHookEvent(HOOK_KEY);
+    int *plain = new int(1);
+    int *array = new int[4];
+    int *nothrow = new (std::nothrow) int(2);
+    int *nothrowArray = new (std::nothrow) int[4];
+    struct alignas(64) Aligned
+    {
+        char bytes[64];
+    };
+    Aligned *aligned = new Aligned;
+    Aligned *alignedArray = new Aligned[2];
+    Aligned *alignedNothrow = new (std::nothrow) Aligned;
+    endHookEvent();
+
+    CHECK_EQUAL(getLastHookEventCost().allocations, 7);
+    CHECK_EQUAL(getHookEventsOverBudget(), overBudget + 1);
+    CHECK_EQUAL((uintptr_t)aligned % 64, 0);
+    CHECK_EQUAL((uintptr_t)alignedArray % 64, 0);
+    CHECK_EQUAL((uintptr_t)alignedNothrow % 64, 0);
+
+    delete plain;
+    delete[] array;
+    delete nothrow;
+    delete[] nothrowArray;
+    delete aligned;
+    delete[] alignedArray;
+    delete alignedNothrow;
+}
+
+int main()
+{
+    setUp();
+    int overBudget = getHookEventsOverBudget();
+
+    traceMovesWithoutWin();
+    traceMovesWithWin();
+    traceDrag();
+    traceResize();
+    traceClicksAndWheel();
+    traceTyping();
+    traceHotkeys();
+    traceWheelsThatDoNotAct();
+
+    // Each kind of event was exercised, and none went over its budget by the hooks' own count either
+    for (int type = 0; type < HOOK_EVENT_TYPES; type++)
+    {
+        CHECK(s_eventsChecked[type] > 0);
+    }
+    CHECK_EQUAL(getHookEventsOverBudget(), overBudget);
+
+    teardownHooks();
+    testEveryAllocationIsCounted();
+
+    CHECK_RESULT();
+}
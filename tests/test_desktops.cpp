@@ -0,0 +1,461 @@
+#include <windows.h>
+#include <chrono>
+#include <thread>
+
+#include "check.h"
+#include "desktops.h"
+#include "fakewin.h"
+#include "hotkeys.h"
+#include "shelldesktops.h"
+#include "winctrl.h"
+
+// Checks the desktop bookkeeping against a fake desktop manager that the test fully controls,
+// then the shell backend against Explorer, the registry and the input of the simulated platform
+
+// FAKE BACKEND
+// ------------
+
+class FakeDesktopBackend : public DesktopBackend
+{
+public:
+    int desktops = 4;
+    int currentDesktop = 0;
+    bool isKnown = true;      // Whether `query` can tell the desktops
+    bool canActivate = false; // Whether `activate` succeeds
+    bool canStep = true;      // Whether `step` succeeds
+    double stepDuration = 12; // How long a step takes, in milliseconds
+
+    int activateCalls = 0;
+    int stepCalls = 0;
+    int lastSteps = 0;
+    void *movedWindow = nullptr;
+    int moveTarget = -1;
+    double clock = 1000;
+
+    bool query(int *count, int *current) override
+    {
+        *count = desktops;
+        *current = currentDesktop;
+        return isKnown;
+    }
+
+    bool activate(int index) override
+    {
+        activateCalls++;
+        if (!canActivate)
+        {
+            return false;
+        }
+        clock += stepDuration;
+        currentDesktop = index;
+        return true;
+    }
+
+    bool step(int steps) override
+    {
+        stepCalls++;
+        lastSteps = steps;
+        clock += stepDuration * (steps < 0 ? -steps : steps);
+        if (!canStep)
+        {
+            return false;
+        }
+
+        // Like the system, stop at the first and last desktop
+        currentDesktop += steps;
+        currentDesktop = currentDesktop < 0 ? 0 : (currentDesktop >= desktops ? desktops - 1 : currentDesktop);
+        return true;
+    }
+
+    bool moveWindow(void *window, int index) override
+    {
+        movedWindow = window;
+        moveTarget = index;
+        return true;
+    }
+
+    double now() override { return clock; }
+};
+
+static void testSwitchToPrefersADirectSwitch()
+{
+    FakeDesktopBackend backend;
+    backend.canActivate = true;
+    VirtualDesktops desktops;
+    desktops.setBackend(&backend);
+
+    CHECK(desktops.switchTo(3));
+    CHECK(desktops.usedDirectSwitch());
+    CHECK_EQUAL(backend.activateCalls, 1);
+    CHECK_EQUAL(backend.stepCalls, 0);
+    CHECK_EQUAL(desktops.current(), 3);
+    CHECK_EQUAL(desktops.lastSwitchLatency(), 12);
+
+    // When the direct switch fails, the steps still get there
+    backend.canActivate = false;
+    CHECK(desktops.switchTo(1));
+    CHECK(!desktops.usedDirectSwitch());
+    CHECK_EQUAL(backend.activateCalls, 2);
+    CHECK_EQUAL(backend.lastSteps, -2);
+    CHECK_EQUAL(backend.currentDesktop, 1);
+
+    // ... and the next switch tries the direct way again
+    backend.canActivate = true;
+    CHECK(desktops.switchBy(1));
+    CHECK(desktops.usedDirectSwitch());
+    CHECK_EQUAL(backend.currentDesktop, 2);
+}
+
+static void testMoveWindowToChecksTheDesktop()
+{
+    FakeDesktopBackend backend;
+    VirtualDesktops desktops;
+    int window = 0;
+    CHECK(!desktops.moveWindowTo(&window, 1)); // No backend yet
+
+    desktops.setBackend(&backend);
+    CHECK(!desktops.moveWindowTo(nullptr, 1));
+    CHECK(!desktops.moveWindowTo(&window, 4));
+    CHECK(!desktops.moveWindowTo(&window, -1));
+    CHECK(backend.movedWindow == nullptr);
+
+    CHECK(desktops.moveWindowTo(&window, 3));
+    CHECK(backend.movedWindow == &window);
+    CHECK_EQUAL(backend.moveTarget, 3);
+    CHECK_EQUAL(backend.currentDesktop, 0); // Moving a window does not switch
+}
+
+static void testSwitchToTakesAllStepsAtOnce()
+{
+    FakeDesktopBackend backend;
+    VirtualDesktops desktops;
+    desktops.setBackend(&backend);
+
+    CHECK(desktops.switchTo(3));
+    CHECK_EQUAL(backend.stepCalls, 1);
+    CHECK_EQUAL(backend.lastSteps, 3);
+    CHECK_EQUAL(desktops.current(), 3);
+    CHECK_EQUAL(desktops.count(), 4);
+    CHECK_EQUAL(desktops.lastSwitchLatency(), 36);
+
+    CHECK(desktops.switchTo(1));
+    CHECK_EQUAL(backend.lastSteps, -2);
+    CHECK_EQUAL(desktops.lastSwitchLatency(), 24);
+    CHECK_EQUAL(backend.currentDesktop, 1);
+}
+
+static void testSwitchToRejectsWhatItCannotDo()
+{
+    FakeDesktopBackend backend;
+    VirtualDesktops desktops;
+    CHECK(!desktops.switchTo(1)); // No backend yet
+
+    desktops.setBackend(&backend);
+    CHECK(!desktops.switchTo(-1));
+    CHECK(!desktops.switchTo(4));
+    CHECK(!desktops.switchTo(0)); // Already there
+    CHECK_EQUAL(backend.stepCalls, 0);
+
+    // Without knowing the desktops, the steps to take are unknown too
+    backend.isKnown = false;
+    CHECK(!desktops.switchTo(2));
+    CHECK_EQUAL(backend.stepCalls, 0);
+    CHECK_EQUAL(desktops.count(), 0);
+    CHECK_EQUAL(desktops.current(), -1);
+
+    // A failed switch does not count as done
+    backend.isKnown = true;
+    backend.canStep = false;
+    CHECK(!desktops.switchTo(2));
+    CHECK_EQUAL(backend.stepCalls, 1);
+    CHECK_EQUAL(desktops.current(), 0);
+}
+
+static void testBookkeepingFollowsTheUser()
+{
+    FakeDesktopBackend backend;
+    VirtualDesktops desktops;
+    desktops.setBackend(&backend);
+    CHECK(desktops.switchTo(1));
+
+    // The user switched and added desktops behind our back
+    backend.currentDesktop = 4;
+    backend.desktops = 6;
+    CHECK(desktops.switchTo(2));
+    CHECK_EQUAL(backend.lastSteps, -2);
+    CHECK_EQUAL(desktops.count(), 6);
+
+    // ... and removed some
+    backend.desktops = 2;
+    backend.currentDesktop = 1;
+    CHECK(!desktops.switchTo(2));
+    CHECK(desktops.switchTo(0));
+    CHECK_EQUAL(backend.lastSteps, -1);
+}
+
+static void testSwitchByStopsAtTheEnds()
+{
+    FakeDesktopBackend backend;
+    VirtualDesktops desktops;
+    desktops.setBackend(&backend);
+
+    CHECK(!desktops.switchBy(0));
+    CHECK(!desktops.switchBy(-1)); // Already on the first desktop
+    CHECK_EQUAL(backend.stepCalls, 0);
+
+    CHECK(desktops.switchBy(2));
+    CHECK_EQUAL(desktops.current(), 2);
+    CHECK(desktops.switchBy(5));
+    CHECK_EQUAL(backend.lastSteps, 1);
+    CHECK_EQUAL(desktops.current(), 3);
+    CHECK(!desktops.switchBy(1));
+}
+
+static void testSwitchByStepsBlindlyWhenTheDesktopsAreUnknown()
+{
+    FakeDesktopBackend backend;
+    backend.isKnown = false;
+    VirtualDesktops desktops;
+    desktops.setBackend(&backend);
+
+    CHECK(desktops.switchBy(1));
+    CHECK_EQUAL(backend.lastSteps, 1);
+    CHECK_EQUAL(desktops.lastSwitchLatency(), 12);
+    CHECK(desktops.switchBy(-1));
+    CHECK_EQUAL(backend.lastSteps, -1);
+    CHECK_EQUAL(backend.stepCalls, 2);
+}
+
+// SHELL BACKEND
+// -------------
+
+/// @brief Checks that the input sent since `clearSentInput` is exactly the given keys,
+/// with negative codes for releases
+static void checkSentKeys(const int *keys, int count)
+{
+    CHECK_EQUAL(fakewin::sentInputCount(), count);
+    for (int i = 0; i < count && i < fakewin::sentInputCount(); i++)
+    {
+        const INPUT &input = fakewin::sentInput(i);
+        bool isKeyUp = input.ki.dwFlags & KEYEVENTF_KEYUP;
+        CHECK_EQUAL(isKeyUp ? -(int)input.ki.wVk : (int)input.ki.wVk, keys[i]);
+    }
+}
+
+/// @brief Checks that nothing talked to Explorer, the registry or the keyboard on the hook thread
+static void checkNothingDoneYet()
+{
+    CHECK_EQUAL(fakewin::calls("CoCreateInstance"), 0);
+    CHECK_EQUAL(fakewin::calls("RegGetValueW"), 0);
+    CHECK_EQUAL(fakewin::calls("SendInput"), 0);
+}
+
+static void testSwitchesAreMadeOnTheThreadPool()
+{
+    const fakewin::ShellRelease RELEASES[] = {fakewin::SHELL_WINDOWS_10, fakewin::SHELL_WINDOWS_11, fakewin::SHELL_WINDOWS_11_24H2};
+    for (fakewin::ShellRelease release : RELEASES)
+    {
+        fakewin::reset();
+        fakewin::setShellRelease(release);
+        fakewin::setDesktops(4, 1);
+        setupVirtualDesktops();
+
+        CHECK(switchToDesktop(3));
+        checkNothingDoneYet();
+        CHECK_EQUAL(fakewin::currentDesktop(), 1);
+
+        // Explorer switches straight there: no keys, and no registry
+        fakewin::runThreadPool();
+        CHECK_EQUAL(fakewin::currentDesktop(), 3);
+        CHECK_EQUAL(fakewin::sentInputCount(), 0);
+        CHECK_EQUAL(fakewin::calls("RegGetValueW"), 0);
+        CHECK_EQUAL(fakewin::calls("CoInitializeEx"), fakewin::calls("CoUninitialize"));
+        CHECK_EQUAL(fakewin::shellReferences(), 0);
+        teardownVirtualDesktops();
+    }
+}
+
+static void testRequestsAreMergedUntilThePoolGetsToThem()
+{
+    fakewin::reset();
+    fakewin::setShellRelease(fakewin::SHELL_WINDOWS_11);
+    fakewin::setDesktops(4, 0);
+    setupVirtualDesktops();
+
+    // A burst of requests becomes one work item, and only the last switch is made
+    CHECK(switchToDesktop(3));
+    CHECK(switchToDesktop(2));
+    CHECK_EQUAL(fakewin::calls("QueueUserWorkItem"), 1);
+    fakewin::runThreadPool();
+    CHECK_EQUAL(fakewin::currentDesktop(), 2);
+    CHECK_EQUAL(fakewin::calls("CoCreateInstance"), 1);
+
+    // Once done, the next request queues a new one
+    CHECK(switchToDesktop(0));
+    CHECK_EQUAL(fakewin::calls("QueueUserWorkItem"), 2);
+    fakewin::runThreadPool();
+    CHECK_EQUAL(fakewin::currentDesktop(), 0);
+
+    // Scrolls add up, and go on from a switch made before them (once past the throttle of the
+    // wheel, which follows the real clock)
+    fakewin::resetCalls();
+    MSLLHOOKSTRUCT scroll = {};
+    scroll.mouseData = (DWORD)(-WHEEL_DELTA) << 16;
+    std::this_thread::sleep_for(std::chrono::milliseconds(510));
+    CHECK(handleMouseWheel(&scroll));
+    std::this_thread::sleep_for(std::chrono::milliseconds(510));
+    CHECK(handleMouseWheel(&scroll));
+    checkNothingDoneYet();
+    fakewin::runThreadPool();
+    CHECK_EQUAL(fakewin::currentDesktop(), 2);
+
+    CHECK(switchToDesktop(0));
+    std::this_thread::sleep_for(std::chrono::milliseconds(510));
+    CHECK(handleMouseWheel(&scroll));
+    fakewin::runThreadPool();
+    CHECK_EQUAL(fakewin::currentDesktop(), 1);
+    teardownVirtualDesktops();
+}
+
+static void testSendToDesktopMovesAnyWindow()
+{
+    fakewin::reset();
+    fakewin::setShellRelease(fakewin::SHELL_WINDOWS_11_24H2);
+    fakewin::setDesktops(3, 0);
+    setupVirtualDesktops();
+
+    // A window of another process, as most are
+    HWND hWnd = fakewin::createWindow(L"Notepad", {100, 100, 600, 500}, 200);
+    HotkeyAction action = {HOTKEY_SEND_TO_DESKTOP, 3, 0};
+    performHotkeyAction(&action, hWnd);
+    checkNothingDoneYet();
+    CHECK_EQUAL(fakewin::window(hWnd)->desktop, 0);
+
+    fakewin::runThreadPool();
+    CHECK_EQUAL(fakewin::window(hWnd)->desktop, 2);
+    CHECK_EQUAL(fakewin::currentDesktop(), 0);
+    CHECK_EQUAL(fakewin::shellReferences(), 0);
+
+    // There is no such desktop
+    CHECK(moveWindowToDesktop(hWnd, 3));
+    fakewin::runThreadPool();
+    CHECK_EQUAL(fakewin::window(hWnd)->desktop, 2);
+    teardownVirtualDesktops();
+}
+
+static void testUnknownReleasesFallBackToKeys()
+{
+    fakewin::reset();
+    fakewin::setDesktops(4, 1);
+    setupVirtualDesktops();
+
+    fakewin::clearSentInput();
+    CHECK(switchToDesktop(3));
+    checkNothingDoneYet();
+    fakewin::runThreadPool();
+    const int keys[] = {VK_LWIN, VK_CONTROL, VK_RIGHT, -VK_RIGHT, VK_RIGHT, -VK_RIGHT, -VK_CONTROL, -VK_LWIN};
+    checkSentKeys(keys, sizeof(keys) / sizeof(keys[0]));
+    CHECK_EQUAL(fakewin::calls("SendInput"), 1);
+    CHECK_EQUAL(fakewin::shellReferences(), 0);
+
+    // There are no keys to move a window with
+    HWND hWnd = fakewin::createWindow(L"Notepad", {100, 100, 600, 500}, 200);
+    CHECK(moveWindowToDesktop(hWnd, 2));
+    fakewin::runThreadPool();
+    CHECK_EQUAL(fakewin::window(hWnd)->desktop, 0);
+
+    // Explorer is only asked which interfaces it has once
+    fakewin::resetCalls();
+    CHECK(switchToDesktop(2));
+    fakewin::runThreadPool();
+    CHECK_EQUAL(fakewin::calls("CoCreateInstance"), 0);
+    teardownVirtualDesktops();
+}
+
+static void testTheRegistryIsOnlyReadAgainOnceItChanged()
+{
+    fakewin::reset();
+    fakewin::setDesktops(4, 1);
+    setupVirtualDesktops();
+
+    CHECK(switchToDesktop(3));
+    fakewin::runThreadPool();
+    CHECK_EQUAL(fakewin::calls("RegGetValueW"), 2);
+
+    // The fake shell does not switch on keys, so the registry still says desktop 1
+    fakewin::resetCalls();
+    fakewin::clearSentInput();
+    CHECK(switchToDesktop(2));
+    fakewin::runThreadPool();
+    CHECK_EQUAL(fakewin::calls("RegGetValueW"), 0);
+    const int right[] = {VK_LWIN, VK_CONTROL, VK_RIGHT, -VK_RIGHT, -VK_CONTROL, -VK_LWIN};
+    checkSentKeys(right, sizeof(right) / sizeof(right[0]));
+
+    // Explorer rewrites the registry once it has switched
+    fakewin::setDesktops(4, 3);
+    fakewin::resetCalls();
+    fakewin::clearSentInput();
+    CHECK(switchToDesktop(2));
+    fakewin::runThreadPool();
+    CHECK_EQUAL(fakewin::calls("RegGetValueW"), 2);
+    const int left[] = {VK_LWIN, VK_CONTROL, VK_LEFT, -VK_LEFT, -VK_CONTROL, -VK_LWIN};
+    checkSentKeys(left, sizeof(left) / sizeof(left[0]));
+    teardownVirtualDesktops();
+}
+
+static void testShellBackendLeavesHeldKeysAlone()
+{
+    fakewin::reset();
+    fakewin::setDesktops(3, 2);
+    setupVirtualDesktops();
+
+    // A switch made while Win is held (a hotkey, or a scroll) only taps the keys that are not down yet
+    fakewin::setKeyDown(VK_LWIN, true);
+    fakewin::clearSentInput();
+    CHECK(switchToDesktop(1));
+    fakewin::runThreadPool();
+    const int keys[] = {VK_CONTROL, VK_LEFT, -VK_LEFT, -VK_CONTROL};
+    checkSentKeys(keys, sizeof(keys) / sizeof(keys[0]));
+    fakewin::setKeyDown(VK_LWIN, false);
+    teardownVirtualDesktops();
+}
+
+static void testShellBackendWithOneDesktop()
+{
+    const fakewin::ShellRelease RELEASES[] = {fakewin::SHELL_UNKNOWN, fakewin::SHELL_WINDOWS_11};
+    for (fakewin::ShellRelease release : RELEASES)
+    {
+        fakewin::reset();
+        fakewin::setShellRelease(release);
+        setupVirtualDesktops();
+
+        // Explorer only lists the desktops in the registry once there is a second one
+        fakewin::clearSentInput();
+        CHECK(switchToDesktop(1));
+        fakewin::runThreadPool();
+        CHECK_EQUAL(fakewin::sentInputCount(), 0);
+        CHECK_EQUAL(fakewin::currentDesktop(), 0);
+        teardownVirtualDesktops();
+    }
+}
+
+int main()
+{
+    testSwitchToTakesAllStepsAtOnce();
+    testSwitchToRejectsWhatItCannotDo();
+    testBookkeepingFollowsTheUser();
+    testSwitchByStopsAtTheEnds();
+    testSwitchByStepsBlindlyWhenTheDesktopsAreUnknown();
+    testSwitchToPrefersADirectSwitch();
+    testMoveWindowToChecksTheDesktop();
+
+    testSwitchesAreMadeOnTheThreadPool();
+    testRequestsAreMergedUntilThePoolGetsToThem();
+    testSendToDesktopMovesAnyWindow();
+    testUnknownReleasesFallBackToKeys();
+    testTheRegistryIsOnlyReadAgainOnceItChanged();
+    testShellBackendLeavesHeldKeysAlone();
+    testShellBackendWithOneDesktop();
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,240 @@
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#include "check.h"
+#include "geometry.h"
+
+// Checks the fixed-point resize and zoom math at run time, over ranges of rects that the checks in
+// geometry.h only sample: exact round trips, rounding that does not depend on where a monitor puts
+// the window, and zooms kept within the size limits
+
+/// A tenth per wheel notch, up to 24 notches either way, as the zoom of winctrl
+const Fixed ZOOM_STEP = 72090;
+const int MAX_STEPS = 24;
+
+/// Rects of odd and even sizes, on monitors left of, across and right of the origin
+static GeometryRect rectAt(int index)
+{
+    int left = -3840 + index * 397 % 7680;
+    int top = -1080 + index * 211 % 2160;
+    return {left, top, left + 201 + index * 53 % 1600, top + 151 + index * 31 % 900};
+}
+
+const int RECTS = 500;
+
+// ROUNDING
+// --------
+
+static void testDivisionRoundsTheSameWayOnBothSidesOfZero()
+{
+    for (int denominator = 1; denominator <= 24; denominator++)
+    {
+        for (int numerator = -1000; numerator <= 1000; numerator++)
+        {
+            double exact = (double)numerator / denominator;
+            CHECK_EQUAL(divideFloor(numerator, denominator), (int64_t)floor(exact));
+            CHECK_EQUAL(divideRounded(numerator, denominator), (int64_t)round(exact));
+            CHECK_EQUAL(divideRounded(-numerator, denominator), -divideRounded(numerator, denominator));
+            CHECK_EQUAL(divideRounded(numerator, -denominator), -divideRounded(numerator, denominator));
+        }
+    }
+}
+
+static void testZoomingDoesNotDependOnTheMonitor()
+{
+    // The same window, zoomed the same way, on each monitor of a row of three, and straddling
+    // the edges between them: only its position differs
+    const int OFFSETS[] = {-1920, -961, -1, 0, 1, 959, 1920};
+    for (int i = 0; i < RECTS; i++)
+    {
+        GeometryRect rect = rectAt(i);
+        int height = rect.height() * 3 / 4 + i % 7;
+        Fixed scale = FIXED_ONE * 3 / 4 + i;
+        GeometryRect centered = zoomAboutCenter(rect, height);
+        GeometryRect anchored = zoomAbout(rect, rect.left + 37, rect.top + 23, scale);
+        for (int offset : OFFSETS)
+        {
+            GeometryRect moved = {rect.left + offset, rect.top - offset, rect.right + offset, rect.bottom - offset};
+            GeometryRect movedCentered = zoomAboutCenter(moved, height);
+            GeometryRect movedAnchored = zoomAbout(moved, moved.left + 37, moved.top + 23, scale);
+            CHECK_EQUAL(movedCentered.left - centered.left, offset);
+            CHECK_EQUAL(movedCentered.bottom - centered.bottom, -offset);
+            CHECK_EQUAL(movedCentered.width(), centered.width());
+            CHECK_EQUAL(movedAnchored.left - anchored.left, offset);
+            CHECK_EQUAL(movedAnchored.bottom - anchored.bottom, -offset);
+            CHECK_EQUAL(movedAnchored.width(), anchored.width());
+        }
+    }
+}
+
+static void testZoomingAboutAMonitorEdgeKeepsTheWindowOnIt()
+{
+    // Windows against the left edge of a monitor left of the origin, and the right edge of the
+    // primary monitor, zoomed about the edge they touch
+    for (int steps = -MAX_STEPS; steps <= MAX_STEPS; steps++)
+    {
+        Fixed scale = powerFixed(ZOOM_STEP, steps);
+        GeometryRect left = zoomAbout({-1920, 117, -1119, 718}, -1920, 400, scale);
+        CHECK_EQUAL(left.left, -1920);
+        CHECK_EQUAL(left.width(), scaleLength(801, scale));
+
+        GeometryRect right = zoomAbout({1119, 117, 1920, 718}, 1920, 718, scale);
+        CHECK_EQUAL(right.right, 1920);
+        CHECK_EQUAL(right.bottom, 718);
+    }
+}
+
+// ROUND TRIPS
+// -----------
+
+static void testZoomingBackReturnsTheSameRect()
+{
+    for (int i = 0; i < RECTS; i++)
+    {
+        GeometryRect rect = rectAt(i);
+        CHECK(zoomAboutCenter(rect, rect.height()) == rect);
+        CHECK(zoomAbout(rect, rect.left + i % 300, rect.bottom - i % 200, powerFixed(ZOOM_STEP, 0)) == rect);
+    }
+
+    // A resize of the center scales by the ratio of the heights, which must come back exactly
+    for (int start = 100; start <= 2160; start += 7)
+    {
+        for (int height = 50; height <= 4000; height += 3)
+        {
+            CHECK_EQUAL(scaleLength(start, fixedRatio(height, start)), height);
+        }
+    }
+}
+
+static void testZoomStepsUndoEachOther()
+{
+    for (int steps = 1; steps <= MAX_STEPS; steps++)
+    {
+        Fixed product = multiplyFixed(powerFixed(ZOOM_STEP, steps), powerFixed(ZOOM_STEP, -steps));
+        CHECK(abs(product - FIXED_ONE) <= 2);
+    }
+    CHECK_EQUAL(powerFixed(ZOOM_STEP, 1), ZOOM_STEP);
+    CHECK(fabs(powerFixed(ZOOM_STEP, 10) / (double)FIXED_ONE - pow(1.1, 10)) < 1e-3);
+}
+
+static void testResizingBackReturnsTheSameRect()
+{
+    const int EDGES[] = {EDGE_LEFT, EDGE_TOP | EDGE_LEFT, EDGE_BOTTOM | EDGE_RIGHT, EDGE_TOP | EDGE_RIGHT};
+    for (int i = 0; i < RECTS; i++)
+    {
+        GeometryRect rect = rectAt(i);
+        int edges = EDGES[i % 4];
+        GeometryRect moved = moveEdges(rect, edges, i - 250, 250 - i);
+        CHECK(moveEdges(moved, edges, 250 - i, i - 250) == rect);
+        CHECK(moveEdges(rect, edges, 0, 0) == rect);
+
+        // The anchored edges stay exactly where they were
+        CHECK_EQUAL(moved.right, edges & EDGE_RIGHT ? rect.right + i - 250 : rect.right);
+        CHECK_EQUAL(moved.bottom, edges & EDGE_BOTTOM ? rect.bottom + 250 - i : rect.bottom);
+    }
+}
+
+// SHAPE
+// -----
+
+static void testZoomingKeepsTheCenterAndTheAspectRatio()
+{
+    for (int i = 0; i < RECTS; i++)
+    {
+        GeometryRect rect = rectAt(i);
+        for (int height = 100; height <= 2000; height += 37)
+        {
+            GeometryRect zoomed = zoomAboutCenter(rect, height);
+            CHECK_EQUAL(zoomed.height(), height);
+
+            // To within half a pixel, always rounding up and to the left
+            double exactWidth = (double)height * rect.width() / rect.height();
+            CHECK(fabs(zoomed.width() - exactWidth) <= 0.5);
+            double centerX = (rect.left + rect.right) / 2.0 - (zoomed.left + zoomed.right) / 2.0;
+            double centerY = (rect.top + rect.bottom) / 2.0 - (zoomed.top + zoomed.bottom) / 2.0;
+            CHECK(centerX >= 0 && centerX <= 0.5);
+            CHECK(centerY >= 0 && centerY <= 0.5);
+        }
+    }
+}
+
+// ZOOM CLAMP
+// ----------
+
+static void testZoomStaysWithinTheSizeLimits()
+{
+    SizeLimits limits;
+    limits.minWidth = 500;
+    limits.minHeight = 400;
+    limits.maxWidth = 1000;
+    limits.maxHeight = 800;
+
+    for (int i = 0; i < RECTS; i++)
+    {
+        GeometryRect rect = rectAt(i);
+        for (int steps = -MAX_STEPS; steps <= MAX_STEPS; steps++)
+        {
+            Fixed scale = clampScale(powerFixed(ZOOM_STEP, steps), rect.width(), rect.height(), limits);
+            GeometryRect zoomed = zoomAbout(rect, rect.left, rect.top, scale);
+
+            // The width is rounded to a pixel, and the height follows from it by the aspect ratio.
+            // The minimum always holds; the maximum only where the window fits both.
+            double heightPerWidth = (double)rect.height() / rect.width();
+            double heightRounding = 1 + heightPerWidth;
+            double lowest = std::max((double)limits.minWidth / rect.width(), (double)limits.minHeight / rect.height());
+            double highest = std::min((double)limits.maxWidth / rect.width(), (double)limits.maxHeight / rect.height());
+            CHECK(zoomed.width() >= limits.minWidth - 1 && zoomed.height() >= limits.minHeight - heightRounding);
+            if (lowest <= highest)
+            {
+                CHECK(zoomed.width() <= limits.maxWidth + 1 && zoomed.height() <= limits.maxHeight + heightRounding);
+            }
+        }
+    }
+}
+
+static void testTheMinimumWinsOverTheMaximum()
+{
+    // A window that is too wide to fit its minimum height under the maximum width, zoomed in
+    // past both and out below both
+    SizeLimits limits;
+    limits.minHeight = 600;
+    limits.maxWidth = 800;
+    CHECK_EQUAL(clampScale(2 * FIXED_ONE, 1600, 400, limits), fixedRatio(600, 400));
+    CHECK_EQUAL(clampScale(FIXED_ONE / 2, 1600, 400, limits), fixedRatio(600, 400));
+    CHECK_EQUAL(scaleLength(400, fixedRatio(600, 400)), 600);
+}
+
+static void testNoLimitsLeaveTheZoomAlone()
+{
+    SizeLimits limits;
+    for (int steps = -MAX_STEPS; steps <= MAX_STEPS; steps++)
+    {
+        Fixed scale = powerFixed(ZOOM_STEP, steps);
+        CHECK_EQUAL(clampScale(scale, 1, 1, limits), scale);
+        CHECK_EQUAL(clampScale(scale, 3840, 2160, limits), scale);
+    }
+
+    // The largest ratio saturates rather than wrapping around
+    CHECK_EQUAL(fixedRatio(INT_MAX, 1), INT32_MAX);
+    CHECK_EQUAL(fixedRatio(0, 1), 0);
+}
+
+int main()
+{
+    testDivisionRoundsTheSameWayOnBothSidesOfZero();
+    testZoomingDoesNotDependOnTheMonitor();
+    testZoomingAboutAMonitorEdgeKeepsTheWindowOnIt();
+
+    testZoomingBackReturnsTheSameRect();
+    testZoomStepsUndoEachOther();
+    testResizingBackReturnsTheSameRect();
+
+    testZoomingKeepsTheCenterAndTheAspectRatio();
+
+    testZoomStaysWithinTheSizeLimits();
+    testTheMinimumWinsOverTheMaximum();
+    testNoLimitsLeaveTheZoomAlone();
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,492 @@
+#include <windows.h>
+
+#include "check.h"
+#include "events.h"
+#include "features.h"
+#include "hooks.h"
+#include "gestures.h"
+
+// Walks the recognizer through every phase a button can be in, and feeds each phase every kind of
+// event. The phases are only reachable through the public interface, so each case rebuilds them.
+
+enum Phase
+{
+    IDLE,
+    PRESSED,
+    LONG_PRESSED,
+    DRAGGING,
+    PHASE_COUNT
+};
+
+const char *const PHASE_NAMES[PHASE_COUNT] = {"IDLE", "PRESSED", "LONG_PRESSED", "DRAGGING"};
+
+const int DOWN_X = 100;
+const int DOWN_Y = 100;
+const uint32_t DOWN_TIME = 1000;
+
+/// @brief Puts the left button in the given phase, pressed at `DOWN_TIME` if it is held
+/// @return The time of the last event
+static uint32_t enterPhase(GestureRecognizer &gestures, Phase phase)
+{
+    if (phase == IDLE)
+    {
+        return DOWN_TIME;
+    }
+
+    gestures.buttonDown(GESTURE_LEFT, DOWN_X, DOWN_Y, DOWN_TIME);
+    switch (phase)
+    {
+    case LONG_PRESSED:
+        CHECK_EQUAL(gestures.poll(DOWN_TIME + 600).kind, GESTURE_LONG_PRESS);
+        return DOWN_TIME + 600;
+
+    case DRAGGING:
+        CHECK_EQUAL(gestures.move(DOWN_X + 10, DOWN_Y, DOWN_TIME + 10).kind, GESTURE_DRAG_START);
+        return DOWN_TIME + 10;
+
+    default:
+        return DOWN_TIME;
+    }
+}
+
+static Phase phaseOf(const GestureRecognizer &gestures)
+{
+    if (gestures.isDragging(GESTURE_LEFT))
+    {
+        return DRAGGING;
+    }
+    if (!gestures.isPressed(GESTURE_LEFT))
+    {
+        return IDLE;
+    }
+
+    // A held button that can still become a long-press has not had it yet
+    uint32_t remaining;
+    return gestures.timeUntilLongPress(DOWN_TIME, &remaining) ? PRESSED : LONG_PRESSED;
+}
+
+enum Event
+{
+    EVENT_DOWN,
+    EVENT_UP_QUICK,       // Released in place before the click time
+    EVENT_UP_SLOW,        // Released in place after the click time
+    EVENT_UP_AWAY,        // Released quickly, but beyond the drag distance
+    EVENT_MOVE_NEAR,      // Moved within the drag distance, early
+    EVENT_MOVE_FAR,       // Moved beyond the drag distance, early
+    EVENT_MOVE_NEAR_LATE, // Moved within the drag distance, after the long-press time
+    EVENT_MOVE_FAR_LATE,  // Moved beyond the drag distance, after the long-press time
+    EVENT_POLL_EARLY,
+    EVENT_POLL_LATE,
+    EVENT_COUNT
+};
+
+const char *const EVENT_NAMES[EVENT_COUNT] = {
+    "down",      "quick up",       "slow up",       "up away",    "near move",
+    "far move",  "late near move", "late far move", "early poll", "late poll",
+};
+
+static Gesture feedEvent(GestureRecognizer &gestures, Event event, uint32_t lastTime)
+{
+    // Events never go back in time, but are timed from the press to land either side of the thresholds
+    auto at = [lastTime](uint32_t sincePress) { return DOWN_TIME + sincePress > lastTime ? DOWN_TIME + sincePress : lastTime; };
+
+    switch (event)
+    {
+    case EVENT_DOWN:
+        return gestures.buttonDown(GESTURE_LEFT, DOWN_X, DOWN_Y, at(100));
+    case EVENT_UP_QUICK:
+        return gestures.buttonUp(GESTURE_LEFT, DOWN_X + 1, DOWN_Y, at(100));
+    case EVENT_UP_SLOW:
+        return gestures.buttonUp(GESTURE_LEFT, DOWN_X, DOWN_Y, at(300));
+    case EVENT_UP_AWAY:
+        return gestures.buttonUp(GESTURE_LEFT, DOWN_X + 10, DOWN_Y, at(100));
+    case EVENT_MOVE_NEAR:
+        return gestures.move(DOWN_X + 3, DOWN_Y - 3, at(100));
+    case EVENT_MOVE_FAR:
+        return gestures.move(DOWN_X, DOWN_Y + 20, at(100));
+    case EVENT_MOVE_NEAR_LATE:
+        return gestures.move(DOWN_X + 3, DOWN_Y - 3, at(700));
+    case EVENT_MOVE_FAR_LATE:
+        return gestures.move(DOWN_X, DOWN_Y + 20, at(700));
+    case EVENT_POLL_EARLY:
+        return gestures.poll(at(100));
+    case EVENT_POLL_LATE:
+    default:
+        return gestures.poll(at(700));
+    }
+}
+
+struct Transition
+{
+    GestureKind gesture;
+    Phase next;
+};
+
+// Rows are phases, columns events, in the order of their enums
+const Transition TRANSITIONS[PHASE_COUNT][EVENT_COUNT] = {
+    // IDLE: only a press does anything
+    {
+        {GESTURE_NONE, PRESSED},
+        {GESTURE_NONE, IDLE},
+        {GESTURE_NONE, IDLE},
+        {GESTURE_NONE, IDLE},
+        {GESTURE_NONE, IDLE},
+        {GESTURE_NONE, IDLE},
+        {GESTURE_NONE, IDLE},
+        {GESTURE_NONE, IDLE},
+        {GESTURE_NONE, IDLE},
+        {GESTURE_NONE, IDLE},
+    },
+    // PRESSED
+    {
+        {GESTURE_NONE, PRESSED},
+        {GESTURE_CLICK, IDLE},
+        {GESTURE_NONE, IDLE},
+        {GESTURE_NONE, IDLE},
+        {GESTURE_NONE, PRESSED},
+        {GESTURE_DRAG_START, DRAGGING},
+        {GESTURE_LONG_PRESS, LONG_PRESSED},
+        {GESTURE_DRAG_START, DRAGGING},
+        {GESTURE_NONE, PRESSED},
+        {GESTURE_LONG_PRESS, LONG_PRESSED},
+    },
+    // LONG_PRESSED: the press has had its gesture, so nothing but a release or a new press ends it
+    {
+        {GESTURE_NONE, PRESSED},
+        {GESTURE_NONE, IDLE},
+        {GESTURE_NONE, IDLE},
+        {GESTURE_NONE, IDLE},
+        {GESTURE_NONE, LONG_PRESSED},
+        {GESTURE_NONE, LONG_PRESSED},
+        {GESTURE_NONE, LONG_PRESSED},
+        {GESTURE_NONE, LONG_PRESSED},
+        {GESTURE_NONE, LONG_PRESSED},
+        {GESTURE_NONE, LONG_PRESSED},
+    },
+    // DRAGGING: every move is a drag step, however far or late
+    {
+        {GESTURE_NONE, PRESSED},
+        {GESTURE_DRAG_END, IDLE},
+        {GESTURE_DRAG_END, IDLE},
+        {GESTURE_DRAG_END, IDLE},
+        {GESTURE_DRAG_MOVE, DRAGGING},
+        {GESTURE_DRAG_MOVE, DRAGGING},
+        {GESTURE_DRAG_MOVE, DRAGGING},
+        {GESTURE_DRAG_MOVE, DRAGGING},
+        {GESTURE_NONE, DRAGGING},
+        {GESTURE_NONE, DRAGGING},
+    },
+};
+
+static void testEveryTransition()
+{
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        for (int event = 0; event < EVENT_COUNT; event++)
+        {
+            GestureRecognizer gestures;
+            uint32_t lastTime = enterPhase(gestures, (Phase)phase);
+            Gesture gesture = feedEvent(gestures, (Event)event, lastTime);
+
+            const Transition &expected = TRANSITIONS[phase][event];
+            Phase next = phaseOf(gestures);
+            if (gesture.kind != expected.gesture || next != expected.next)
+            {
+                fprintf(stderr, "%s, %s: got gesture %d and %s, expected gesture %d and %s\n", PHASE_NAMES[phase],
+                        EVENT_NAMES[event], gesture.kind, PHASE_NAMES[next], expected.gesture,
+                        PHASE_NAMES[expected.next]);
+                s_failedChecks++;
+            }
+            CHECK(gesture.kind == GESTURE_NONE || gesture.button == GESTURE_LEFT);
+        }
+    }
+}
+
+static void testDoubleClick()
+{
+    GestureRecognizer gestures;
+    gestures.buttonDown(GESTURE_LEFT, 100, 100, 1000);
+    CHECK_EQUAL(gestures.buttonUp(GESTURE_LEFT, 100, 100, 1050).kind, GESTURE_CLICK);
+    gestures.buttonDown(GESTURE_LEFT, 103, 97, 1200);
+    CHECK_EQUAL(gestures.buttonUp(GESTURE_LEFT, 104, 96, 1250).kind, GESTURE_DOUBLE_CLICK);
+
+    // A double-click uses up both clicks, so a third click starts over
+    gestures.buttonDown(GESTURE_LEFT, 100, 100, 1300);
+    CHECK_EQUAL(gestures.buttonUp(GESTURE_LEFT, 100, 100, 1350).kind, GESTURE_CLICK);
+
+    // Too late
+    gestures.buttonDown(GESTURE_LEFT, 100, 100, 1800);
+    CHECK_EQUAL(gestures.buttonUp(GESTURE_LEFT, 100, 100, 1850).kind, GESTURE_CLICK);
+
+    // Too far
+    gestures.buttonDown(GESTURE_LEFT, 105, 100, 1900);
+    CHECK_EQUAL(gestures.buttonUp(GESTURE_LEFT, 105, 100, 1950).kind, GESTURE_CLICK);
+
+    // The buttons count their clicks apart
+    gestures.buttonDown(GESTURE_MIDDLE, 105, 100, 2000);
+    CHECK_EQUAL(gestures.buttonUp(GESTURE_MIDDLE, 105, 100, 2050).kind, GESTURE_CLICK);
+    gestures.buttonDown(GESTURE_LEFT, 105, 100, 2100);
+    CHECK_EQUAL(gestures.buttonUp(GESTURE_LEFT, 105, 100, 2150).kind, GESTURE_DOUBLE_CLICK);
+}
+
+static void testGesturesInBetweenBreakDoubleClicks()
+{
+    // A long-press, a drag or a press that is not a click all come between two clicks
+    const Event IN_BETWEEN[] = {EVENT_MOVE_NEAR_LATE, EVENT_POLL_LATE, EVENT_MOVE_FAR, EVENT_UP_SLOW};
+    for (Event event : IN_BETWEEN)
+    {
+        GestureRecognizer gestures;
+        gestures.thresholds.doubleClickTime = 2000;
+        gestures.buttonDown(GESTURE_LEFT, DOWN_X, DOWN_Y, DOWN_TIME - 100);
+        CHECK_EQUAL(gestures.buttonUp(GESTURE_LEFT, DOWN_X, DOWN_Y, DOWN_TIME - 50).kind, GESTURE_CLICK);
+
+        gestures.buttonDown(GESTURE_LEFT, DOWN_X, DOWN_Y, DOWN_TIME);
+        uint32_t time = DOWN_TIME + 700;
+        CHECK(feedEvent(gestures, event, DOWN_TIME).kind != GESTURE_NONE || event == EVENT_UP_SLOW);
+
+        // The release may be missed (e.g. the Win key was let go first), so the next press does
+        // not end the gesture in between either
+        gestures.buttonDown(GESTURE_LEFT, DOWN_X, DOWN_Y, time + 10);
+        Gesture gesture = gestures.buttonUp(GESTURE_LEFT, DOWN_X, DOWN_Y, time + 50);
+        if (gesture.kind != GESTURE_CLICK)
+        {
+            fprintf(stderr, "click after %s: got gesture %d, expected a click\n", EVENT_NAMES[event], gesture.kind);
+            s_failedChecks++;
+        }
+    }
+}
+
+static void testLongPressedButtonsDoNotDrag()
+{
+    GestureRecognizer gestures;
+    gestures.buttonDown(GESTURE_LEFT, 100, 100, 1000);
+    CHECK_EQUAL(gestures.poll(1600).kind, GESTURE_LONG_PRESS);
+
+    for (int x = 100; x < 400; x += 25)
+    {
+        CHECK_EQUAL(gestures.move(x, 100, 1600 + x).kind, GESTURE_NONE);
+    }
+    CHECK(!gestures.isDragging(GESTURE_LEFT));
+    CHECK_EQUAL(gestures.buttonUp(GESTURE_LEFT, 400, 100, 2000).kind, GESTURE_NONE);
+
+    // ... but a button held alongside still can
+    gestures.buttonDown(GESTURE_LEFT, 100, 100, 3000);
+    CHECK_EQUAL(gestures.poll(3600).kind, GESTURE_LONG_PRESS);
+    gestures.buttonDown(GESTURE_MIDDLE, 100, 100, 3700);
+    Gesture gesture = gestures.move(120, 100, 3710);
+    CHECK_EQUAL(gesture.kind, GESTURE_DRAG_START);
+    CHECK_EQUAL(gesture.button, GESTURE_MIDDLE);
+}
+
+static void testLeftButtonTakesPrecedence()
+{
+    GestureRecognizer gestures;
+    gestures.buttonDown(GESTURE_LEFT, 100, 100, 1000);
+    gestures.buttonDown(GESTURE_MIDDLE, 100, 100, 1000);
+    Gesture gesture = gestures.move(120, 100, 1010);
+    CHECK_EQUAL(gesture.kind, GESTURE_DRAG_START);
+    CHECK_EQUAL(gesture.button, GESTURE_LEFT);
+
+    gesture = gestures.poll(1700);
+    CHECK_EQUAL(gesture.kind, GESTURE_LONG_PRESS);
+    CHECK_EQUAL(gesture.button, GESTURE_MIDDLE);
+}
+
+static void testAPressedLeftButtonDoesNotHoldUpTheMiddleOne()
+{
+    // The cursor moved between the presses, so a move can be near the one and far from the other
+    GestureRecognizer gestures;
+    gestures.buttonDown(GESTURE_LEFT, 100, 100, 1000);
+    gestures.buttonDown(GESTURE_MIDDLE, 97, 100, 1010);
+    Gesture gesture = gestures.move(103, 100, 1020);
+    CHECK_EQUAL(gesture.kind, GESTURE_DRAG_START);
+    CHECK_EQUAL(gesture.button, GESTURE_MIDDLE);
+
+    // ... and keeps dragging while the left button is still a press
+    gesture = gestures.move(104, 100, 1030);
+    CHECK_EQUAL(gesture.kind, GESTURE_DRAG_MOVE);
+    CHECK_EQUAL(gesture.button, GESTURE_MIDDLE);
+    CHECK(!gestures.isDragging(GESTURE_LEFT));
+}
+
+static void testTimeUntilLongPress()
+{
+    GestureRecognizer gestures;
+    uint32_t remaining = 12345;
+    CHECK(!gestures.timeUntilLongPress(1000, &remaining));
+    CHECK_EQUAL(remaining, 12345);
+
+    gestures.buttonDown(GESTURE_LEFT, 100, 100, 1000);
+    CHECK(gestures.timeUntilLongPress(1000, &remaining));
+    CHECK_EQUAL(remaining, 600);
+    CHECK(gestures.timeUntilLongPress(1590, &remaining));
+    CHECK_EQUAL(remaining, 10);
+    CHECK(gestures.timeUntilLongPress(1700, &remaining));
+    CHECK_EQUAL(remaining, 0);
+
+    // The button pressed first is due first
+    gestures.buttonDown(GESTURE_MIDDLE, 100, 100, 1200);
+    CHECK(gestures.timeUntilLongPress(1500, &remaining));
+    CHECK_EQUAL(remaining, 100);
+
+    gestures.poll(1600);
+    CHECK(gestures.timeUntilLongPress(1600, &remaining));
+    CHECK_EQUAL(remaining, 200);
+
+    gestures.move(120, 100, 1610);
+    CHECK(gestures.isDragging(GESTURE_MIDDLE));
+    CHECK(!gestures.timeUntilLongPress(1610, &remaining));
+}
+
+static void testTimesWrapAround()
+{
+    GestureRecognizer gestures;
+    uint32_t downTime = UINT32_MAX - 50;
+    gestures.buttonDown(GESTURE_LEFT, 100, 100, downTime);
+    CHECK_EQUAL(gestures.buttonUp(GESTURE_LEFT, 100, 100, downTime + 100).kind, GESTURE_CLICK);
+    gestures.buttonDown(GESTURE_LEFT, 100, 100, downTime + 200);
+    CHECK_EQUAL(gestures.buttonUp(GESTURE_LEFT, 100, 100, downTime + 250).kind, GESTURE_DOUBLE_CLICK);
+
+    gestures.buttonDown(GESTURE_LEFT, 100, 100, downTime);
+    uint32_t remaining;
+    CHECK(gestures.timeUntilLongPress(downTime + 400, &remaining));
+    CHECK_EQUAL(remaining, 200);
+    CHECK_EQUAL(gestures.poll(downTime + 599).kind, GESTURE_NONE);
+    CHECK_EQUAL(gestures.poll(downTime + 600).kind, GESTURE_LONG_PRESS);
+}
+
+static void testResetForgetsEverything()
+{
+    GestureRecognizer gestures;
+    gestures.buttonDown(GESTURE_LEFT, 100, 100, 1000);
+    gestures.buttonUp(GESTURE_LEFT, 100, 100, 1050);
+    gestures.buttonDown(GESTURE_MIDDLE, 100, 100, 1100);
+    gestures.reset();
+
+    CHECK(!gestures.isPressed(GESTURE_MIDDLE));
+    gestures.buttonDown(GESTURE_LEFT, 100, 100, 1200);
+    CHECK_EQUAL(gestures.buttonUp(GESTURE_LEFT, 100, 100, 1250).kind, GESTURE_CLICK);
+}
+
+// HOOKS
+// -----
+
+static LRESULT sendMouseAt(UINT message, int x, int y, DWORD time)
+{
+    fakewin::setCursor(x, y);
+    MSLLHOOKSTRUCT mouse = {};
+    mouse.pt = {x, y};
+    mouse.time = time;
+    return MouseProc(HC_ACTION, message, (LPARAM)&mouse);
+}
+
+static bool isTopmost(HWND hWnd)
+{
+    return GetWindowLongPtr(hWnd, GWL_EXSTYLE) & WS_EX_TOPMOST;
+}
+
+static void testEarlyTimerStillLongPresses()
+{
+    fakewin::reset();
+    HWND hWnd = fakewin::createWindow(L"Notepad", {100, 100, 500, 400});
+
+    // The event is stamped a little ahead of the clock the timer runs on, so the timer fires
+    // before the press is long enough
+    sendKey(VK_LWIN, true);
+    sendMouseAt(WM_LBUTTONDOWN, 200, 200, fakewin::now() + 10);
+    fakewin::advance(600);
+    CHECK_EQUAL(fakewin::fireTimers(), 1);
+    CHECK(!isTopmost(hWnd));
+    CHECK_EQUAL(fakewin::timerCount(), 1);
+
+    fakewin::advance(10);
+    CHECK_EQUAL(fakewin::fireTimers(), 1);
+    CHECK(isTopmost(hWnd));
+
+    // Dragging the long-pressed button neither moves the window nor changes it again
+    sendMouse(WM_MOUSEMOVE, 300, 200);
+    sendMouse(WM_MOUSEMOVE, 400, 250);
+    CHECK_RECT(fakewin::window(hWnd)->rect, 100, 100, 500, 400);
+    sendMouse(WM_LBUTTONUP, 400, 250);
+    CHECK(isTopmost(hWnd));
+    sendKey(VK_LWIN, false);
+}
+
+static void testClicksNeedTheWinKeyWhenReleased()
+{
+    fakewin::reset();
+    fakewin::addMonitor({0, 0, 1920, 1080}, {0, 0, 1920, 1040});
+    Feature::Animations = false;
+    Feature::PredictiveDrag = false;
+    Feature::KineticThrow = false;
+    HWND hWnd = fakewin::createWindow(L"Notepad", {100, 100, 500, 400});
+    CHECK(setupHooks());
+
+    sendKey(VK_LWIN, true);
+    sendMouse(WM_LBUTTONDOWN, 200, 200);
+    sendKey(VK_LWIN, false);
+    fakewin::advance(50);
+    sendMouse(WM_LBUTTONUP, 200, 200);
+    CHECK(!IsZoomed(hWnd));
+
+    // A drag still ends
+    sendKey(VK_LWIN, true);
+    sendMouse(WM_LBUTTONDOWN, 200, 200);
+    sendMouse(WM_MOUSEMOVE, 210, 200);
+    fakewin::advance(8);
+    sendMouse(WM_MOUSEMOVE, 250, 200);
+    CHECK_RECT(fakewin::window(hWnd)->rect, 140, 100, 540, 400);
+    sendKey(VK_LWIN, false);
+    sendMouse(WM_LBUTTONUP, 250, 200);
+    sendKey(VK_LWIN, true);
+    sendMouse(WM_MOUSEMOVE, 300, 200);
+    CHECK_RECT(fakewin::window(hWnd)->rect, 140, 100, 540, 400);
+    sendKey(VK_LWIN, false);
+
+    // ... and a click with Win held throughout toggles
+    fakewin::advance(1000);
+    sendKey(VK_LWIN, true);
+    click(WM_LBUTTONDOWN, 200, 200);
+    sendKey(VK_LWIN, false);
+    CHECK(IsZoomed(hWnd));
+
+    teardownHooks();
+}
+
+static void testLongPressNeedsTheWinKey()
+{
+    fakewin::reset();
+    HWND hWnd = fakewin::createWindow(L"Notepad", {100, 100, 500, 400});
+
+    sendKey(VK_LWIN, true);
+    sendMouse(WM_LBUTTONDOWN, 200, 200);
+    sendKey(VK_LWIN, false);
+    fakewin::advance(600);
+    fakewin::fireTimers();
+    CHECK(!isTopmost(hWnd));
+
+    // ... and is not waited for any longer once it is let go
+    fakewin::advance(600);
+    fakewin::fireTimers();
+    CHECK(!isTopmost(hWnd));
+    sendMouse(WM_LBUTTONUP, 200, 200);
+}
+
+int main()
+{
+    testEveryTransition();
+    testDoubleClick();
+    testGesturesInBetweenBreakDoubleClicks();
+    testLongPressedButtonsDoNotDrag();
+    testLeftButtonTakesPrecedence();
+    testAPressedLeftButtonDoesNotHoldUpTheMiddleOne();
+    testTimeUntilLongPress();
+    testTimesWrapAround();
+    testResetForgetsEverything();
+
+    testEarlyTimerStillLongPresses();
+    testClicksNeedTheWinKeyWhenReleased();
+    testLongPressNeedsTheWinKey();
+
+    CHECK_RESULT();
+}
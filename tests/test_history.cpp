@@ -0,0 +1,161 @@
+#include <windows.h>
+
+#include "check.h"
+#include "fakewin.h"
+#include "history.h"
+
+// Mirrors the arena in history.cpp
+const int HISTORY_WINDOWS = 32;
+const int HISTORY_DEPTH = 16;
+
+static HWND createWindowAt(int x)
+{
+    return fakewin::createWindow(L"Notepad", {x, 0, x + 400, 300});
+}
+
+static int leftOf(HWND hWnd)
+{
+    return fakewin::window(hWnd)->rect.left;
+}
+
+/// @brief Records a change of the window, then moves it by `dx`
+static void moveWithHistory(HWND hWnd, int dx)
+{
+    recordGeometryChange(hWnd);
+    RECT rect = fakewin::window(hWnd)->rect;
+    SetWindowPos(hWnd, NULL, rect.left + dx, rect.top, 0, 0, SWP_NOSIZE);
+}
+
+static void testUndoAndRedoWithinCapacity()
+{
+    HWND hWnd = createWindowAt(0);
+    for (int i = 0; i < HISTORY_DEPTH + 4; i++)
+    {
+        moveWithHistory(hWnd, 10);
+    }
+    CHECK_EQUAL(leftOf(hWnd), 200);
+
+    // The current state takes a slot once undoing starts, so one state less than the depth can be undone
+    int undone = 0;
+    while (undoGeometryChange(hWnd))
+    {
+        undone++;
+        CHECK_EQUAL(leftOf(hWnd), 200 - 10 * undone);
+    }
+    CHECK_EQUAL(undone, HISTORY_DEPTH - 1);
+
+    int redone = 0;
+    while (redoGeometryChange(hWnd))
+    {
+        redone++;
+    }
+    CHECK_EQUAL(redone, HISTORY_DEPTH - 1);
+    CHECK_EQUAL(leftOf(hWnd), 200);
+
+    // A new change after undoing discards what could have been redone
+    undoGeometryChange(hWnd);
+    undoGeometryChange(hWnd);
+    moveWithHistory(hWnd, 5);
+    CHECK(!redoGeometryChange(hWnd));
+    CHECK(undoGeometryChange(hWnd));
+    CHECK_EQUAL(leftOf(hWnd), 180);
+
+    fakewin::destroyWindow(hWnd);
+}
+
+static void testForgetResetsTheWholeSlot()
+{
+    HWND hWnd = createWindowAt(0);
+    moveWithHistory(hWnd, 10);
+    moveWithHistory(hWnd, 10);
+    undoGeometryChange(hWnd);
+    forgetGeometryHistory(hWnd);
+
+    // A forgotten slot keeps no cursor, so nothing can be undone through it
+    CHECK(!undoGeometryChange(hWnd));
+    CHECK(!undoGeometryChange(NULL));
+    CHECK(!redoGeometryChange(NULL));
+
+    // A recycled handle starts with an empty history
+    fakewin::destroyWindow(hWnd);
+    forgetGeometryHistory(hWnd);
+    fakewin::createWindowWithHandle(hWnd, L"Other", {500, 500, 600, 600});
+    CHECK(!undoGeometryChange(hWnd));
+    CHECK_EQUAL(leftOf(hWnd), 500);
+    moveWithHistory(hWnd, 10);
+    CHECK(undoGeometryChange(hWnd));
+    CHECK_EQUAL(leftOf(hWnd), 500);
+    CHECK(!undoGeometryChange(hWnd));
+
+    fakewin::destroyWindow(hWnd);
+}
+
+static void testLeastRecentlyUsedIsEvicted()
+{
+    HWND windows[HISTORY_WINDOWS + 1];
+    for (int i = 0; i <= HISTORY_WINDOWS; i++)
+    {
+        windows[i] = createWindowAt(i);
+    }
+    for (int i = 0; i < HISTORY_WINDOWS; i++)
+    {
+        moveWithHistory(windows[i], 10);
+    }
+
+    // Using the oldest history makes the second one the least recently used
+    moveWithHistory(windows[0], 10);
+    moveWithHistory(windows[HISTORY_WINDOWS], 10);
+
+    CHECK(!undoGeometryChange(windows[1]));
+    CHECK(undoGeometryChange(windows[0]));
+    CHECK(undoGeometryChange(windows[2]));
+    CHECK(undoGeometryChange(windows[HISTORY_WINDOWS]));
+
+    for (HWND hWnd : windows)
+    {
+        fakewin::destroyWindow(hWnd);
+    }
+}
+
+static void testDestroyedWindowsAreReclaimedFirst()
+{
+    HWND windows[HISTORY_WINDOWS + 1];
+    for (int i = 0; i <= HISTORY_WINDOWS; i++)
+    {
+        windows[i] = createWindowAt(i);
+    }
+    for (int i = 0; i < HISTORY_WINDOWS; i++)
+    {
+        moveWithHistory(windows[i], 10);
+    }
+
+    // The destroyed window was never forgotten (its WinEvent was missed), but its slot is reused
+    // before any live history is evicted
+    fakewin::destroyWindow(windows[7]);
+    moveWithHistory(windows[HISTORY_WINDOWS], 10);
+
+    for (int i = 0; i <= HISTORY_WINDOWS; i++)
+    {
+        if (i != 7)
+        {
+            CHECK(undoGeometryChange(windows[i]));
+        }
+    }
+
+    for (HWND hWnd : windows)
+    {
+        fakewin::destroyWindow(hWnd);
+    }
+}
+
+int main()
+{
+    fakewin::reset();
+
+    testUndoAndRedoWithinCapacity();
+    testForgetResetsTheWholeSlot();
+    testLeastRecentlyUsedIsEvicted();
+    testDestroyedWindowsAreReclaimedFirst();
+
+    CHECK_RESULT();
+}
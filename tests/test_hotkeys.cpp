@@ -0,0 +1,247 @@
+#include <windows.h>
+
+#include "check.h"
+#include "events.h"
+#include "features.h"
+#include "hooks.h"
+#include "hotkeys.h"
+
+// Parses bindings from the simulated ini file, then feeds key streams through the keyboard hook
+
+const RECT MONITOR = {0, 0, 1920, 1080};
+const RECT WORK_AREA = {0, 0, 1920, 1040};
+
+static void bind(const wchar_t *chord, const wchar_t *action) { fakewin::setIni(L"Hotkeys", chord, action); }
+
+static void setUp()
+{
+    fakewin::reset();
+    fakewin::addMonitor(MONITOR, WORK_AREA);
+    Feature::Animations = false;
+}
+
+// PARSING
+// -------
+
+static void testParsesChords()
+{
+    setUp();
+    bind(L"Win+F1", L"maximize");
+    bind(L"win+f24", L"minimize");
+    bind(L" Win + Alt + Left ", L"move -20 0");
+    bind(L"Win+Ctrl+Shift+7", L"opacity 15");
+    bind(L"Win+Alt+Shift+Plus", L"resize 20 10");
+    CHECK_EQUAL(loadHotkeys(), 5);
+
+    CHECK_EQUAL(matchHotkey(MOD_WIN, VK_F1)->kind, HOTKEY_MAXIMIZE);
+    CHECK_EQUAL(matchHotkey(MOD_WIN, VK_F1 + 23)->kind, HOTKEY_MINIMIZE);
+    const HotkeyAction *move = matchHotkey(MOD_WIN | MOD_ALT, VK_LEFT);
+    CHECK(move && move->kind == HOTKEY_MOVE && move->x == -20 && move->y == 0);
+    CHECK_EQUAL(matchHotkey(MOD_WIN | MOD_CONTROL | MOD_SHIFT, '7')->x, 15);
+    const HotkeyAction *resize = matchHotkey(MOD_WIN | MOD_ALT | MOD_SHIFT, VK_OEM_PLUS);
+    CHECK(resize && resize->x == 20 && resize->y == 10);
+
+    // The modifiers must match exactly
+    CHECK(!matchHotkey(MOD_WIN | MOD_SHIFT, VK_F1));
+    CHECK(!matchHotkey(MOD_WIN | MOD_ALT | MOD_SHIFT, VK_LEFT));
+}
+
+static void testRejectsMalformedChords()
+{
+    setUp();
+    bind(L"Win+F1a", L"maximize");    // Not F1
+    bind(L"Win+F25", L"maximize");    // No such keys
+    bind(L"Win+F0", L"maximize");
+    bind(L"Win+Fx", L"maximize");
+    bind(L"Win+Pause", L"maximize");
+    bind(L"Win+A+B", L"maximize");    // Two keys
+    bind(L"Win+Alt", L"maximize");    // No key
+    bind(L"Win+Q", L"explode");       // Unknown action
+    bind(L"Ctrl+Z", L"undo");         // No Win
+    bind(L"Alt+Shift+Left", L"move");
+    bind(L"F5", L"maximize");
+    CHECK_EQUAL(loadHotkeys(), 0);
+
+    CHECK(!matchHotkey(MOD_WIN, VK_F1));
+    CHECK(!matchHotkey(MOD_CONTROL, 'Z'));
+    CHECK(!matchHotkey(0, VK_F1 + 4));
+}
+
+static void testLaterBindingsWin()
+{
+    setUp();
+    bind(L"Win+Alt+M", L"minimize");
+    bind(L"Alt+Win+M", L"maximize"); // The same chord
+    CHECK_EQUAL(loadHotkeys(), 2);
+    CHECK_EQUAL(matchHotkey(MOD_WIN | MOD_ALT, 'M')->kind, HOTKEY_MAXIMIZE);
+}
+
+static void testDefaultsLeaveTaskbarShortcutsAlone()
+{
+    setUp();
+    CHECK(loadHotkeys() > 0);
+    CHECK_EQUAL(matchHotkey(MOD_WIN | MOD_ALT, VK_RIGHT)->kind, HOTKEY_MOVE);
+    CHECK_EQUAL(matchHotkey(MOD_WIN | MOD_CONTROL, 'Z')->kind, HOTKEY_UNDO);
+
+    for (int digit = '0'; digit <= '9'; digit++)
+    {
+        CHECK(!matchHotkey(MOD_WIN | MOD_ALT, digit));
+        CHECK(!matchHotkey(MOD_WIN | MOD_CONTROL, digit));
+    }
+}
+
+// KEY STREAMS
+// -----------
+
+static HWND setUpHooks()
+{
+    HWND hWnd = fakewin::createWindow(L"Notepad", {100, 100, 900, 700});
+    fakewin::setCursor(400, 400);
+    CHECK(setupHooks());
+    fakewin::clearSentInput();
+    return hWnd;
+}
+
+static void testAChordActsOnTheWindowUnderTheCursor()
+{
+    setUp();
+    HWND hWnd = setUpHooks();
+
+    CHECK_EQUAL(sendKey(VK_LWIN, true), 0);
+    CHECK_EQUAL(sendKey(VK_LMENU, true), 0);
+    CHECK_EQUAL(sendKey(VK_RIGHT, true), 1); // Consumed
+    CHECK_RECT(fakewin::window(hWnd)->rect, 120, 100, 920, 700);
+
+    // Held down, the key repeats
+    CHECK_EQUAL(sendKey(VK_RIGHT, true), 1);
+    CHECK_RECT(fakewin::window(hWnd)->rect, 140, 100, 940, 700);
+    CHECK_EQUAL(sendKey(VK_RIGHT, false), 0);
+
+    // Shift joins in: now it resizes
+    sendKey(VK_LSHIFT, true);
+    CHECK_EQUAL(sendKey(VK_DOWN, true), 1);
+    sendKey(VK_DOWN, false);
+    sendKey(VK_LSHIFT, false);
+    CHECK_RECT(fakewin::window(hWnd)->rect, 140, 100, 940, 720);
+
+    sendKey(VK_LMENU, false);
+    sendKey(VK_LWIN, false);
+
+    // Each hotkey tapped the mask key, so releasing Win does not open the Start Menu
+    CHECK(fakewin::sentInputCount() >= 6);
+    CHECK_EQUAL(fakewin::sentInput(0).ki.wVk, 0xE8);
+    teardownHooks();
+}
+
+static void testKeysWithoutAChordPassThrough()
+{
+    setUp();
+    HWND hWnd = setUpHooks();
+
+    // Alt+Right without Win belongs to the focused application
+    sendKey(VK_LMENU, true);
+    CHECK_EQUAL(sendKey(VK_RIGHT, true), 0);
+    sendKey(VK_RIGHT, false);
+    sendKey(VK_LMENU, false);
+
+    // So does typing, with or without Win
+    const char *text = "HELLO WORLD 1234";
+    for (const char *c = text; *c; c++)
+    {
+        CHECK_EQUAL(sendKey(*c, true), 0);
+        sendKey(*c, false);
+    }
+    sendKey(VK_LWIN, true);
+    CHECK_EQUAL(sendKey('Q', true), 0);
+    sendKey('Q', false);
+    CHECK_EQUAL(sendKey('1', true), 0);
+    sendKey('1', false);
+    sendKey(VK_LWIN, false);
+
+    CHECK_RECT(fakewin::window(hWnd)->rect, 100, 100, 900, 700);
+    CHECK_EQUAL(fakewin::sentInputCount(), 0);
+    teardownHooks();
+}
+
+static void testAMissedReleaseDoesNotFireAHotkey()
+{
+    setUp();
+    HWND hWnd = setUpHooks();
+
+    // Win was released while the hook did not see it (e.g. on the secure desktop)
+    sendKey(VK_LWIN, true);
+    fakewin::setKeyDown(VK_LWIN, false);
+
+    sendKey(VK_LMENU, true);
+    CHECK_EQUAL(sendKey(VK_RIGHT, true), 0);
+    sendKey(VK_RIGHT, false);
+    sendKey(VK_LMENU, false);
+    CHECK_RECT(fakewin::window(hWnd)->rect, 100, 100, 900, 700);
+    teardownHooks();
+}
+
+static void testManyBindings()
+{
+    setUp();
+    static const UINT MODIFIERS[] = {0, MOD_ALT, MOD_CONTROL, MOD_SHIFT, MOD_ALT | MOD_SHIFT, MOD_CONTROL | MOD_SHIFT};
+    static const wchar_t *const PREFIXES[] = {L"Win+", L"Win+Alt+", L"Win+Ctrl+", L"Win+Shift+", L"Win+Alt+Shift+", L"Win+Ctrl+Shift+"};
+    const wchar_t KEYS[] = L"ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    int count = 0;
+    for (const wchar_t *prefix : PREFIXES)
+    {
+        for (int k = 0; KEYS[k] && count < 200; k++, count++)
+        {
+            wchar_t chord[32];
+            wchar_t action[32];
+            swprintf(chord, 32, L"%ls%lc", prefix, KEYS[k]);
+            swprintf(action, 32, L"move %d 0", count + 1);
+            bind(chord, action);
+        }
+    }
+    CHECK_EQUAL(loadHotkeys(), 200);
+
+    for (int i = 0; i < 200; i++)
+    {
+        const HotkeyAction *action = matchHotkey(MOD_WIN | MODIFIERS[i / 36], KEYS[i % 36]);
+        CHECK(action && action->x == i + 1);
+    }
+    CHECK(!matchHotkey(MOD_WIN | MOD_CONTROL | MOD_SHIFT, '9'));
+    CHECK(!matchHotkey(MOD_ALT, 'A'));
+}
+
+static void testRebindingKeepsTheSlot()
+{
+    // More lines than there are slots, all but one binding the same chord, spelled differently
+    setUp();
+    const int REBINDS = 255;
+    for (int i = 0; i < REBINDS; i++)
+    {
+        wchar_t chord[32];
+        wchar_t action[32];
+        swprintf(chord, 32, L"%*lsWin%*ls+%*lsAlt%*ls+M", i % 4, L"", i / 4 % 4, L"", i / 16 % 4, L"", i / 64, L"");
+        swprintf(action, 32, L"move %d 0", i + 1);
+        bind(chord, action);
+    }
+    bind(L"Win+Alt+N", L"minimize");
+    CHECK_EQUAL(loadHotkeys(), REBINDS + 1);
+
+    CHECK_EQUAL(matchHotkey(MOD_WIN | MOD_ALT, 'M')->x, REBINDS);
+    const HotkeyAction *other = matchHotkey(MOD_WIN | MOD_ALT, 'N');
+    CHECK(other && other->kind == HOTKEY_MINIMIZE);
+}
+
+int main()
+{
+    testParsesChords();
+    testRejectsMalformedChords();
+    testLaterBindingsWin();
+    testDefaultsLeaveTaskbarShortcutsAlone();
+
+    testAChordActsOnTheWindowUnderTheCursor();
+    testKeysWithoutAChordPassThrough();
+    testAMissedReleaseDoesNotFireAHotkey();
+    testManyBindings();
+    testRebindingKeepsTheSlot();
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,223 @@
+#include <windows.h>
+
+#include "check.h"
+#include "fakewin.h"
+#include "layout.h"
+
+// Saves and restores layouts on the simulated desktop, as the displays come and go
+
+const RECT LEFT_MONITOR = {0, 0, 1920, 1080};
+const RECT LEFT_WORK_AREA = {0, 0, 1920, 1040};
+const RECT RIGHT_MONITOR = {1920, 0, 3840, 1080};
+const RECT RIGHT_WORK_AREA = {1920, 0, 3840, 1040};
+const RECT LAPTOP_MONITOR = {0, 0, 1280, 720};
+const RECT LAPTOP_WORK_AREA = {0, 0, 1280, 680};
+
+const DWORD EDITOR_PROCESS = 200;
+
+static void setUp()
+{
+    fakewin::reset();
+    fakewin::addMonitor(LEFT_MONITOR, LEFT_WORK_AREA);
+    fakewin::addMonitor(RIGHT_MONITOR, RIGHT_WORK_AREA);
+    fakewin::addProcess(EDITOR_PROCESS, L"C:\\Program Files\\Editor\\editor.exe", 1);
+}
+
+static HWND createEditor(const wchar_t *title, RECT rect)
+{
+    return fakewin::createWindow(L"EditorFrame", rect, EDITOR_PROCESS, title);
+}
+
+static void moveTo(HWND hWnd, RECT rect)
+{
+    SetWindowPos(hWnd, NULL, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top, SWP_NOZORDER);
+}
+
+static RECT rectOf(HWND hWnd) { return fakewin::window(hWnd)->rect; }
+
+// MATCHING
+// --------
+
+static void testRestoresWindowsThatWereMoved()
+{
+    setUp();
+    HWND notes = createEditor(L"notes.txt", {100, 100, 900, 700});
+    HWND todo = createEditor(L"todo.txt", {2000, 50, 2600, 650});
+    CHECK(saveLayout(false));
+    CHECK(hasLayout());
+
+    moveTo(notes, {300, 300, 700, 600});
+    moveTo(todo, {10, 10, 410, 310});
+    fakewin::resetCalls();
+    CHECK_EQUAL(restoreLayout(), 2);
+    CHECK_RECT(rectOf(notes), 100, 100, 900, 700);
+    CHECK_RECT(rectOf(todo), 2000, 50, 2600, 650);
+
+    // Both moves went through a single deferred batch
+    CHECK_EQUAL(fakewin::calls("EndDeferWindowPos"), 1);
+    CHECK_EQUAL(fakewin::calls("SetWindowPos"), 0);
+}
+
+static void testAFailedBatchStillRestoresEveryWindow()
+{
+    setUp();
+    HWND notes = createEditor(L"notes.txt", {100, 100, 900, 700});
+    HWND todo = createEditor(L"todo.txt", {2000, 50, 2600, 650});
+    HWND draft = createEditor(L"draft.txt", {400, 200, 1000, 800});
+    CHECK(saveLayout(false));
+
+    moveTo(notes, {300, 300, 700, 600});
+    moveTo(todo, {10, 10, 410, 310});
+    moveTo(draft, {20, 20, 420, 320});
+
+    // The system abandons the batch at the last window, along with the two deferred before it
+    fakewin::failDeferredPosition(2);
+    CHECK_EQUAL(restoreLayout(), 3);
+    CHECK_RECT(rectOf(notes), 100, 100, 900, 700);
+    CHECK_RECT(rectOf(todo), 2000, 50, 2600, 650);
+    CHECK_RECT(rectOf(draft), 400, 200, 1000, 800);
+}
+
+static void testMatchesWindowsUnderNewHandles()
+{
+    setUp();
+    HWND notes = createEditor(L"notes.txt", {100, 100, 900, 700});
+    HWND todo = createEditor(L"todo.txt", {2000, 50, 2600, 650});
+    HWND other = fakewin::createWindow(L"Notepad", {500, 500, 900, 900}, 300, L"notes.txt");
+    CHECK(saveLayout(false));
+
+    // The editor was restarted: same process image, class and titles, new handles, in another order
+    fakewin::destroyWindow(notes);
+    fakewin::destroyWindow(todo);
+    fakewin::destroyWindow(other);
+    fakewin::addProcess(EDITOR_PROCESS + 1, L"C:\\Program Files\\Editor\\editor.exe", 2);
+    HWND newTodo = fakewin::createWindow(L"EditorFrame", {0, 0, 300, 300}, EDITOR_PROCESS + 1, L"todo.txt");
+    HWND newNotes = fakewin::createWindow(L"EditorFrame", {0, 0, 300, 300}, EDITOR_PROCESS + 1, L"notes.txt");
+    HWND stranger = fakewin::createWindow(L"Notepad", {40, 40, 340, 340}, 300, L"other.txt");
+
+    // The stranger still matches its record by process and class, if not by title
+    CHECK_EQUAL(restoreLayout(), 3);
+    CHECK_RECT(rectOf(newNotes), 100, 100, 900, 700);
+    CHECK_RECT(rectOf(newTodo), 2000, 50, 2600, 650);
+    CHECK_RECT(rectOf(stranger), 500, 500, 900, 900);
+}
+
+static void testPrefersTheSameHandle()
+{
+    setUp();
+    HWND first = createEditor(L"Untitled", {100, 100, 500, 500});
+    HWND second = createEditor(L"Untitled", {600, 100, 1000, 500});
+    CHECK(saveLayout(false));
+
+    moveTo(first, {600, 100, 1000, 500});
+    moveTo(second, {100, 100, 500, 500});
+    CHECK_EQUAL(restoreLayout(), 2);
+    CHECK_RECT(rectOf(first), 100, 100, 500, 500);
+    CHECK_RECT(rectOf(second), 600, 100, 1000, 500);
+}
+
+// DISPLAYS
+// --------
+
+static void testMapsWindowsOfAMissingMonitor()
+{
+    setUp();
+    HWND left = createEditor(L"left.txt", {100, 100, 900, 700});
+    HWND right = createEditor(L"right.txt", {2020, 104, 2980, 624});
+    CHECK(saveLayout(false));
+
+    // The right monitor was unplugged. The left one stays as it was.
+    fakewin::clearMonitors();
+    fakewin::addMonitor(LEFT_MONITOR, LEFT_WORK_AREA);
+    CHECK_EQUAL(restoreLayout(), 2);
+    CHECK_RECT(rectOf(left), 100, 100, 900, 700);
+    CHECK_RECT(rectOf(right), 100, 104, 1060, 624);
+
+    // Only a smaller monitor is left: both windows are scaled into its work area
+    fakewin::clearMonitors();
+    fakewin::addMonitor(LAPTOP_MONITOR, LAPTOP_WORK_AREA);
+    CHECK_EQUAL(restoreLayout(), 2);
+    CHECK_RECT(rectOf(left), 66, 65, 600, 457);
+    CHECK_RECT(rectOf(right), 66, 68, 706, 408);
+}
+
+static void testKeepsASnapshotPerDisplaySetup()
+{
+    setUp();
+    HWND hWnd = createEditor(L"notes.txt", {2100, 100, 2900, 700});
+    CHECK(saveLayout(false)); // Docked
+
+    fakewin::clearMonitors();
+    fakewin::addMonitor(LAPTOP_MONITOR, LAPTOP_WORK_AREA);
+    moveTo(hWnd, {20, 20, 620, 420});
+    CHECK(saveLayout(false)); // Undocked
+
+    // Docking again brings back the docked layout as it was, not the undocked one mapped
+    fakewin::clearMonitors();
+    fakewin::addMonitor(LEFT_MONITOR, LEFT_WORK_AREA);
+    fakewin::addMonitor(RIGHT_MONITOR, RIGHT_WORK_AREA);
+    moveTo(hWnd, {0, 0, 600, 400});
+    CHECK_EQUAL(restoreLayout(), 1);
+    CHECK_RECT(rectOf(hWnd), 2100, 100, 2900, 700);
+
+    fakewin::clearMonitors();
+    fakewin::addMonitor(LAPTOP_MONITOR, LAPTOP_WORK_AREA);
+    CHECK_EQUAL(restoreLayout(), 1);
+    CHECK_RECT(rectOf(hWnd), 20, 20, 620, 420);
+}
+
+// WINDOW STATE
+// ------------
+
+static void testMaximizedWindowsMaximizeOnTheMappedMonitor()
+{
+    setUp();
+    HWND hWnd = createEditor(L"notes.txt", {2100, 100, 2900, 700});
+    ShowWindow(hWnd, SW_MAXIMIZE);
+    CHECK_RECT(rectOf(hWnd), 1920, 0, 3840, 1040);
+    CHECK(saveLayout(false));
+
+    fakewin::clearMonitors();
+    fakewin::addMonitor(LEFT_MONITOR, LEFT_WORK_AREA);
+    ShowWindow(hWnd, SW_SHOWNORMAL);
+    CHECK_EQUAL(restoreLayout(), 1);
+    CHECK(fakewin::window(hWnd)->isZoomed);
+    CHECK_RECT(rectOf(hWnd), 0, 0, 1920, 1040);
+
+    // Restoring it later brings it back to where it was on the old monitor, in its new place
+    ShowWindow(hWnd, SW_SHOWNORMAL);
+    CHECK_RECT(rectOf(hWnd), 180, 100, 980, 700);
+}
+
+static void testRestoresMinimizedAndTranslucentWindows()
+{
+    setUp();
+    HWND minimized = createEditor(L"notes.txt", {100, 100, 900, 700});
+    HWND translucent = createEditor(L"todo.txt", {2000, 50, 2600, 650});
+    ShowWindow(minimized, SW_MINIMIZE);
+    SetWindowLongPtr(translucent, GWL_EXSTYLE, GetWindowLongPtr(translucent, GWL_EXSTYLE) | WS_EX_LAYERED);
+    SetLayeredWindowAttributes(translucent, 0, 128, LWA_ALPHA);
+    CHECK(saveLayout(false));
+
+    ShowWindow(minimized, SW_SHOWNORMAL);
+    SetLayeredWindowAttributes(translucent, 0, 255, LWA_ALPHA);
+    CHECK_EQUAL(restoreLayout(), 2);
+    CHECK(fakewin::window(minimized)->isIconic);
+    CHECK_EQUAL(fakewin::window(translucent)->alpha, 128);
+}
+
+int main()
+{
+    testRestoresWindowsThatWereMoved();
+    testAFailedBatchStillRestoresEveryWindow();
+    testMatchesWindowsUnderNewHandles();
+    testPrefersTheSameHandle();
+
+    testMapsWindowsOfAMissingMonitor();
+    testKeepsASnapshotPerDisplaySetup();
+
+    testMaximizedWindowsMaximizeOnTheMappedMonitor();
+    testRestoresMinimizedAndTranslucentWindows();
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,499 @@
+#include <windows.h>
+
+#include "check.h"
+#include "events.h"
+#include "features.h"
+#include "hooks.h"
+#include "plugins.h"
+
+// Loads plugins into the registry through a backend the test controls, and checks what they get
+// to bind and see; then loads them from the simulated plugins folder and performs their gestures
+// through the mouse hook
+
+const uint32_t LEFT_CLICK = WINCTRL_GESTURE_ID(WINCTRL_BUTTON_LEFT, WINCTRL_GESTURE_CLICK, 0);
+const uint32_t CTRL_LEFT_CLICK = WINCTRL_GESTURE_ID(WINCTRL_BUTTON_LEFT, WINCTRL_GESTURE_CLICK, WINCTRL_MOD_CTRL);
+const uint32_t MIDDLE_LONG_PRESS = WINCTRL_GESTURE_ID(WINCTRL_BUTTON_MIDDLE, WINCTRL_GESTURE_LONG_PRESS, 0);
+
+// PLUGINS
+// -------
+
+// What the handlers and entry points of the test plugins saw, reset by each test
+static struct
+{
+    const WinCtrlHost *host;
+    int handlerCalls;
+    const void *lastUserData;
+    WinCtrlWindowView lastView;
+    int loadCalls;
+    int unloadOrder[4];
+    int unloadCount;
+    int handlerResult; // What the handlers return: nonzero handles the gesture
+    uint32_t submitted;
+} s_seen;
+
+static void resetSeen()
+{
+    s_seen = {};
+    s_seen.handlerResult = 1;
+}
+
+static const WinCtrlCommand COMMANDS[] = {
+    {WINCTRL_COMMAND_SET_RECT, 0, NULL, {10, 20, 610, 420}},
+    {WINCTRL_COMMAND_ADJUST_OPACITY, -30, NULL, {}},
+};
+
+/// @brief Records its call and submits `COMMANDS`, for the window it was given
+static int WINCTRL_CALL recordingHandler(void *userData, const WinCtrlWindowView *view)
+{
+    s_seen.handlerCalls++;
+    s_seen.lastUserData = userData;
+    s_seen.lastView = *view;
+
+    WinCtrlCommand commands[2] = {COMMANDS[0], COMMANDS[1]};
+    commands[0].window = commands[1].window = view->window;
+    s_seen.submitted = s_seen.host->submit(s_seen.host->context, commands, 2);
+    return s_seen.handlerResult;
+}
+
+/// @brief Submits one command more than a handler may
+static int WINCTRL_CALL floodingHandler(void *, const WinCtrlWindowView *view)
+{
+    WinCtrlCommand commands[PluginRegistry::MAX_COMMANDS + 1] = {};
+    for (WinCtrlCommand &command : commands)
+    {
+        command.kind = WINCTRL_COMMAND_MINIMIZE;
+    }
+    s_seen.submitted = s_seen.host->submit(s_seen.host->context, commands, PluginRegistry::MAX_COMMANDS + 1);
+    return 1;
+}
+
+static uint32_t WINCTRL_CALL currentVersion() { return WINCTRL_PLUGIN_API_VERSION; }
+static uint32_t WINCTRL_CALL noVersion() { return 0; }
+static uint32_t WINCTRL_CALL newerVersion() { return WINCTRL_PLUGIN_API_VERSION + 1; }
+
+/// @brief Binds a left click and a middle long press
+static int WINCTRL_CALL loadClicks(const WinCtrlHost *host)
+{
+    s_seen.host = host;
+    s_seen.loadCalls++;
+    CHECK_EQUAL(host->bind(host->context, LEFT_CLICK, recordingHandler, (void *)&LEFT_CLICK), WINCTRL_OK);
+    CHECK_EQUAL(host->bind(host->context, MIDDLE_LONG_PRESS, recordingHandler, (void *)&MIDDLE_LONG_PRESS), WINCTRL_OK);
+    return 0;
+}
+
+/// @brief Wants the left click too, which is already taken, and binds Ctrl+click instead
+static int WINCTRL_CALL loadCtrlClick(const WinCtrlHost *host)
+{
+    s_seen.loadCalls++;
+    CHECK_EQUAL(host->bind(host->context, LEFT_CLICK, floodingHandler, NULL), WINCTRL_ERROR_TAKEN);
+    CHECK_EQUAL(host->bind(host->context, WINCTRL_GESTURE_COUNT, floodingHandler, NULL), WINCTRL_ERROR_INVALID);
+    CHECK_EQUAL(host->bind(host->context, CTRL_LEFT_CLICK, NULL, NULL), WINCTRL_ERROR_INVALID);
+    CHECK_EQUAL(host->bind(host->context, CTRL_LEFT_CLICK, floodingHandler, NULL), WINCTRL_OK);
+    return 0;
+}
+
+/// @brief Binds two gestures, then gives up
+static int WINCTRL_CALL loadAndFail(const WinCtrlHost *host)
+{
+    s_seen.loadCalls++;
+    host->bind(host->context, LEFT_CLICK, recordingHandler, NULL);
+    host->bind(host->context, CTRL_LEFT_CLICK, recordingHandler, NULL);
+    return 1;
+}
+
+static void WINCTRL_CALL unloadFirst() { s_seen.unloadOrder[s_seen.unloadCount++] = 1; }
+static void WINCTRL_CALL unloadSecond() { s_seen.unloadOrder[s_seen.unloadCount++] = 2; }
+
+// FAKE BACKEND
+// ------------
+
+/// @brief A library, as far as the registry can tell: the entry points it exports (null if not)
+struct TestLibrary
+{
+    WinCtrlPluginVersionProc version;
+    WinCtrlPluginLoadProc load;
+    WinCtrlPluginUnloadProc unload;
+    bool isOpen;
+};
+
+class TestPluginBackend : public PluginBackend
+{
+public:
+    WinCtrlCommand applied[64];
+    int appliedCount = 0;
+    int applyCalls = 0;
+
+    void *findSymbol(void *library, const char *name) override
+    {
+        TestLibrary *entry = (TestLibrary *)library;
+        if (strcmp(name, "winctrlPluginVersion") == 0)
+            return (void *)entry->version;
+        if (strcmp(name, "winctrlPluginLoad") == 0)
+            return (void *)entry->load;
+        if (strcmp(name, "winctrlPluginUnload") == 0)
+            return (void *)entry->unload;
+        return NULL;
+    }
+
+    void closeLibrary(void *library) override { ((TestLibrary *)library)->isOpen = false; }
+
+    void apply(const WinCtrlCommand *commands, int count) override
+    {
+        applyCalls++;
+        for (int i = 0; i < count && appliedCount < 64; i++)
+        {
+            applied[appliedCount++] = commands[i];
+        }
+    }
+};
+
+// REGISTRY
+// --------
+
+static void testDispatchesToTheBoundHandler()
+{
+    resetSeen();
+    TestPluginBackend backend;
+    PluginRegistry registry = {};
+    registry.setBackend(&backend);
+
+    TestLibrary clicks = {currentVersion, loadClicks, NULL, true};
+    CHECK(registry.load(&clicks));
+    CHECK_EQUAL(registry.pluginCount(), 1);
+    CHECK_EQUAL(registry.bindingCount(), 2);
+    CHECK(registry.isBound(LEFT_CLICK) && registry.isBound(MIDDLE_LONG_PRESS));
+    CHECK(!registry.isBound(CTRL_LEFT_CLICK));
+
+    WinCtrlWindowView view = {sizeof(WinCtrlWindowView), WINCTRL_WINDOW_TOPMOST, (void *)0x1234, 77, 300, 200};
+    CHECK(registry.dispatch(MIDDLE_LONG_PRESS, &view));
+    CHECK_EQUAL(s_seen.handlerCalls, 1);
+    CHECK(s_seen.lastUserData == &MIDDLE_LONG_PRESS);
+    CHECK(s_seen.lastView.window == (void *)0x1234 && s_seen.lastView.processId == 77);
+    CHECK(s_seen.lastView.cursorX == 300 && s_seen.lastView.cursorY == 200);
+
+    // The commands are applied once the handler returned, in one call and in order
+    CHECK_EQUAL(s_seen.submitted, 2U);
+    CHECK_EQUAL(backend.applyCalls, 1);
+    CHECK_EQUAL(backend.appliedCount, 2);
+    CHECK_EQUAL(backend.applied[0].kind, (uint32_t)WINCTRL_COMMAND_SET_RECT);
+    CHECK_EQUAL(backend.applied[0].rect.right, 610);
+    CHECK(backend.applied[0].window == (void *)0x1234);
+    CHECK_EQUAL(backend.applied[1].kind, (uint32_t)WINCTRL_COMMAND_ADJUST_OPACITY);
+    CHECK_EQUAL(backend.applied[1].value, -30);
+
+    // A declined gesture is still dispatched, but reported as not handled
+    s_seen.handlerResult = 0;
+    CHECK(!registry.dispatch(LEFT_CLICK, &view));
+    CHECK(s_seen.lastUserData == &LEFT_CLICK);
+    CHECK_EQUAL(s_seen.handlerCalls, 2);
+
+    // Gestures nobody bound reach no handler
+    CHECK(!registry.dispatch(CTRL_LEFT_CLICK, &view));
+    CHECK(!registry.dispatch(WINCTRL_GESTURE_COUNT, &view));
+    CHECK_EQUAL(s_seen.handlerCalls, 2);
+
+    registry.unloadAll();
+    CHECK(!clicks.isOpen);
+}
+
+static void testTheFirstPluginKeepsAGesture()
+{
+    resetSeen();
+    TestPluginBackend backend;
+    PluginRegistry registry = {};
+    registry.setBackend(&backend);
+
+    TestLibrary clicks = {currentVersion, loadClicks, NULL, true};
+    TestLibrary ctrlClick = {currentVersion, loadCtrlClick, NULL, true};
+    CHECK(registry.load(&clicks));
+    CHECK(registry.load(&ctrlClick));
+    CHECK_EQUAL(registry.bindingCount(), 3);
+
+    WinCtrlWindowView view = {sizeof(WinCtrlWindowView)};
+    CHECK(registry.dispatch(LEFT_CLICK, &view));
+    CHECK_EQUAL(s_seen.handlerCalls, 1);
+
+    // The second plugin's handler floods the queue, which takes only as many as it holds
+    CHECK(registry.dispatch(CTRL_LEFT_CLICK, &view));
+    CHECK_EQUAL(s_seen.submitted, (uint32_t)PluginRegistry::MAX_COMMANDS);
+    CHECK_EQUAL(backend.appliedCount, 2 + PluginRegistry::MAX_COMMANDS);
+
+    registry.unloadAll();
+}
+
+static void testARejectedLoadIsRolledBack()
+{
+    resetSeen();
+    TestPluginBackend backend;
+    PluginRegistry registry = {};
+    registry.setBackend(&backend);
+
+    TestLibrary failing = {currentVersion, loadAndFail, unloadFirst, true};
+    CHECK(!registry.load(&failing));
+    CHECK_EQUAL(s_seen.loadCalls, 1);
+    CHECK(!failing.isOpen);
+    CHECK_EQUAL(registry.pluginCount(), 0);
+    CHECK_EQUAL(registry.bindingCount(), 0);
+    CHECK(!registry.isBound(LEFT_CLICK) && !registry.isBound(CTRL_LEFT_CLICK));
+
+    // What it had bound is free again
+    TestLibrary clicks = {currentVersion, loadClicks, NULL, true};
+    CHECK(registry.load(&clicks));
+    CHECK(registry.isBound(LEFT_CLICK));
+
+    // Its unload entry point is never called, since it never loaded
+    registry.unloadAll();
+    CHECK_EQUAL(s_seen.unloadCount, 0);
+}
+
+static void testIncompatiblePluginsAreRejected()
+{
+    resetSeen();
+    TestPluginBackend backend;
+    PluginRegistry registry = {};
+    registry.setBackend(&backend);
+
+    TestLibrary unversioned = {NULL, loadClicks, NULL, true};
+    TestLibrary versionZero = {noVersion, loadClicks, NULL, true};
+    TestLibrary newer = {newerVersion, loadClicks, NULL, true};
+    TestLibrary noLoad = {currentVersion, NULL, NULL, true};
+    TestLibrary *libraries[] = {&unversioned, &versionZero, &newer, &noLoad};
+    for (TestLibrary *library : libraries)
+    {
+        CHECK(!registry.load(library));
+        CHECK(!library->isOpen);
+    }
+
+    // Not even their load entry point ran
+    CHECK_EQUAL(s_seen.loadCalls, 0);
+    CHECK_EQUAL(registry.pluginCount(), 0);
+    CHECK_EQUAL(registry.bindingCount(), 0);
+    CHECK(!registry.load(NULL));
+}
+
+static void testHostFunctionsOnlyWorkWhenAllowed()
+{
+    resetSeen();
+    TestPluginBackend backend;
+    PluginRegistry registry = {};
+    registry.setBackend(&backend);
+
+    TestLibrary clicks = {currentVersion, loadClicks, NULL, true};
+    CHECK(registry.load(&clicks));
+
+    // Binding is over once the plugin loaded, and commands need a handler to come from
+    const WinCtrlHost *host = s_seen.host;
+    CHECK_EQUAL(host->bind(host->context, CTRL_LEFT_CLICK, recordingHandler, NULL), WINCTRL_ERROR_LOCKED);
+    CHECK(!registry.isBound(CTRL_LEFT_CLICK));
+    CHECK_EQUAL(host->submit(host->context, COMMANDS, 2), 0U);
+    CHECK_EQUAL(backend.applyCalls, 0);
+
+    registry.unloadAll();
+}
+
+static void testUnloadsInReverseOrder()
+{
+    resetSeen();
+    TestPluginBackend backend;
+    PluginRegistry registry = {};
+    registry.setBackend(&backend);
+
+    TestLibrary first = {currentVersion, loadClicks, unloadFirst, true};
+    TestLibrary second = {currentVersion, loadCtrlClick, unloadSecond, true};
+    CHECK(registry.load(&first));
+    CHECK(registry.load(&second));
+
+    registry.unloadAll();
+    CHECK_EQUAL(s_seen.unloadCount, 2);
+    CHECK_EQUAL(s_seen.unloadOrder[0], 2);
+    CHECK_EQUAL(s_seen.unloadOrder[1], 1);
+    CHECK(!first.isOpen && !second.isOpen);
+    CHECK_EQUAL(registry.pluginCount(), 0);
+    CHECK_EQUAL(registry.bindingCount(), 0);
+}
+
+// THROUGH THE HOOK
+// ----------------
+
+static const fakewin::Symbol CLICKS_SYMBOLS[] = {
+    {"winctrlPluginVersion", (void *)currentVersion},
+    {"winctrlPluginLoad", (void *)loadClicks},
+    {"winctrlPluginUnload", (void *)unloadFirst},
+};
+
+static const fakewin::Symbol NEWER_SYMBOLS[] = {
+    {"winctrlPluginVersion", (void *)newerVersion},
+    {"winctrlPluginLoad", (void *)loadCtrlClick},
+};
+
+static HWND setUpDesktop()
+{
+    fakewin::reset();
+    fakewin::addMonitor({0, 0, 1920, 1080}, {0, 0, 1920, 1040});
+    Feature::Animations = false;
+    resetSeen();
+    fakewin::addLibrary(L"clicks.dll", CLICKS_SYMBOLS, 3);
+    fakewin::addLibrary(L"newer.dll", NEWER_SYMBOLS, 2);
+
+    HWND hWnd = fakewin::createWindow(L"Notepad", {100, 100, 900, 700}, 300);
+    CHECK(setupHooks());
+
+    // Only the compatible plugin stays loaded
+    CHECK_EQUAL(s_seen.loadCalls, 1);
+    CHECK_EQUAL(fakewin::loadedLibraries(), 1);
+    return hWnd;
+}
+
+static void testHandlersRunFromTheMessageLoop()
+{
+    HWND hWnd = setUpDesktop();
+
+    sendKey(VK_LWIN, true);
+    sendMouse(WM_LBUTTONDOWN, 400, 300);
+    fakewin::advance(50);
+    sendMouse(WM_LBUTTONUP, 400, 300);
+
+    // The hook only queued the gesture
+    CHECK_EQUAL(s_seen.handlerCalls, 0);
+    CHECK_RECT(fakewin::window(hWnd)->rect, 100, 100, 900, 700);
+
+    CHECK(fakewin::fireTimers() >= 1);
+    CHECK_EQUAL(s_seen.handlerCalls, 1);
+    CHECK(s_seen.lastUserData == &LEFT_CLICK);
+    CHECK(s_seen.lastView.window == hWnd);
+    CHECK_EQUAL(s_seen.lastView.processId, 300U);
+    CHECK(s_seen.lastView.cursorX == 400 && s_seen.lastView.cursorY == 300);
+    CHECK_EQUAL(s_seen.lastView.rect.right, 900);
+    CHECK_EQUAL(s_seen.lastView.workArea.bottom, 1040);
+
+    // Its commands were applied, and the built-in action did not run
+    CHECK_RECT(fakewin::window(hWnd)->rect, 10, 20, 610, 420);
+    CHECK_EQUAL(fakewin::window(hWnd)->alpha, 255 - 30);
+    CHECK(!fakewin::window(hWnd)->isZoomed);
+
+    // Nothing is left to run
+    CHECK_EQUAL(fakewin::fireTimers(), 0);
+    CHECK_EQUAL(s_seen.handlerCalls, 1);
+    sendKey(VK_LWIN, false);
+
+    teardownHooks();
+    CHECK_EQUAL(s_seen.unloadCount, 1);
+    CHECK_EQUAL(fakewin::loadedLibraries(), 0);
+}
+
+static void testADeclinedGestureRunsItsBuiltInAction()
+{
+    HWND hWnd = setUpDesktop();
+    s_seen.handlerResult = 0;
+
+    sendKey(VK_LWIN, true);
+    sendMouse(WM_LBUTTONDOWN, 400, 300);
+    fakewin::advance(50);
+    sendMouse(WM_LBUTTONUP, 400, 300);
+    CHECK(!fakewin::window(hWnd)->isZoomed);
+
+    fakewin::fireTimers();
+    CHECK_EQUAL(s_seen.handlerCalls, 1);
+    CHECK(fakewin::window(hWnd)->isZoomed);
+    sendKey(VK_LWIN, false);
+
+    // Gestures no plugin bound run their built-in action right away
+    fakewin::advance(1000);
+    sendKey(VK_LWIN, true);
+    sendKey(VK_LCONTROL, true);
+    sendMouse(WM_LBUTTONDOWN, 400, 300);
+    fakewin::advance(50);
+    sendMouse(WM_LBUTTONUP, 400, 300);
+    CHECK(!fakewin::window(hWnd)->isZoomed);
+    CHECK_EQUAL(s_seen.handlerCalls, 1);
+    sendKey(VK_LCONTROL, false);
+    sendKey(VK_LWIN, false);
+
+    teardownHooks();
+}
+
+/// The windows `tilingHandler` puts side by side
+static HWND s_tiledWindows[2];
+
+/// @brief Puts the two windows side by side, in one batch
+static int WINCTRL_CALL tilingHandler(void *, const WinCtrlWindowView *)
+{
+    WinCtrlCommand commands[2] = {
+        {WINCTRL_COMMAND_SET_RECT, 0, s_tiledWindows[0], {0, 0, 960, 1040}},
+        {WINCTRL_COMMAND_SET_RECT, 0, s_tiledWindows[1], {960, 0, 1920, 1040}},
+    };
+    s_seen.submitted = s_seen.host->submit(s_seen.host->context, commands, 2);
+    return 1;
+}
+
+static int WINCTRL_CALL loadTiles(const WinCtrlHost *host)
+{
+    s_seen.host = host;
+    CHECK_EQUAL(host->bind(host->context, LEFT_CLICK, tilingHandler, NULL), WINCTRL_OK);
+    return 0;
+}
+
+static const fakewin::Symbol TILES_SYMBOLS[] = {
+    {"winctrlPluginVersion", (void *)currentVersion},
+    {"winctrlPluginLoad", (void *)loadTiles},
+};
+
+static void testAFailedBatchStillPlacesEveryWindow()
+{
+    fakewin::reset();
+    fakewin::addMonitor({0, 0, 1920, 1080}, {0, 0, 1920, 1040});
+    Feature::Animations = false;
+    resetSeen();
+    fakewin::addLibrary(L"tiles.dll", TILES_SYMBOLS, 2);
+    s_tiledWindows[0] = fakewin::createWindow(L"Notepad", {100, 100, 900, 700}, 300);
+    s_tiledWindows[1] = fakewin::createWindow(L"Notepad", {1000, 100, 1800, 700}, 300);
+    CHECK(setupHooks());
+
+    sendKey(VK_LWIN, true);
+    sendMouse(WM_LBUTTONDOWN, 400, 300);
+    fakewin::advance(50);
+    sendMouse(WM_LBUTTONUP, 400, 300);
+    sendKey(VK_LWIN, false);
+
+    // The system abandons the batch at the second window, along with the first one
+    fakewin::failDeferredPosition(1);
+    fakewin::fireTimers();
+    CHECK_EQUAL(s_seen.submitted, 2U);
+    CHECK_RECT(fakewin::window(s_tiledWindows[0])->rect, 0, 0, 960, 1040);
+    CHECK_RECT(fakewin::window(s_tiledWindows[1])->rect, 960, 0, 1920, 1040);
+
+    teardownHooks();
+}
+
+static void testTeardownDropsQueuedGestures()
+{
+    setUpDesktop();
+
+    sendKey(VK_LWIN, true);
+    sendMouse(WM_LBUTTONDOWN, 400, 300);
+    fakewin::advance(50);
+    sendMouse(WM_LBUTTONUP, 400, 300);
+    sendKey(VK_LWIN, false);
+
+    teardownHooks();
+    fakewin::fireTimers();
+    CHECK_EQUAL(s_seen.handlerCalls, 0);
+    CHECK_EQUAL(fakewin::timerCount(), 0);
+}
+
+int main()
+{
+    testDispatchesToTheBoundHandler();
+    testTheFirstPluginKeepsAGesture();
+    testARejectedLoadIsRolledBack();
+    testIncompatiblePluginsAreRejected();
+    testHostFunctionsOnlyWorkWhenAllowed();
+    testUnloadsInReverseOrder();
+
+    testHandlersRunFromTheMessageLoop();
+    testADeclinedGestureRunsItsBuiltInAction();
+    testAFailedBatchStillPlacesEveryWindow();
+    testTeardownDropsQueuedGestures();
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,259 @@
+#include <math.h>
+#include <stdint.h>
+
+#include "check.h"
+#include "prediction.h"
+
+// Replays generated cursor traces against a simulated compositor delay, and bounds how far the
+// dragged window trails the cursor with and without prediction
+
+/// How long the compositor takes to show a placement, in milliseconds
+const uint32_t COMPOSITOR_DELAY = 16;
+/// The interval between mouse events of a 125 Hz mouse, in milliseconds
+const uint32_t SAMPLE_INTERVAL = 8;
+
+const int MAX_TRACE = 4096;
+
+// TRACES
+// ------
+
+struct TracePoint
+{
+    uint32_t time;
+    int x;
+    int y;
+};
+
+struct Trace
+{
+    TracePoint points[MAX_TRACE];
+    int count;
+
+    void add(uint32_t time, double x, double y)
+    {
+        if (count < MAX_TRACE)
+        {
+            points[count++] = {time, (int)lround(x), (int)lround(y)};
+        }
+    }
+};
+
+static Trace s_trace;
+
+/// @brief A random number generator that gives the same numbers everywhere
+static uint32_t s_seed;
+static int randomBelow(int limit)
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return (int)((s_seed >> 16) % (uint32_t)limit);
+}
+
+/// @brief Eased drags between random points, each speeding up and then slowing down to a stop,
+/// with rests in between
+static void generateStrokes(uint32_t startTime)
+{
+    s_trace.count = 0;
+    s_seed = 1;
+    uint32_t time = startTime;
+    double x = 400, y = 300;
+    for (int stroke = 0; stroke < 40; stroke++)
+    {
+        double targetX = 100 + randomBelow(1600);
+        double targetY = 100 + randomBelow(800);
+        int steps = 20 + randomBelow(60);
+        double startX = x, startY = y;
+        for (int step = 1; step <= steps; step++)
+        {
+            double t = (double)step / steps;
+            double eased = t * t * (3 - 2 * t);
+            x = startX + (targetX - startX) * eased;
+            y = startY + (targetY - startY) * eased;
+            time += SAMPLE_INTERVAL;
+            s_trace.add(time, x, y);
+        }
+        time += 100 + randomBelow(300);
+    }
+}
+
+/// @brief The cursor position at any time, interpolated between the samples of the trace
+static void cursorAt(uint32_t time, double *x, double *y)
+{
+    const TracePoint *points = s_trace.points;
+    int i = 1;
+    while (i < s_trace.count && (int32_t)(points[i].time - time) < 0)
+    {
+        i++;
+    }
+    if (i >= s_trace.count)
+    {
+        *x = points[s_trace.count - 1].x;
+        *y = points[s_trace.count - 1].y;
+        return;
+    }
+
+    const TracePoint &a = points[i - 1];
+    const TracePoint &b = points[i];
+    double t = b.time != a.time ? (double)(time - a.time) / (b.time - a.time) : 1.0;
+    *x = a.x + (b.x - a.x) * t;
+    *y = a.y + (b.y - a.y) * t;
+}
+
+struct ErrorStats
+{
+    double mean;
+    double peak;
+};
+
+/// @brief Places the window for every sample, as the drag does, and measures its distance to the
+/// cursor when the compositor shows that placement
+static ErrorStats evaluate(bool usePrediction)
+{
+    MotionPredictor predictor;
+    predictor.settings.horizon = COMPOSITOR_DELAY;
+
+    double total = 0;
+    double peak = 0;
+    for (int i = 0; i < s_trace.count; i++)
+    {
+        const TracePoint &point = s_trace.points[i];
+        int windowX = point.x;
+        int windowY = point.y;
+        if (usePrediction)
+        {
+            predictor.addSample(point.x, point.y, point.time);
+            predictor.predict(&windowX, &windowY);
+        }
+
+        double cursorX, cursorY;
+        cursorAt(point.time + COMPOSITOR_DELAY, &cursorX, &cursorY);
+        double error = hypot(windowX - cursorX, windowY - cursorY);
+        total += error;
+        peak = error > peak ? error : peak;
+    }
+    return {total / s_trace.count, peak};
+}
+
+// ERROR BOUNDS
+// ------------
+
+static void testPredictionCutsTheLag()
+{
+    generateStrokes(1000);
+    ErrorStats raw = evaluate(false);
+    ErrorStats predicted = evaluate(true);
+
+    // Without prediction the window trails by about 22 px on average, with it by about 2 px
+    CHECK(raw.mean > 15);
+    CHECK(predicted.mean < 3);
+    CHECK(predicted.mean < raw.mean / 5);
+    CHECK(predicted.peak < raw.peak / 2);
+}
+
+static void testTimestampsMayWrapAround()
+{
+    generateStrokes(1000);
+    ErrorStats expected = evaluate(true);
+
+    // The same trace, with the millisecond clock wrapping around in the middle of it
+    generateStrokes(0xFFFFFFFFu - 20000);
+    ErrorStats wrapped = evaluate(true);
+    CHECK(fabs(wrapped.mean - expected.mean) < 1e-9);
+    CHECK(fabs(wrapped.peak - expected.peak) < 1e-9);
+}
+
+// MOTIONS
+// -------
+
+static void testSteadyMotionIsPredictedExactly()
+{
+    MotionPredictor predictor;
+    predictor.settings.horizon = COMPOSITOR_DELAY;
+    for (uint32_t time = 0; time <= 200; time += SAMPLE_INTERVAL)
+    {
+        predictor.addSample(100 + (int)time, 500 - (int)time / 2, time);
+    }
+
+    int x = 0, y = 0;
+    predictor.predict(&x, &y);
+    CHECK_EQUAL(x, 100 + 200 + 16);
+    CHECK_EQUAL(y, 500 - 100 - 8);
+}
+
+static void testStoppingDoesNotOvershoot()
+{
+    MotionPredictor predictor;
+    predictor.settings.horizon = COMPOSITOR_DELAY;
+
+    // One eased stroke to x = 1000 in 320 ms, sampled until the cursor has rested there a while
+    const int STEPS = 40;
+    for (int step = 1; step <= STEPS + 4; step++)
+    {
+        double t = step < STEPS ? (double)step / STEPS : 1.0;
+        int x = (int)lround(1000 * t * t * (3 - 2 * t));
+        predictor.addSample(x, 300, (uint32_t)step * SAMPLE_INTERVAL);
+
+        int predictedX = x, predictedY = 300;
+        predictor.predict(&predictedX, &predictedY);
+        CHECK_EQUAL(predictedY, 300);
+
+        // Slowing down never turns the prediction back. The estimates lag the deceleration a
+        // little, so the window may pass the stop by a few pixels, and settle back within a few
+        // once the cursor rests; either is far less than the 75 px that a frame at the top speed
+        // of the stroke would carry it.
+        if (step <= STEPS)
+        {
+            CHECK(predictedX >= x);
+        }
+        CHECK(predictedX <= 1000 + 8);
+        CHECK(predictedX >= 1000 - 12 || step <= STEPS);
+    }
+}
+
+static void testARestForgetsTheMotion()
+{
+    MotionPredictor predictor;
+    for (uint32_t time = 0; time <= 64; time += SAMPLE_INTERVAL)
+    {
+        predictor.addSample((int)time * 2, 0, time);
+    }
+
+    // The cursor rested, then moved on from somewhere else
+    predictor.addSample(500, 500, 64 + predictor.settings.stopTime);
+    int x = 0, y = 0;
+    predictor.predict(&x, &y);
+    CHECK_EQUAL(x, 500);
+    CHECK_EQUAL(y, 500);
+
+    float velocityX, velocityY;
+    predictor.velocity(&velocityX, &velocityY);
+    CHECK(velocityX == 0 && velocityY == 0);
+}
+
+static void testAFlickIsPredictedNoFurtherThanTheLimit()
+{
+    MotionPredictor predictor;
+    predictor.settings.horizon = COMPOSITOR_DELAY;
+    for (uint32_t time = 0; time <= 48; time += SAMPLE_INTERVAL)
+    {
+        predictor.addSample((int)(time * time), (int)(time * time), time); // Speeding up to 96 px/ms
+    }
+
+    int x = 48 * 48, y = 48 * 48;
+    predictor.predict(&x, &y);
+    double distance = hypot(x - 48 * 48, y - 48 * 48);
+    CHECK(distance <= predictor.settings.maxDistance + 1);
+    CHECK(distance >= predictor.settings.maxDistance - 1);
+}
+
+int main()
+{
+    testPredictionCutsTheLag();
+    testTimestampsMayWrapAround();
+
+    testSteadyMotionIsPredictedExactly();
+    testStoppingDoesNotOvershoot();
+    testARestForgetsTheMotion();
+    testAFlickIsPredictedNoFurtherThanTheLimit();
+
+    CHECK_RESULT();
+}
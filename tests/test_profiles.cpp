@@ -0,0 +1,168 @@
+#include <windows.h>
+
+#include "check.h"
+#include "fakewin.h"
+#include "profiles.h"
+
+// Matches profiles against windows of simulated processes, and checks that the cache notices
+// when a window handle comes back for another process
+
+const DWORD BROWSER_PROCESS = 400;
+const DWORD ELEVATED_PROCESS = 500;
+const DWORD OTHER_PROCESS = 600;
+
+const RECT WINDOW_RECT = {100, 100, 900, 700};
+
+static void setUp()
+{
+    fakewin::reset();
+    fakewin::setIni(L"Profile.Browser", L"Image", L"browser.exe");
+    fakewin::setIni(L"Profile.Browser", L"MinWindowSize", L"300");
+    fakewin::setIni(L"Profile.BrowserPopup", L"Image", L"browser.exe");
+    fakewin::setIni(L"Profile.BrowserPopup", L"Class", L"Popup");
+    fakewin::setIni(L"Profile.BrowserPopup", L"Exclude", L"1");
+    fakewin::setIni(L"Profile.Console", L"Class", L"ConsoleWindowClass");
+    fakewin::setIni(L"Profile.Console", L"AlphaStep", L"20");
+    fakewin::setIni(L"Profile.Console", L"LiveResize", L"0");
+    CHECK_EQUAL(loadAppProfiles(), 3);
+
+    fakewin::addProcess(BROWSER_PROCESS, L"browser.exe", 1);
+    fakewin::addProcess(ELEVATED_PROCESS, L"console.exe", 2, false);
+    fakewin::addProcess(OTHER_PROCESS, L"other.exe", 3);
+}
+
+// MATCHING
+// --------
+
+static void testTheMostSpecificProfileWins()
+{
+    setUp();
+    HWND browser = fakewin::createWindow(L"BrowserFrame", WINDOW_RECT, BROWSER_PROCESS);
+    HWND popup = fakewin::createWindow(L"Popup", WINDOW_RECT, BROWSER_PROCESS);
+    HWND console = fakewin::createWindow(L"ConsoleWindowClass", WINDOW_RECT, ELEVATED_PROCESS);
+    HWND other = fakewin::createWindow(L"Popup", WINDOW_RECT, OTHER_PROCESS);
+
+    CHECK_EQUAL(getAppProfile(browser)->minWindowSize, 300);
+    CHECK(!getAppProfile(browser)->exclude);
+    CHECK(getAppProfile(popup)->exclude);
+
+    // A process that cannot be opened still matches by class
+    CHECK_EQUAL(getAppProfile(console)->alphaStep, 20);
+    CHECK(!getAppProfile(console)->liveResize);
+
+    CHECK_EQUAL(getAppProfile(other)->minWindowSize, DEFAULT_MIN_WINDOW_SIZE);
+    CHECK_EQUAL(getAppProfile(other)->alphaStep, DEFAULT_ALPHA_STEP);
+    CHECK(!getAppProfile(other)->exclude);
+
+    clearAppProfileCache();
+}
+
+// CACHE
+// -----
+
+static void testCachedLookupsMakeNoSystemCalls()
+{
+    setUp();
+    HWND browser = fakewin::createWindow(L"BrowserFrame", WINDOW_RECT, BROWSER_PROCESS);
+    HWND popup = fakewin::createWindow(L"Popup", WINDOW_RECT, BROWSER_PROCESS);
+    getAppProfile(browser);
+    getAppProfile(popup, L"Popup");
+
+    fakewin::resetCalls();
+    for (int i = 0; i < 100; i++)
+    {
+        CHECK_EQUAL(getAppProfile(browser)->minWindowSize, 300);
+        CHECK(getAppProfile(popup, L"Popup")->exclude);
+    }
+    CHECK_EQUAL(fakewin::calls(), 0);
+
+    clearAppProfileCache();
+    CHECK_EQUAL(fakewin::openHandles(), 0);
+}
+
+static void testAHandleReusedAfterTheProcessExited()
+{
+    setUp();
+    HWND hWnd = fakewin::createWindow(L"Popup", WINDOW_RECT, BROWSER_PROCESS);
+    CHECK(getAppProfile(hWnd)->exclude);
+
+    // The browser exits, and its window handle and process id come back for another application
+    fakewin::destroyWindow(hWnd);
+    fakewin::endProcess(BROWSER_PROCESS);
+    fakewin::runThreadPool();
+    fakewin::addProcess(BROWSER_PROCESS, L"other.exe", 4);
+    fakewin::createWindowWithHandle(hWnd, L"Popup", WINDOW_RECT, BROWSER_PROCESS);
+    CHECK(!getAppProfile(hWnd)->exclude);
+
+    clearAppProfileCache();
+}
+
+static void testAHandleReusedByAnotherProcessThatCannotBeOpened()
+{
+    setUp();
+    HWND hWnd = fakewin::createWindow(L"ConsoleWindowClass", WINDOW_RECT, ELEVATED_PROCESS);
+    CHECK_EQUAL(getAppProfile(hWnd)->alphaStep, 20);
+
+    // Nothing tells the cache that the elevated process exited, but its window's thread changed
+    fakewin::destroyWindow(hWnd);
+    fakewin::endProcess(ELEVATED_PROCESS);
+    fakewin::createWindowWithHandle(hWnd, L"OtherWindowClass", WINDOW_RECT, OTHER_PROCESS);
+    CHECK_EQUAL(getAppProfile(hWnd)->alphaStep, DEFAULT_ALPHA_STEP);
+
+    clearAppProfileCache();
+}
+
+static void testEvictionNeverWaitsForACallback()
+{
+    setUp();
+    const int WINDOWS = 100; // More than the cache holds
+    HWND windows[WINDOWS];
+    for (int i = 0; i < WINDOWS; i++)
+    {
+        fakewin::addProcess(1000 + 4 * (i % 16), L"browser.exe", 10 + i);
+        windows[i] = fakewin::createWindow(L"BrowserFrame", WINDOW_RECT, 1000 + 4 * (i % 16));
+        CHECK_EQUAL(getAppProfile(windows[i])->minWindowSize, 300);
+    }
+
+    // The processes exit while their callbacks wait for the thread pool, and their entries are
+    // evicted and reused in the meantime
+    for (int i = 0; i < 16; i++)
+    {
+        fakewin::endProcess(1000 + 4 * i);
+    }
+    fakewin::addProcess(2000, L"browser.exe", 200);
+    for (int i = 0; i < WINDOWS; i++)
+    {
+        HWND hWnd = fakewin::createWindow(L"BrowserFrame", WINDOW_RECT, 2000);
+        CHECK_EQUAL(getAppProfile(hWnd)->minWindowSize, 300);
+        windows[i] = hWnd;
+    }
+    CHECK_EQUAL(fakewin::blockingUnregisters(), 0);
+
+    // The late callbacks leave the entries that took over alone
+    fakewin::runThreadPool();
+    fakewin::resetCalls();
+    for (int i = WINDOWS - 16; i < WINDOWS; i++)
+    {
+        getAppProfile(windows[i]);
+    }
+    CHECK_EQUAL(fakewin::calls(), 0);
+
+    clearAppProfileCache();
+    fakewin::runThreadPool();
+    CHECK_EQUAL(fakewin::blockingUnregisters(), 0);
+    CHECK_EQUAL(fakewin::activeWaits(), 0);
+    CHECK_EQUAL(fakewin::openHandles(), 0);
+}
+
+int main()
+{
+    testTheMostSpecificProfileWins();
+
+    testCachedLookupsMakeNoSystemCalls();
+    testAHandleReusedAfterTheProcessExited();
+    testAHandleReusedByAnotherProcessThatCannotBeOpened();
+    testEvictionNeverWaitsForACallback();
+
+    CHECK_RESULT();
+}
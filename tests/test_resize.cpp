@@ -0,0 +1,154 @@
+#include <windows.h>
+#include <algorithm>
+
+#include "check.h"
+#include "events.h"
+#include "features.h"
+#include "hooks.h"
+#include "profiles.h"
+
+// Resizes and zooms simulated applications that report and enforce size limits, and checks that
+// the hook never waits for them to report
+
+const RECT MONITOR = {0, 0, 1920, 1080};
+const RECT WORK_AREA = {0, 0, 1920, 1040};
+
+/// @brief A window that accepts sizes from 500x400 to 1000x800, the way its application enforces them
+static HWND createLimitedWindow()
+{
+    HWND hWnd = fakewin::createWindow(L"Limited", {100, 100, 900, 700});
+    fakewin::window(hWnd)->minTrack = {500, 400};
+    fakewin::window(hWnd)->maxTrack = {1000, 800};
+    return hWnd;
+}
+
+static void setUp()
+{
+    fakewin::reset();
+    fakewin::addMonitor(MONITOR, WORK_AREA);
+    Feature::Animations = false;
+    CHECK(setupHooks());
+}
+
+/// @brief Starts resizing from the top left corner, which moves the left and top edges
+static void startResizing(int x, int y)
+{
+    sendKey(VK_LWIN, true);
+    sendMouse(WM_MBUTTONDOWN, x, y);
+    sendMouse(WM_MOUSEMOVE, x + 10, y + 10);
+    sendMouse(WM_MOUSEMOVE, x + 20, y + 20);
+}
+
+static void stopResizing(int x, int y)
+{
+    sendMouse(WM_MBUTTONUP, x, y);
+    sendKey(VK_LWIN, false);
+    fakewin::deliverWinEvents();
+}
+
+// RESIZE
+// ------
+
+static void testResizeKeepsToTheReportedLimits()
+{
+    setUp();
+    HWND hWnd = createLimitedWindow();
+
+    fakewin::resetCalls();
+    startResizing(150, 150);
+
+    // The hook only asked for the limits; the window answers on the thread pool
+    CHECK_EQUAL(fakewin::calls("SendMessageTimeoutW"), 0);
+    fakewin::runThreadPool();
+    CHECK_EQUAL(fakewin::calls("SendMessageTimeoutW"), 1);
+
+    // Shrinking stops at the minimum, with the right and bottom edges where they were. Had the
+    // request not been clamped, the application would have kept the left and top edges instead
+    sendMouse(WM_MOUSEMOVE, 800, 700);
+    CHECK_RECT(fakewin::window(hWnd)->rect, 400, 300, 900, 700);
+
+    sendMouse(WM_MOUSEMOVE, -400, -400);
+    CHECK_RECT(fakewin::window(hWnd)->rect, -100, -100, 900, 700);
+
+    stopResizing(-400, -400);
+    CHECK_EQUAL(fakewin::calls("SendMessageTimeoutW"), 1); // Once per resize
+    teardownHooks();
+}
+
+static void testAHungWindowKeepsTheDefaults()
+{
+    setUp();
+    HWND hWnd = createLimitedWindow();
+    fakewin::window(hWnd)->minTrack = {};
+    fakewin::window(hWnd)->isHung = true;
+
+    startResizing(150, 150);
+    fakewin::runThreadPool();
+    sendMouse(WM_MOUSEMOVE, 1200, 1000);
+
+    int minWidth = std::max(DEFAULT_MIN_WINDOW_SIZE, GetSystemMetrics(SM_CXMINTRACK));
+    int minHeight = std::max(DEFAULT_MIN_WINDOW_SIZE, GetSystemMetrics(SM_CYMINTRACK));
+    CHECK_RECT(fakewin::window(hWnd)->rect, 900 - minWidth, 700 - minHeight, 900, 700);
+    stopResizing(1200, 1000);
+    teardownHooks();
+}
+
+static void testEachResizeGetsTheLimitsOfItsWindow()
+{
+    setUp();
+    HWND large = createLimitedWindow();
+    fakewin::window(large)->minTrack = {700, 500};
+    HWND small = fakewin::createWindow(L"Limited", {1000, 100, 1800, 700});
+    fakewin::window(small)->minTrack = {300, 200};
+
+    // The first window has not answered by the time the next resize starts
+    startResizing(150, 150);
+    stopResizing(170, 170);
+
+    startResizing(1050, 150);
+    fakewin::runThreadPool();
+    sendMouse(WM_MOUSEMOVE, 1800, 700);
+    CHECK_RECT(fakewin::window(small)->rect, 1500, 500, 1800, 700);
+    stopResizing(1800, 700);
+    teardownHooks();
+}
+
+// ZOOM
+// ----
+
+static void testZoomKeepsToTheReportedLimits()
+{
+    setUp();
+    HWND hWnd = createLimitedWindow();
+
+    fakewin::resetCalls();
+    sendKey(VK_LWIN, true);
+    sendKey(VK_LSHIFT, true);
+    for (int i = 0; i < 10; i++)
+    {
+        sendMouse(WM_MOUSEWHEEL, 500, 400, WHEEL_DELTA);
+    }
+    CHECK_EQUAL(fakewin::calls("SendMessageTimeoutW"), 0);
+    fakewin::runThreadPool();
+
+    fakewin::advance(16);
+    fakewin::fireTimers();
+    RECT rect = fakewin::window(hWnd)->rect;
+    CHECK(rect.right - rect.left <= 1000 && rect.bottom - rect.top <= 800);
+    CHECK(rect.right - rect.left > 800);
+
+    sendKey(VK_LSHIFT, false);
+    sendKey(VK_LWIN, false);
+    teardownHooks();
+}
+
+int main()
+{
+    testResizeKeepsToTheReportedLimits();
+    testAHungWindowKeepsTheDefaults();
+    testEachResizeGetsTheLimitsOfItsWindow();
+
+    testZoomKeepsToTheReportedLimits();
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,155 @@
+#include <atomic>
+#include <string.h>
+#include <thread>
+
+#include "check.h"
+#include "seqlock.h"
+#include "statusblock.h"
+
+// Checks the seqlock (src/seqlock.h) step by step, then runs one writer against several reader
+// threads for a fixed number of writes, and fails if any reader accepts a torn copy. Every value
+// the writer publishes is filled with words derived from a single counter, so a copy mixing two
+// writes is easy to spot.
+
+const int READERS = 3;
+const uint64_t WRITES = 10 * 1000 * 1000;
+
+/// @brief Fills every field of the status with values derived from `counter`
+static StatusData makeValue(uint64_t counter)
+{
+    StatusData data;
+    data.publishTime = counter;
+    data.totalEvents = counter * 3;
+    data.totalActions = ~counter;
+    data.processId = (uint32_t)counter;
+    data.flags = (uint32_t)(counter >> 7);
+    data.features = (uint32_t)counter ^ 0xA5A5A5A5;
+    data.eventsPerSecond = (uint32_t)counter + 1;
+    data.actionsPerSecond = (uint32_t)counter + 2;
+    data.lastHookLatency = (uint32_t)counter + 3;
+    data.maxHookLatency = (uint32_t)counter + 4;
+    data.reserved = (uint32_t)(counter * 7);
+    return data;
+}
+
+static bool isWhole(const StatusData &copy)
+{
+    StatusData expected = makeValue(copy.publishTime);
+    return memcmp(&copy, &expected, sizeof(copy)) == 0;
+}
+
+// STEPS
+// -----
+
+static void testAReadGetsTheLastWrite()
+{
+    StatusBlock block = {};
+    seqlockWrite(&block.header.sequence, &block.data, makeValue(41));
+    seqlockWrite(&block.header.sequence, &block.data, makeValue(42));
+    CHECK_EQUAL(block.header.sequence, 4u);
+
+    StatusData copy;
+    CHECK(seqlockTryRead(&block.header.sequence, &block.data, &copy));
+    CHECK_EQUAL(copy.publishTime, 42u);
+    CHECK(isWhole(copy));
+}
+
+static void testAReadDuringAWriteFails()
+{
+    // A writer that stopped halfway: the sequence is odd, and half of the words are new
+    StatusBlock block = {};
+    seqlockWrite(&block.header.sequence, &block.data, makeValue(1));
+    StatusData next = makeValue(2);
+    block.header.sequence++;
+    memcpy(&block.data, &next, sizeof(next) / 2);
+
+    StatusData copy;
+    CHECK(!seqlockTryRead(&block.header.sequence, &block.data, &copy));
+    CHECK(!seqlockRead(&block.header.sequence, &block.data, &copy, 10));
+
+    // ... and finished
+    memcpy(&block.data, &next, sizeof(next));
+    block.header.sequence++;
+    CHECK(seqlockRead(&block.header.sequence, &block.data, &copy, 10));
+    CHECK_EQUAL(copy.publishTime, 2u);
+}
+
+static void testTheSequenceMayWrapAround()
+{
+    StatusBlock block = {};
+    block.header.sequence = 0xFFFFFFFE;
+    seqlockWrite(&block.header.sequence, &block.data, makeValue(7));
+    CHECK_EQUAL(block.header.sequence, 0u);
+
+    StatusData copy;
+    CHECK(seqlockTryRead(&block.header.sequence, &block.data, &copy));
+    CHECK_EQUAL(copy.publishTime, 7u);
+}
+
+// THREADS
+// -------
+
+struct ReaderStats
+{
+    uint64_t reads = 0;
+    uint64_t torn = 0;      // Accepted copies that mix two writes
+    uint64_t backwards = 0; // Accepted copies older than one accepted before
+};
+
+static void testConcurrentReadsAreNeverTorn()
+{
+    static StatusBlock s_block;
+    seqlockWrite(&s_block.header.sequence, &s_block.data, makeValue(0));
+
+    std::atomic<bool> isWriting(true);
+    ReaderStats stats[READERS];
+    std::thread readers[READERS];
+    for (int r = 0; r < READERS; r++)
+    {
+        readers[r] = std::thread([&, r]() {
+            ReaderStats &own = stats[r];
+            uint64_t latest = 0;
+            // One more pass after the writer is done, so every reader reads at least once
+            bool isLastPass = false;
+            while (!isLastPass)
+            {
+                isLastPass = !isWriting.load(std::memory_order_acquire);
+                StatusData copy;
+                if (!seqlockTryRead(&s_block.header.sequence, &s_block.data, &copy))
+                {
+                    continue;
+                }
+                own.torn += !isWhole(copy);
+                own.backwards += copy.publishTime < latest;
+                latest = copy.publishTime;
+                own.reads++;
+            }
+        });
+    }
+
+    for (uint64_t write = 1; write <= WRITES; write++)
+    {
+        seqlockWrite(&s_block.header.sequence, &s_block.data, makeValue(write));
+    }
+    isWriting.store(false, std::memory_order_release);
+
+    for (int r = 0; r < READERS; r++)
+    {
+        readers[r].join();
+        CHECK(stats[r].reads > 0);
+        CHECK_EQUAL(stats[r].torn, 0u);
+        CHECK_EQUAL(stats[r].backwards, 0u);
+    }
+    CHECK_EQUAL(s_block.data.publishTime, WRITES);
+}
+
+int main()
+{
+    testAReadGetsTheLastWrite();
+    testAReadDuringAWriteFails();
+    testTheSequenceMayWrapAround();
+
+    testConcurrentReadsAreNeverTorn();
+
+    CHECK_RESULT();
+}
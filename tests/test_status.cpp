@@ -0,0 +1,141 @@
+#include <windows.h>
+
+#include "check.h"
+#include "events.h"
+#include "features.h"
+#include "hooks.h"
+#include "seqlock.h"
+#include "statusblock.h"
+
+// Feeds input through the hooks and reads the live status back from its shared memory, as a
+// monitor in another process would: only the events that perform a window action count as actions
+
+const RECT MONITOR = {0, 0, 1920, 1080};
+const RECT WORK_AREA = {0, 0, 1920, 1040};
+
+/// How often winctrl publishes the status
+const DWORD PUBLISH_INTERVAL_MS = 250;
+
+static void setUp()
+{
+    fakewin::reset();
+    fakewin::addMonitor(MONITOR, WORK_AREA);
+    fakewin::createWindow(L"Notepad", {100, 100, 900, 700});
+    Feature::Animations = false;
+    CHECK(setupHooks());
+}
+
+/// @brief Waits for the next publish, then reads the status block
+static StatusData readStatus()
+{
+    fakewin::advance(PUBLISH_INTERVAL_MS);
+    fakewin::fireTimers();
+
+    StatusData data = {};
+    HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, STATUS_MAPPING_NAME);
+    CHECK(mapping != NULL);
+    if (mapping)
+    {
+        StatusBlock *block = (StatusBlock *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(StatusBlock));
+        CHECK(block && block->header.magic == STATUS_MAGIC);
+        CHECK(block && seqlockRead(&block->header.sequence, &block->data, &data));
+        UnmapViewOfFile(block);
+        CloseHandle(mapping);
+    }
+    return data;
+}
+
+// ACTIONS
+// -------
+
+static void testActionsAreCountedOnce()
+{
+    setUp();
+    uint64_t actions = readStatus().totalActions;
+
+    // A drag is one action, however long it lasts
+    sendKey(VK_LWIN, true);
+    sendMouse(WM_LBUTTONDOWN, 300, 300);
+    for (int i = 1; i <= 10; i++)
+    {
+        fakewin::advance(8);
+        sendMouse(WM_MOUSEMOVE, 300 + 10 * i, 300);
+    }
+    sendMouse(WM_LBUTTONUP, 400, 300);
+    CHECK_EQUAL(readStatus().totalActions, actions + 1);
+
+    // So is a hotkey
+    sendKey(VK_LMENU, true);
+    sendKey(VK_RIGHT, true);
+    sendKey(VK_RIGHT, false);
+    sendKey(VK_LMENU, false);
+    sendKey(VK_LWIN, false);
+    CHECK_EQUAL(readStatus().totalActions, actions + 2);
+
+    teardownHooks();
+}
+
+static void testThrottledWheelTurnsAreNotActions()
+{
+    setUp();
+    uint64_t actions = readStatus().totalActions;
+
+    // The first turn switches desktops, and the rest come within the throttle time
+    sendKey(VK_LWIN, true);
+    for (int i = 0; i < 10; i++)
+    {
+        fakewin::advance(8);
+        sendMouse(WM_MOUSEWHEEL, 300, 300, -WHEEL_DELTA);
+    }
+    CHECK_EQUAL(readStatus().totalActions, actions + 1);
+
+    // Nor is a turn that finds no window to act on
+    sendKey(VK_LCONTROL, true);
+    sendMouse(WM_MOUSEWHEEL, 1500, 900, WHEEL_DELTA);
+    sendKey(VK_LCONTROL, false);
+    sendKey(VK_LWIN, false);
+    CHECK_EQUAL(readStatus().totalActions, actions + 1);
+
+    teardownHooks();
+}
+
+static void testGesturesWithoutAnActionAreNotActions()
+{
+    setUp();
+    uint64_t actions = readStatus().totalActions;
+
+    // A middle click has no built-in action
+    sendKey(VK_LWIN, true);
+    click(WM_MBUTTONDOWN, 300, 300);
+    sendKey(VK_LWIN, false);
+    CHECK_EQUAL(readStatus().totalActions, actions);
+
+    teardownHooks();
+}
+
+static void testRejectedHotkeysAreNotActions()
+{
+    setUp();
+    uint64_t actions = readStatus().totalActions;
+
+    // Alt was released while the hooks did not see it, so Win+Right is not the bound Win+Alt+Right
+    sendKey(VK_LWIN, true);
+    sendKey(VK_LMENU, true);
+    fakewin::setKeyDown(VK_LMENU, false);
+    CHECK_EQUAL(sendKey(VK_RIGHT, true), 0);
+    sendKey(VK_RIGHT, false);
+    sendKey(VK_LWIN, false);
+    CHECK_EQUAL(readStatus().totalActions, actions);
+
+    teardownHooks();
+}
+
+int main()
+{
+    testActionsAreCountedOnce();
+    testThrottledWheelTurnsAreNotActions();
+    testGesturesWithoutAnActionAreNotActions();
+    testRejectedHotkeysAreNotActions();
+
+    CHECK_RESULT();
+}
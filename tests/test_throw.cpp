@@ -0,0 +1,253 @@
+#include <windows.h>
+#include <math.h>
+
+#include "animation.h"
+#include "animator.h"
+#include "check.h"
+#include "events.h"
+#include "features.h"
+#include "hooks.h"
+#include "kinetic.h"
+#include "prediction.h"
+
+// Plans throws from replayed flicks and checks where the windows come to rest and how they glide
+// there; then throws windows through the hooks, with and without animations
+
+const AnimationRect BOUNDS = {0, 0, 1920, 1080};
+const RECT MONITOR = {0, 0, 1920, 1080};
+const RECT WORK_AREA = {0, 0, 1920, 1040};
+
+/// The interval between the frames of the glide
+const double FRAME_INTERVAL_MS = 1000.0 / 60;
+/// The interval between mouse events of a 125 Hz mouse, in milliseconds
+const uint32_t SAMPLE_INTERVAL = 8;
+const int FLICK_SAMPLES = 16;
+
+static AnimationRect windowAt(int centerX, int centerY, int width, int height)
+{
+    AnimationRect rect = {centerX - width / 2, centerY - height / 2, 0, 0};
+    rect.right = rect.left + width;
+    rect.bottom = rect.top + height;
+    return rect;
+}
+
+/// @brief Feeds the predictor a flick to the right and slightly up, at 125 Hz: the cursor speeds
+/// up by 0.2 px/ms every sample, and is let go of while still moving
+/// @return Where the cursor was let go of
+static POINT replayFlick(MotionPredictor *predictor)
+{
+    double x = 600, y = 500;
+    double speed = 0;
+    for (int step = 0; step < FLICK_SAMPLES; step++)
+    {
+        predictor->addSample((int)lround(x), (int)lround(y), 1000 + step * SAMPLE_INTERVAL);
+        speed += 0.2;
+        x += speed * 8;
+        y -= speed * 2;
+    }
+    return {(LONG)lround(x - speed * 8), (LONG)lround(y + speed * 2)};
+}
+
+// PLANNING
+// --------
+
+static void testAFlickGlidesOnAtTheSpeedOfTheCursor()
+{
+    MotionPredictor predictor;
+    POINT release = replayFlick(&predictor);
+    float velocityX, velocityY;
+    predictor.velocity(&velocityX, &velocityY);
+
+    // Let go of at 3.2 px/ms, four times as fast to the right as up
+    CHECK(velocityX > 2.9f && velocityX < 3.3f);
+    CHECK(fabsf(velocityY + velocityX / 4) < 0.05f);
+
+    // It glides about `speed * glideTime` pixels on
+    ThrowSettings settings;
+    AnimationRect window = windowAt(release.x, release.y, 800, 600);
+    ThrowPlan plan;
+    CHECK(planThrow(window, velocityX, velocityY, BOUNDS, settings, &plan));
+    CHECK(!plan.isSnapped);
+    CHECK_EQUAL(plan.to.left - window.left, lroundf(velocityX * settings.glideTime * (1 - expf(-GLIDE_DECAY))));
+    CHECK_EQUAL(plan.to.top - window.top, lroundf(velocityY * settings.glideTime * (1 - expf(-GLIDE_DECAY))));
+    CHECK_EQUAL(plan.to.right - plan.to.left, 800);
+    CHECK_EQUAL(plan.to.bottom - plan.to.top, 600);
+    CHECK_EQUAL(plan.duration, settings.glideTime * GLIDE_DECAY);
+
+    // Frame by frame, it leaves at nearly the speed of the cursor, slows down, and stops exactly
+    // where it was planned to
+    AnimationScheduler scheduler = {};
+    AnimationFrame frames[AnimationScheduler::MAX_ANIMATIONS];
+    scheduler.start(&window, window, plan.to, 0, plan.duration, EASE_GLIDE, ANIMATION_FINISH_NONE);
+    AnimationRect previous = window;
+    int previousStep = 0;
+    int frameCount = 0;
+    for (double time = FRAME_INTERVAL_MS; scheduler.isActive(); time += FRAME_INTERVAL_MS)
+    {
+        CHECK_EQUAL(scheduler.tick(time, frames), 1);
+        const AnimationRect &rect = frames[0].rect;
+        int step = rect.left - previous.left;
+        if (frameCount == 0)
+        {
+            CHECK(step / FRAME_INTERVAL_MS > 0.85 * velocityX);
+        }
+        else
+        {
+            CHECK(step >= 0 && step <= previousStep + 1); // Give or take the rounding to whole pixels
+        }
+        CHECK(rect.top <= previous.top);
+        previous = rect;
+        previousStep = step;
+        frameCount++;
+    }
+    CHECK(frames[0].isLast);
+    CHECK(memcmp(&previous, &plan.to, sizeof(AnimationRect)) == 0);
+    CHECK_EQUAL(frameCount, (int)ceil(plan.duration / FRAME_INTERVAL_MS));
+}
+
+static void testASlowReleaseIsNotAThrow()
+{
+    ThrowSettings settings;
+    ThrowPlan plan;
+    AnimationRect window = windowAt(960, 540, 800, 600);
+    CHECK(!planThrow(window, 0.6f, 0.6f, BOUNDS, settings, &plan));
+    CHECK(!planThrow(window, 0, 0, BOUNDS, settings, &plan));
+    CHECK(planThrow(window, settings.minSpeed, 0, BOUNDS, settings, &plan));
+}
+
+static void testAHardFlickGoesNoFurtherThanTheFastestThrow()
+{
+    ThrowSettings settings;
+    ThrowPlan fastest, harder;
+    AnimationRect window = windowAt(400, 300, 200, 150);
+    CHECK(planThrow(window, settings.maxSpeed, 0, BOUNDS, settings, &fastest));
+    CHECK(planThrow(window, 10 * settings.maxSpeed, 0, BOUNDS, settings, &harder));
+    CHECK(memcmp(&fastest.to, &harder.to, sizeof(AnimationRect)) == 0);
+}
+
+static void testThrowsStopAtTheEdges()
+{
+    ThrowSettings settings;
+    ThrowPlan plan;
+
+    // Gently against the right edge: it stops there
+    AnimationRect window = windowAt(1400, 540, 800, 600);
+    CHECK(planThrow(window, 1.5f, 0, BOUNDS, settings, &plan));
+    CHECK(!plan.isSnapped);
+    CHECK_EQUAL(plan.to.right, BOUNDS.right);
+    CHECK_EQUAL(plan.to.top, window.top);
+
+    // Hard into the right edge: it fills the right half
+    CHECK(planThrow(window, 6.0f, 0, BOUNDS, settings, &plan));
+    CHECK(plan.isSnapped);
+    CHECK(plan.to.left == 960 && plan.to.top == 0 && plan.to.right == 1920 && plan.to.bottom == 1080);
+
+    // Hard into the top left corner: the quarter
+    window = windowAt(500, 400, 800, 600);
+    CHECK(planThrow(window, -6.0f, -6.0f, BOUNDS, settings, &plan));
+    CHECK(plan.to.left == 0 && plan.to.top == 0 && plan.to.right == 960 && plan.to.bottom == 540);
+}
+
+// THROUGH THE HOOKS
+// -----------------
+
+static HWND setUpThrow(bool isAnimated)
+{
+    fakewin::reset();
+    fakewin::addMonitor(MONITOR, WORK_AREA);
+    fakewin::setUnlimitedFrames(false); // An animation only moves on when the test presents a frame
+    Feature::Animations = isAnimated;
+    Feature::KineticThrow = true;
+    Feature::PredictiveDrag = false;
+    HWND hWnd = fakewin::createWindow(L"Notepad", {100, 100, 900, 700});
+    CHECK(setupHooks());
+    return hWnd;
+}
+
+static void tearDownThrow()
+{
+    teardownHooks();
+    fakewin::setUnlimitedFrames(true);
+    teardownAnimations();
+    Feature::KineticThrow = false;
+}
+
+/// @brief Drags the window by its center, and flicks it like `replayFlick`
+/// @return Where the window was when it was let go of
+static RECT flickThroughTheHooks(HWND hWnd)
+{
+    sendKey(VK_LWIN, true);
+    double x = 500, y = 400;
+    double speed = 0;
+    sendMouse(WM_LBUTTONDOWN, (int)x, (int)y);
+    for (int step = 1; step < FLICK_SAMPLES; step++)
+    {
+        fakewin::advance(SAMPLE_INTERVAL);
+        speed += 0.2;
+        x += speed * 8;
+        y -= speed * 2;
+        sendMouse(WM_MOUSEMOVE, (int)lround(x), (int)lround(y));
+    }
+    RECT released = fakewin::window(hWnd)->rect;
+    sendMouse(WM_LBUTTONUP, (int)lround(x), (int)lround(y));
+    sendKey(VK_LWIN, false);
+    return released;
+}
+
+/// @brief Presents frames until the animation thread has nothing left to animate
+static void finishAnimations()
+{
+    CHECK(fakewin::waitUntilParked());
+    for (int frame = 0; frame < 100; frame++)
+    {
+        fakewin::advance(16);
+        if (!fakewin::presentFrame())
+        {
+            return;
+        }
+    }
+    CHECK(!"the glide did not finish");
+}
+
+static void testThrowsAnimateOnlyWhenAnimationsAreOn()
+{
+    // Animated, the window glides on from where it was let go of
+    HWND hWnd = setUpThrow(true);
+    RECT released = flickThroughTheHooks(hWnd);
+    CHECK(memcmp(&fakewin::window(hWnd)->rect, &released, sizeof(RECT)) == 0);
+    finishAnimations();
+    RECT rest = fakewin::window(hWnd)->rect;
+    CHECK(rest.left > released.left + 100 && rest.top < released.top);
+    CHECK(rest.right - rest.left == 800 && rest.bottom - rest.top == 600);
+    tearDownThrow();
+
+    // With animations off in winctrl, it is put where it would have come to rest at once
+    hWnd = setUpThrow(false);
+    RECT releasedAgain = flickThroughTheHooks(hWnd);
+    CHECK(memcmp(&releasedAgain, &released, sizeof(RECT)) == 0);
+    CHECK_RECT(fakewin::window(hWnd)->rect, rest.left, rest.top, rest.right, rest.bottom);
+    tearDownThrow();
+
+    // ... and likewise with a zero animation duration
+    hWnd = setUpThrow(true);
+    fakewin::setIni(L"Animation", L"Duration", L"0");
+    loadAnimationSettings();
+    flickThroughTheHooks(hWnd);
+    CHECK_RECT(fakewin::window(hWnd)->rect, rest.left, rest.top, rest.right, rest.bottom);
+    tearDownThrow();
+
+    fakewin::reset();
+    loadAnimationSettings();
+}
+
+int main()
+{
+    testAFlickGlidesOnAtTheSpeedOfTheCursor();
+    testASlowReleaseIsNotAThrow();
+    testAHardFlickGoesNoFurtherThanTheFastestThrow();
+    testThrowsStopAtTheEdges();
+
+    testThrowsAnimateOnlyWhenAnimationsAreOn();
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,63 @@
+/* An example action plugin (see src/pluginapi.h). It tiles the window under the cursor to the
+ * left or right half of its monitor, and pins it on top with a long press of the middle button.
+ *
+ * Windows: gcc -shared -O2 -iquote src tools/plugin_sample.c -o plugins/sample.dll
+ * Linux:   gcc -shared -fPIC -O2 -iquote src tools/plugin_sample.c -o plugin_sample.so
+ */
+
+#include <stddef.h>
+
+#include "pluginapi.h"
+
+static const WinCtrlHost *s_host = NULL;
+
+/* Places the window on one half of its work area. `userData` is 0 for the left half, 1 for the right */
+static int WINCTRL_CALL tileHalf(void *userData, const WinCtrlWindowView *view)
+{
+    if (!view->window)
+    {
+        return 0;
+    }
+
+    int isRight = userData != NULL;
+    int middle = view->workArea.left + (view->workArea.right - view->workArea.left) / 2;
+
+    WinCtrlCommand command = {0};
+    command.kind = WINCTRL_COMMAND_SET_RECT;
+    command.window = view->window;
+    command.rect = view->workArea;
+    if (isRight)
+        command.rect.left = middle;
+    else
+        command.rect.right = middle;
+
+    s_host->submit(s_host->context, &command, 1);
+    return 1;
+}
+
+static int WINCTRL_CALL pinOnTop(void *userData, const WinCtrlWindowView *view)
+{
+    (void)userData;
+
+    WinCtrlCommand command = {0};
+    command.kind = WINCTRL_COMMAND_TOGGLE_TOPMOST;
+    command.window = view->window;
+    return view->window && s_host->submit(s_host->context, &command, 1) == 1;
+}
+
+WINCTRL_PLUGIN_EXPORT uint32_t WINCTRL_CALL winctrlPluginVersion(void)
+{
+    return WINCTRL_PLUGIN_API_VERSION;
+}
+
+WINCTRL_PLUGIN_EXPORT int WINCTRL_CALL winctrlPluginLoad(const WinCtrlHost *host)
+{
+    s_host = host;
+
+    int result = host->bind(host->context, WINCTRL_GESTURE_ID(WINCTRL_BUTTON_LEFT, WINCTRL_GESTURE_CLICK, WINCTRL_MOD_CTRL), tileHalf, (void *)0);
+    if (result == WINCTRL_OK)
+        result = host->bind(host->context, WINCTRL_GESTURE_ID(WINCTRL_BUTTON_LEFT, WINCTRL_GESTURE_CLICK, WINCTRL_MOD_CTRL | WINCTRL_MOD_SHIFT), tileHalf, (void *)1);
+    if (result == WINCTRL_OK)
+        result = host->bind(host->context, WINCTRL_GESTURE_ID(WINCTRL_BUTTON_MIDDLE, WINCTRL_GESTURE_LONG_PRESS, 0), pinOnTop, NULL);
+    return result;
+}
@@ -0,0 +1,99 @@
+// Prints the live status winctrl publishes in shared memory (see src/statusblock.h). Reading never
+// calls into winctrl, and never blocks it.
+//
+// The exit code tells monitoring scripts whether winctrl is healthy: 0 if it is running with
+// responsive hooks, 1 if it is not running (or has stopped publishing), 2 if its hooks were removed.
+//
+// Usage: status_reader [--watch <ms>]
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "statusblock.h"
+#include "seqlock.h"
+
+/// A status older than this means winctrl has stopped publishing, e.g. because it hangs or crashed
+const ULONGLONG STALE_AFTER_MS = 2000;
+
+enum ExitCode
+{
+    EXIT_HEALTHY = 0,
+    EXIT_NOT_RUNNING = 1,
+    EXIT_HOOKS_REMOVED = 2,
+};
+
+static const char *const FEATURE_NAMES[] = {
+    "enabled", "move", "resize", "transparency", "desktop-scroll",
+    "auto-restore-layout", "hotkeys", "predictive-drag", "animations", "throw",
+};
+
+static int printStatus(const StatusBlock *block)
+{
+    StatusData data;
+    if (!seqlockRead(&block->header.sequence, &block->data, &data))
+    {
+        fputs("winctrl: status is being rewritten too often to read\n", stderr);
+        return EXIT_NOT_RUNNING;
+    }
+
+    ULONGLONG age = GetTickCount64() - data.publishTime;
+    bool isStale = age > STALE_AFTER_MS;
+    bool isResponsive = data.flags & STATUS_HOOKS_RESPONSIVE;
+
+    printf("winctrl (pid %lu, version %lu): %s\n", (unsigned long)data.processId, (unsigned long)block->header.version,
+           isStale ? "not publishing" : (isResponsive ? "healthy" : "hooks removed"));
+    printf("  updated      %llu ms ago\n", (unsigned long long)age);
+    printf("  hooks        %s, %s\n", data.flags & STATUS_HOOKS_INSTALLED ? "installed" : "not installed", isResponsive ? "responsive" : "not responsive");
+    printf("  events       %lu/s (%llu total)\n", (unsigned long)data.eventsPerSecond, (unsigned long long)data.totalEvents);
+    printf("  actions      %lu/s (%llu total)\n", (unsigned long)data.actionsPerSecond, (unsigned long long)data.totalActions);
+    printf("  hook latency %lu us last, %lu us max in the last second\n", (unsigned long)data.lastHookLatency, (unsigned long)data.maxHookLatency);
+    printf("  features    ");
+    for (size_t i = 0; i < sizeof(FEATURE_NAMES) / sizeof(FEATURE_NAMES[0]); i++)
+    {
+        if (data.features & (1u << i))
+        {
+            printf(" %s", FEATURE_NAMES[i]);
+        }
+    }
+    printf("\n");
+
+    return isStale ? EXIT_NOT_RUNNING : (isResponsive ? EXIT_HEALTHY : EXIT_HOOKS_REMOVED);
+}
+
+int main(int argc, char *argv[])
+{
+    DWORD watchInterval = 0;
+    if (argc > 2 && strcmp(argv[1], "--watch") == 0)
+    {
+        watchInterval = (DWORD)atoi(argv[2]);
+    }
+
+    HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, STATUS_MAPPING_NAME);
+    if (!mapping)
+    {
+        fputs("winctrl: not running\n", stderr);
+        return EXIT_NOT_RUNNING;
+    }
+
+    const StatusBlock *block = (const StatusBlock *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!block || __atomic_load_n(&block->header.magic, __ATOMIC_ACQUIRE) != STATUS_MAGIC || block->header.size < sizeof(StatusBlock))
+    {
+        fputs("winctrl: status block not recognized\n", stderr);
+        return EXIT_NOT_RUNNING;
+    }
+
+    // Newer versions only append fields, so the ones known here can always be read
+    int result = printStatus(block);
+    while (watchInterval > 0)
+    {
+        Sleep(watchInterval);
+        printf("\n");
+        result = printStatus(block);
+    }
+
+    UnmapViewOfFile(block);
+    CloseHandle(mapping);
+    return result;
+}